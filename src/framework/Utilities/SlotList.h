@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2008-2014 Hellground <http://hellground.net/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef HELLGROUND_SLOTLIST_H
+#define HELLGROUND_SLOTLIST_H
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+/// Pointer list stored in one contiguous vector. remove() only clears the slot, so iterators stay
+/// valid across push_back() and remove() like std::list ones and iteration skips cleared slots.
+/// Cleared slots are dropped by compact(), which must not be called while someone iterates the list.
+template<class T>
+class SlotList
+{
+    private:
+        typedef std::vector<T> Storage;
+
+        template<class List, class Ref>
+        class iterator_base : public std::iterator<std::forward_iterator_tag, T, ptrdiff_t, T*, Ref>
+        {
+            public:
+                iterator_base() : m_list(NULL), m_index(0) {}
+                iterator_base(List* list, size_t index) : m_list(list), m_index(index) { skip(); }
+
+                // iterator to const_iterator
+                template<class OtherList, class OtherRef>
+                iterator_base(iterator_base<OtherList, OtherRef> const& other) : m_list(other.m_list), m_index(other.m_index) {}
+
+                // cleared slot reads as NULL when its element was removed after iterator got there
+                Ref operator*() const { return m_list->m_slots[m_index]; }
+
+                iterator_base& operator++() { ++m_index; skip(); return *this; }
+                iterator_base operator++(int) { iterator_base tmp = *this; ++*this; return tmp; }
+
+                bool operator==(iterator_base const& other) const { return m_index == other.m_index; }
+                bool operator!=(iterator_base const& other) const { return m_index != other.m_index; }
+
+            private:
+                friend class SlotList;
+                template<class, class> friend class iterator_base;
+
+                void skip()
+                {
+                    while (m_index < m_list->m_slots.size() && !m_list->m_slots[m_index])
+                        ++m_index;
+                }
+
+                List* m_list;
+                size_t m_index;
+        };
+
+    public:
+        typedef T value_type;
+        typedef size_t size_type;
+        typedef iterator_base<SlotList, T&> iterator;
+        typedef iterator_base<SlotList const, T const&> const_iterator;
+
+        SlotList() : m_count(0) {}
+        SlotList(SlotList const& other) : m_count(0) { *this = other; }
+
+        // copies only used slots
+        SlotList& operator=(SlotList const& other)
+        {
+            if (this == &other)
+                return *this;
+
+            m_slots.clear();
+            m_slots.reserve(other.m_count);
+            for (const_iterator itr = other.begin(); itr != other.end(); ++itr)
+                m_slots.push_back(*itr);
+
+            m_count = m_slots.size();
+            return *this;
+        }
+
+        iterator begin() { return iterator(this, 0); }
+        iterator end() { return iterator(this, m_slots.size()); }
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(this, m_slots.size()); }
+
+        size_t size() const { return m_count; }
+        bool empty() const { return !m_count; }
+
+        // list must not be empty
+        T& front() { return *begin(); }
+        T const& front() const { return *begin(); }
+
+        // number of cleared slots waiting for compact()
+        size_t holes() const { return m_slots.size() - m_count; }
+
+        void push_back(T const& value)
+        {
+            m_slots.push_back(value);
+            ++m_count;
+        }
+
+        bool remove(T const& value)
+        {
+            for (typename Storage::iterator itr = m_slots.begin(); itr != m_slots.end(); ++itr)
+            {
+                if (*itr == value)
+                {
+                    *itr = T();
+                    --m_count;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        void clear()
+        {
+            m_slots.clear();
+            m_count = 0;
+        }
+
+        void compact()
+        {
+            if (!holes())
+                return;
+
+            typename Storage::iterator dest = m_slots.begin();
+            for (typename Storage::iterator itr = m_slots.begin(); itr != m_slots.end(); ++itr)
+                if (*itr)
+                    *dest++ = *itr;
+
+            m_slots.erase(dest, m_slots.end());
+        }
+
+    private:
+        Storage m_slots;
+        size_t m_count;
+};
+
+#endif
@@ -20,114 +20,165 @@
 
 #include "ObjectMgr.h"
 #include "Language.h"
+#include "World.h"
 
-int ACRequest::call()
-{
-    Player *pPlayer = sObjectMgr.GetPlayer(m_ownerGUID);
-    if (!pPlayer)
-        return -1;
-
-    // is on taxi
-    if (pPlayer->IsTaxiFlying() || pPlayer->GetTransport())
-        return -1;
+#include <set>
 
-    // charging
-    if (pPlayer->hasUnitState(UNIT_STAT_CHARGING))
-        return -1;
-
-    uint32 latency = pPlayer->GetSession()->GetLatency();
+void ACMapQueue::AddVerdict(ACVerdict const& verdict)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_verdictLock);
+    m_verdicts.push_back(verdict);
+    ++m_pendingVerdicts;
+}
 
-    if (DetectFlyHack(pPlayer))
-    {
-        sLog.outLog(LOG_CHEAT, "Player %s (GUID: %u / ACCOUNT_ID: %u) - possible Fly Cheat. MapId: %u, coords: x: %f, y: %f, z: %f. MOVEMENTFLAGS: %u LATENCY: %u. BG/Arena: %s",
-            pPlayer->GetName(), pPlayer->GetGUIDLow(), pPlayer->GetSession()->GetAccountId(), pPlayer->GetMapId(), GetNewMovementInfo().pos.x, GetNewMovementInfo().pos.y, GetNewMovementInfo().pos.z, GetNewMovementInfo().GetMovementFlags(), latency, pPlayer->GetMap() ? (pPlayer->GetMap()->IsBattleGroundOrArena() ? "Yes" : "No") : "No");
-        
-        pPlayer->CumulativeACReport(ANTICHEAT_CHECK_FLYHACK);
-        pPlayer->SetFlying(false);
-        return -1;
-    }
-    
-    if (DetectSpeedHack(pPlayer))
-        return -1;
-        
-    if (DetectWaterWalkHack(pPlayer))
-    {
-        sLog.outLog(LOG_CHEAT, "Player %s (GUID: %u / ACCOUNT_ID: %u) - possible water walk Cheat. MapId: %u, coords: %f %f %f. MOVEMENTFLAGS: %u LATENCY: %u. BG/Arena: %s",
-            pPlayer->GetName(), pPlayer->GetGUIDLow(), pPlayer->GetSession()->GetAccountId(), pPlayer->GetMapId(), GetNewMovementInfo().pos.x, GetNewMovementInfo().pos.y, GetNewMovementInfo().pos.z, GetNewMovementInfo().GetMovementFlags(), latency, pPlayer->GetMap() ? (pPlayer->GetMap()->IsBattleGroundOrArena() ? "Yes" : "No") : "No");
+bool ACMapQueue::TakeVerdicts(std::vector<ACVerdict>& verdicts)
+{
+    if (!m_pendingVerdicts.value())
+        return false;
 
-        pPlayer->CumulativeACReport(ANTICHEAT_CHECK_WATERWALKHACK);
-        pPlayer->SetMovement(MOVE_LAND_WALK); 
-        return -1;
-    }
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_verdictLock, false);
+    verdicts.swap(m_verdicts);
+    m_pendingVerdicts = 0;
+    return true;
+}
 
-    if (DetectTeleportToPlane(pPlayer))
-        return -1;
+ACBatchRequest::ACBatchRequest(ACMapQueue* queue) : m_queue(queue)
+{
+    m_queue->AddRef();
+    m_queue->TakeSamples(m_samples);
+}
 
-    return 0;
+ACBatchRequest::~ACBatchRequest()
+{
+    m_queue->Release();
 }
 
-bool ACRequest::DetectTeleportToPlane(Player *pPlayer)
+int ACBatchRequest::call()
 {
-    // teleport to plane cheat
-    if (GetNewMovementInfo().pos.z == 0.0f)
+    for (std::vector<ACMovementSample>::const_iterator itr = m_samples.begin(); itr != m_samples.end(); ++itr)
     {
-        float ground_Z = pPlayer->GetTerrain()->GetHeight(GetNewMovementInfo().pos.x, GetNewMovementInfo().pos.y, GetNewMovementInfo().pos.z);
-        float z_diff = fabs(ground_Z - pPlayer->GetPositionZ());
-
-        // we are not really walking there
-        if (z_diff > 1.0f)
-        {
-            sLog.outLog(LOG_CHEAT, "Player %s (GUID: %u / ACCOUNT_ID: %u) - teleport to plane cheat. MapId: %u, MapHeight: %f, coords: %f, %f, %f. MOVEMENTFLAGS: %u LATENCY: %u. BG/Arena: %s", pPlayer->GetName(), pPlayer->GetGUIDLow(), pPlayer->GetSession()->GetAccountId(), pPlayer->GetMapId(), ground_Z, GetNewMovementInfo().pos.x, GetNewMovementInfo().pos.y, GetNewMovementInfo().pos.z, GetNewMovementInfo().GetMovementFlags(), pPlayer->GetSession()->GetLatency() , pPlayer->GetMap() ? (pPlayer->GetMap()->IsBattleGroundOrArena() ? "Yes" : "No") : "No");
-
-            pPlayer->Relocate(GetLastMovementInfo().pos.x, GetLastMovementInfo().pos.y, ground_Z, GetLastMovementInfo().pos.o);
-            pPlayer->GetSession()->KickPlayer();
-            return true;
-        }
+        ACVerdict verdict;
+        verdict.guid = itr->guid;
+        verdict.oldPos = itr->oldPos;
+        verdict.newPos = itr->newPos;
+        verdict.flags = itr->newFlags;
+        verdict.distance = 0.0f;
+        verdict.speed = 0.0f;
+        verdict.clientSpeed = 0.0f;
+
+        if (DetectFlyHack(*itr))
+            verdict.type = AC_VERDICT_FLYHACK;
+        else if (DetectSpeedHack(*itr, verdict))
+            verdict.type = AC_VERDICT_SPEEDHACK;
+        else if (DetectWaterWalkHack(*itr))
+            verdict.type = AC_VERDICT_WATERWALKHACK;
+        else
+            continue;
+
+        m_queue->AddVerdict(verdict);
     }
-    return false;
+
+    return 0;
 }
 
-bool ACRequest::DetectFlyHack(Player *pPlayer)
+bool ACBatchRequest::DetectFlyHack(ACMovementSample const& sample) const
 {
     // forced fly by calling ->SetFlying
-    if (pPlayer->HasByteFlag(UNIT_FIELD_BYTES_1, 3, 0x02))
+    if (sample.state & AC_STATE_FORCED_FLY)
         return false;
 
-    if (!GetLastMovementInfo().HasMovementFlag(MOVEFLAG_FLYING))
+    if (!(sample.oldFlags & MOVEFLAG_FLYING))
         return false;
 
-    if (!GetNewMovementInfo().HasMovementFlag(MOVEFLAG_FLYING))
+    if (!(sample.newFlags & MOVEFLAG_FLYING))
         return false;
 
-    if (pPlayer->HasAuraType(SPELL_AURA_FLY) ||
-        pPlayer->HasAuraType(SPELL_AURA_MOD_SPEED_FLIGHT) ||
-        pPlayer->HasAuraType(SPELL_AURA_MOD_INCREASE_FLIGHT_SPEED) ||
-        pPlayer->HasAuraType(SPELL_AURA_MOD_FLIGHT_SPEED_ALWAYS) ||
-        pPlayer->HasAuraType(SPELL_AURA_MOD_FLIGHT_SPEED_NOT_STACK))
+    if (sample.state & AC_STATE_FLY_AURA)
         return false;
 
     return true;
 }
 
-bool ACRequest::DetectWaterWalkHack(Player *pPlayer)
+bool ACBatchRequest::DetectWaterWalkHack(ACMovementSample const& sample) const
 {
-    if (!GetLastMovementInfo().HasMovementFlag(MOVEFLAG_WATERWALKING))
+    if (!(sample.oldFlags & MOVEFLAG_WATERWALKING))
         return false;
 
     // if we are a ghost we can walk on water
-    if (!pPlayer->isAlive())
+    if (!(sample.state & AC_STATE_ALIVE))
         return false;
 
-    if (pPlayer->HasAuraType(SPELL_AURA_FEATHER_FALL) ||
-        pPlayer->HasAuraType(SPELL_AURA_SAFE_FALL) ||
-        pPlayer->HasAuraType(SPELL_AURA_WATER_WALK))
+    if (sample.state & AC_STATE_WATER_WALK_AURA)
         return false;
 
     return true;
 }
 
-bool ACRequest::DetectSpeedHack(Player *pPlayer)
+bool ACBatchRequest::DetectSpeedHack(ACMovementSample const& sample, ACVerdict& verdict) const
 {
+    float dx = sample.newPos.x - sample.oldPos.x;
+    float dy = sample.newPos.y - sample.oldPos.y;
+
+    float exact2dDist = sqrt(dx*dx + dy*dy);
+
+    // how many yards the player should do in one sec. (server-side speed)
+    float speedRate = sample.speed + sample.jumpXYSpeed;
+
+    // how long the player took to move to here.
+    uint32 timeDiff = WorldTimer::getMSTimeDiff(sample.oldTime, sample.newTime);
+    if (!timeDiff)
+        timeDiff = 1;
+
+    //client-side speed, traveled distance div by movement time.
+    float clientSpeedRate = exact2dDist * 1000 / timeDiff;
+
+    if (clientSpeedRate <= speedRate * sWorld.getConfig(CONFIG_ANTICHEAT_SPEEDHACK_TOLERANCE))
+        return false;
+
+    verdict.distance = exact2dDist;
+    verdict.speed = speedRate;
+    verdict.clientSpeed = clientSpeedRate;
+    return true;
+}
+
+static bool DetectTeleportToPlane(Player* pPlayer, MovementInfo const& newMovement)
+{
+    // teleport to plane cheat
+    if (newMovement.pos.z == 0.0f)
+    {
+        float ground_Z = pPlayer->GetTerrain()->GetHeight(newMovement.pos.x, newMovement.pos.y, newMovement.pos.z);
+        float z_diff = fabs(ground_Z - pPlayer->GetPositionZ());
+
+        // we are not really walking there
+        if (z_diff > 1.0f)
+        {
+            sLog.outLog(LOG_CHEAT, "Player %s (GUID: %u / ACCOUNT_ID: %u) - teleport to plane cheat. MapId: %u, MapHeight: %f, coords: %f, %f, %f. MOVEMENTFLAGS: %u LATENCY: %u. BG/Arena: %s", pPlayer->GetName(), pPlayer->GetGUIDLow(), pPlayer->GetSession()->GetAccountId(), pPlayer->GetMapId(), ground_Z, newMovement.pos.x, newMovement.pos.y, newMovement.pos.z, newMovement.GetMovementFlags(), pPlayer->GetSession()->GetLatency() , pPlayer->GetMap()->IsBattleGroundOrArena() ? "Yes" : "No");
+
+            MovementInfo const& lastMovement = pPlayer->m_movementInfo;
+            pPlayer->Relocate(lastMovement.pos.x, lastMovement.pos.y, ground_Z, lastMovement.pos.o);
+            pPlayer->GetSession()->KickPlayer();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ACQueueMovement(Player* pPlayer, MovementInfo const& newMovement)
+{
+    // is on taxi
+    if (pPlayer->IsTaxiFlying() || pPlayer->GetTransport())
+        return;
+
+    // charging
+    if (pPlayer->hasUnitState(UNIT_STAT_CHARGING))
+        return;
+
+    // needs terrain and current player position, so it's done right away
+    if (DetectTeleportToPlane(pPlayer, newMovement))
+        return;
+
+    MovementInfo const& lastMovement = pPlayer->m_movementInfo;
+
     uint8 moveType = 0;
     if (pPlayer->HasUnitMovementFlag(MOVEFLAG_SWIMMING))
         moveType = MOVE_SWIM;
@@ -138,36 +189,87 @@ bool ACRequest::DetectSpeedHack(Player *pPlayer)
     else
         moveType = MOVE_RUN;
 
-    Position n = GetNewMovementInfo().pos;
-    Position o = GetLastMovementInfo().pos;
+    ACMovementSample sample;
+    sample.guid = pPlayer->GetGUID();
+    sample.oldPos = lastMovement.pos;
+    sample.newPos = newMovement.pos;
+    sample.oldFlags = lastMovement.GetMovementFlags();
+    sample.newFlags = newMovement.GetMovementFlags();
+    sample.oldTime = lastMovement.time;
+    sample.newTime = newMovement.time;
+    sample.jumpXYSpeed = newMovement.j_xyspeed;
+    sample.speed = pPlayer->GetSpeed(UnitMoveType(moveType));
+    sample.state = 0;
 
-    n.x = n.x - o.x;
-    n.y = n.y - o.y;
+    if (pPlayer->HasByteFlag(UNIT_FIELD_BYTES_1, 3, 0x02))
+        sample.state |= AC_STATE_FORCED_FLY;
 
-    float exact2dDist = sqrt(n.x*n.x + n.y*n.y);
+    if (pPlayer->HasAuraType(SPELL_AURA_FLY) ||
+        pPlayer->HasAuraType(SPELL_AURA_MOD_SPEED_FLIGHT) ||
+        pPlayer->HasAuraType(SPELL_AURA_MOD_INCREASE_FLIGHT_SPEED) ||
+        pPlayer->HasAuraType(SPELL_AURA_MOD_FLIGHT_SPEED_ALWAYS) ||
+        pPlayer->HasAuraType(SPELL_AURA_MOD_FLIGHT_SPEED_NOT_STACK))
+        sample.state |= AC_STATE_FLY_AURA;
 
-    // how many yards the player should do in one sec. (server-side speed)
-    float speedRate = pPlayer->GetSpeed(UnitMoveType(moveType)) + GetNewMovementInfo().j_xyspeed;
+    if (pPlayer->isAlive())
+        sample.state |= AC_STATE_ALIVE;
 
-    // how long the player took to move to here.
-    uint32 timeDiff = WorldTimer::getMSTimeDiff(GetLastMovementInfo().time, GetNewMovementInfo().time);
-    if (!timeDiff)
-        timeDiff = 1;
+    if (pPlayer->HasAuraType(SPELL_AURA_FEATHER_FALL) ||
+        pPlayer->HasAuraType(SPELL_AURA_SAFE_FALL) ||
+        pPlayer->HasAuraType(SPELL_AURA_WATER_WALK))
+        sample.state |= AC_STATE_WATER_WALK_AURA;
 
-    //client-side speed, traveled distance div by movement time.
-    float clientSpeedRate = exact2dDist * 1000 / timeDiff;
+    pPlayer->GetMap()->GetAntiCheatQueue()->AddSample(sample);
+}
 
-    if (clientSpeedRate <= speedRate * sWorld.getConfig(CONFIG_ANTICHEAT_SPEEDHACK_TOLERANCE))
-        return false;
+void ACApplyVerdicts(Map* map, ACMapQueue* queue)
+{
+    std::vector<ACVerdict> verdicts;
+    if (!queue->TakeVerdicts(verdicts))
+        return;
 
-    pPlayer->m_AC_timer = IN_MILISECONDS;   // 1 sek
+    // player moving many times in one map update gets many verdicts, act and report only on first of each type
+    std::set<std::pair<uint64, ACVerdictType> > applied;
 
-    sWorld.SendGMText(LANG_ANTICHEAT_SPEEDHACK, pPlayer->GetName(), pPlayer->GetName(), 0, speedRate, clientSpeedRate);
-    sLog.outLog(LOG_CHEAT, "Player %s (GUID: %u / ACCOUNT_ID: %u) moved for distance %f with server speed : %f (client speed: %f). MapID: %u, player's coord before X:%f Y:%f Z:%f. Player's coord now X:%f Y:%f Z:%f. MOVEMENTFLAGS: %u LATENCY: %u. BG/Arena: %s\n",
-        pPlayer->GetName(), pPlayer->GetGUIDLow(), pPlayer->GetSession()->GetAccountId(), exact2dDist, speedRate,
-        clientSpeedRate, pPlayer->GetMapId(), GetLastMovementInfo().pos.x, GetLastMovementInfo().pos.y, GetLastMovementInfo().pos.z,
-        GetNewMovementInfo().pos.x, GetNewMovementInfo().pos.y, GetNewMovementInfo().pos.z,
-        GetNewMovementInfo().GetMovementFlags(), pPlayer->GetSession()->GetLatency(),
-        pPlayer->GetMap() ? (pPlayer->GetMap()->IsBattleGroundOrArena() ? "Yes" : "No") : "No");
-    return true;
+    for (std::vector<ACVerdict>::const_iterator itr = verdicts.begin(); itr != verdicts.end(); ++itr)
+    {
+        if (!applied.insert(std::make_pair(itr->guid, itr->type)).second)
+            continue;
+
+        // player could leave map meanwhile
+        Player* pPlayer = sObjectMgr.GetPlayer(itr->guid);
+        if (!pPlayer || !pPlayer->IsInWorld() || pPlayer->GetMap() != map)
+            continue;
+
+        uint32 latency = pPlayer->GetSession()->GetLatency();
+        char const* inBG = map->IsBattleGroundOrArena() ? "Yes" : "No";
+
+        switch (itr->type)
+        {
+            case AC_VERDICT_FLYHACK:
+                sLog.outLog(LOG_CHEAT, "Player %s (GUID: %u / ACCOUNT_ID: %u) - possible Fly Cheat. MapId: %u, coords: x: %f, y: %f, z: %f. MOVEMENTFLAGS: %u LATENCY: %u. BG/Arena: %s",
+                    pPlayer->GetName(), pPlayer->GetGUIDLow(), pPlayer->GetSession()->GetAccountId(), pPlayer->GetMapId(), itr->newPos.x, itr->newPos.y, itr->newPos.z, itr->flags, latency, inBG);
+
+                pPlayer->CumulativeACReport(ANTICHEAT_CHECK_FLYHACK);
+                pPlayer->SetFlying(false);
+                break;
+            case AC_VERDICT_SPEEDHACK:
+                pPlayer->m_AC_timer = IN_MILISECONDS;   // 1 sek
+
+                sWorld.SendGMText(LANG_ANTICHEAT_SPEEDHACK, pPlayer->GetName(), pPlayer->GetName(), 0, itr->speed, itr->clientSpeed);
+                sLog.outLog(LOG_CHEAT, "Player %s (GUID: %u / ACCOUNT_ID: %u) moved for distance %f with server speed : %f (client speed: %f). MapID: %u, player's coord before X:%f Y:%f Z:%f. Player's coord now X:%f Y:%f Z:%f. MOVEMENTFLAGS: %u LATENCY: %u. BG/Arena: %s\n",
+                    pPlayer->GetName(), pPlayer->GetGUIDLow(), pPlayer->GetSession()->GetAccountId(), itr->distance, itr->speed,
+                    itr->clientSpeed, pPlayer->GetMapId(), itr->oldPos.x, itr->oldPos.y, itr->oldPos.z,
+                    itr->newPos.x, itr->newPos.y, itr->newPos.z, itr->flags, latency, inBG);
+                break;
+            case AC_VERDICT_WATERWALKHACK:
+                sLog.outLog(LOG_CHEAT, "Player %s (GUID: %u / ACCOUNT_ID: %u) - possible water walk Cheat. MapId: %u, coords: %f %f %f. MOVEMENTFLAGS: %u LATENCY: %u. BG/Arena: %s",
+                    pPlayer->GetName(), pPlayer->GetGUIDLow(), pPlayer->GetSession()->GetAccountId(), pPlayer->GetMapId(), itr->newPos.x, itr->newPos.y, itr->newPos.z, itr->flags, latency, inBG);
+
+                pPlayer->CumulativeACReport(ANTICHEAT_CHECK_WATERWALKHACK);
+                pPlayer->SetMovement(MOVE_LAND_WALK);
+                break;
+        }
+    }
 }
+
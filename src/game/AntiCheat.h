@@ -19,31 +19,109 @@
 #ifndef HELLGROUND_ANTICHEAT_H
 #define HELLGROUND_ANTICHEAT_H
 
+#include <ace/Atomic_Op.h>
 #include <ace/Method_Request.h>
+#include <ace/Thread_Mutex.h>
 
 #include "Player.h"
 
-class ACRequest : public ACE_Method_Request
+#include <vector>
+
+enum ACSampleState
+{
+    AC_STATE_FORCED_FLY         = 0x01,                     // flying set by SetFlying
+    AC_STATE_FLY_AURA           = 0x02,
+    AC_STATE_ALIVE              = 0x04,
+    AC_STATE_WATER_WALK_AURA    = 0x08                      // water walk, feather fall or safe fall
+};
+
+/// One movement step with player state it has to be checked against, captured on map thread
+struct ACMovementSample
+{
+    uint64 guid;
+    Position oldPos;
+    Position newPos;
+    uint32 oldFlags;
+    uint32 newFlags;
+    uint32 oldTime;
+    uint32 newTime;
+    float jumpXYSpeed;
+    float speed;                                            // server side speed for current movement type
+    uint8 state;                                            // ACSampleState
+};
+
+enum ACVerdictType
+{
+    AC_VERDICT_FLYHACK,
+    AC_VERDICT_SPEEDHACK,
+    AC_VERDICT_WATERWALKHACK
+};
+
+struct ACVerdict
+{
+    uint64 guid;
+    ACVerdictType type;
+    Position oldPos;
+    Position newPos;
+    uint32 flags;
+    float distance;
+    float speed;
+    float clientSpeed;
+};
+
+/// Movement samples of one map collected during its update and verdicts for them.
+/// Shared by the map and its batches being checked, deleted with the last reference.
+class ACMapQueue
 {
     public:
-        ACRequest(Player *player, MovementInfo lastPacket, MovementInfo newPacket)
-            : m_ownerGUID(player->GetGUID()), m_oldMovement(lastPacket), m_newMovement(newPacket) {}
+        ACMapQueue() : m_refs(1), m_pendingVerdicts(0) {}
 
-        virtual int call();
+        void AddRef() { ++m_refs; }
+        void Release() { if (--m_refs == 0) delete this; }
 
-        bool DetectWaterWalkHack(Player *);
-        bool DetectTeleportToPlane(Player*);
-        bool DetectFlyHack(Player*);
-        bool DetectSpeedHack(Player*);
+        // map thread only
+        void AddSample(ACMovementSample const& sample) { m_samples.push_back(sample); }
+        void TakeSamples(std::vector<ACMovementSample>& samples) { samples.swap(m_samples); }
+        bool HasSamples() const { return !m_samples.empty(); }
 
-        MovementInfo &GetLastMovementInfo() { return m_oldMovement; }
-        MovementInfo &GetNewMovementInfo() { return m_newMovement; }
+        // called by checking threads
+        void AddVerdict(ACVerdict const& verdict);
+
+        // map thread, doesn't lock when there is nothing to take
+        bool TakeVerdicts(std::vector<ACVerdict>& verdicts);
 
     private:
-        uint64 m_ownerGUID;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_refs;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_pendingVerdicts;
+
+        std::vector<ACMovementSample> m_samples;
 
-        MovementInfo m_oldMovement;
-        MovementInfo m_newMovement;
+        ACE_Thread_Mutex m_verdictLock;
+        std::vector<ACVerdict> m_verdicts;
 };
 
+/// Checks all samples collected by one map in one update
+class ACBatchRequest : public ACE_Method_Request
+{
+    public:
+        explicit ACBatchRequest(ACMapQueue* queue);
+        ~ACBatchRequest();
+
+        virtual int call();
+
+    private:
+        bool DetectFlyHack(ACMovementSample const& sample) const;
+        bool DetectWaterWalkHack(ACMovementSample const& sample) const;
+        bool DetectSpeedHack(ACMovementSample const& sample, ACVerdict& verdict) const;
+
+        ACMapQueue* m_queue;
+        std::vector<ACMovementSample> m_samples;
+};
+
+/// map thread: capture sample of new movement of player for next batch of its map
+void ACQueueMovement(Player* player, MovementInfo const& newMovement);
+
+/// map thread: act on verdicts for players of given map
+void ACApplyVerdicts(Map* map, ACMapQueue* queue);
+
 #endif
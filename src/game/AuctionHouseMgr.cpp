@@ -566,31 +566,41 @@ AuctionHouseEntry const* AuctionHouseMgr::GetAuctionHouseEntry(Unit* unit)
 void AuctionHouseObject::Update()
 {
     time_t curTime = sWorld.GetGameTime();
-    ///- Handle expired auctions
-    for (AuctionEntryMap::iterator itr = AuctionsMap.begin(); itr != AuctionsMap.end();)
+
+    // nothing expired yet, queue top is the earliest expire time
+    if (AuctionsExpireQueue.empty() || curTime <= AuctionsExpireQueue.top().first)
+        return;
+
+    ///- Handle expired auctions, all mails and DB changes of this tick go in one transaction
+    RealmDataDatabase.BeginNestedTransaction();
+    while (!AuctionsExpireQueue.empty() && curTime > AuctionsExpireQueue.top().first)
     {
-        if (curTime > itr->second->expireTime)
+        AuctionExpireEntry expired = AuctionsExpireQueue.top();
+        AuctionsExpireQueue.pop();
+
+        AuctionEntryMap::iterator itr = AuctionsMap.find(expired.second);
+
+        // auction already bought out or canceled
+        if (itr == AuctionsMap.end() || itr->second->expireTime != expired.first)
+            continue;
+
+        AuctionEntry* auction = itr->second;
+
+        ///- perform the transaction if there was bidder
+        if (auction->bid)
+            auction->AuctionBidWinning();
+        ///- cancel the auction if there was no bidder and clear the auction
+        else
         {
-            ///- perform the transaction if there was bidder
-            if (itr->second->bid)
-            {
-                AuctionEntryMap::iterator current = itr++;
-                current->second->AuctionBidWinning();
-            }
-            ///- cancel the auction if there was no bidder and clear the auction
-            else
-            {
-                sAuctionMgr.SendAuctionExpiredMail(itr->second);
+            sAuctionMgr.SendAuctionExpiredMail(auction);
 
-                itr->second->DeleteFromDB();
-                sAuctionMgr.RemoveAItem(itr->second->itemGuidLow);
-                delete itr->second;
-                AuctionsMap.erase(itr++);
-            }
+            auction->DeleteFromDB();
+            sAuctionMgr.RemoveAItem(auction->itemGuidLow);
+            AuctionsMap.erase(itr);
+            delete auction;
         }
-        else
-            ++itr;
     }
+    RealmDataDatabase.CommitTransaction();
 }
 
 void AuctionHouseObject::BuildListBidderItems(WorldPacket& data, Player* player, uint32& count, uint32& totalcount)
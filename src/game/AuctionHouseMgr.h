@@ -103,6 +103,10 @@ class AuctionHouseObject
         typedef std::map<uint32, AuctionEntry*> AuctionEntryMap;
         typedef std::pair<AuctionEntryMap::const_iterator, AuctionEntryMap::const_iterator> AuctionEntryMapBounds;
 
+        // (expire time, auction id), earliest expire time on top
+        typedef std::pair<time_t, uint32> AuctionExpireEntry;
+        typedef std::priority_queue<AuctionExpireEntry, std::vector<AuctionExpireEntry>, std::greater<AuctionExpireEntry> > AuctionExpireQueue;
+
         uint32 GetCount() { return AuctionsMap.size(); }
 
         AuctionEntryMap const& GetAuctions() const { return AuctionsMap; }
@@ -113,6 +117,7 @@ class AuctionHouseObject
         {
             ASSERT(ah);
             AuctionsMap[ah->Id] = ah;
+            AuctionsExpireQueue.push(AuctionExpireEntry(ah->expireTime, ah->Id));
         }
 
         AuctionEntry* GetAuction(uint32 id) const
@@ -121,6 +126,7 @@ class AuctionHouseObject
             return itr != AuctionsMap.end() ? itr->second : NULL;
         }
 
+        // expire queue entry is left in place and skipped at Update() when auction is gone
         bool RemoveAuction(uint32 id)
         {
             return AuctionsMap.erase(id);
@@ -134,6 +140,7 @@ class AuctionHouseObject
         AuctionEntry* AddAuction(AuctionHouseEntry const* auctionHouseEntry, Item* newItem, uint32 etime, uint32 bid, uint32 buyout = 0, uint32 deposit = 0, Player * pl = NULL);
     private:
         AuctionEntryMap AuctionsMap;
+        AuctionExpireQueue AuctionsExpireQueue;
 };
 
 class AuctionSorter
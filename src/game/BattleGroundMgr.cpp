@@ -46,6 +46,8 @@
 
 BattleGroundQueue::BattleGroundQueue()
 {
+    memset(m_WaitingGroups, 0, sizeof(m_WaitingGroups));
+
     for (int i = 0; i < MAX_BATTLEGROUND_BRACKETS; ++i)
     {
         queuedPlayersCount[BG_TEAM_ALLIANCE][i] = 0;
@@ -150,6 +152,7 @@ GroupQueueInfo * BattleGroundQueue::AddGroup(Player *leader, BattleGroundTypeId
     ginfo->HiddenRating              = hiddenRating;
     ginfo->OpponentsTeamRating       = 0;
     ginfo->OpponentsHiddenRating     = 0;
+    ginfo->BracketId                 = bracketId;
 
     ginfo->Players.clear();
 
@@ -161,7 +164,9 @@ GroupQueueInfo * BattleGroundQueue::AddGroup(Player *leader, BattleGroundTypeId
         index++;
     DEBUG_LOG("Adding Group to BattleGroundQueue bgTypeId : %u, bracket_id : %u, index : %u", BgTypeId, bracketId, index);
 
-    m_QueuedGroups[bracketId][index].push_back(ginfo);
+    ginfo->QueueIndex = index;
+    ginfo->QueueItr = m_QueuedGroups[bracketId][index].insert(m_QueuedGroups[bracketId][index].end(), ginfo);
+    ++m_WaitingGroups[bracketId][index];
 
     // return ginfo, because it is needed to add players to this group info
     return ginfo;
@@ -188,7 +193,6 @@ void BattleGroundQueue::RemovePlayer(const uint64& guid, bool decreaseInvitedCou
 {
     //Player *plr = sObjectMgr.GetPlayer(guid);
 
-    int32 bracket_id = -1;                                     // signed for proper for-loop finish
     QueuedPlayersMap::iterator itr;
 
     //remove player from map, if he's there
@@ -199,38 +203,11 @@ void BattleGroundQueue::RemovePlayer(const uint64& guid, bool decreaseInvitedCou
         return;
     }
 
+    // group remembers its queue list position, no need to search all brackets
     GroupQueueInfo* group = itr->second.GroupInfo;
-    GroupsQueueType::iterator group_itr, group_itr_tmp;
-    // mostly people with the highest levels are in battlegrounds, thats why
-    // we count from MAX_BATTLEGROUND_QUEUES - 1 to 0
-    // variable index removes useless searching in other team's queue
-    uint32 index = (group->Team == HORDE) ? BG_TEAM_HORDE : BG_TEAM_ALLIANCE;
+    BattleGroundBracketId bracket_id = group->BracketId;
+    uint32 index = group->QueueIndex;
 
-    for (int32 bracket_id_tmp = MAX_BATTLEGROUND_BRACKETS - 1; bracket_id_tmp >= 0 && bracket_id == -1; --bracket_id_tmp)
-    {
-        //we must check premade and normal team's queue - because when players from premade are joining bg,
-        //they leave groupinfo so we can't use its players size to find out index
-        for (uint32 j = index; j < BG_QUEUE_GROUP_TYPES_COUNT; j += BG_QUEUE_NORMAL_ALLIANCE)
-        {
-            for(group_itr_tmp = m_QueuedGroups[bracket_id_tmp][j].begin(); group_itr_tmp != m_QueuedGroups[bracket_id_tmp][j].end(); ++group_itr_tmp)
-            {
-                if ((*group_itr_tmp) == group)
-                {
-                    bracket_id = bracket_id_tmp;
-                    group_itr = group_itr_tmp;
-                    //we must store index to be able to erase iterator
-                    index = j;
-                    break;
-                }
-            }
-        }
-    }
-    //player can't be in queue without group, but just in case
-    if (bracket_id == -1)
-    {
-        sLog.outLog(LOG_DEFAULT, "ERROR: BattleGroundQueue: ERROR Cannot find groupinfo for player GUID: %u", GUID_LOPART(guid));
-        return;
-    }
     DEBUG_LOG("BattleGroundQueue: Removing player GUID %u, from bracket_id %u", GUID_LOPART(guid), (uint32)bracket_id);
 
     // ALL variables are correctly set
@@ -259,7 +236,10 @@ void BattleGroundQueue::RemovePlayer(const uint64& guid, bool decreaseInvitedCou
     // remove group queue info if needed
     if (group->Players.empty())
     {
-        m_QueuedGroups[bracket_id][index].erase(group_itr);
+        if (!group->IsInvitedToBGInstanceGUID)
+            --m_WaitingGroups[bracket_id][index];
+
+        m_QueuedGroups[bracket_id][index].erase(group->QueueItr);
         delete group;
     }
     // if group wasn't empty, so it wasn't deleted, and player have left a rated
@@ -296,6 +276,7 @@ bool BattleGroundQueue::InviteGroupToBG(GroupQueueInfo * ginfo, BattleGround * b
         // not yet invited
         // set invitation
         ginfo->IsInvitedToBGInstanceGUID = bg->GetInstanceID();
+        --m_WaitingGroups[ginfo->BracketId][ginfo->QueueIndex];
         BattleGroundQueueTypeId bgQueueTypeId = BattleGroundMgr::BGQueueTypeId(bg->GetTypeID(), bg->GetArenaType());
         // loop through the players
         for(std::map<uint64,PlayerQueueInfo*>::iterator itr = ginfo->Players.begin(); itr != ginfo->Players.end(); ++itr)
@@ -518,8 +499,7 @@ bool BattleGroundQueue::CheckPremadeMatch(BattleGroundBracketId bracket_id, uint
             if (!(*itr)->IsInvitedToBGInstanceGUID && ((*itr)->JoinTime < time_before || (*itr)->Players.size() < MinPlayersPerTeam))
             {
                 //we must insert group to normal queue and erase pointer from premade queue
-                m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + i].push_front((*itr));
-                m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE + i].erase(itr);
+                MoveGroup(*itr, BG_QUEUE_NORMAL_ALLIANCE + i);
             }
         }
     }
@@ -589,12 +569,9 @@ bool BattleGroundQueue::CheckSkirmishForSameFaction(BattleGroundBracketId bracke
     //store last ginfo pointer
     GroupQueueInfo* ginfo = m_SelectionPools[teamIndex].SelectedGroups.back();
     //set itr_team to group that was added to selection pool latest
-    GroupsQueueType::iterator itr_team = m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + teamIndex].begin();
-    for(; itr_team != m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + teamIndex].end(); ++itr_team)
-        if (ginfo == *itr_team)
-            break;
-    if (itr_team == m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + teamIndex].end())
+    if (ginfo->QueueIndex != BG_QUEUE_NORMAL_ALLIANCE + teamIndex)
         return false;
+    GroupsQueueType::iterator itr_team = ginfo->QueueItr;
     GroupsQueueType::iterator itr_team2 = itr_team;
     ++itr_team2;
     //invite players to other selection pool
@@ -612,19 +589,8 @@ bool BattleGroundQueue::CheckSkirmishForSameFaction(BattleGroundBracketId bracke
     {
         //set correct team
         (*itr)->Team = otherTeamId;
-        //add team to other queue
-        m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + otherTeam].push_front(*itr);
-        //remove team from old queue
-        GroupsQueueType::iterator itr2 = itr_team;
-        ++itr2;
-        for(; itr2 != m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + teamIndex].end(); ++itr2)
-        {
-            if (*itr2 == *itr)
-            {
-                m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + teamIndex].erase(itr2);
-                break;
-            }
-        }
+        //move team to other queue
+        MoveGroup(*itr, BG_QUEUE_NORMAL_ALLIANCE + otherTeam);
     }
     return true;
 }
@@ -636,11 +602,8 @@ should be called from BattleGround::RemovePlayer function in some cases
 */
 void BattleGroundQueue::Update(BattleGroundTypeId bgTypeId, BattleGroundBracketId bracket_id, uint8 arenaType, bool isRated, uint32 arenaRating, uint32 hiddenRating)
 {
-    //if no players in queue - do nothing
-    if( m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE].empty() &&
-        m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_HORDE].empty() &&
-        m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE].empty() &&
-        m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_HORDE].empty() )
+    //if no players waiting for invitation in queue - do nothing, already invited groups can't be matched again
+    if (!HasWaitingGroups(bracket_id))
         return;
 
     //battleground with free slot for player should be always in the beggining of the queue
@@ -925,20 +888,11 @@ void BattleGroundQueue::Update(BattleGroundTypeId bgTypeId, BattleGroundBracketI
             (*(itr_team[BG_TEAM_HORDE]))->OpponentsHiddenRating = (*(itr_team[BG_TEAM_ALLIANCE]))->HiddenRating;
             DEBUG_LOG("setting oposite teamrating for team %u to %u", (*(itr_team[BG_TEAM_HORDE]))->ArenaTeamId, (*(itr_team[BG_TEAM_HORDE]))->OpponentsTeamRating);
             // now we must move team if we changed its faction to another faction queue, because then we will spam log by errors in Queue::RemovePlayer
+            // moving keeps list iterators valid
             if ((*(itr_team[BG_TEAM_ALLIANCE]))->Team != ALLIANCE)
-            {
-                // add to alliance queue
-                m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE].push_front(*(itr_team[BG_TEAM_ALLIANCE]));
-                // erase from horde queue
-                m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_HORDE].erase(itr_team[BG_TEAM_ALLIANCE]);
-                itr_team[BG_TEAM_ALLIANCE] = m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE].begin();
-            }
+                MoveGroup(*(itr_team[BG_TEAM_ALLIANCE]), BG_QUEUE_PREMADE_ALLIANCE);
             if ((*(itr_team[BG_TEAM_HORDE]))->Team != HORDE)
-            {
-                m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_HORDE].push_front(*(itr_team[BG_TEAM_HORDE]));
-                m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE].erase(itr_team[BG_TEAM_HORDE]);
-                itr_team[BG_TEAM_HORDE] = m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_HORDE].begin();
-            }
+                MoveGroup(*(itr_team[BG_TEAM_HORDE]), BG_QUEUE_PREMADE_HORDE);
 
             InviteGroupToBG(*(itr_team[BG_TEAM_ALLIANCE]), arena, ALLIANCE);
             InviteGroupToBG(*(itr_team[BG_TEAM_HORDE]), arena, HORDE);
@@ -950,6 +904,32 @@ void BattleGroundQueue::Update(BattleGroundTypeId bgTypeId, BattleGroundBracketI
     }
 }
 
+void BattleGroundQueue::MoveGroup(GroupQueueInfo* ginfo, uint32 index)
+{
+    GroupsQueueType& from = m_QueuedGroups[ginfo->BracketId][ginfo->QueueIndex];
+    GroupsQueueType& to = m_QueuedGroups[ginfo->BracketId][index];
+
+    // splice doesn't invalidate QueueItr, it now points into the new list
+    to.splice(to.begin(), from, ginfo->QueueItr);
+
+    if (!ginfo->IsInvitedToBGInstanceGUID)
+    {
+        --m_WaitingGroups[ginfo->BracketId][ginfo->QueueIndex];
+        ++m_WaitingGroups[ginfo->BracketId][index];
+    }
+
+    ginfo->QueueIndex = index;
+}
+
+bool BattleGroundQueue::HasWaitingGroups(BattleGroundBracketId bracketId) const
+{
+    for (uint32 i = 0; i < BG_QUEUE_GROUP_TYPES_COUNT; ++i)
+        if (m_WaitingGroups[bracketId][i])
+            return true;
+
+    return false;
+}
+
 uint32 BattleGroundQueue::GetQueuedPlayersCount(BattleGroundTeamId team, BattleGroundBracketId bracketId)
 {
     if (bracketId >= MAX_BATTLEGROUND_BRACKETS || team >= BG_TEAMS_COUNT)
@@ -61,6 +61,10 @@ struct GroupQueueInfo                                       // stores informatio
     uint32  OpponentsTeamRating;                            // for rated arena matches
     uint32  OpponentsHiddenRating;                          // for rated arena matches
 
+    BattleGroundBracketId BracketId;                        // queue list holding the group,
+    uint8   QueueIndex;                                     // kept up to date when group is moved between lists
+    std::list<GroupQueueInfo*>::iterator QueueItr;
+
     BattleGroundTeamId GetBGTeam()
     {
         return Team == HORDE ? BG_TEAM_HORDE : BG_TEAM_ALLIANCE;
@@ -96,6 +100,7 @@ class BattleGroundQueue
         void BGEndedRemoveInvites(BattleGround * bg);
 
         uint32 GetQueuedPlayersCount(BattleGroundTeamId team, BattleGroundBracketId bracketId);
+        bool HasWaitingGroups(BattleGroundBracketId bracketId) const;
 
         typedef std::map<uint64, PlayerQueueInfo> QueuedPlayersMap;
         QueuedPlayersMap m_QueuedPlayers;
@@ -137,6 +142,11 @@ class BattleGroundQueue
     private:
 
         bool InviteGroupToBG(GroupQueueInfo * ginfo, BattleGround * bg, uint32 side);
+        // moves group to the front of other queue list in the same bracket
+        void MoveGroup(GroupQueueInfo* ginfo, uint32 index);
+
+        // groups not invited yet, no match can be made in bracket without them
+        uint32 m_WaitingGroups[MAX_BATTLEGROUND_BRACKETS][BG_QUEUE_GROUP_TYPES_COUNT];
 };
 
 /*
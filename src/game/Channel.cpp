@@ -126,10 +126,7 @@ void Channel::Join(uint64 p, const char *pass)
 
     data.clear();
 
-    PlayerInfo pinfo;
-    pinfo.player = p;
-    pinfo.flags = 0;
-    players[p] = pinfo;
+    AddMember(p, plr);
 
     MakeYouJoined(&data);
     SendToOne(&data, p);
@@ -171,7 +168,7 @@ void Channel::Leave(uint64 p, bool send)
 
         bool changeowner = players[p].IsOwner();
 
-        players.erase(p);
+        RemoveMember(p);
         if (m_announce && (!plr || !plr->GetSession()->HasPermissions(PERM_GMT) || !sWorld.getConfig(CONFIG_SILENTLY_GM_JOIN_TO_CHANNEL)))
         {
             WorldPacket data;
@@ -235,7 +232,7 @@ void Channel::KickOrBan(uint64 good, const char *badname, bool ban)
                 MakePlayerKicked(&data, bad->GetGUID(), good);
 
             SendToAll(&data);
-            players.erase(bad->GetGUID());
+            RemoveMember(bad->GetGUID());
             bad->LeftChannel(this);
 
             if (changeowner)
@@ -470,9 +467,9 @@ void Channel::List(Player* player)
         bool gmInWhoList = sWorld.getConfig(CONFIG_GM_IN_WHO_LIST) || player->GetSession()->HasPermissions(PERM_GMT_HDEV);
 
         uint32 count  = 0;
-        for (PlayerList::iterator i = players.begin(); i != players.end(); ++i)
+        for (MemberList::const_iterator i = m_members.begin(); i != m_members.end(); ++i)
         {
-            Player *user = sObjectMgr.GetPlayer(i->first);
+            Player *user = (*i)->plr;
             if (!user)
                 continue;
 
@@ -480,8 +477,8 @@ void Channel::List(Player* player)
             // MODERATOR, GAME MASTER, ADMINISTRATOR can see all
             if (!user->GetSession()->HasPermissions(PERM_GMT) || gmInWhoList)
             {
-                data << uint64(i->first);
-                data << uint8(i->second.flags);             // flags seems to be changed...
+                data << uint64((*i)->player);
+                data << uint8((*i)->flags);                 // flags seems to be changed...
                 ++count;
             }
         }
@@ -703,14 +700,44 @@ void Channel::SetOwner(uint64 guid, bool exclaim)
     }
 }
 
+void Channel::AddMember(uint64 guid, Player* plr)
+{
+    PlayerInfo& info = players[guid];
+    info.player = guid;
+    info.flags = 0;
+    info.plr = plr;
+    info.slot = m_members.size();
+    m_members.push_back(&info);
+}
+
+void Channel::RemoveMember(uint64 guid)
+{
+    PlayerList::iterator itr = players.find(guid);
+    if (itr == players.end())
+        return;
+
+    // entries created by players[] lookups of non members were never added to member list
+    uint32 slot = itr->second.slot;
+    if (slot < m_members.size() && m_members[slot] == &itr->second)
+    {
+        m_members[slot] = m_members.back();
+        m_members[slot]->slot = slot;
+        m_members.pop_back();
+    }
+
+    players.erase(itr);
+}
+
+// members are sent through cached Player pointers, no global player lookup per member
 void Channel::SendToAll(WorldPacket *data, uint64 p)
 {
-    for (PlayerList::iterator i = players.begin(); i != players.end(); ++i)
+    uint32 ignoreGuid = GUID_LOPART(p);
+    for (MemberList::const_iterator i = m_members.begin(); i != m_members.end(); ++i)
     {
-        Player *plr = sObjectMgr.GetPlayer(i->first);
+        Player *plr = (*i)->plr;
         if (plr)
         {
-            if (!p || !plr->GetSocial()->HasIgnore(GUID_LOPART(p)))
+            if (!p || !plr->GetSocial()->HasIgnore(ignoreGuid))
                 plr->SendPacketToSelf(data);
         }
     }
@@ -718,14 +745,10 @@ void Channel::SendToAll(WorldPacket *data, uint64 p)
 
 void Channel::SendToAllButOne(WorldPacket *data, uint64 who)
 {
-    for (PlayerList::iterator i = players.begin(); i != players.end(); ++i)
+    for (MemberList::const_iterator i = m_members.begin(); i != m_members.end(); ++i)
     {
-        if (i->first != who)
-        {
-            Player *plr = sObjectMgr.GetPlayer(i->first);
-            if (plr)
-                plr->SendPacketToSelf(data);
-        }
+        if ((*i)->player != who && (*i)->plr)
+            (*i)->plr->SendPacketToSelf(data);
     }
 }
 
@@ -30,6 +30,7 @@
 #include <list>
 #include <map>
 #include <string>
+#include <vector>
 
 enum ChannelDBCFlags
     {
@@ -122,8 +123,12 @@ class Channel
 
     struct PlayerInfo
     {
+        PlayerInfo() : player(0), flags(0), plr(NULL), slot(0) {}
+
         uint64 player;
         uint8 flags;
+        Player* plr;                                        // cached on join, members always leave before Player is destroyed
+        uint32 slot;                                        // position in member list
 
         bool HasFlag(uint8 flag) { return flags & flag; }
         void SetFlag(uint8 flag) { if (!HasFlag(flag)) flags |= flag; }
@@ -149,6 +154,8 @@ class Channel
 
     typedef     std::map<uint64, PlayerInfo> PlayerList;
     PlayerList  players;
+    typedef     std::vector<PlayerInfo*> MemberList;
+    MemberList  m_members;                                  // dense copy of players for packet fan-out
     typedef     std::set<uint64> BannedList;
     BannedList  banned;
     bool        m_announce;
@@ -201,6 +208,9 @@ class Channel
         void MakeVoiceOn(WorldPacket *data, uint64 guid);                       //+ 0x22
         void MakeVoiceOff(WorldPacket *data, uint64 guid);                      //+ 0x23
 
+        void AddMember(uint64 guid, Player* plr);
+        void RemoveMember(uint64 guid);
+
         void SendToAll(WorldPacket *data, uint64 p = 0);
         void SendToAllButOne(WorldPacket *data, uint64 who);
         void SendToOne(WorldPacket *data, uint64 who);
@@ -269,6 +269,7 @@ ChatCommand * ChatHandler::getCommandTable()
         { "anim",           PERM_GMT_DEV,   PERM_CONSOLE, false,  &ChatHandler::HandleDebugAnimCommand,               "", NULL },
         { "arena",          PERM_ADM,       PERM_CONSOLE, false,  &ChatHandler::HandleDebugArenaCommand,              "", NULL },
         { "bg",             PERM_ADM,       PERM_CONSOLE, false,  &ChatHandler::HandleDebugBattleGroundCommand,       "", NULL },
+        { "eventai",        PERM_GMT_DEV,   PERM_CONSOLE, false,  &ChatHandler::HandleDebugEventAIStatsCommand,       "", NULL },
         { "getitemstate",   PERM_ADM,       PERM_CONSOLE, false,  &ChatHandler::HandleDebugGetItemState,              "", NULL },
         { "getinstdata",    PERM_ADM,       PERM_CONSOLE, false,  &ChatHandler::HandleDebugGetInstanceDataCommand,    "", NULL },
         { "getinstdata64",  PERM_ADM,       PERM_CONSOLE, false,  &ChatHandler::HandleDebugGetInstanceData64Command,  "", NULL },
@@ -276,6 +277,9 @@ ChatCommand * ChatHandler::getCommandTable()
         { "hostilelist",    PERM_GMT_DEV,   PERM_CONSOLE, false,  &ChatHandler::HandleDebugHostileRefList,            "", NULL },
         { "lootrecipient",  PERM_GMT_DEV,   PERM_CONSOLE, false,  &ChatHandler::HandleDebugGetLootRecipient,          "", NULL },
         { "Mod32Value",     PERM_ADM,       PERM_CONSOLE, false,  &ChatHandler::HandleDebugMod32Value,                "", NULL },
+        { "opcodelatency",  PERM_ADM,       PERM_CONSOLE, true,   &ChatHandler::HandleDebugOpcodeLatencyCommand,      "", NULL },
+        { "opcodes",        PERM_ADM,       PERM_CONSOLE, true,   &ChatHandler::HandleDebugOpcodesCommand,            "", NULL },
+        { "pathfinding",    PERM_GMT_DEV,   PERM_CONSOLE, false,  &ChatHandler::HandleDebugPathfindingStatsCommand,   "", NULL },
         { "play",           PERM_DEVELOPER, PERM_CONSOLE, false,  NULL,                                               "", debugPlayCommandTable },
         { "poolstats",      PERM_GMT_DEV,   PERM_CONSOLE, false,  &ChatHandler::HandleGetPoolObjectStatsCommand,      "", NULL },
         { "rel",            PERM_ADM,       PERM_CONSOLE, false,  &ChatHandler::HandleRelocateCreatureCommand,        "", NULL },
@@ -289,6 +293,7 @@ ChatCommand * ChatHandler::getCommandTable()
         { "printstate",     PERM_PLAYER,    PERM_CONSOLE, false,  &ChatHandler::HandleDebugUnitState,                 "", NULL },
         { "update",         PERM_ADM,       PERM_CONSOLE, false,  &ChatHandler::HandleDebugUpdate,                    "", NULL },
         { "uws",            PERM_ADM,       PERM_CONSOLE, false,  &ChatHandler::HandleDebugUpdateWorldStateCommand,   "", NULL },
+        { "warden",         PERM_ADM,       PERM_CONSOLE, true,   &ChatHandler::HandleDebugWardenStatsCommand,        "", NULL },
         { NULL,             0,              0,            false,  NULL,                                               "", NULL }
     };
 
@@ -141,12 +141,17 @@ class ChatHandler
         bool HandleDebugAnimCommand(const char* args);
         bool HandleDebugArenaCommand(const char * args);
         bool HandleDebugBattleGroundCommand(const char * args);
+        bool HandleDebugEventAIStatsCommand(const char * args);
+        bool HandleDebugPathfindingStatsCommand(const char * args);
+        bool HandleDebugWardenStatsCommand(const char * args);
         bool HandleDebugGetInstanceDataCommand(const char* args);
         bool HandleDebugGetInstanceData64Command(const char* args);
         bool HandleDebugGetItemState(const char * args);
         bool HandleDebugGetLootRecipient(const char * args);
         bool HandleDebugGetValue(const char* args);
         bool HandleDebugMod32Value(const char* args);
+        bool HandleDebugOpcodeLatencyCommand(const char* args);
+        bool HandleDebugOpcodesCommand(const char* args);
         bool HandleDebugSetInstanceDataCommand(const char* args);
         bool HandleDebugSetInstanceData64Command(const char* args);
         bool HandleDebugSetItemFlagCommand(const char * args);
@@ -126,6 +126,13 @@ CreatureEventAI::CreatureEventAI(Creature *c) : CreatureAI(c)
 
     InvinceabilityHpLevel = 0;
 
+    EventUpdateTime = EVENT_UPDATE_TIME;
+    EventDiff = 0;
+    TimerSkipDiff = 0;
+    NextTimerExpire = 0;
+    ArmedCombatEvents = false;
+    ArmedOOCEvents = false;
+
     CreatureEventAI_Event cevent;
     cevent.event_type = EVENT_T_TIMER;
     cevent.event_inverse_phase_mask = 0;
@@ -151,6 +158,9 @@ CreatureEventAI::CreatureEventAI(Creature *c) : CreatureAI(c)
 
 bool CreatureEventAI::ProcessEvent(CreatureEventAIHolder& pHolder, Unit* pActionInvoker)
 {
+    // timers must be up to date before checking them outside of UpdateAI
+    FlushSkippedTimers();
+
     if (!pHolder.Enabled || pHolder.Time)
         return false;
 
@@ -158,6 +168,8 @@ bool CreatureEventAI::ProcessEvent(CreatureEventAIHolder& pHolder, Unit* pAction
     if (pHolder.Event.event_inverse_phase_mask & (1 << Phase))
         return false;
 
+    m_creature->GetMap()->CountEventAIEvaluated();
+
     CreatureEventAI_Event const& event = pHolder.Event;
 
     //Check event conditions based on the event type, also reset events
@@ -377,10 +389,14 @@ bool CreatureEventAI::ProcessEvent(CreatureEventAIHolder& pHolder, Unit* pAction
     if (pHolder.Event.event_chance <= rnd % 100)
         return false;
 
+    m_creature->GetMap()->CountEventAIFired();
+
     //Process actions
     for (uint32 j = 0; j < MAX_ACTIONS; j++)
         ProcessAction(pHolder.Event.action[j], rnd, pHolder.Event.event_id, pActionInvoker);
 
+    // repeat timer and phase may have changed, next UpdateAI has to check all events again
+    NextTimerExpire = 0;
     return true;
 }
 
@@ -945,8 +961,11 @@ void CreatureEventAI::JustRespawned()
 
 void CreatureEventAI::Reset()
 {
+    FlushSkippedTimers();
+
     EventUpdateTime = EVENT_UPDATE_TIME;
     EventDiff = 0;
+    NextTimerExpire = 0;
 
     if (bEmptyList)
         return;
@@ -1025,8 +1044,10 @@ void CreatureEventAI::JustDied(Unit* killer)
 
     eventAISummonedList.clear();
 
-    // reset phase after any death state events
+    // reset phase after any death state events, skipped time has to be applied before forcing full update
+    FlushSkippedTimers();
     Phase = 0;
+    NextTimerExpire = 0;
 }
 
 void CreatureEventAI::KilledUnit(Unit* victim)
@@ -1085,6 +1106,8 @@ void CreatureEventAI::JustSummoned(Creature* pUnit)
 
 void CreatureEventAI::EnterCombat(Unit *enemy)
 {
+    FlushSkippedTimers();
+
     //Check for on combat start events
     if (!bEmptyList)
     {
@@ -1113,6 +1136,7 @@ void CreatureEventAI::EnterCombat(Unit *enemy)
 
     EventUpdateTime = EVENT_UPDATE_TIME;
     EventDiff = 0;
+    NextTimerExpire = 0;
 }
 
 void CreatureEventAI::AttackStart(Unit *who)
@@ -1183,54 +1207,18 @@ void CreatureEventAI::UpdateAI(const uint32 diff)
         {
             EventDiff += diff;
 
-            //Check for time based events
-            for (std::list<CreatureEventAIHolder>::iterator i = CreatureEventAIList.begin(); i != CreatureEventAIList.end(); ++i)
+            // nothing can trigger before the first running timer expires unless a polled event is ready to check,
+            // so idle creatures only collect the elapsed time and apply it when something happens
+            if (TimerSkipDiff + EventDiff < NextTimerExpire &&
+                !(ArmedCombatEvents && me->getVictim()) && !(ArmedOOCEvents && !me->isInCombat()))
             {
-                //Decrement Timers
-                if ((*i).Time)
-                {
-                    if ((*i).Time > EventDiff)
-                    {
-                        //Do not decrement timers if event cannot trigger in this phase
-                        if (!((*i).Event.event_inverse_phase_mask & (1 << Phase)))
-                            (*i).Time -= EventDiff;
-
-                        //Skip processing of events that have time remaining
-                        continue;
-                    }
-                    else (*i).Time = 0;
-                }
-
-                //Events that are updated every EVENT_UPDATE_TIME
-                switch ((*i).Event.event_type)
-                {
-                    case EVENT_T_TIMER_OOC:
-                        ProcessEvent(*i);
-                        break;
-                    case EVENT_T_TIMER:
-                    case EVENT_T_MANA:
-                    case EVENT_T_HP:
-                    case EVENT_T_TARGET_HP:
-                    case EVENT_T_TARGET_CASTING:
-                    case EVENT_T_FRIENDLY_HP:
-                        if (me->getVictim())
-                            ProcessEvent(*i);
-                        break;
-                    case EVENT_T_RANGE:
-                        if (me->getVictim())
-                        {
-                            if (m_creature->IsInMap(m_creature->getVictim()))
-                            {
-                                if (m_creature->IsInRange(m_creature->getVictim(),(float)(*i).Event.range.minDist,(float)(*i).Event.range.maxDist))
-                                    ProcessEvent(*i);
-                            }
-                        }
-                        break;
-                }
+                if (NextTimerExpire != 0xFFFFFFFF)          // no running timer, nothing to apply skipped time to
+                    TimerSkipDiff += EventDiff;
+                EventDiff = 0;
+                EventUpdateTime = EVENT_UPDATE_TIME;
             }
-
-            EventDiff = 0;
-            EventUpdateTime = EVENT_UPDATE_TIME;
+            else
+                UpdateEvents();
         }
         else
         {
@@ -1244,6 +1232,93 @@ void CreatureEventAI::UpdateAI(const uint32 diff)
         DoMeleeAttackIfReady();
 }
 
+void CreatureEventAI::UpdateEvents()
+{
+    EventDiff += TimerSkipDiff;
+    TimerSkipDiff = 0;
+
+    NextTimerExpire = 0xFFFFFFFF;
+    ArmedCombatEvents = false;
+    ArmedOOCEvents = false;
+
+    //Check for time based events
+    for (std::list<CreatureEventAIHolder>::iterator i = CreatureEventAIList.begin(); i != CreatureEventAIList.end(); ++i)
+    {
+        //Decrement Timers
+        if ((*i).Time)
+        {
+            if ((*i).Time > EventDiff)
+            {
+                //Do not decrement timers if event cannot trigger in this phase
+                if (!((*i).Event.event_inverse_phase_mask & (1 << Phase)))
+                {
+                    (*i).Time -= EventDiff;
+                    NextTimerExpire = std::min(NextTimerExpire, (*i).Time);
+                }
+
+                //Skip processing of events that have time remaining
+                continue;
+            }
+            else (*i).Time = 0;
+        }
+
+        //Events that are updated every EVENT_UPDATE_TIME
+        switch ((*i).Event.event_type)
+        {
+            case EVENT_T_TIMER_OOC:
+                ProcessEvent(*i);
+                if ((*i).Enabled && !(*i).Time)
+                    ArmedOOCEvents = true;
+                break;
+            case EVENT_T_TIMER:
+            case EVENT_T_MANA:
+            case EVENT_T_HP:
+            case EVENT_T_TARGET_HP:
+            case EVENT_T_TARGET_CASTING:
+            case EVENT_T_FRIENDLY_HP:
+                if (me->getVictim())
+                    ProcessEvent(*i);
+                if ((*i).Enabled && !(*i).Time)
+                    ArmedCombatEvents = true;
+                break;
+            case EVENT_T_RANGE:
+                if (me->getVictim())
+                {
+                    if (m_creature->IsInMap(m_creature->getVictim()))
+                    {
+                        if (m_creature->IsInRange(m_creature->getVictim(),(float)(*i).Event.range.minDist,(float)(*i).Event.range.maxDist))
+                            ProcessEvent(*i);
+                    }
+                }
+                if ((*i).Enabled && !(*i).Time)
+                    ArmedCombatEvents = true;
+                break;
+        }
+
+        if ((*i).Time)
+            NextTimerExpire = std::min(NextTimerExpire, (*i).Time);
+    }
+
+    EventDiff = 0;
+    EventUpdateTime = EVENT_UPDATE_TIME;
+}
+
+void CreatureEventAI::FlushSkippedTimers()
+{
+    if (!TimerSkipDiff)
+        return;
+
+    // skipped time is always shorter than the first running timer, so none of them expires here
+    for (std::list<CreatureEventAIHolder>::iterator i = CreatureEventAIList.begin(); i != CreatureEventAIList.end(); ++i)
+        if ((*i).Time && !((*i).Event.event_inverse_phase_mask & (1 << Phase)))
+            (*i).Time -= TimerSkipDiff;
+
+    // full update already forced (0) or no running timer, nothing to shorten
+    if (NextTimerExpire != 0xFFFFFFFF)
+        NextTimerExpire = NextTimerExpire > TimerSkipDiff ? NextTimerExpire - TimerSkipDiff : 0;
+    TimerSkipDiff = 0;
+}
+
 inline uint32 CreatureEventAI::GetRandActionParam(uint32 rnd, uint32 param1, uint32 param2, uint32 param3)
 {
     switch (rnd % 3)
@@ -629,6 +629,8 @@ class HELLGROUND_IMPORT_EXPORT CreatureEventAI : public CreatureAI
         static int Permissible(const Creature *);
 
         bool ProcessEvent(CreatureEventAIHolder& pHolder, Unit* pActionInvoker = NULL);
+        void UpdateEvents();
+        void FlushSkippedTimers();
         void ProcessAction(CreatureEventAI_Action const& action, uint32 rnd, uint32 EventId, Unit* pActionInvoker);
         inline uint32 GetRandActionParam(uint32 rnd, uint32 param1, uint32 param2, uint32 param3);
         inline int32 GetRandActionParam(uint32 rnd, int32 param1, int32 param2, int32 param3);
@@ -647,6 +649,10 @@ class HELLGROUND_IMPORT_EXPORT CreatureEventAI : public CreatureAI
         std::list<CreatureEventAIHolder> CreatureEventAIList;
         uint32 EventUpdateTime;                             //Time between event updates
         uint32 EventDiff;                                   //Time between the last event call
+        uint32 TimerSkipDiff;                               //Time not yet applied to timers while event updates were skipped
+        uint32 NextTimerExpire;                             //Time left to first running timer expire, 0 forces next event update
+        bool ArmedCombatEvents;                             //Polled combat events are ready to be checked
+        bool ArmedOOCEvents;                                //Polled out of combat timers are ready to be checked
         bool bEmptyList;
 
         //Variables used by Events themselves
@@ -38,6 +38,7 @@
 #include "InstanceData.h"
 #include "GridNotifiers.h"
 #include "GridNotifiersImpl.h"
+#include "OpcodeStats.h"
 #include "CellImpl.h"
 
 #define COMMAND_COOLDOWN 2
@@ -668,6 +669,127 @@ bool ChatHandler::HandleDebugBattleGroundCommand(const char * /*args*/)
     sBattleGroundMgr.ToggleTesting();
     return true;
 }
+
+bool ChatHandler::HandleDebugOpcodeLatencyCommand(const char* args)
+{
+    if (!*args)
+        return false;
+
+    if (!sOpcodeStats.IsEnabled())
+    {
+        SendSysMessage("Opcode statistics are disabled (SessionUpdate.OpcodeStats).");
+        return true;
+    }
+
+    uint16 opcode = isdigit(*args) ? uint16(atoi(args)) : LookupOpcodeId(args);
+    if (opcode >= NUM_MSG_TYPES || (!opcode && !isdigit(*args)))
+    {
+        PSendSysMessage("Unknown opcode %s", args);
+        return true;
+    }
+
+    OpcodeStatsBlock* stats = new OpcodeStatsBlock;
+    sOpcodeStats.Merge(*stats);
+
+    PSendSysMessage("Latency of %s (0x%.4X), handler / queue time:", LookupOpcodeName(opcode), opcode);
+    for (uint32 i = 0; i < OPCODE_STATS_BUCKETS; ++i)
+    {
+        uint32 handled = stats->handleTime[opcode].buckets[i];
+        uint32 queued = stats->queueTime[opcode].buckets[i];
+        if (!handled && !queued)
+            continue;
+
+        if (i == OPCODE_STATS_BUCKETS - 1)
+            PSendSysMessage("  >= %u us: %u / %u", 1 << i, handled, queued);
+        else
+            PSendSysMessage("  < %u us: %u / %u", 2 << i, handled, queued);
+    }
+
+    delete stats;
+    return true;
+}
+
+bool ChatHandler::HandleDebugOpcodesCommand(const char* args)
+{
+    if (!sOpcodeStats.IsEnabled())
+    {
+        SendSysMessage("Opcode statistics are disabled (SessionUpdate.OpcodeStats).");
+        return true;
+    }
+
+    if (strcmp(args, "reset") == 0)
+    {
+        sOpcodeStats.Reset();
+        SendSysMessage("Opcode statistics reset.");
+        return true;
+    }
+
+    uint32 limit = *args ? atoi(args) : 10;
+    if (!limit)
+        return false;
+
+    std::vector<std::string> report;
+    sOpcodeStats.BuildReport(limit, report);
+
+    for (std::vector<std::string>::const_iterator itr = report.begin(); itr != report.end(); ++itr)
+        SendSysMessage(itr->c_str());
+
+    return true;
+}
+
+bool ChatHandler::HandleDebugEventAIStatsCommand(const char * args)
+{
+    Map* map = m_session->GetPlayer()->GetMap();
+
+    uint32 evaluated = map->GetEventAIEvaluatedCount();
+    uint32 fired = map->GetEventAIFiredCount();
+
+    PSendSysMessage("EventAI on map %u (instance %u): %u events evaluated, %u fired (%.2f%%)",
+        map->GetId(), map->GetInstanceId(), evaluated, fired, evaluated ? fired * 100.0f / evaluated : 0.0f);
+
+    if (args && strcmp(args, "reset") == 0)
+    {
+        map->ResetEventAICounters();
+        SendSysMessage("Counters reset.");
+    }
+    return true;
+}
+
+bool ChatHandler::HandleDebugPathfindingStatsCommand(const char * args)
+{
+    Map* map = m_session->GetPlayer()->GetMap();
+
+    uint32 count = map->GetPathfindingCount();
+    uint32 cached = map->GetPathfindingCachedCount();
+    uint64 time = map->GetPathfindingTime();
+
+    PSendSysMessage("Pathfinding on map %u (instance %u): %u paths built in %.1f ms (avg %u us), %u taken from cache",
+        map->GetId(), map->GetInstanceId(), count, time / 1000.0f, count ? uint32(time / count) : 0, cached);
+
+    if (args && strcmp(args, "reset") == 0)
+    {
+        map->ResetPathfindingCounters();
+        SendSysMessage("Counters reset.");
+    }
+    return true;
+}
+
+bool ChatHandler::HandleDebugWardenStatsCommand(const char * args)
+{
+    std::vector<std::string> lines;
+    sWardenStats.BuildReport(lines);
+
+    for (std::vector<std::string>::const_iterator itr = lines.begin(); itr != lines.end(); ++itr)
+        SendSysMessage(itr->c_str());
+
+    if (args && strcmp(args, "reset") == 0)
+    {
+        sWardenStats.Reset();
+        SendSysMessage("Counters reset.");
+    }
+    return true;
+}
+
 bool ChatHandler::HandleDebugUnitState(const char * /*args*/)
 {
     Player* player = m_session->GetPlayer();
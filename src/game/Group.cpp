@@ -64,6 +64,8 @@ Group::~Group()
             sLog.outLog(LOG_DEFAULT, "ERROR: Group::~Group: battleground group is not linked to the correct battleground.");
     }
 
+    sObjectMgr.UnscheduleGroupUpdate(this);
+
     Rolls::iterator itr;
     while (!RollId.empty())
     {
@@ -174,6 +176,7 @@ bool Group::LoadGroupFromDB(const uint64 &leaderGuid, QueryResultAutoPtr result,
 
     m_leaderGuid = leaderGuid;
     m_leaderLogoutTime = time(NULL); // Give the leader a chance to keep his position after a server crash
+    sObjectMgr.ScheduleGroupUpdate(this);
 
     // group leader not exist
     if (!sObjectMgr.GetPlayerNameByGUID(m_leaderGuid, m_leaderName))
@@ -455,6 +458,7 @@ void Group::CheckLeader(const uint64 &guid, bool isLogout)
         if (isLogout)
         {
             m_leaderLogoutTime = time(NULL);
+            sObjectMgr.ScheduleGroupUpdate(this);
         }
         else
         {
@@ -480,6 +484,7 @@ void Group::CheckLeader(const uint64 &guid, bool isLogout)
             if (!leader || !leader->IsInWorld())
             {
                 m_leaderLogoutTime = time(NULL);
+                sObjectMgr.ScheduleGroupUpdate(this);
             }
         }
     }
@@ -723,6 +728,7 @@ void Group::PrepareLootRolls(const uint64& playerGUID, Loot *loot, WorldObject*
                 i->is_blocked = true;
 
                 RollId.push_back(r);
+                sObjectMgr.ScheduleGroupUpdate(this);
             }
             else
                 delete r;
@@ -1813,18 +1819,19 @@ void Group::UnbindInstance(uint32 mapid, uint8 difficulty, bool unload)
         static SqlStatementID deleteGroupInstance;
         static SqlStatementID deleteGroupSavedLoot;
 
-        RealmDataDatabase.BeginTransaction();
+        // unloading only drops the bind from memory, no need for an empty transaction
         if (!unload)
         {
+            RealmDataDatabase.BeginTransaction();
             SqlStatement stmt = RealmDataDatabase.CreateStatement(deleteGroupInstance, "DELETE FROM group_instance WHERE leaderGuid = ? AND instance = ?");
             stmt.PExecute(GUID_LOPART(GetLeaderGUID()), itr->second.save->GetInstanceId());
 
             stmt = RealmDataDatabase.CreateStatement(deleteGroupSavedLoot, "DELETE FROM group_saved_loot WHERE instanceId = ?");
             stmt.PExecute((*itr).second.save->GetInstanceId());
+            RealmDataDatabase.CommitTransaction();
         }
 
         itr->second.save->RemoveGroup(this);                // save can become invalid
-        RealmDataDatabase.CommitTransaction();
 
         m_boundInstances[difficulty].erase(itr);
     }
@@ -306,6 +306,8 @@ class HELLGROUND_IMPORT_EXPORT Group
         void SendTargetIconList(WorldSession *session);
         void SendUpdate();
         void Update(uint32 diff);
+        // pending loot rolls or leader reconnect timer, groups without them are not updated
+        bool NeedsUpdate() const { return m_leaderLogoutTime || !RollId.empty(); }
         void UpdatePlayerOutOfRange(Player* pPlayer);
                                                             // ignore: GUID of player that will be ignored
         void BroadcastPacket(WorldPacket *packet, bool ignorePlayersInBGRaid, int group=-1, uint64 ignore=0);
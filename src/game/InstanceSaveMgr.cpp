@@ -41,7 +41,7 @@
 #include "InstanceData.h"
 #include "ProgressBar.h"
 
-InstanceSaveManager::InstanceSaveManager() : lock_instLists(false)
+InstanceSaveManager::InstanceSaveManager() : lock_instLists(false), m_resetWheelTime(time(NULL))
 {
 
 }
@@ -61,24 +61,30 @@ void InstanceSaveManager::UnbindBeforeDelete()
         if (save == nullptr)
 			continue;
 			
-        for (InstanceSave::PlayerListType::iterator itr2 = save->m_playerList.begin(); itr2 != save->m_playerList.end(); ++itr2)
+        // unbinding removes the entry from the list, so always take the first one
+        while (!save->m_playerList.empty())
         {
-            if (Player* player = sObjectMgr.GetPlayer(*itr2))
+            uint64 guid = *save->m_playerList.begin();
+            if (Player* player = sObjectMgr.GetPlayer(guid))
                 player->UnbindInstance(save->GetMapId(), save->GetDifficulty(), true);
-        }
 
-        save->m_playerList.clear();
+            save->m_playerList.erase(guid);
+        }
 
-        for (InstanceSave::GroupListType::iterator itr2 = save->m_groupList.begin(); itr2 != save->m_groupList.end(); ++itr2)
-            (*itr2)->UnbindInstance(save->GetMapId(), save->GetDifficulty(), true);
+        while (!save->m_groupList.empty())
+        {
+            Group* group = *save->m_groupList.begin();
+            group->UnbindInstance(save->GetMapId(), save->GetDifficulty(), true);
 
-        save->m_groupList.clear();
+            save->m_groupList.erase(group);
+        }
 		
         delete save;
 		itr->second = nullptr;
     }
 
     m_instanceSaveById.clear();
+    m_instanceIdsByMapId.clear();
 }
 
 /*
@@ -118,6 +124,7 @@ InstanceSave* InstanceSaveManager::AddInstanceSave(uint32 mapId, uint32 instance
         save->SaveToDB();
 
     m_instanceSaveById[instanceId] = save;
+    m_instanceIdsByMapId[mapId].insert(instanceId);
     return save;
 }
 
@@ -148,6 +155,7 @@ void InstanceSaveManager::RemoveInstanceSave(uint32 InstanceId)
             RealmDataDatabase.PExecute("UPDATE instance SET resettime = '" UI64FMTD "' WHERE id = '%u'", (uint64)resettime, InstanceId);
 
         InstanceSave *temp = itr->second;
+        m_instanceIdsByMapId[temp->GetMapId()].erase(InstanceId);
         m_instanceSaveById.erase(itr);
         delete temp;
     }
@@ -207,11 +215,6 @@ time_t InstanceSave::GetResetTimeForDB()
         return GetResetTime();
 }
 
-bool InstanceSave::HasPlayer(uint64 guid)
-{
-    return std::any_of(m_playerList.begin(), m_playerList.end(), [guid](uint64 p) { return p == guid; });
-}
-
 // to cache or not to cache, that is the question
 InstanceTemplate const* InstanceSave::GetTemplate()
 {
@@ -480,37 +483,82 @@ void InstanceSaveManager::LoadResetTimes()
 
 void InstanceSaveManager::ScheduleReset(bool add, time_t time, InstResetEvent event)
 {
-    if (add) m_resetTimeQueue.insert(std::pair<time_t, InstResetEvent>(time, event));
-    else
+    if (add)
     {
-        // find the event in the queue and remove it
-        ResetTimeQueue::iterator itr;
-        std::pair<ResetTimeQueue::iterator, ResetTimeQueue::iterator> range;
-        range = m_resetTimeQueue.equal_range(time);
-        for (itr = range.first; itr != range.second; ++itr)
-            if (itr->second == event) { m_resetTimeQueue.erase(itr); return; }
-        // in case the reset time changed (should happen very rarely), we search the whole queue
-        if (itr == range.second)
+        // events already due are executed with the next update
+        if (time <= m_resetWheelTime)
+            time = m_resetWheelTime + 1;
+
+        m_resetWheel[time % RESET_WHEEL_SIZE].push_back(ResetWheelEntry(time, event));
+        return;
+    }
+
+    // find the event in the wheel and remove it
+    ResetWheelSlot& slot = m_resetWheel[time % RESET_WHEEL_SIZE];
+    for (ResetWheelSlot::iterator itr = slot.begin(); itr != slot.end(); ++itr)
+    {
+        if (itr->event == event)
         {
-            for (itr = m_resetTimeQueue.begin(); itr != m_resetTimeQueue.end(); ++itr)
-                if (itr->second == event) { m_resetTimeQueue.erase(itr); return; }
-            if (itr == m_resetTimeQueue.end())
-                sLog.outLog(LOG_DEFAULT, "ERROR: InstanceSaveManager::ScheduleReset: cannot cancel the reset, the event(%d,%d,%d) was not found!", event.type, event.mapid, event.instanceId);
+            *itr = slot.back();
+            slot.pop_back();
+            return;
+        }
+    }
+
+    // in case the reset time changed (should happen very rarely), we search the whole wheel
+    for (uint32 i = 0; i < RESET_WHEEL_SIZE; ++i)
+    {
+        ResetWheelSlot& other = m_resetWheel[i];
+        for (ResetWheelSlot::iterator itr = other.begin(); itr != other.end(); ++itr)
+        {
+            if (itr->event == event)
+            {
+                *itr = other.back();
+                other.pop_back();
+                return;
+            }
         }
     }
+
+    sLog.outLog(LOG_DEFAULT, "ERROR: InstanceSaveManager::ScheduleReset: cannot cancel the reset, the event(%d,%d,%d) was not found!", event.type, event.mapid, event.instanceId);
 }
 
 void InstanceSaveManager::Update()
 {
-    time_t now = time(NULL), t;
-    while (!m_resetTimeQueue.empty() && (t = m_resetTimeQueue.begin()->first) < now)
+    time_t now = time(NULL);
+    if (now - 1 <= m_resetWheelTime)
+        return;
+
+    // collect everything due from slots passed since the last update,
+    // after a longer stall each slot is visited at most once
+    std::vector<ResetWheelEntry> due;
+    time_t from = std::max<time_t>(m_resetWheelTime + 1, now - RESET_WHEEL_SIZE);
+    for (time_t t = from; t < now; ++t)
     {
-        InstResetEvent &event = m_resetTimeQueue.begin()->second;
+        ResetWheelSlot& slot = m_resetWheel[t % RESET_WHEEL_SIZE];
+        for (size_t i = 0; i < slot.size();)
+        {
+            if (slot[i].time < now)
+            {
+                due.push_back(slot[i]);
+                slot[i] = slot.back();
+                slot.pop_back();
+            }
+            else
+                ++i;
+        }
+    }
+
+    m_resetWheelTime = now - 1;
+
+    std::stable_sort(due.begin(), due.end());
+    for (std::vector<ResetWheelEntry>::iterator itr = due.begin(); itr != due.end(); ++itr)
+    {
+        InstResetEvent &event = itr->event;
         if (event.type == 0)
         {
             // for individual normal instances, max creature respawn + X hours
             _ResetInstance(event.mapid, event.instanceId);
-            m_resetTimeQueue.erase(m_resetTimeQueue.begin());
         }
         else
         {
@@ -526,13 +574,11 @@ void InstanceSaveManager::Update()
             }
             else
                 sMapMgr.InitMaxInstanceId(); // recalculate max instance id
-
-            m_resetTimeQueue.erase(m_resetTimeQueue.begin());
         }
     }
 }
 
-void InstanceSaveManager::_ResetSave(InstanceSaveHashMap::iterator &itr)
+void InstanceSaveManager::_ResetSave(InstanceSaveHashMap::iterator &itr, bool deleteSavedLoot)
 {
     // unbind all players bound to the instance
     // do not allow UnbindInstance to automatically unload the InstanceSaves
@@ -540,8 +586,11 @@ void InstanceSaveManager::_ResetSave(InstanceSaveHashMap::iterator &itr)
     InstanceSave::PlayerListType &pList = itr->second->m_playerList;
     while (!pList.empty())
     {
-        Player *player = sObjectMgr.GetPlayer(*pList.begin());
-        player->UnbindInstance(itr->second->GetMapId(), itr->second->GetDifficulty(), true);
+        uint64 guid = *pList.begin();
+        if (Player *player = sObjectMgr.GetPlayer(guid))
+            player->UnbindInstance(itr->second->GetMapId(), itr->second->GetDifficulty(), true);
+
+        pList.erase(guid);
     }
 
     InstanceSave::GroupListType &gList = itr->second->m_groupList;
@@ -551,7 +600,11 @@ void InstanceSaveManager::_ResetSave(InstanceSaveHashMap::iterator &itr)
         group->UnbindInstance(itr->second->GetMapId(), itr->second->GetDifficulty(), true);
     }
 
-    RealmDataDatabase.PExecute("DELETE FROM group_saved_loot WHERE instanceid = '%u'", itr->second->GetInstanceId());
+    // global resets remove saved loot of the whole map with one statement
+    if (deleteSavedLoot)
+        RealmDataDatabase.PExecute("DELETE FROM group_saved_loot WHERE instanceid = '%u'", itr->second->GetInstanceId());
+
+    m_instanceIdsByMapId[itr->second->GetMapId()].erase(itr->first);
 
     delete itr->second;
     itr->second = nullptr;
@@ -608,17 +661,24 @@ void InstanceSaveManager::_ResetOrWarnAll(uint32 mapid, bool warn, uint32 timeLe
             return;
         }
 
-        // remove all binds to instances of the given map
-        for (InstanceSaveHashMap::iterator itr = m_instanceSaveById.begin(); itr != m_instanceSaveById.end();)
+        // remove all binds to instances of the given map, copy the ids as _ResetSave updates the index
+        InstanceIdsByMap::iterator ids = m_instanceIdsByMapId.find(mapid);
+        if (ids != m_instanceIdsByMapId.end())
         {
-            if (itr->second->GetMapId() == mapid)
-                _ResetSave(itr);
-            else
-                ++itr;
+            std::vector<uint32> instanceIds(ids->second.begin(), ids->second.end());
+            for (std::vector<uint32>::const_iterator id = instanceIds.begin(); id != instanceIds.end(); ++id)
+            {
+                InstanceSaveHashMap::iterator itr = m_instanceSaveById.find(*id);
+                if (itr != m_instanceSaveById.end())
+                    _ResetSave(itr, false);
+            }
+
+            m_instanceIdsByMapId.erase(mapid);
         }
 
         // delete them from the DB, even if not loaded
         RealmDataDatabase.BeginTransaction();
+        RealmDataDatabase.PExecute("DELETE FROM group_saved_loot USING group_saved_loot JOIN instance ON group_saved_loot.instanceId = instance.id WHERE map = '%u'", mapid);
         RealmDataDatabase.PExecute("DELETE FROM character_instance USING character_instance LEFT JOIN instance ON character_instance.instance = id WHERE map = '%u'", mapid);
         RealmDataDatabase.PExecute("DELETE FROM group_instance USING group_instance LEFT JOIN instance ON group_instance.instance = id WHERE map = '%u'", mapid);
         RealmDataDatabase.PExecute("DELETE FROM instance WHERE map = '%u'", mapid);
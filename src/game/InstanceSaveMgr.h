@@ -24,8 +24,9 @@
 #include "Platform/Define.h"
 #include "ace/Singleton.h"
 #include "ace/Thread_Mutex.h"
-#include <list>
 #include <map>
+#include <set>
+#include <vector>
 #include "Utilities/UnorderedMap.h"
 #include "Database/DatabaseEnv.h"
 
@@ -78,15 +79,15 @@ class InstanceSave
         InstanceTemplate const* GetTemplate();
         MapEntry const* GetMapEntry();
 
-        bool HasPlayer(uint64 guid);
+        bool HasPlayer(uint64 guid) { return m_playerList.find(guid) != m_playerList.end(); }
 
         /* online players bound to the instance (perm/solo)
            does not include the members of the group unless they have permanent saves */
-        void AddPlayer(uint64 guid) { m_playerList.push_back(guid); }
-        bool RemovePlayer(uint64 guid) { m_playerList.remove(guid); return UnloadIfEmpty(); }
+        void AddPlayer(uint64 guid) { m_playerList.insert(guid); }
+        bool RemovePlayer(uint64 guid) { m_playerList.erase(guid); return UnloadIfEmpty(); }
         /* all groups bound to the instance */
-        void AddGroup(Group *group) { m_groupList.push_back(group); }
-        bool RemoveGroup(Group *group) { m_groupList.remove(group); return UnloadIfEmpty(); }
+        void AddGroup(Group *group) { m_groupList.insert(group); }
+        bool RemoveGroup(Group *group) { m_groupList.erase(group); return UnloadIfEmpty(); }
 
         /* instances cannot be reset (except at the global reset time)
            if there are players permanently bound to it
@@ -98,8 +99,8 @@ class InstanceSave
            but that would depend on a lot of things that can easily change in future */
         uint8 GetDifficulty() { return m_difficulty; }
 
-        typedef std::list<uint64> PlayerListType;
-        typedef std::list<Group*> GroupListType;
+        typedef std::set<uint64> PlayerListType;
+        typedef std::set<Group*> GroupListType;
     private:
         bool UnloadIfEmpty();
         /* the only reason the instSave-object links are kept is because
@@ -135,12 +136,25 @@ class InstanceSaveManager
         {
             uint8 type;
             uint16 mapid;
-            uint16 instanceId;
-            InstResetEvent(uint8 t = 0, uint16 m = 0, uint16 i = 0) : type(t), mapid(m), instanceId(i) {}
-            bool operator == (const InstResetEvent& e) { return e.instanceId == instanceId; }
+            uint32 instanceId;
+            InstResetEvent(uint8 t = 0, uint16 m = 0, uint32 i = 0) : type(t), mapid(m), instanceId(i) {}
+            bool operator == (const InstResetEvent& e) const { return e.instanceId == instanceId; }
         };
-        typedef std::multimap<time_t /*resetTime*/, InstResetEvent> ResetTimeQueue;
+
+        struct ResetWheelEntry
+        {
+            ResetWheelEntry(time_t t, InstResetEvent const& e) : time(t), event(e) {}
+            bool operator < (const ResetWheelEntry& e) const { return time < e.time; }
+
+            time_t time;
+            InstResetEvent event;
+        };
+        /* one slot per second, entries are kept in slot time % RESET_WHEEL_SIZE
+           until the wheel reaches their time, later rounds are skipped */
+        #define RESET_WHEEL_SIZE 4096
+        typedef std::vector<ResetWheelEntry> ResetWheelSlot;
         typedef std::vector<time_t /*resetTime*/> ResetTimeVector;
+        typedef UNORDERED_MAP<uint32 /*mapId*/, std::set<uint32> /*InstanceId*/> InstanceIdsByMap;
 
         void CleanupInstances();
         void PackInstances();
@@ -165,15 +179,18 @@ class InstanceSaveManager
     private:
         void _ResetOrWarnAll(uint32 mapid, bool warn, uint32 timeleft);
         void _ResetInstance(uint32 mapid, uint32 instanceId);
-        void _ResetSave(InstanceSaveHashMap::iterator &itr);
+        void _ResetSave(InstanceSaveHashMap::iterator &itr, bool deleteSavedLoot = true);
         void _DelHelper(DatabaseType &db, const char *fields, const char *table, const char *queryTail,...);
         // used during global instance resets
         bool lock_instLists;
         // fast lookup by instance id
         InstanceSaveHashMap m_instanceSaveById;
+        // loaded saves of every map, for global resets
+        InstanceIdsByMap m_instanceIdsByMapId;
         // fast lookup for reset times
         ResetTimeVector m_resetTimeByMapId;
-        ResetTimeQueue m_resetTimeQueue;
+        ResetWheelSlot m_resetWheel[RESET_WHEEL_SIZE];
+        time_t m_resetWheelTime;                            // events up to this time were already executed
 };
 
 #define sInstanceSaveManager (*ACE_Singleton<InstanceSaveManager, ACE_Thread_Mutex>::instance())
@@ -26,6 +26,7 @@
 #include "Util.h"
 #include "SharedDefines.h"
 #include "Group.h"
+#include "Database/DataSnapshot.h"
 
 static Rates const qualityToRate[MAX_ITEM_QUALITY] = {
     RATE_DROP_ITEM_POOR,                                    // ITEM_QUALITY_POOR
@@ -63,11 +64,17 @@ class LootTemplate::LootGroup                               // A set of loot def
         void Verify(LootStore const& lootstore, uint32 id, uint32 group_id) const;
         void CollectLootIds(LootIdSet& set) const;
         void CheckLootRefs(LootTemplateMap const& store, LootIdSet* ref_set) const;
+        void BuildAliasTable();                             // Prepares table for Roll, called after all entries are added
     private:
         LootStoreItemList ExplicitlyChanced;                // Entries with chances defined in DB
         LootStoreItemList EqualChanced;                     // Zero chances - every entry takes the same chance
 
+        // Walker's alias table over explicitly chanced entries, last column stands for missing all of them
+        std::vector<float> AliasChance;                     // chance to keep the rolled column
+        std::vector<uint32> AliasIndex;                     // column taken otherwise
+
         LootStoreItem const * Roll(std::set<uint32> &except) const;                 // Rolls an item from the group, returns NULL if all miss their chances
+        bool HasExcepted(std::set<uint32> const& except) const;
 };
 
 //Remove all data and free all memory
@@ -98,8 +105,10 @@ void LootStore::LoadLootTable()
 
     sLog.outString("%s :", GetName());
 
-    //                                                        0      1     2                    3        4              5         6              7                 8
-    QueryResultAutoPtr result = GameDataDatabase.PQuery("SELECT entry, item, ChanceOrQuestChance, groupid, mincountOrRef, maxcount, lootcondition, condition_value1, condition_value2 FROM %s",GetName());
+    //                          0      1     2                    3        4              5         6              7                 8
+    std::string query = "SELECT entry, item, ChanceOrQuestChance, groupid, mincountOrRef, maxcount, lootcondition, condition_value1, condition_value2 FROM ";
+    query += GetName();
+    QueryResultAutoPtr result = DataSnapshot::Query(GetName(), GetName(), query.c_str());
 
     if (result)
     {
@@ -157,6 +166,9 @@ void LootStore::LoadLootTable()
 
         Verify();                                           // Checks validity of the loot store
 
+        for (LootTemplateMap::const_iterator i = m_LootTemplates.begin(); i != m_LootTemplates.end(); ++i)
+            i->second->BuildGroupTables();
+
         sLog.outString();
         sLog.outString(">> Loaded %u loot definitions (%d templates)", count, m_LootTemplates.size());
     }
@@ -696,6 +708,16 @@ void Loot::FillLoot(uint32 loot_id, LootStore const& store, Player* loot_owner,
     }
 }
 
+void Loot::FillPendingLoot(Player* loot_owner)
+{
+    uint32 loot_id = m_pendingLootId;
+    if (!loot_id)
+        return;
+
+    m_pendingLootId = 0;
+    FillLoot(loot_id, LootTemplates_Creature, loot_owner, false);
+}
+
 void Loot::FillNotNormalLootFor(Player* pl)
 {
     uint32 plguid = pl->GetGUIDLow();
@@ -1118,9 +1140,91 @@ void LootTemplate::LootGroup::AddEntry(LootStoreItem& item)
         EqualChanced.push_back(item);
 }
 
+// Builds alias table with the same distribution as sequential rolling over explicitly chanced entries
+void LootTemplate::LootGroup::BuildAliasTable()
+{
+    std::vector<float> weights;
+    float total = 0.0f;
+
+    // entries over 100% total are never reached by sequential roll
+    for (LootStoreItemList::const_iterator i = ExplicitlyChanced.begin(); i != ExplicitlyChanced.end(); ++i)
+    {
+        float weight = std::min(i->chance, std::max(0.0f, 100.0f - total));
+        weights.push_back(weight);
+        total += weight;
+    }
+    weights.push_back(std::max(0.0f, 100.0f - total));
+    total = std::max(total, 100.0f);
+
+    uint32 size = weights.size();
+    AliasChance.assign(size, 1.0f);
+    AliasIndex.resize(size);
+
+    std::vector<uint32> small, large;
+    for (uint32 i = 0; i < size; ++i)
+    {
+        AliasIndex[i] = i;
+        weights[i] = weights[i] * size / total;
+        if (weights[i] < 1.0f)
+            small.push_back(i);
+        else
+            large.push_back(i);
+    }
+
+    while (!small.empty() && !large.empty())
+    {
+        uint32 less = small.back();
+        small.pop_back();
+        uint32 more = large.back();
+
+        AliasChance[less] = weights[less];
+        AliasIndex[less] = more;
+
+        weights[more] -= 1.0f - weights[less];
+        if (weights[more] < 1.0f)
+        {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+    // columns left in either list are full up to float rounding, they keep chance 1
+}
+
+// True if any entry of the group is in except set, such rolls have to renormalize chances
+bool LootTemplate::LootGroup::HasExcepted(std::set<uint32> const& except) const
+{
+    if (except.empty())
+        return false;
+
+    for (LootStoreItemList::const_iterator i = ExplicitlyChanced.begin(); i != ExplicitlyChanced.end(); ++i)
+        if (except.find(i->itemid) != except.end())
+            return true;
+
+    for (LootStoreItemList::const_iterator i = EqualChanced.begin(); i != EqualChanced.end(); ++i)
+        if (except.find(i->itemid) != except.end())
+            return true;
+
+    return false;
+}
+
 // Rolls an item from the group, returns NULL if all miss their chances
 LootStoreItem const * LootTemplate::LootGroup::Roll(std::set<uint32> &except) const
 {
+    if (!AliasIndex.empty() && !HasExcepted(except))
+    {
+        uint32 column = urand(0, AliasIndex.size() - 1);
+        if (rand_norm() >= AliasChance[column])
+            column = AliasIndex[column];
+
+        if (column < ExplicitlyChanced.size())
+            return &ExplicitlyChanced[column];
+
+        if (EqualChanced.empty())
+            return NULL;
+
+        return &EqualChanced[urand(0, EqualChanced.size() - 1)];
+    }
+
     if (!ExplicitlyChanced.empty())                         // First explicitly chanced entries are checked
     {
         float Roll = rand_chance();
@@ -1283,6 +1387,12 @@ void LootTemplate::AddEntry(LootStoreItem& item)
         Entries.push_back(item);
 }
 
+void LootTemplate::BuildGroupTables()
+{
+    for (LootGroups::iterator i = Groups.begin(); i != Groups.end(); ++i)
+        i->BuildAliasTable();
+}
+
 // Rolls for every item in the template and adds the rolled items the the loot
 void LootTemplate::Process(Loot& loot, LootStore const& store, uint8 groupId) const
 {
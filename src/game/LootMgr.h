@@ -182,6 +182,8 @@ class LootTemplate
         // Checks integrity of the template
         void Verify(LootStore const& store, uint32 Id) const;
         void CheckLootRefs(LootTemplateMap const& store, LootIdSet* ref_set) const;
+        // Prepares groups for rolling, called once all entries are added
+        void BuildGroupTables();
     private:
         LootStoreItemList Entries;                          // not grouped only
         LootGroups        Groups;                           // groups have own (optimised) processing, grouped entries go there
@@ -243,7 +245,7 @@ struct Loot
     uint64 looterCheckTimer;
 
     Loot(uint32 _gold = 0) : gold(_gold), unlootedCount(0), m_lootLoadedFromDB(false), m_creatureGUID(0), m_mapID(0,0), looterGUID(0), max_quality(ITEM_QUALITY_POOR), everyone_can_open(false),
-                            looterTimer(0), looterCheckTimer(0) {}
+                            looterTimer(0), looterCheckTimer(0), m_pendingLootId(0) {}
     ~Loot() { clear(); }
 
     // if loot becomes invalid this reference is used to inform the listener
@@ -273,11 +275,12 @@ struct Loot
         gold = 0;
         unlootedCount = 0;
         looterGUID = 0;
+        m_pendingLootId = 0;
         i_LootValidatorRefManager.clearReferences();
     }
 
-    bool empty() const { return items.empty() && gold == 0; }
-    bool isLooted() const { return gold == 0 && unlootedCount == 0; }
+    bool empty() const { return items.empty() && gold == 0 && !m_pendingLootId; }
+    bool isLooted() const { return gold == 0 && unlootedCount == 0 && !m_pendingLootId; }
 
     void NotifyItemRemoved(uint8 lootIndex);
     void NotifyQuestItemRemoved(uint8 questIndex);
@@ -288,6 +291,10 @@ struct Loot
     void generateMoneyLoot(uint32 minAmount, uint32 maxAmount);
     void FillLoot(uint32 loot_id, LootStore const& store, Player* loot_owner, bool personal);
 
+    // creature loot rolled only when the corpse is opened for the first time
+    void SetPendingLoot(uint32 loot_id) { m_pendingLootId = loot_id; }
+    void FillPendingLoot(Player* loot_owner);
+
     void saveLootToDB(Player *owner);
     void RemoveSavedLootFromDB();
 
@@ -327,6 +334,7 @@ struct Loot
 
         uint64 m_creatureGUID;
         bool m_lootLoadedFromDB;
+        uint32 m_pendingLootId;                             // creature loot template not rolled yet
 
         MapID m_mapID;
 
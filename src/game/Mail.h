@@ -85,6 +85,16 @@ enum MailStationery
     MAIL_STATIONERY_VAL     = 64,
     MAIL_STATIONERY_CHR     = 65,
 };
+
+/**
+ * Expired mail with items is returned to its sender, unless it is from auction house or creature,
+ * was already returned, is COD or is read GM mail. Otherwise it is deleted together with the items.
+ */
+inline bool IsExpiredMailReturned(uint8 messageType, uint32 checked, uint8 stationery)
+{
+    return messageType == MAIL_NORMAL && !(checked & (MAIL_CHECK_MASK_COD_PAYMENT | MAIL_CHECK_MASK_RETURNED)) &&
+        !(stationery == MAIL_STATIONERY_GM && checked & MAIL_CHECK_MASK_READ);
+}
 /**
  * Representation of the State of a mail.
  */
@@ -43,6 +43,7 @@
 #include "InstanceSaveMgr.h"
 #include "VMapFactory.h"
 #include "MoveMap.h"
+#include "AntiCheat.h"
 
 #define DEFAULT_GRID_EXPIRY     300
 #define MAX_GRID_LOAD_TIME      50
@@ -65,7 +66,8 @@ Map::~Map()
     if (!m_scriptSchedule.empty())
         sWorld.DecreaseScheduledScriptCount(m_scriptSchedule.size());
 
-     MMAP::MMapFactory::createOrGetMMapManager()->unloadMapInstance(m_TerrainData->GetMapId(), GetInstanceId());
+    // batch still being checked keeps its own reference
+    m_antiCheatQueue->Release();
 
     //release reference count
     if (m_TerrainData->Release())
@@ -101,7 +103,8 @@ void Map::DeleteStateMachine()
 Map::Map(uint32 id, time_t expiry, uint32 InstanceId, uint8 SpawnMode)
    : i_mapEntry (sMapStore.LookupEntry(id)), i_spawnMode(SpawnMode),
      i_id(id), i_InstanceId(InstanceId), m_unloadTimer(0), i_gridExpiry(expiry), m_TerrainData(sTerrainMgr.LoadTerrain(id)),
-     m_activeNonPlayersIter(m_activeNonPlayers.end()), i_scriptLock(true)
+     m_activeNonPlayersIter(m_activeNonPlayers.end()), m_eventAIEvaluated(0), m_eventAIFired(0),
+     m_pathfindingCount(0), m_pathfindingCached(0), m_pathfindingTime(0), m_chasePathBudget(0), m_chasePathReserved(0), m_chasePathDeferred(0), m_antiCheatQueue(new ACMapQueue), i_scriptLock(true)
 {
     for (unsigned int j=0; j < MAX_NUMBER_OF_GRIDS; ++j)
     {
@@ -441,12 +444,42 @@ bool Map::loaded(const GridPair &p) const
     return false;
 }
 
+bool Map::TakeChasePathBudget(bool pending)
+{
+    if (!sWorld.getConfig(CONFIG_CHASE_PATH_BUDGET))
+        return true;
+
+    if (pending && m_chasePathReserved)
+    {
+        --m_chasePathReserved;
+        --m_chasePathBudget;
+        return true;
+    }
+
+    if (m_chasePathBudget > m_chasePathReserved)
+    {
+        --m_chasePathBudget;
+        return true;
+    }
+
+    ++m_chasePathDeferred;
+    MAP_UPDATE_DIFF(sWorld.MapUpdateDiff().CumulateDiffFor(DIFF_CHASE_PATH_DEFERRED, 1, GetId()))
+    return false;
+}
+
 void Map::Update(const uint32 &t_diff)
 {
     volatile uint32 debug_map_id = GetId();
     
     MAP_UPDATE_DIFF(DiffRecorder diff("", 0))
 
+    m_chasePathBudget = sWorld.getConfig(CONFIG_CHASE_PATH_BUDGET);
+    m_chasePathReserved = std::min(m_chasePathDeferred, m_chasePathBudget);
+    m_chasePathDeferred = 0;
+
+    /// act on anticheat results of previous ticks
+    ACApplyVerdicts(this, m_antiCheatQueue);
+
     /// update worldsessions for existing players
     for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
     {
@@ -459,6 +492,10 @@ void Map::Update(const uint32 &t_diff)
         }
     }
 
+    /// movement received in this tick is checked outside of map update
+    if (m_antiCheatQueue->HasSamples())
+        sWorld.m_ac.execute(new ACBatchRequest(m_antiCheatQueue));
+
     MAP_UPDATE_DIFF(sWorld.MapUpdateDiff().CumulateDiffFor(DIFF_SESSION_UPDATE, diff.RecordTimeFor(""), GetId()))
 
     /// update players at tick
@@ -54,6 +54,7 @@ class BattleGround;
 
 class GridMap;
 class TerrainInfo;
+class ACMapQueue;
 
 struct ScriptInfo;
 struct ScriptAction;
@@ -290,6 +291,27 @@ class HELLGROUND_IMPORT_EXPORT Map : public GridRefManager<NGridType>
             return i_grids[x][y];
         }
 
+        // CreatureEventAI statistics, changed only from map update
+        void CountEventAIEvaluated() { ++m_eventAIEvaluated; }
+        void CountEventAIFired() { ++m_eventAIFired; }
+        uint32 GetEventAIEvaluatedCount() const { return m_eventAIEvaluated; }
+        uint32 GetEventAIFiredCount() const { return m_eventAIFired; }
+        void ResetEventAICounters() { m_eventAIEvaluated = 0; m_eventAIFired = 0; }
+
+        // pathfinding statistics, time in microseconds
+        void CountPathfinding(uint64 time, bool cached) { ++m_pathfindingCount; m_pathfindingTime += time; if (cached) ++m_pathfindingCached; }
+        uint32 GetPathfindingCount() const { return m_pathfindingCount; }
+        uint32 GetPathfindingCachedCount() const { return m_pathfindingCached; }
+        uint64 GetPathfindingTime() const { return m_pathfindingTime; }
+        void ResetPathfindingCounters() { m_pathfindingCount = 0; m_pathfindingCached = 0; m_pathfindingTime = 0; }
+
+        // chase and follow paths are limited per update, returns false when over the limit
+        // paths postponed in previous update have part of the budget reserved, so they cannot starve
+        bool TakeChasePathBudget(bool pending);
+
+        // passive anticheat samples collected during update, checked in one batch per tick
+        ACMapQueue* GetAntiCheatQueue() { return m_antiCheatQueue; }
+
         //per-map script storage
         void ScriptsStart(std::map<uint32, std::multimap<uint32, ScriptInfo> > const& scripts, uint32 id, Object* source, Object* target);
         void ScriptCommandStart(ScriptInfo const& script, uint32 delay, Object* source, Object* target);
@@ -363,6 +385,18 @@ class HELLGROUND_IMPORT_EXPORT Map : public GridRefManager<NGridType>
         time_t i_gridExpiry;
         WorldUpdateCounter m_updateTracker;
 
+        uint32 m_eventAIEvaluated;
+        uint32 m_eventAIFired;
+
+        uint32 m_pathfindingCount;
+        uint32 m_pathfindingCached;
+        uint64 m_pathfindingTime;
+        uint32 m_chasePathBudget;
+        uint32 m_chasePathReserved;                         // part of budget kept for paths postponed in previous update
+        uint32 m_chasePathDeferred;                         // paths postponed in this update
+
+        ACMapQueue* m_antiCheatQueue;
+
         bool i_scriptLock;
 
         std::set<WorldObject *> i_objectsToRemove;
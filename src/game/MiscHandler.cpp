@@ -51,6 +51,7 @@
 #include "Group.h"
 #include "luaengine/HookMgr.h"
 #include "GuildMgr.h"
+#include "WhoListCache.h"
 
 void WorldSession::HandleRepopRequestOpcode(WorldPacket & /*recv_data*/)
 {
@@ -236,121 +237,104 @@ void WorldSession::HandleWhoOpcode(WorldPacket & recv_data)
     data << clientcount;                                    // clientcount place holder
     data << clientcount;                                    // clientcount place holder
 
-    ACE_GUARD(ACE_Thread_Mutex, guard, *HashMapHolder<Player>::GetLock());
-    HashMapHolder<Player>::MapType& m = sObjectAccessor.GetPlayers();
-    for (HashMapHolder<Player>::MapType::iterator itr = m.begin(); itr != m.end(); ++itr)
-    {
-        if (!HasPermissions(PERM_GMT_HDEV))
-        {
-            // player can see member of other team only if CONFIG_ALLOW_TWO_SIDE_WHO_LIST
-            if (itr->second->GetTeam() != team && !allowTwoSideWhoList)
-                continue;
-
-            // player can see MODERATOR, GAME MASTER, ADMINISTRATOR only if CONFIG_GM_IN_WHO_LIST
-            if (itr->second->GetSession()->HasPermissions(PERM_GMT) && !gmInWhoList)
-                continue;
-        }
-
-        //do not process players which are not in world
-        if (!itr->second->IsInWorld())
-            continue;
-
-        // check if target is globally visible for player
-        if (!itr->second->IsVisibleGloballyfor(_player))
-            continue;
-
-        // check if target's level is in level range
-        uint32 lvl = itr->second->getLevel();
-        if (lvl < level_min || lvl > level_max)
-            continue;
+    bool isGM = HasPermissions(PERM_GMT_HDEV);
+    bool fakeWhoOnArena = !GetPlayer()->isGameMaster() && sWorld.getConfig(CONFIG_ENABLE_FAKE_WHO_ON_ARENA);
+    uint32 maxWho = sWorld.getConfig(CONFIG_MAX_WHO);
 
-        // check if class matches classmask
-        uint32 class_ = itr->second->getClass();
-        if (!(classmask & (1 << class_)))
+    for (uint32 t = BG_TEAM_ALLIANCE; t < BG_TEAMS_COUNT; ++t)
+    {
+        // player can see member of other team only if CONFIG_ALLOW_TWO_SIDE_WHO_LIST
+        if (!isGM && !allowTwoSideWhoList && t != (team == HORDE ? BG_TEAM_HORDE : BG_TEAM_ALLIANCE))
             continue;
 
-        // check if race matches racemask
-        uint32 race = itr->second->getRace();
-        if (!(racemask & (1 << race)))
-            continue;
+        // lists are sorted by level, start at first one in level range
+        WhoList const& players = sWhoListCache.GetList(BattleGroundTeamId(t));
+        WhoListEntry levelKey;
+        levelKey.level = level_min;
+        WhoList::const_iterator itr = std::lower_bound(players.begin(), players.end(), levelKey, WhoListCache::LevelOrder);
 
-        uint32 pzoneid = itr->second->GetCachedZone();
-        if (!GetPlayer()->isGameMaster() && sWorld.getConfig(CONFIG_ENABLE_FAKE_WHO_ON_ARENA))
+        for (; itr != players.end() && itr->level <= level_max; ++itr)
         {
-            if (itr->second->InArena())
-            {
-                Player *pPlayer = itr->second;
-                pzoneid = sTerrainMgr.GetZoneId(pPlayer->GetBattleGroundEntryPointMap(), pPlayer->GetBattleGroundEntryPointX(), pPlayer->GetBattleGroundEntryPointY(), pPlayer->GetBattleGroundEntryPointZ());
-            }
-        }
-
-        uint8 gender = itr->second->getGender();
+            // player can see MODERATOR, GAME MASTER, ADMINISTRATOR only if CONFIG_GM_IN_WHO_LIST
+            if (!isGM && (itr->permissions & PERM_GMT) && !gmInWhoList)
+                continue;
 
-        bool z_show = true;
-        for (uint32 i = 0; i < zones_count; i++)
-        {
-            if (zoneids[i] == pzoneid)
+            // check if target is globally visible for player, same rules as Player::IsVisibleGloballyfor
+            if (itr->guid != _player->GetGUID() && itr->visibility != VISIBILITY_ON)
             {
-                z_show = true;
-                break;
+                if (isGM ? itr->permissions > GetPermissions() : itr->visibility == VISIBILITY_OFF)
+                    continue;
             }
 
-            z_show = false;
-        }
-        if (!z_show)
-            continue;
+            // check if class matches classmask
+            if (!(classmask & (1 << itr->class_)))
+                continue;
 
-        std::string pname = itr->second->GetName();
-        std::wstring wpname;
-        if (!Utf8toWStr(pname,wpname))
-            continue;
-        wstrToLower(wpname);
+            // check if race matches racemask
+            if (!(racemask & (1 << itr->race)))
+                continue;
 
-        if (!(wplayer_name.empty() || wpname.find(wplayer_name) != std::wstring::npos))
-            continue;
+            uint32 pzoneid = itr->zoneId;
+            if (fakeWhoOnArena && itr->entryZoneId)
+                pzoneid = itr->entryZoneId;
 
-        std::string gname = sGuildMgr.GetGuildNameById(itr->second->GetGuildId());
-        std::wstring wgname;
-        if (!Utf8toWStr(gname,wgname))
-            continue;
-        wstrToLower(wgname);
+            bool z_show = true;
+            for (uint32 i = 0; i < zones_count; i++)
+            {
+                if (zoneids[i] == pzoneid)
+                {
+                    z_show = true;
+                    break;
+                }
 
-        if (!(wguild_name.empty() || wgname.find(wguild_name) != std::wstring::npos))
-            continue;
+                z_show = false;
+            }
+            if (!z_show)
+                continue;
 
-        std::string aname;
-        if (AreaTableEntry const* areaEntry = GetAreaEntryByAreaID(pzoneid))
-            aname = areaEntry->area_name[GetSessionDbcLocale()];
+            if (!(wplayer_name.empty() || itr->wname.find(wplayer_name) != std::wstring::npos))
+                continue;
 
-        bool s_show = true;
-        for (uint32 i = 0; i < str_count; i++)
-        {
-            if (!str[i].empty())
+            if (!(wguild_name.empty() || itr->wguildName.find(wguild_name) != std::wstring::npos))
+                continue;
+
+            bool s_show = true;
+            for (uint32 i = 0; i < str_count; i++)
             {
-                if (wgname.find(str[i]) != std::wstring::npos ||
-                    wpname.find(str[i]) != std::wstring::npos ||
-                    Utf8FitTo(aname, str[i]))
+                if (!str[i].empty())
                 {
-                    s_show = true;
-                    break;
+                    std::string aname;
+                    if (AreaTableEntry const* areaEntry = GetAreaEntryByAreaID(pzoneid))
+                        aname = areaEntry->area_name[GetSessionDbcLocale()];
+
+                    if (itr->wguildName.find(str[i]) != std::wstring::npos ||
+                        itr->wname.find(str[i]) != std::wstring::npos ||
+                        Utf8FitTo(aname, str[i]))
+                    {
+                        s_show = true;
+                        break;
+                    }
+                    s_show = false;
                 }
-                s_show = false;
             }
+            if (!s_show)
+                continue;
+
+            data << itr->name;                              // player name
+            data << itr->guildName;                         // guild name
+            data << uint32(itr->level);                     // player level
+            data << uint32(itr->class_);                    // player class
+            data << uint32(itr->race);                      // player race
+            data << uint8(itr->gender);                     // player gender
+            data << uint32(pzoneid);                        // player zone id
+
+            // 49 is maximum player count sent to client - can be overridden
+            // through config, but is unstable
+            if ((++clientcount) == maxWho)
+                break;
         }
-        if (!s_show)
-            continue;
 
-        data << pname;                                  // player name
-        data << gname;                                  // guild name
-        data << uint32(lvl);                            // player level
-        data << uint32(class_);                         // player class
-        data << uint32(race);                           // player race
-        data << uint8(gender);                          // player gender
-        data << uint32(pzoneid);                        // player zone id
-
-        // 49 is maximum player count sent to client - can be overridden
-        // through config, but is unstable
-        if ((++clientcount) == sWorld.getConfig(CONFIG_MAX_WHO))
+        if (maxWho && clientcount == maxWho)
             break;
     }
 
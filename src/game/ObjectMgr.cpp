@@ -22,6 +22,7 @@
 #include "Database/DatabaseEnv.h"
 #include "Database/SQLStorage.h"
 #include "Database/SQLStorageImpl.h"
+#include "Database/DataSnapshot.h"
 
 #include "Log.h"
 #include "MapManager.h"
@@ -46,6 +47,7 @@
 #include "Util.h"
 #include "WaypointMgr.h"
 #include "InstanceData.h" //for condition_instance_data
+#include "Database/DatabaseImpl.h"
 
 bool normalizePlayerName(std::string& name)
 {
@@ -117,6 +119,8 @@ ObjectMgr::ObjectMgr()
     m_arenaTeamId       = 1;
     m_auctionid         = 1;
 
+    m_oldMailsPassRunning = false;
+
     // Only zero condition left, others will be added while loading DB tables
     mConditions.resize(1);
 }
@@ -162,6 +166,36 @@ Group * ObjectMgr::GetGroupByLeader(const uint64 &guid) const
     return NULL;
 }
 
+void ObjectMgr::ScheduleGroupUpdate(Group* group)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, mGroupUpdateLock);
+    mGroupUpdateSet.insert(group);
+}
+
+void ObjectMgr::UnscheduleGroupUpdate(Group* group)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, mGroupUpdateLock);
+    mGroupUpdateSet.erase(group);
+}
+
+void ObjectMgr::UpdateGroups(uint32 diff)
+{
+    std::vector<Group*> groups;
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, mGroupUpdateLock);
+        groups.assign(mGroupUpdateSet.begin(), mGroupUpdateSet.end());
+    }
+
+    // updated without lock, group update may schedule group again
+    for (std::vector<Group*>::iterator itr = groups.begin(); itr != groups.end(); ++itr)
+        (*itr)->Update(diff);
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, mGroupUpdateLock);
+    for (std::vector<Group*>::iterator itr = groups.begin(); itr != groups.end(); ++itr)
+        if (!(*itr)->NeedsUpdate())
+            mGroupUpdateSet.erase(*itr);
+}
+
 ArenaTeam* ObjectMgr::GetArenaTeamById(const uint32 arenateamid) const
 {
     ArenaTeamMap::const_iterator itr = mArenaTeamMap.find(arenateamid);
@@ -344,6 +378,8 @@ struct SQLCreatureLoader : public SQLStorageLoaderBase<SQLCreatureLoader>
     {
         dst = D(sScriptMgr.GetScriptId(src));
     }
+
+    uint32 snapshotSalt() const { return sScriptMgr.GetScriptNamesHash(); }
 };
 
 void ObjectMgr::LoadCreatureTemplates()
@@ -514,8 +550,10 @@ void ObjectMgr::LoadCreatureTemplates()
     }
 }
 
-void ObjectMgr::ConvertCreatureAddonAuras(CreatureDataAddon* addon, char const* table, char const* guidEntryStr)
+void ObjectMgr::ConvertCreatureAddonAuras(CreatureDataAddon* addon, SQLStorage const& storage, char const* guidEntryStr)
 {
+    char const* table = storage.GetTableName();
+
     // Now add the auras, format "spellid effectindex spellid effectindex..."
     char *p,*s;
     std::vector<int> val;
@@ -535,7 +573,7 @@ void ObjectMgr::ConvertCreatureAddonAuras(CreatureDataAddon* addon, char const*
             val.push_back(atoi(s));
 
         // free char* loaded memory
-        delete[] (char*)reinterpret_cast<char const*>(addon->auras);
+        storage.FreeString(reinterpret_cast<char const*>(addon->auras));
 
         // wrong list
         if (val.size()%2)
@@ -606,7 +644,7 @@ void ObjectMgr::LoadCreatureAddons()
         if (!sEmotesStore.LookupEntry(addon->emote))
             sLog.outLog(LOG_DB_ERR, "Creature (GUID: %u) have invalid emote (%u) defined in `creature_addon`.", addon->guidOrEntry, addon->emote);
 
-        ConvertCreatureAddonAuras(const_cast<CreatureDataAddon*>(addon), "creature_template_addon", "Entry");
+        ConvertCreatureAddonAuras(const_cast<CreatureDataAddon*>(addon), sCreatureInfoAddonStorage, "Entry");
 
         if (!sCreatureStorage.LookupEntry<CreatureInfo>(addon->guidOrEntry))
             sLog.outLog(LOG_DB_ERR, "Creature (Entry: %u) does not exist but has a record in `creature_template_addon`",addon->guidOrEntry);
@@ -627,7 +665,7 @@ void ObjectMgr::LoadCreatureAddons()
         if (!sEmotesStore.LookupEntry(addon->emote))
             sLog.outLog(LOG_DB_ERR, "Creature (GUID: %u) have invalid emote (%u) defined in `creature_template_addon`.", addon->guidOrEntry, addon->emote);
 
-        ConvertCreatureAddonAuras(const_cast<CreatureDataAddon*>(addon), "creature_addon", "GUIDLow");
+        ConvertCreatureAddonAuras(const_cast<CreatureDataAddon*>(addon), sCreatureDataAddonStorage, "GUIDLow");
 
         if (mCreatureDataMap.find(addon->guidOrEntry)==mCreatureDataMap.end())
             sLog.outLog(LOG_DB_ERR, "Creature (GUID: %u) does not exist but has a record in `creature_addon`",addon->guidOrEntry);
@@ -834,8 +872,8 @@ bool ObjectMgr::IsUnqueuedAccount(uint64 accid)
 void ObjectMgr::LoadCreatures()
 {
     uint32 count = 0;
-    //                                                       0              1   2    3
-    QueryResultAutoPtr result = GameDataDatabase.Query("SELECT creature.guid, id, map, modelid,"
+    //                                                                                                              0              1   2    3
+    QueryResultAutoPtr result = DataSnapshot::Query("creature", "creature,game_event_creature,pool_creature", "SELECT creature.guid, id, map, modelid,"
     //   4             5           6           7           8            9              10         11
         "equipment_id, position_x, position_y, position_z, orientation, spawntimesecs, spawndist, currentwaypoint,"
     //   12         13       14          15            16         17     18
@@ -1091,8 +1129,8 @@ void ObjectMgr::LoadGameobjects()
 {
     uint32 count = 0;
 
-    //                                                       0                1   2    3           4           5           6
-    QueryResultAutoPtr result = GameDataDatabase.Query("SELECT gameobject.guid, id, map, position_x, position_y, position_z, orientation,"
+    //                                                                                                                      0                1   2    3           4           5           6
+    QueryResultAutoPtr result = DataSnapshot::Query("gameobject", "gameobject,game_event_gameobject,pool_gameobject", "SELECT gameobject.guid, id, map, position_x, position_y, position_z, orientation,"
     //   7          8          9          10         11             12            13     14         15     16
         "rotation0, rotation1, rotation2, rotation3, spawntimesecs, animprogress, state, spawnMask, event, pool_entry "
         "FROM gameobject LEFT OUTER JOIN game_event_gameobject ON gameobject.guid = game_event_gameobject.guid "
@@ -1440,6 +1478,8 @@ struct SQLItemLoader : public SQLStorageLoaderBase<SQLItemLoader>
     {
         dst = D(sScriptMgr.GetScriptId(src));
     }
+
+    uint32 snapshotSalt() const { return sScriptMgr.GetScriptNamesHash(); }
 };
 
 void ObjectMgr::LoadItemPrototypes()
@@ -2674,8 +2714,8 @@ void ObjectMgr::LoadQuests()
     mQuestTemplates.clear();
     mExclusiveQuestGroups.clear();
 
-    //                                                       0      1       2           3             4         5           6     7              8
-    QueryResultAutoPtr result = GameDataDatabase.Query("SELECT entry, Method, ZoneOrSort, SkillOrClass, MinLevel, QuestLevel, Type, RequiredRaces, RequiredSkillValue,"
+    //                                                                                        0      1       2           3             4         5           6     7              8
+    QueryResultAutoPtr result = DataSnapshot::Query("quest_template", "quest_template", "SELECT entry, Method, ZoneOrSort, SkillOrClass, MinLevel, QuestLevel, Type, RequiredRaces, RequiredSkillValue,"
     //   9                    10                 11                     12                   13                     14                   15                16
         "RepObjectiveFaction, RepObjectiveValue, RequiredMinRepFaction, RequiredMinRepValue, RequiredMaxRepFaction, RequiredMaxRepValue, SuggestedPlayers, LimitTime,"
     //   17          18            19           20           21           22              23                24         25            26
@@ -3453,6 +3493,8 @@ struct SQLInstanceLoader : public SQLStorageLoaderBase<SQLInstanceLoader>
     {
         dst = D(sScriptMgr.GetScriptId(src));
     }
+
+    uint32 snapshotSalt() const { return sScriptMgr.GetScriptNamesHash(); }
 };
 
 void ObjectMgr::LoadInstanceTemplate()
@@ -3636,98 +3678,234 @@ void ObjectMgr::LoadNpcTextLocales()
     sLog.outString(">> Loaded %u NpcText locale strings", mNpcTextLocaleMap.size());
 }
 
-//not very fast function but it is called only once a day, or on starting-up
+//                                 0  1           2      3        4          5         6       7
+#define OLD_MAILS_QUERY         "SELECT id,messageType,sender,receiver,itemTextId,has_items,checked,stationery FROM mail WHERE expire_time < '" UI64FMTD "' AND id > '%u' ORDER BY id LIMIT %u"
+//                                 0       1
+#define OLD_MAIL_ITEMS_QUERY    "SELECT mail_id,item_guid FROM mail_items WHERE mail_id IN " \
+                                "(SELECT id FROM (SELECT id FROM mail WHERE expire_time < '" UI64FMTD "' AND id > '%u' ORDER BY id LIMIT %u) AS old_mails)"
+
+enum OldMailsQueryIndex
+{
+    OLD_MAILS_QUERY_MAILS = 0,
+    OLD_MAILS_QUERY_ITEMS,
+    MAX_OLD_MAILS_QUERY
+};
+
+class OldMailsQueryHolder : public SqlQueryHolder
+{
+    private:
+        time_t m_basetime;
+        uint32 m_lastId;
+    public:
+        OldMailsQueryHolder(time_t basetime, uint32 lastId)
+            : m_basetime(basetime), m_lastId(lastId) { }
+        time_t GetBaseTime() const { return m_basetime; }
+        uint32 GetLastId() const { return m_lastId; }
+        bool Initialize(uint32 chunkSize)
+        {
+            SetSize(MAX_OLD_MAILS_QUERY);
+
+            bool res = true;
+            res &= SetPQuery(OLD_MAILS_QUERY_MAILS, OLD_MAILS_QUERY, (uint64)m_basetime, m_lastId, chunkSize);
+            res &= SetPQuery(OLD_MAILS_QUERY_ITEMS, OLD_MAIL_ITEMS_QUERY, (uint64)m_basetime, m_lastId, chunkSize);
+            return res;
+        }
+};
+
+// executes "<sql> IN (ids)", split so single request fits into MAX_QUERY_LEN
+static void ExecuteForIds(std::string const& sql, std::vector<uint32> const& ids)
+{
+    static const size_t maxIdsPerRequest = 1000;
+
+    for (size_t i = 0; i < ids.size(); i += maxIdsPerRequest)
+    {
+        std::ostringstream ss;
+        ss << sql << " IN (";
+        for (size_t j = i; j < ids.size() && j < i + maxIdsPerRequest; ++j)
+        {
+            if (j != i)
+                ss << ",";
+            ss << ids[j];
+        }
+        ss << ")";
+
+        RealmDataDatabase.Execute(ss.str().c_str());
+    }
+}
+
+// on starting-up whole table is processed at once, while server is up mails are processed in chunks from async callbacks
 void ObjectMgr::ReturnOrDeleteOldMails(bool serverUp)
 {
     time_t basetime = time(NULL);
     sLog.outDebug("Returning mails current time: hour: %d, minute: %d, second: %d ", localtime(&basetime)->tm_hour, localtime(&basetime)->tm_min, localtime(&basetime)->tm_sec);
+
+    if (serverUp)
+    {
+        // previous pass still running
+        if (m_oldMailsPassRunning)
+            return;
+
+        m_oldMailsPassRunning = true;
+        QueueOldMailsChunk(basetime, 0);
+        return;
+    }
+
     //delete all old mails without item and without body immediately, if starting server
-    if (!serverUp)
-        RealmDataDatabase.PExecute("DELETE FROM mail WHERE expire_time < '" UI64FMTD "' AND has_items = '0' AND itemTextId = 0", (uint64)basetime);
-    //                                                            0  1           2      3        4          5         6           7   8       9
-    QueryResultAutoPtr result = RealmDataDatabase.PQuery("SELECT id,messageType,sender,receiver,itemTextId,has_items,expire_time,cod,checked,mailTemplateId FROM mail WHERE expire_time < '" UI64FMTD "'", (uint64)basetime);
-    if (!result)
-        return;                                             // any mails need to be returned or deleted
-    Field *fields;
-    //std::ostringstream delitems, delmails; //will be here for optimization
-    //bool deletemail = false, deleteitem = false;
-    //delitems << "DELETE FROM item_instance WHERE guid IN (";
-    //delmails << "DELETE FROM mail WHERE id IN ("
+    RealmDataDatabase.PExecute("DELETE FROM mail WHERE expire_time < '" UI64FMTD "' AND has_items = '0' AND itemTextId = 0", (uint64)basetime);
+
+    uint32 chunkSize = sWorld.getConfig(CONFIG_RETURNOLDMAILS_CHUNK_SIZE);
+    uint32 lastId = 0;
+    while (QueryResultAutoPtr mails = RealmDataDatabase.PQuery(OLD_MAILS_QUERY, (uint64)basetime, lastId, chunkSize))
+    {
+        QueryResultAutoPtr items = RealmDataDatabase.PQuery(OLD_MAIL_ITEMS_QUERY, (uint64)basetime, lastId, chunkSize);
+        if (ReturnOrDeleteOldMailsChunk(mails, items, basetime, false, lastId) < chunkSize)
+            break;
+    }
+}
+
+void ObjectMgr::QueueOldMailsChunk(time_t basetime, uint32 lastId)
+{
+    OldMailsQueryHolder* holder = new OldMailsQueryHolder(basetime, lastId);
+    if (!holder->Initialize(sWorld.getConfig(CONFIG_RETURNOLDMAILS_CHUNK_SIZE)) ||
+        !RealmDataDatabase.DelayQueryHolder(this, &ObjectMgr::ReturnOrDeleteOldMailsCallback, (SqlQueryHolder*)holder))
+    {
+        delete holder;
+        m_oldMailsPassRunning = false;
+    }
+}
+
+void ObjectMgr::ReturnOrDeleteOldMailsCallback(QueryResultAutoPtr /*dummy*/, SqlQueryHolder* holder)
+{
+    if (!holder)
+        return;
+
+    OldMailsQueryHolder* mailsHolder = (OldMailsQueryHolder*)holder;
+    time_t basetime = mailsHolder->GetBaseTime();
+    uint32 lastId = mailsHolder->GetLastId();
+
+    uint32 count = ReturnOrDeleteOldMailsChunk(mailsHolder->GetResult(OLD_MAILS_QUERY_MAILS), mailsHolder->GetResult(OLD_MAILS_QUERY_ITEMS), basetime, true, lastId);
+    delete mailsHolder;
+
+    // full chunk, there can be more; next one will be processed at one of next result queue updates
+    if (count && count >= sWorld.getConfig(CONFIG_RETURNOLDMAILS_CHUNK_SIZE))
+        QueueOldMailsChunk(basetime, lastId);
+    else
+        m_oldMailsPassRunning = false;
+}
+
+// returns amount of mails in chunk, lastId is set to highest processed mail id
+uint32 ObjectMgr::ReturnOrDeleteOldMailsChunk(QueryResultAutoPtr mails, QueryResultAutoPtr items, time_t basetime, bool serverUp, uint32& lastId)
+{
+    if (!mails)
+        return 0;                                           // any mails need to be returned or deleted
+
+    typedef std::map<uint32, std::vector<uint32> > MailItemGuids;
+    MailItemGuids mailItems;                                // mail id -> item guids
+
+    if (items)
+    {
+        do
+        {
+            Field *fields = items->Fetch();
+            mailItems[fields[0].GetUInt32()].push_back(fields[1].GetUInt32());
+        }
+        while (items->NextRow());
+    }
+
+    std::vector<uint32> deletedMails, deletedItems, deletedTexts;
+
+    typedef std::map<std::pair<uint32, uint32>, std::vector<uint32> > ReturnedMails;
+    ReturnedMails returnedMails;                            // (receiver, sender) -> mail ids
+    MailItemGuids returnedItems;                            // new owner -> item guids
+
+    uint32 count = 0;
     do
     {
-        fields = result->Fetch();
-        Mail *m = new Mail;
-        m->messageID = fields[0].GetUInt32();
-        m->messageType = fields[1].GetUInt8();
-        m->sender = fields[2].GetUInt32();
-        m->receiverGuid = ObjectGuid(HIGHGUID_PLAYER, fields[3].GetUInt32());
-        m->itemTextId = fields[4].GetUInt32();
+        ++count;
+
+        Field *fields = mails->Fetch();
+        uint32 mailId = fields[0].GetUInt32();
+        uint8 messageType = fields[1].GetUInt8();
+        uint32 sender = fields[2].GetUInt32();
+        uint32 receiver = fields[3].GetUInt32();
+        uint32 itemTextId = fields[4].GetUInt32();
         bool has_items = fields[5].GetBool();
-        m->expire_time = (time_t)fields[6].GetUInt64();
-        m->deliver_time = 0;
-        m->COD = fields[7].GetUInt32();
-        m->checked = fields[8].GetUInt32();
-        m->mailTemplateId = fields[9].GetInt16();
+        uint32 checked = fields[6].GetUInt32();
+        uint8 stationery = fields[7].GetUInt8();
 
-        Player *pl = 0;
-        if (serverUp)
-            pl = GetPlayer(m->receiverGuid.GetRawValue());
+        lastId = mailId;
 
-        if (pl)
+        // in-memory mailbox of online receiver is updated at his map thread
+        if (serverUp)
         {
-            delete m;
-            continue;
+            if (Player *pl = GetPlayer(ObjectGuid(HIGHGUID_PLAYER, receiver)))
+            {
+                pl->QueueExpiredMail(mailId);
+                continue;
+            }
         }
 
         //delete or return mail:
         if (has_items)
         {
-            QueryResultAutoPtr resultItems = RealmDataDatabase.PQuery("SELECT item_guid,item_template FROM mail_items WHERE mail_id='%u'", m->messageID);
-            if (resultItems)
-            {
-                do
-                {
-                    Field *fields2 = resultItems->Fetch();
-
-                    uint32 item_guid_low = fields2[0].GetUInt32();
-                    uint32 item_template = fields2[1].GetUInt32();
-
-                    m->AddItem(item_guid_low, item_template);
-                }
-                while (resultItems->NextRow());
-            }
+            std::vector<uint32> const& itemGuids = mailItems[mailId];
 
             // mail should be deleted if:
             // - it's from AH
             // - it's readed mail from GM (or meybe all readed mails should be deleted not returned ?)
-            if (m->messageType != MAIL_NORMAL || (m->checked & (MAIL_CHECK_MASK_COD_PAYMENT | MAIL_CHECK_MASK_RETURNED)) || (m->stationery == MAIL_STATIONERY_GM && m->checked & MAIL_CHECK_MASK_READ))
+            if (!IsExpiredMailReturned(messageType, checked, stationery))
             {
                 // mail open and then not returned
-                for (std::vector<MailItemInfo>::iterator itr2 = m->items.begin(); itr2 != m->items.end(); ++itr2)
-                    RealmDataDatabase.PExecute("DELETE FROM item_instance WHERE guid = '%u'", itr2->item_guid);
+                deletedItems.insert(deletedItems.end(), itemGuids.begin(), itemGuids.end());
             }
             else
             {
                 //mail will be returned:
-                RealmDataDatabase.PExecute("UPDATE mail SET sender = '%u', receiver = '%u', expire_time = '" UI64FMTD "', deliver_time = '" UI64FMTD "',cod = '0', checked = '%u' WHERE id = '%u'", m->receiverGuid.GetCounter(), m->sender, (uint64)(basetime + 30*DAY), (uint64)basetime, MAIL_CHECK_MASK_RETURNED, m->messageID);
-                for (std::vector<MailItemInfo>::iterator itr2 = m->items.begin(); itr2 != m->items.end(); ++itr2)
-                {
-                    RealmDataDatabase.PExecute("UPDATE mail_items SET receiver = %u WHERE item_guid = '%u'", m->sender, itr2->item_guid);
-                    RealmDataDatabase.PExecute("UPDATE item_instance SET owner_guid = %u WHERE guid = '%u'", m->sender, itr2->item_guid);
-                }
-                delete m;
+                returnedMails[std::make_pair(receiver, sender)].push_back(mailId);
+
+                std::vector<uint32>& senderItems = returnedItems[sender];
+                senderItems.insert(senderItems.end(), itemGuids.begin(), itemGuids.end());
                 continue;
             }
         }
 
-        if (m->itemTextId)
-            RealmDataDatabase.PExecute("DELETE FROM item_text WHERE id = '%u'", m->itemTextId);
+        if (itemTextId)
+            deletedTexts.push_back(itemTextId);
 
-        //deletemail = true;
-        //delmails << m->messageID << ", ";
-        RealmDataDatabase.PExecute("DELETE FROM mail WHERE id = '%u'", m->messageID);
-        delete m;
-    } while (result->NextRow());
+        deletedMails.push_back(mailId);
+    }
+    while (mails->NextRow());
+
+    RealmDataDatabase.BeginTransaction();
+
+    ExecuteForIds("DELETE FROM item_instance WHERE guid", deletedItems);
+    ExecuteForIds("DELETE FROM item_text WHERE id", deletedTexts);
+    ExecuteForIds("DELETE FROM mail_items WHERE mail_id", deletedMails);
+    ExecuteForIds("DELETE FROM mail WHERE id", deletedMails);
+
+    for (ReturnedMails::const_iterator itr = returnedMails.begin(); itr != returnedMails.end(); ++itr)
+    {
+        std::ostringstream ss;
+        ss << "UPDATE mail SET sender = '" << itr->first.first << "', receiver = '" << itr->first.second
+           << "', expire_time = '" << uint64(basetime + 30*DAY) << "', deliver_time = '" << uint64(basetime)
+           << "', cod = '0', checked = '" << uint32(MAIL_CHECK_MASK_RETURNED) << "' WHERE id";
+        ExecuteForIds(ss.str(), itr->second);
+
+        ss.str("");
+        ss << "UPDATE mail_items SET receiver = '" << itr->first.second << "' WHERE mail_id";
+        ExecuteForIds(ss.str(), itr->second);
+    }
+
+    for (MailItemGuids::const_iterator itr = returnedItems.begin(); itr != returnedItems.end(); ++itr)
+    {
+        std::ostringstream ss;
+        ss << "UPDATE item_instance SET owner_guid = '" << itr->first << "' WHERE guid";
+        ExecuteForIds(ss.str(), itr->second);
+    }
+
+    RealmDataDatabase.CommitTransaction();
+
+    return count;
 }
 
 void ObjectMgr::LoadQuestAreaTriggers()
@@ -4491,12 +4669,13 @@ uint32 ObjectMgr::GenerateAuctionID()
 
 uint32 ObjectMgr::GenerateMailID()
 {
-    if (m_mailid>=0xFFFFFFFE)
+    uint32 mailId = m_mailid++;
+    if (mailId>=0xFFFFFFFE)
     {
         sLog.outLog(LOG_DEFAULT, "ERROR: Mail ids overflow!! Can't continue, shutting down server. ");
         World::StopNow(ERROR_EXIT_CODE);
     }
-    return m_mailid++;
+    return mailId;
 }
 
 uint32 ObjectMgr::GenerateItemTextID()
@@ -4660,6 +4839,8 @@ struct SQLGameObjectLoader : public SQLStorageLoaderBase<SQLGameObjectLoader>
     {
         dst = D(sScriptMgr.GetScriptId(src));
     }
+
+    uint32 snapshotSalt() const { return sScriptMgr.GetScriptNamesHash(); }
 };
 
 inline void CheckGOLockId(GameObjectInfo const* goInfo, uint32 dataN, uint32 N)
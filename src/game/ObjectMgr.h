@@ -298,6 +298,11 @@ class ObjectMgr
         GroupSet::iterator GetGroupSetBegin() { return mGroupSet.begin(); }
         GroupSet::iterator GetGroupSetEnd()   { return mGroupSet.end(); }
 
+        // only groups with pending work (see Group::NeedsUpdate) are updated on session tick
+        void ScheduleGroupUpdate(Group* group);
+        void UnscheduleGroupUpdate(Group* group);
+        void UpdateGroups(uint32 diff);
+
         ArenaTeam* GetArenaTeamById(const uint32 arenateamid) const;
         ArenaTeam* GetArenaTeamByName(const std::string& arenateamname) const;
         ArenaTeam* GetArenaTeamByCaptain(uint64 const& guid) const;
@@ -533,6 +538,7 @@ class ObjectMgr
         }
 
         void ReturnOrDeleteOldMails(bool serverUp);
+        void ReturnOrDeleteOldMailsCallback(QueryResultAutoPtr /*dummy*/, SqlQueryHolder* holder);
 
         void SetHighestGuids();
         uint32 GenerateLowGuid(HighGuid guidhigh);
@@ -762,7 +768,7 @@ class ObjectMgr
 
         // first free id for selected id type
         uint32 m_auctionid;
-        uint32 m_mailid;
+        ACE_Atomic_Op<ACE_Thread_Mutex, uint32> m_mailid;   // mails are returned from map threads too
         uint32 m_ItemTextId;
         uint32 m_arenaTeamId;
         uint32 m_hiPetNumber;
@@ -785,6 +791,8 @@ class ObjectMgr
         typedef std::set<uint32> GameObjectForQuestSet;
 
         GroupSet                mGroupSet;
+        GroupSet                mGroupUpdateSet;
+        ACE_Thread_Mutex        mGroupUpdateLock;       // rolls are started from map threads
         ArenaTeamMap            mArenaTeamMap;
 
         ItemTextMap             mItemTexts;
@@ -822,8 +830,14 @@ class ObjectMgr
 
         int DBCLocaleIndex;
 
+        // old mails pass in progress, chunks are requested one after another from async callback
+        bool m_oldMailsPassRunning;
+
     private:
-        void ConvertCreatureAddonAuras(CreatureDataAddon* addon, char const* table, char const* guidEntryStr);
+        uint32 ReturnOrDeleteOldMailsChunk(QueryResultAutoPtr mails, QueryResultAutoPtr items, time_t basetime, bool serverUp, uint32& lastId);
+        void QueueOldMailsChunk(time_t basetime, uint32 lastId);
+
+        void ConvertCreatureAddonAuras(CreatureDataAddon* addon, SQLStorage const& storage, char const* guidEntryStr);
         void LoadQuestRelationsHelper(QuestRelations& map,char const* table);
 
         typedef std::map<uint32,PetLevelInfo*> PetLevelInfoMap;
@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2008-2014 Hellground <http://hellground.net/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "OpcodeStats.h"
+
+#include <ace/OS_NS_sys_time.h>
+#include <ace/TSS_T.h>
+
+#include <algorithm>
+
+// blocks are owned by OpcodeStats, slot only remembers which one belongs to the thread
+struct OpcodeStatsSlot
+{
+    OpcodeStatsSlot() : block(NULL) {}
+
+    OpcodeStatsBlock* block;
+};
+
+typedef ACE_TSS<OpcodeStatsSlot> OpcodeStatsSlotTSS;
+
+static OpcodeStatsSlotTSS threadSlot;
+
+OpcodeStats::OpcodeStats() : m_enabled(false), m_generation(0)
+{
+}
+
+OpcodeStats::~OpcodeStats()
+{
+    for (std::vector<OpcodeStatsBlock*>::iterator itr = m_blocks.begin(); itr != m_blocks.end(); ++itr)
+        delete *itr;
+}
+
+uint64 OpcodeStats::GetTimeUS()
+{
+    ACE_Time_Value now = ACE_OS::gettimeofday();
+    return uint64(now.sec()) * 1000000 + now.usec();
+}
+
+uint32 OpcodeStats::GetBucket(uint64 time)
+{
+    uint32 bucket = 0;
+    while (time > 1 && bucket < OPCODE_STATS_BUCKETS - 1)
+    {
+        time >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+OpcodeStatsBlock* OpcodeStats::GetThreadBlock()
+{
+    OpcodeStatsSlot* slot = threadSlot.ts_object();
+    if (!slot)
+    {
+        slot = new OpcodeStatsSlot;
+        threadSlot.ts_object(slot);
+    }
+
+    if (!slot->block)
+    {
+        slot->block = new OpcodeStatsBlock;
+
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, slot->block);
+        m_blocks.push_back(slot->block);
+    }
+
+    return slot->block;
+}
+
+void OpcodeStats::RecordPacket(uint16 opcode, uint64 queueTime, uint64 handleTime, uint32 size)
+{
+    if (opcode >= NUM_MSG_TYPES)
+        return;
+
+    OpcodeStatsBlock* block = GetThreadBlock();
+
+    uint32 generation = uint32(m_generation.value());
+    if (block->generation != generation)
+    {
+        block->Reset();
+        block->generation = generation;
+    }
+
+    OpcodeCounters& counters = block->counters[opcode];
+    ++counters.count;
+    counters.totalTime += handleTime;
+    counters.bytes += size;
+    if (handleTime > counters.maxTime)
+        counters.maxTime = uint32(std::min<uint64>(handleTime, 0xFFFFFFFF));
+
+    ++block->handleTime[opcode].buckets[GetBucket(handleTime)];
+    ++block->queueTime[opcode].buckets[GetBucket(queueTime)];
+}
+
+void OpcodeStats::Merge(OpcodeStatsBlock& result) const
+{
+    result.Reset();
+
+    uint32 generation = uint32(m_generation.value());
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+    for (std::vector<OpcodeStatsBlock*>::const_iterator itr = m_blocks.begin(); itr != m_blocks.end(); ++itr)
+    {
+        // not cleared by its thread since last reset
+        if ((*itr)->generation != generation)
+            continue;
+
+        for (uint32 opcode = 0; opcode < NUM_MSG_TYPES; ++opcode)
+        {
+            OpcodeCounters const& counters = (*itr)->counters[opcode];
+            result.counters[opcode].count += counters.count;
+            result.counters[opcode].totalTime += counters.totalTime;
+            result.counters[opcode].bytes += counters.bytes;
+            result.counters[opcode].maxTime = std::max(result.counters[opcode].maxTime, counters.maxTime);
+
+            for (uint32 i = 0; i < OPCODE_STATS_BUCKETS; ++i)
+            {
+                result.handleTime[opcode].buckets[i] += (*itr)->handleTime[opcode].buckets[i];
+                result.queueTime[opcode].buckets[i] += (*itr)->queueTime[opcode].buckets[i];
+            }
+        }
+    }
+}
+
+void OpcodeStats::Reset()
+{
+    // blocks are written without lock by their threads, so they are never cleared from here
+    ++m_generation;
+}
+
+static char const* PacketProcessingName(PacketProcessing place)
+{
+    switch (place)
+    {
+        case PROCESS_INPLACE:       return "inplace";
+        case PROCESS_THREADUNSAFE:  return "threadunsafe";
+        case PROCESS_THREADSAFE:    return "threadsafe";
+    }
+    return "unknown";
+}
+
+struct OpcodeTotalTimeOrder
+{
+    explicit OpcodeTotalTimeOrder(OpcodeStatsBlock const& s) : stats(s) {}
+
+    bool operator()(uint16 a, uint16 b) const
+    {
+        return stats.counters[a].totalTime > stats.counters[b].totalTime;
+    }
+
+    OpcodeStatsBlock const& stats;
+};
+
+void OpcodeStats::BuildReport(uint32 limit, std::vector<std::string>& lines) const
+{
+    OpcodeStatsBlock* stats = new OpcodeStatsBlock;
+    Merge(*stats);
+
+    uint32 placeCount[PROCESS_THREADSAFE + 1] = { 0, 0, 0 };
+    uint64 placeTime[PROCESS_THREADSAFE + 1] = { 0, 0, 0 };
+
+    std::vector<uint16> opcodes;
+    for (uint16 opcode = 0; opcode < NUM_MSG_TYPES; ++opcode)
+    {
+        OpcodeCounters const& counters = stats->counters[opcode];
+        if (!counters.count)
+            continue;
+
+        PacketProcessing place = opcodeTable[opcode].packetProcessing;
+        placeCount[place] += counters.count;
+        placeTime[place] += counters.totalTime;
+        opcodes.push_back(opcode);
+    }
+
+    std::sort(opcodes.begin(), opcodes.end(), OpcodeTotalTimeOrder(*stats));
+    if (opcodes.size() > limit)
+        opcodes.resize(limit);
+
+    char buff[256];
+    for (uint32 place = PROCESS_INPLACE; place <= PROCESS_THREADSAFE; ++place)
+    {
+        snprintf(buff, sizeof(buff), "%s: %u calls, %.1f ms", PacketProcessingName(PacketProcessing(place)), placeCount[place], placeTime[place] / 1000.0f);
+        lines.push_back(buff);
+    }
+
+    for (std::vector<uint16>::const_iterator itr = opcodes.begin(); itr != opcodes.end(); ++itr)
+    {
+        OpcodeCounters const& counters = stats->counters[*itr];
+        snprintf(buff, sizeof(buff), "%s (%s): %u calls, total %.1f ms, avg %u us, max %u us, " UI64FMTD " bytes",
+            LookupOpcodeName(*itr), PacketProcessingName(opcodeTable[*itr].packetProcessing), counters.count,
+            counters.totalTime / 1000.0f, uint32(counters.totalTime / counters.count), counters.maxTime, counters.bytes);
+        lines.push_back(buff);
+    }
+
+    delete stats;
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2008-2014 Hellground <http://hellground.net/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef HELLGROUND_OPCODESTATS_H
+#define HELLGROUND_OPCODESTATS_H
+
+#include <ace/Atomic_Op.h>
+#include <ace/Singleton.h>
+#include <ace/Thread_Mutex.h>
+
+#include "Common.h"
+#include "Opcodes.h"
+
+#include <string>
+#include <vector>
+
+// bucket i counts samples in [2^i, 2^(i+1)) microseconds, first one everything below 2us, last one everything above
+#define OPCODE_STATS_BUCKETS 24
+
+struct OpcodeHistogram
+{
+    uint32 buckets[OPCODE_STATS_BUCKETS];
+};
+
+struct OpcodeCounters
+{
+    uint32 count;
+    uint32 maxTime;                                         // longest single handler call in microseconds
+    uint64 totalTime;                                       // in microseconds
+    uint64 bytes;                                           // payload size of handled packets
+};
+
+struct OpcodeStatsBlock
+{
+    OpcodeStatsBlock() { Reset(); }
+
+    void Reset() { memset(this, 0, sizeof(OpcodeStatsBlock)); }
+
+    uint32 generation;                                      // reset generation block was last cleared in
+    OpcodeCounters counters[NUM_MSG_TYPES];
+    OpcodeHistogram handleTime[NUM_MSG_TYPES];              // time spent in handler
+    OpcodeHistogram queueTime[NUM_MSG_TYPES];               // time between receiving and handling packet
+};
+
+/// Per opcode handler profile and queue latency histograms.
+/// Every thread processing packets writes only to its own block, blocks are summed when read.
+/// Reset only bumps generation, each thread clears its own block on next recorded packet.
+class OpcodeStats
+{
+    public:
+        OpcodeStats();
+        ~OpcodeStats();
+
+        void SetEnabled(bool enabled) { m_enabled = enabled; }
+        bool IsEnabled() const { return m_enabled; }
+
+        /// times in microseconds
+        void RecordPacket(uint16 opcode, uint64 queueTime, uint64 handleTime, uint32 size);
+
+        /// sum of all thread blocks, values of running threads may be a few samples behind
+        void Merge(OpcodeStatsBlock& result) const;
+        void Reset();
+
+        /// per processing place summary followed by opcodes with the highest total handler time
+        void BuildReport(uint32 limit, std::vector<std::string>& lines) const;
+
+        static uint64 GetTimeUS();
+        static uint32 GetBucket(uint64 time);
+
+    private:
+        OpcodeStatsBlock* GetThreadBlock();
+
+        bool m_enabled;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_generation;
+
+        mutable ACE_Thread_Mutex m_lock;                    // guards only list of blocks
+        std::vector<OpcodeStatsBlock*> m_blocks;
+};
+
+#define sOpcodeStats (*ACE_Singleton<OpcodeStats, ACE_Null_Mutex>::instance())
+
+#endif
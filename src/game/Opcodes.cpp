@@ -285,7 +285,7 @@ OpcodeHandler opcodeTable[NUM_MSG_TYPES] =
     /*0x0FE*/ { "CMSG_TUTORIAL_FLAG",               STATUS_LOGGEDIN,    PROCESS_THREADUNSAFE, &WorldSession::HandleTutorialFlag              },
     /*0x0FF*/ { "CMSG_TUTORIAL_CLEAR",              STATUS_LOGGEDIN,    PROCESS_THREADUNSAFE,  &WorldSession::HandleTutorialClear             },
     /*0x100*/ { "CMSG_TUTORIAL_RESET",              STATUS_LOGGEDIN,    PROCESS_THREADUNSAFE,  &WorldSession::HandleTutorialReset             },
-    /*0x101*/ { "CMSG_STANDSTATECHANGE",            STATUS_LOGGEDIN,    PROCESS_THREADUNSAFE,  &WorldSession::HandleStandStateChangeOpcode    },
+    /*0x101*/ { "CMSG_STANDSTATECHANGE",            STATUS_LOGGEDIN,    PROCESS_THREADSAFE,    &WorldSession::HandleStandStateChangeOpcode    },
     /*0x102*/ { "CMSG_EMOTE",                       STATUS_LOGGEDIN,    PROCESS_THREADUNSAFE,  &WorldSession::HandleEmoteOpcode               },
     /*0x103*/ { "SMSG_EMOTE",                       STATUS_NEVER,       PROCESS_INPLACE, &WorldSession::Handle_ServerSide               },
     /*0x104*/ { "CMSG_TEXT_EMOTE",                  STATUS_LOGGEDIN,    PROCESS_THREADUNSAFE,  &WorldSession::HandleTextEmoteOpcode           },
@@ -324,7 +324,7 @@ OpcodeHandler opcodeTable[NUM_MSG_TYPES] =
     /*0x125*/ { "CMSG_SET_FACTION_ATWAR",           STATUS_LOGGEDIN,    PROCESS_THREADUNSAFE,  &WorldSession::HandleSetFactionAtWar           },
     /*0x126*/ { "CMSG_SET_FACTION_CHEAT",           STATUS_LOGGEDIN,    PROCESS_THREADUNSAFE,  &WorldSession::Handle_Deprecated           },
     /*0x127*/ { "SMSG_SET_PROFICIENCY",             STATUS_NEVER,       PROCESS_INPLACE, &WorldSession::Handle_ServerSide               },
-    /*0x128*/ { "CMSG_SET_ACTION_BUTTON",           STATUS_LOGGEDIN,    PROCESS_THREADUNSAFE,  &WorldSession::HandleSetActionButtonOpcode     },
+    /*0x128*/ { "CMSG_SET_ACTION_BUTTON",           STATUS_LOGGEDIN,    PROCESS_THREADSAFE,    &WorldSession::HandleSetActionButtonOpcode     },
     /*0x129*/ { "SMSG_ACTION_BUTTONS",              STATUS_NEVER,       PROCESS_INPLACE, &WorldSession::Handle_ServerSide               },
     /*0x12A*/ { "SMSG_INITIAL_SPELLS",              STATUS_NEVER,       PROCESS_INPLACE, &WorldSession::Handle_ServerSide               },
     /*0x12B*/ { "SMSG_LEARNED_SPELL",               STATUS_NEVER,       PROCESS_INPLACE, &WorldSession::Handle_ServerSide               },
@@ -338,15 +338,15 @@ OpcodeHandler opcodeTable[NUM_MSG_TYPES] =
     /*0x133*/ { "SMSG_SPELL_FAILURE",               STATUS_NEVER,       PROCESS_INPLACE, &WorldSession::Handle_ServerSide               },
     /*0x134*/ { "SMSG_SPELL_COOLDOWN",              STATUS_NEVER,       PROCESS_INPLACE, &WorldSession::Handle_ServerSide               },
     /*0x135*/ { "SMSG_COOLDOWN_EVENT",              STATUS_NEVER,       PROCESS_INPLACE, &WorldSession::Handle_ServerSide               },
-    /*0x136*/ { "CMSG_CANCEL_AURA",                 STATUS_LOGGEDIN,    PROCESS_THREADUNSAFE,  &WorldSession::HandleCancelAuraOpcode          },
+    /*0x136*/ { "CMSG_CANCEL_AURA",                 STATUS_LOGGEDIN,    PROCESS_THREADSAFE,    &WorldSession::HandleCancelAuraOpcode          },
     /*0x137*/ { "SMSG_UPDATE_AURA_DURATION",        STATUS_NEVER,       PROCESS_INPLACE, &WorldSession::Handle_ServerSide               },
     /*0x138*/ { "SMSG_PET_CAST_FAILED",             STATUS_NEVER,       PROCESS_INPLACE, &WorldSession::Handle_ServerSide               },
     /*0x139*/ { "MSG_CHANNEL_START",                STATUS_NEVER,       PROCESS_INPLACE, &WorldSession::Handle_NULL                     },
     /*0x13A*/ { "MSG_CHANNEL_UPDATE",               STATUS_NEVER,       PROCESS_INPLACE, &WorldSession::Handle_NULL                     },
-    /*0x13B*/ { "CMSG_CANCEL_CHANNELLING",          STATUS_LOGGEDIN,    PROCESS_THREADUNSAFE,  &WorldSession::HandleCancelChanneling          },
+    /*0x13B*/ { "CMSG_CANCEL_CHANNELLING",          STATUS_LOGGEDIN,    PROCESS_THREADSAFE,    &WorldSession::HandleCancelChanneling          },
     /*0x13C*/ { "SMSG_AI_REACTION",                 STATUS_NEVER,       PROCESS_INPLACE, &WorldSession::Handle_ServerSide               },
     /*0x13D*/ { "CMSG_SET_SELECTION",               STATUS_LOGGEDIN,    PROCESS_INPLACE,  &WorldSession::HandleSetSelectionOpcode        },
-    /*0x13E*/ { "CMSG_SET_TARGET_OBSOLETE",         STATUS_LOGGEDIN,    PROCESS_THREADUNSAFE,  &WorldSession::HandleSetTargetOpcode           },
+    /*0x13E*/ { "CMSG_SET_TARGET_OBSOLETE",         STATUS_LOGGEDIN,    PROCESS_THREADSAFE,    &WorldSession::HandleSetTargetOpcode           },
     /*0x13F*/ { "CMSG_UNUSED",                      STATUS_NEVER,       PROCESS_INPLACE, &WorldSession::Handle_NULL                     },
     /*0x140*/ { "CMSG_UNUSED2",                     STATUS_NEVER,       PROCESS_INPLACE, &WorldSession::Handle_NULL                     },
     /*0x141*/ { "CMSG_ATTACKSWING",                 STATUS_LOGGEDIN,    PROCESS_INPLACE,  &WorldSession::HandleAttackSwingOpcode         },
@@ -647,9 +647,9 @@ OpcodeHandler opcodeTable[NUM_MSG_TYPES] =
     /*0x268*/ { "CMSG_SET_AMMO",                    STATUS_LOGGEDIN,    PROCESS_THREADUNSAFE,  &WorldSession::HandleSetAmmoOpcode             },
     /*0x269*/ { "SMSG_CORPSE_RECLAIM_DELAY",        STATUS_NEVER,       PROCESS_INPLACE, &WorldSession::Handle_ServerSide               },
     /*0x26A*/ { "CMSG_SET_ACTIVE_MOVER",            STATUS_LOGGEDIN,    PROCESS_THREADUNSAFE,  &WorldSession::HandleSetActiveMoverOpcode      },
-    /*0x26B*/ { "CMSG_PET_CANCEL_AURA",             STATUS_LOGGEDIN,    PROCESS_THREADUNSAFE,  &WorldSession::HandlePetCancelAuraOpcode       },
+    /*0x26B*/ { "CMSG_PET_CANCEL_AURA",             STATUS_LOGGEDIN,    PROCESS_THREADSAFE,    &WorldSession::HandlePetCancelAuraOpcode       },
     /*0x26C*/ { "CMSG_PLAYER_AI_CHEAT",             STATUS_NEVER,       PROCESS_INPLACE, &WorldSession::Handle_NULL                     },
-    /*0x26D*/ { "CMSG_CANCEL_AUTO_REPEAT_SPELL",    STATUS_LOGGEDIN,    PROCESS_THREADUNSAFE,  &WorldSession::HandleCancelAutoRepeatSpellOpcode},
+    /*0x26D*/ { "CMSG_CANCEL_AUTO_REPEAT_SPELL",    STATUS_LOGGEDIN,    PROCESS_THREADSAFE,    &WorldSession::HandleCancelAutoRepeatSpellOpcode},
     /*0x26E*/ { "MSG_GM_ACCOUNT_ONLINE",            STATUS_NEVER,       PROCESS_INPLACE, &WorldSession::Handle_NULL                     },
     /*0x26F*/ { "MSG_LIST_STABLED_PETS",            STATUS_LOGGEDIN,    PROCESS_THREADUNSAFE,  &WorldSession::HandleListStabledPetsOpcode     },
     /*0x270*/ { "CMSG_STABLE_PET",                  STATUS_LOGGEDIN,    PROCESS_THREADUNSAFE,  &WorldSession::HandleStablePet                 },
@@ -725,8 +725,8 @@ OpcodeHandler opcodeTable[NUM_MSG_TYPES] =
     /*0x2B6*/ { "SMSG_SCRIPT_MESSAGE",              STATUS_NEVER,       PROCESS_INPLACE, &WorldSession::Handle_ServerSide               },
     /*0x2B7*/ { "SMSG_DUEL_COUNTDOWN",              STATUS_NEVER,       PROCESS_INPLACE, &WorldSession::Handle_ServerSide               },
     /*0x2B8*/ { "SMSG_AREA_TRIGGER_MESSAGE",        STATUS_NEVER,       PROCESS_INPLACE, &WorldSession::Handle_ServerSide               },
-    /*0x2B9*/ { "CMSG_TOGGLE_HELM",                 STATUS_LOGGEDIN,    PROCESS_THREADUNSAFE,  &WorldSession::HandleToggleHelmOpcode          },
-    /*0x2BA*/ { "CMSG_TOGGLE_CLOAK",                STATUS_LOGGEDIN,    PROCESS_THREADUNSAFE,  &WorldSession::HandleToggleCloakOpcode         },
+    /*0x2B9*/ { "CMSG_TOGGLE_HELM",                 STATUS_LOGGEDIN,    PROCESS_THREADSAFE,    &WorldSession::HandleToggleHelmOpcode          },
+    /*0x2BA*/ { "CMSG_TOGGLE_CLOAK",                STATUS_LOGGEDIN,    PROCESS_THREADSAFE,    &WorldSession::HandleToggleCloakOpcode         },
     /*0x2BB*/ { "SMSG_MEETINGSTONE_JOINFAILED",     STATUS_NEVER,       PROCESS_INPLACE, &WorldSession::Handle_ServerSide               },
     /*0x2BC*/ { "SMSG_PLAYER_SKINNED",              STATUS_NEVER,       PROCESS_INPLACE, &WorldSession::Handle_ServerSide               },
     /*0x2BD*/ { "SMSG_DURABILITY_DAMAGE_DEATH",     STATUS_NEVER,       PROCESS_INPLACE, &WorldSession::Handle_ServerSide               },
@@ -81,6 +81,8 @@ Pet::Pet(PetType type) : Creature()
 
     m_spells.clear();
     m_Auras.clear();
+    m_procAuras.clear();
+    m_procAurasFlags = 0;
     m_CreatureSpellCooldowns.clear();
     m_CreatureCategoryCooldowns.clear();
     m_autospells.clear();
@@ -1382,9 +1384,7 @@ void Pet::_SaveSpells()
 
 void Pet::_LoadAuras(uint32 timediff)
 {
-    m_Auras.clear();
-    for (int i = 0; i < TOTAL_AURAS; i++)
-        m_modAuras[i].clear();
+    _ClearAuraLists();
 
     // all aura related fields
     for (int i = UNIT_FIELD_AURA; i <= UNIT_FIELD_AURASTATE; ++i)
@@ -334,6 +334,7 @@ Player::Player (WorldSession *session): Unit(), m_reputationMgr(this), m_camera(
     // group is initialized in the reference constructor
     SetGroupInvite(NULL);
     m_groupUpdateMask = 0;
+    m_groupUpdateTimer = 0;
     m_auraUpdateMask = 0;
 
     duel = NULL;
@@ -419,6 +420,7 @@ Player::Player (WorldSession *session): Unit(), m_reputationMgr(this), m_camera(
     m_mailsUpdated = false;
     unReadMails = 0;
     m_nextMailDelivereTime = 0;
+    m_expiredMailsTimer = EXPIRED_MAILS_CHECK_INTERVAL;
 
     m_resetTalentsCost = 0;
     m_resetTalentsTime = 0;
@@ -1215,6 +1217,15 @@ void Player::Update(uint32 update_diff, uint32 p_time)
         m_nextMailDelivereTime = 0;
     }
 
+    // queue is filled only by periodic old mails pass, no need to take its lock every update
+    if (m_expiredMailsTimer <= update_diff)
+    {
+        ReturnOrDeleteExpiredMails();
+        m_expiredMailsTimer = EXPIRED_MAILS_CHECK_INTERVAL;
+    }
+    else
+        m_expiredMailsTimer -= update_diff;
+
     Unit::Update(update_diff, p_time);
 
     time_t now = time(NULL);
@@ -1459,8 +1470,14 @@ void Player::Update(uint32 update_diff, uint32 p_time)
     UpdateEnchantTime(update_diff);
     UpdateHomebindTime(update_diff);
 
-    // group update
-    SendUpdateToOutOfRangeGroupMembers();
+    // group update, changes are collected in update mask and sent to out of range members at most once per interval
+    if (m_groupUpdateTimer <= update_diff)
+    {
+        SendUpdateToOutOfRangeGroupMembers();
+        m_groupUpdateTimer = sWorld.getConfig(CONFIG_GROUP_MEMBER_STATS_INTERVAL);
+    }
+    else
+        m_groupUpdateTimer -= update_diff;
 
     UpdateConsecutiveKills();
 
@@ -2860,6 +2877,65 @@ void Player::RemoveMail(uint32 id)
     }
 }
 
+void Player::ReturnOrDeleteExpiredMails()
+{
+    time_t now = time(NULL);
+
+    uint32 mailId;
+    while (m_expiredMails.next(mailId))
+    {
+        Mail* m = GetMail(mailId);
+
+        // already deleted, returned or taken in meantime
+        if (!m || m->state == MAIL_STATE_DELETED || m->expire_time > now)
+            continue;
+
+        // same rules as for offline receivers in ObjectMgr::ReturnOrDeleteOldMails
+        if (m->HasItems() && IsExpiredMailReturned(m->messageType, m->checked, m->stationery))
+        {
+            RealmDataDatabase.BeginTransaction();
+            RealmDataDatabase.PExecute("DELETE FROM mail WHERE id = '%u'", mailId);
+            RealmDataDatabase.PExecute("DELETE FROM mail_items WHERE mail_id = '%u'", mailId);
+            RealmDataDatabase.CommitTransaction();
+            RemoveMail(mailId);
+
+            MailDraft* draft = new MailDraft;
+            if (m->mailTemplateId)
+                draft->SetMailTemplate(m->mailTemplateId, false);// items already included
+            else
+                draft->SetSubjectAndBodyId(m->subject, m->itemTextId);
+
+            for (MailItemInfoVec::iterator itr = m->items.begin(); itr != m->items.end(); ++itr)
+            {
+                if (Item *item = GetMItem(itr->item_guid))
+                    draft->AddItem(item);
+
+                RemoveMItem(itr->item_guid);
+            }
+
+            // sent after map update, sender may be online on other map
+            draft->SetMoney(m->money);
+            sWorld.QueueMailReturn(draft, GetSession()->GetAccountId(), m->receiverGuid, ObjectGuid(HIGHGUID_PLAYER, m->sender));
+            delete m;
+        }
+        else
+        {
+            // item_instance rows are deleted at _SaveMail
+            for (MailItemInfoVec::iterator itr = m->items.begin(); itr != m->items.end(); ++itr)
+            {
+                if (Item *item = GetMItem(itr->item_guid))
+                {
+                    RemoveMItem(itr->item_guid);
+                    delete item;
+                }
+            }
+
+            m->state = MAIL_STATE_DELETED;
+            m_mailsUpdated = true;
+        }
+    }
+}
+
 void Player::SendMailResult(uint32 mailId, uint32 mailAction, uint32 mailError, uint32 equipError, uint32 item_guid, uint32 item_count)
 {
     WorldPacket data(SMSG_SEND_MAIL_RESULT, (4+4+4+(mailError == MAIL_ERR_EQUIP_ERROR?4:(mailAction == MAIL_ITEM_TAKEN?4+4:0))));
@@ -7848,6 +7924,8 @@ void Player::SendLoot(uint64 guid, LootType loot_type)
             if (!creature->lootForBody)
             {
                 creature->lootForBody = true;
+                loot->FillPendingLoot(recipient);
+
                 if (Group* group = recipient->GetGroup())
                 {
                     group->PrepareLootRolls(recipient->GetGUID(), loot, creature);
@@ -15259,9 +15337,7 @@ void Player::_LoadActions(QueryResultAutoPtr result)
 
 void Player::_LoadAuras(QueryResultAutoPtr result, uint32 timediff)
 {
-    m_Auras.clear();
-    for (int i = 0; i < TOTAL_AURAS; i++)
-        m_modAuras[i].clear();
+    _ClearAuraLists();
 
     // all aura related fields
     for (int i = UNIT_FIELD_AURA; i <= UNIT_FIELD_AURASTATE; ++i)
@@ -62,6 +62,9 @@ typedef std::deque<Mail*> PlayerMails;
 
 #define PLAYER_MAX_SKILLS       127
 
+// how often player checks mails queued by ObjectMgr::ReturnOrDeleteOldMails
+#define EXPIRED_MAILS_CHECK_INTERVAL (10*IN_MILISECONDS)
+
 enum AnticheatChecks
 {
     ANTICHEAT_CHECK_FLYHACK,
@@ -1448,12 +1451,17 @@ class HELLGROUND_EXPORT Player : public Unit
         PlayerMails::iterator GetmailBegin() { return m_mail.begin();};
         PlayerMails::iterator GetmailEnd() { return m_mail.end();};
 
+        // called by old mails pass from world thread, mails are returned or deleted by Player::Update within EXPIRED_MAILS_CHECK_INTERVAL
+        void QueueExpiredMail(uint32 mailId) { m_expiredMails.add(mailId); }
+        void ReturnOrDeleteExpiredMails();
+
         /*********************************************************/
         /***               MAILED ITEMS SYSTEM                 ***/
         /*********************************************************/
 
         uint8 unReadMails;
         time_t m_nextMailDelivereTime;
+        uint32 m_expiredMailsTimer;
 
         typedef UNORDERED_MAP<uint32, Item*> ItemMap;
 
@@ -2407,6 +2415,7 @@ class HELLGROUND_EXPORT Player : public Unit
         uint32 m_ArenaTeamIdInvited;
 
         PlayerMails m_mail;
+        ACE_Based::LockedQueue<uint32, ACE_Thread_Mutex> m_expiredMails;
         PlayerSpellMap m_spells;
         SpellCooldowns m_spellCooldowns;
 
@@ -2492,6 +2501,7 @@ class HELLGROUND_EXPORT Player : public Unit
 
         Group *m_groupInvite;
         uint32 m_groupUpdateMask;
+        uint32 m_groupUpdateTimer;
         uint64 m_auraUpdateMask;
 
         uint64 m_miniPet;
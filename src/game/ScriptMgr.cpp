@@ -1079,6 +1079,21 @@ uint32 ScriptMgr::GetScriptId(const char *name)
     return itr - m_scriptNames.begin();
 }
 
+// script ids depend on whole sorted name list, used to key cached template snapshots
+uint32 ScriptMgr::GetScriptNamesHash() const
+{
+    uint32 hash = 2166136261u;                              // FNV-1a
+    for (ScriptNameMap::const_iterator itr = m_scriptNames.begin(); itr != m_scriptNames.end(); ++itr)
+    {
+        for (std::string::const_iterator c = itr->begin(); c != itr->end(); ++c)
+            hash = (hash ^ uint8(*c)) * 16777619u;
+
+        hash *= 16777619u;                                  // name separator
+    }
+
+    return hash;
+}
+
 uint32 ScriptMgr::GetAreaTriggerScriptId(uint32 trigger_id) const
 {
     AreaTriggerScriptMap::const_iterator i = m_AreaTriggerScripts.find(trigger_id);
@@ -101,6 +101,7 @@ class ScriptMgr
         ScriptNameMap &GetScriptNames() { return m_scriptNames; }
         const char * GetScriptName(uint32 id) { return id < m_scriptNames.size() ? m_scriptNames[id].c_str() : ""; }
         uint32 GetScriptId(const char *name);
+        uint32 GetScriptNamesHash() const;
 
         bool LoadScriptLibrary(const char* libName);
         void UnloadScriptLibrary();
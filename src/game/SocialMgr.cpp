@@ -82,6 +82,9 @@ bool PlayerSocial::AddToSocialList(uint32 friend_guid, bool ignore)
         fi.Flags |= flag;
         m_playerSocialMap[friend_guid] = fi;
     }
+
+    if (!ignore)
+        sSocialMgr.AddFriendLister(friend_guid, GetPlayerGUID());
     return true;
 }
 
@@ -94,6 +97,8 @@ void PlayerSocial::RemoveFromSocialList(uint32 friend_guid, bool ignore)
     uint32 flag = SOCIAL_FLAG_FRIEND;
     if (ignore)
         flag = SOCIAL_FLAG_IGNORED;
+    else
+        sSocialMgr.RemoveFriendLister(friend_guid, GetPlayerGUID());
 
     itr->second.Flags &= ~flag;
     if (itr->second.Flags == 0)
@@ -185,7 +190,32 @@ void SocialMgr::RemovePlayerSocial(uint32 guid)
 {
     SocialMap::iterator itr = m_socialMap.find(guid);
     if (itr != m_socialMap.end())
+    {
+        PlayerSocialMap const& socials = itr->second.m_playerSocialMap;
+        for (PlayerSocialMap::const_iterator itr2 = socials.begin(); itr2 != socials.end(); ++itr2)
+            if (itr2->second.Flags & SOCIAL_FLAG_FRIEND)
+                RemoveFriendLister(itr2->first, guid);
+
         m_socialMap.erase(itr);
+    }
+}
+
+void SocialMgr::AddFriendLister(uint32 friend_guid, uint32 lister_guid)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_friendListersLock);
+    m_friendListers[friend_guid].insert(lister_guid);
+}
+
+void SocialMgr::RemoveFriendLister(uint32 friend_guid, uint32 lister_guid)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_friendListersLock);
+    FriendListersMap::iterator itr = m_friendListers.find(friend_guid);
+    if (itr == m_friendListers.end())
+        return;
+
+    itr->second.erase(lister_guid);
+    if (itr->second.empty())
+        m_friendListers.erase(itr);
 }
 
 void SocialMgr::GetFriendInfo(Player *player, uint32 friendGUID, FriendInfo &friendInfo)
@@ -284,22 +314,29 @@ void SocialMgr::BroadcastToFriendListers(Player *player, WorldPacket *packet)
     bool gmInWhoList = sWorld.getConfig(CONFIG_GM_IN_WHO_LIST);
     bool allowTwoSideWhoList = sWorld.getConfig(CONFIG_ALLOW_TWO_SIDE_WHO_LIST);
 
-    for (SocialMap::iterator itr = m_socialMap.begin(); itr != m_socialMap.end(); ++itr)
+    // only players having us on friend list, copied so packets aren't sent under lock
+    std::vector<uint32> listers;
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_friendListersLock);
+        FriendListersMap::const_iterator itr = m_friendListers.find(guid);
+        if (itr == m_friendListers.end())
+            return;
+
+        listers.assign(itr->second.begin(), itr->second.end());
+    }
+
+    for (std::vector<uint32>::const_iterator itr = listers.begin(); itr != listers.end(); ++itr)
     {
-        PlayerSocialMap::const_iterator itr2 = itr->second.m_playerSocialMap.find(guid);
-        if (itr2 != itr->second.m_playerSocialMap.end() && (itr2->second.Flags & SOCIAL_FLAG_FRIEND))
+        Player *pFriend = ObjectAccessor::FindPlayer(MAKE_NEW_GUID(*itr, 0, HIGHGUID_PLAYER));
+
+        // PLAYER see his team only and PLAYER can't see MODERATOR, GAME MASTER, ADMINISTRATOR characters
+        // MODERATOR, GAME MASTER, ADMINISTRATOR can see all
+        if (pFriend && pFriend->IsInWorld() &&
+            (pFriend->GetSession()->HasPermissions(PERM_GMT_HDEV) ||
+            (pFriend->GetTeam() == team || allowTwoSideWhoList) &&
+            (!player->GetSession()->HasPermissions(PERM_GMT) || gmInWhoList && player->IsVisibleGloballyfor (pFriend))))
         {
-            Player *pFriend = ObjectAccessor::FindPlayer(MAKE_NEW_GUID(itr->first, 0, HIGHGUID_PLAYER));
-
-            // PLAYER see his team only and PLAYER can't see MODERATOR, GAME MASTER, ADMINISTRATOR characters
-            // MODERATOR, GAME MASTER, ADMINISTRATOR can see all
-            if (pFriend && pFriend->IsInWorld() &&
-                (pFriend->GetSession()->HasPermissions(PERM_GMT_HDEV) ||
-                (pFriend->GetTeam() == team || allowTwoSideWhoList) &&
-                (!player->GetSession()->HasPermissions(PERM_GMT) || gmInWhoList && player->IsVisibleGloballyfor (pFriend))))
-            {
-                pFriend->SendPacketToSelf(packet);
-            }
+            pFriend->SendPacketToSelf(packet);
         }
     }
 }
@@ -309,6 +346,12 @@ PlayerSocial *SocialMgr::LoadFromDB(QueryResultAutoPtr result, uint32 guid)
     PlayerSocial *social = &m_socialMap[guid];
     social->SetPlayerGUID(guid);
 
+    // relogin before old social was removed, its friends must not stay in reverse index
+    for (PlayerSocialMap::const_iterator itr = social->m_playerSocialMap.begin(); itr != social->m_playerSocialMap.end(); ++itr)
+        if (itr->second.Flags & SOCIAL_FLAG_FRIEND)
+            RemoveFriendLister(itr->first, guid);
+    social->m_playerSocialMap.clear();
+
     if (!result)
         return social;
 
@@ -325,6 +368,8 @@ PlayerSocial *SocialMgr::LoadFromDB(QueryResultAutoPtr result, uint32 guid)
         note = fields[2].GetCppString();
 
         social->m_playerSocialMap[friend_guid] = FriendInfo(flags, note);
+        if (flags & SOCIAL_FLAG_FRIEND)
+            AddFriendLister(friend_guid, guid);
 
         // client limit
         if (social->m_playerSocialMap.size() >= (SOCIALMGR_FRIEND_LIMIT + SOCIALMGR_IGNORE_LIMIT))
@@ -22,6 +22,7 @@
 #define HELLGROUND_SOCIALMGR_H
 
 #include "ace/Singleton.h"
+#include "ace/Thread_Mutex.h"
 
 #include "Database/DatabaseEnv.h"
 #include "Common.h"
@@ -79,6 +80,8 @@ struct FriendInfo
 
 typedef std::map<uint32, FriendInfo> PlayerSocialMap;
 typedef std::map<uint32, PlayerSocial> SocialMap;
+typedef std::set<uint32> FriendListerSet;
+typedef UNORDERED_MAP<uint32, FriendListerSet> FriendListersMap;
 
 /// Results of friend related commands
 enum FriendsResult
@@ -154,10 +157,16 @@ class SocialMgr
         void BroadcastToFriendListers(Player *player, WorldPacket *packet);
         // Loading
         PlayerSocial *LoadFromDB(QueryResultAutoPtr result, uint32 guid);
+        // Reverse friend index, friend guid -> loaded players having him on friend list
+        void AddFriendLister(uint32 friend_guid, uint32 lister_guid);
+        void RemoveFriendLister(uint32 friend_guid, uint32 lister_guid);
 
         std::list<uint64> canWhisperToGMList;
     private:
         SocialMap m_socialMap;
+
+        FriendListersMap m_friendListers;
+        ACE_Thread_Mutex m_friendListersLock;               // broadcasts come also from map threads
 };
 
 #define sSocialMgr (*ACE_Singleton<SocialMgr, ACE_Null_Mutex>::instance())
@@ -325,7 +325,7 @@ m_timeCla(1000), m_castItemGuid(castItem?castItem->GetGUID():0), m_auraSlot(MAX_
 m_positive(false), m_permanent(false), m_isPeriodic(false), m_isAreaAura(false),
 m_isPersistent(false), m_removeMode(AURA_REMOVE_BY_DEFAULT), m_isRemovedOnShapeLost(true), m_in_use(false),
 m_periodicTimer(0), m_amplitude(0), m_PeriodicEventId(0), m_AuraDRGroup(DIMINISHING_NONE), m_heartbeatTimer(0)
-,m_tickNumber(0)
+,m_tickNumber(0), m_updateSlot(AURA_UPDATE_NONE)
 {
     ASSERT(target);
 
@@ -543,6 +543,38 @@ void Aura::SetModifier(AuraType t, int32 a, uint32 pt, int32 miscValue)
     m_modifier.periodictime = pt;
 }
 
+void Aura::SetAuraDuration(int32 duration)
+{
+    m_duration = duration;
+    if (duration<0)
+        m_permanent=true;
+    else
+        m_permanent=false;
+
+    // new duration has to be counted down or expired
+    if (m_target)
+        m_target->WakeAuraUpdate(this);
+}
+
+void Aura::SetLoadedState(uint64 caster_guid,int32 damage,int32 maxduration,int32 duration,int32 charges)
+{
+    m_caster_guid = caster_guid;
+    m_modifier.m_amount = damage;
+    m_maxduration = maxduration;
+    m_duration = duration;
+    m_procCharges = charges;
+
+    if (m_target)
+        m_target->WakeAuraUpdate(this);
+}
+
+bool Aura::NeedsUpdate() const
+{
+    // everything Update() does depends on these, IsExpired() auras wait for removal in Unit::_UpdateSpells
+    return m_duration > 0 || IsExpired() || m_isPeriodic || m_heartbeatTimer || GetId() == 37284 ||
+        SpellMgr::IsChanneledSpell(m_spellProto);
+}
+
 void Aura::Update(uint32 diff)
 {
     if (!m_target)
@@ -893,6 +925,10 @@ void Aura::ApplyModifier(bool apply, bool Real)
     if (aura<TOTAL_AURAS)
         (*this.*AuraHandler [aura])(apply,Real);
     m_in_use = false;
+
+    // handlers start periodic effects
+    if (m_target)
+        m_target->WakeAuraUpdate(this);
 }
 
 void Aura::UpdateAuraDuration()
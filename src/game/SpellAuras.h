@@ -55,6 +55,13 @@ struct SpellEntry;
 struct SpellModifier;
 struct ProcTriggerSpell;
 
+// Aura::m_updateSlot values besides index in Unit::m_updateAuras
+enum AuraUpdateSlot
+{
+    AURA_UPDATE_NONE    = -1,                               // not added to target yet or already removed
+    AURA_UPDATE_PARKED  = -2                                // Update() has nothing to do, woken by state changes
+};
+
 // forward decl
 class Aura;
 
@@ -245,14 +252,7 @@ class HELLGROUND_IMPORT_EXPORT Aura
         int32 GetAuraMaxDuration() const { return m_maxduration; }
         void SetAuraMaxDuration(int32 duration) { m_maxduration = duration; }
         int32 GetAuraDuration() const { return m_duration; }
-        void SetAuraDuration(int32 duration)
-        {
-            m_duration = duration;
-            if (duration<0)
-                m_permanent=true;
-            else
-                m_permanent=false;
-        }
+        void SetAuraDuration(int32 duration);
         time_t GetAuraApplyTime() { return m_applyTime; }
 
         bool IsExpired() const { return !GetAuraDuration() && !(IsPermanent() || IsPassive()); }
@@ -265,14 +265,7 @@ class HELLGROUND_IMPORT_EXPORT Aura
         Unit* GetCaster() const;
         Unit* GetTarget() const { return m_target ? m_target : NULL; }
         void SetTarget(Unit* target) { m_target = target; }
-        void SetLoadedState(uint64 caster_guid,int32 damage,int32 maxduration,int32 duration,int32 charges)
-        {
-            m_caster_guid = caster_guid;
-            m_modifier.m_amount = damage;
-            m_maxduration = maxduration;
-            m_duration = duration;
-            m_procCharges = charges;
-        }
+        void SetLoadedState(uint64 caster_guid,int32 damage,int32 maxduration,int32 duration,int32 charges);
 
         uint8 GetAuraSlot() const { return m_auraSlot; }
         void SetAuraSlot(uint8 slot) { m_auraSlot = slot; }
@@ -333,8 +326,14 @@ class HELLGROUND_IMPORT_EXPORT Aura
         bool isWeaponBuffCoexistableWith(Aura *ref);
 
         virtual void Update(uint32 diff);
+        // false when Update() would do nothing until duration, periodic state or modifier changes
+        virtual bool NeedsUpdate() const;
         void ApplyModifier(bool apply, bool Real = false);
 
+        // index in target's aura update list or AuraUpdateSlot state, managed by Unit
+        int32 GetUpdateSlot() const { return m_updateSlot; }
+        void SetUpdateSlot(int32 slot) { m_updateSlot = slot; }
+
         void _AddAura();
         void _RemoveAura();
 
@@ -411,6 +410,7 @@ class HELLGROUND_IMPORT_EXPORT Aura
         CasterModifiers m_casterModifiers;
 
         int32 m_stackAmount;
+        int32 m_updateSlot;
     private:
         void SetAura(uint32 slot, bool remove) { m_target->SetUInt32Value(UNIT_FIELD_AURA + slot, remove ? 0 : GetId()); }
         void SetAuraFlag(uint32 slot, bool add);
@@ -424,6 +424,7 @@ class HELLGROUND_IMPORT_EXPORT AreaAura : public Aura
         AreaAura(SpellEntry const* spellproto, uint32 eff, int32 *currentBasePoints, Unit *target, Unit *caster = NULL, Item* castItem = NULL);
         ~AreaAura();
         void Update(uint32 diff);
+        bool NeedsUpdate() const { return true; }
         bool CheckTarget(Unit *target);
     private:
         float m_radius;
@@ -436,6 +437,7 @@ class HELLGROUND_IMPORT_EXPORT PersistentAreaAura : public Aura
         PersistentAreaAura(SpellEntry const* spellproto, uint32 eff, int32 *currentBasePoints, Unit *target, Unit *caster = NULL, Item* castItem = NULL, uint64 dynObjGUID = 0);
         ~PersistentAreaAura();
         void Update(uint32 diff);
+        bool NeedsUpdate() const { return true; }
 
     private:
         uint64 m_dynamicObjectGUID;
@@ -36,6 +36,9 @@
 template<class T, typename D>
 void TargetedMovementGeneratorMedium<T,D>::_setTargetLocation(T &owner)
 {
+    bool wasPending = _pathPending;
+    _pathPending = false;
+
     if (!_target.isValid() || !_target->IsInWorld())
         return;
 
@@ -83,6 +86,21 @@ void TargetedMovementGeneratorMedium<T,D>::_setTargetLocation(T &owner)
     if (!_path)
         _path = new PathFinder(&owner);
 
+    // too many paths were calculated on this map in this update, go straight for now
+    // and calculate real path on next update, from positions valid at that time
+    if (!owner.GetMap()->TakeChasePathBudget(wasPending))
+    {
+        _pathPending = true;
+        _targetReached = false;
+        static_cast<MovementGenerator*>(this)->_recalculateTravel = false;
+
+        Movement::MoveSplineInit init(owner);
+        init.MoveTo(x, y, z);
+        init.SetWalk(((D*)this)->EnableWalking(owner));
+        init.Launch();
+        return;
+    }
+
     // allow pets following their master to cheat while generating paths
     bool forceDest = (owner.GetObjectGuid().IsPet() && owner.hasUnitState(UNIT_STAT_FOLLOW));
     bool result = _path->calculate(x, y, z, forceDest);
@@ -137,6 +155,9 @@ bool TargetedMovementGeneratorMedium<T,D>::Update(T &owner, const uint32 & time_
     if (static_cast<D*>(this)->_lostTarget(owner))
         return true;
 
+    if (_pathPending)
+        _setTargetLocation(owner);
+
     _recheckDistance.Update(time_diff);
     if (_recheckDistance.Passed())
     {
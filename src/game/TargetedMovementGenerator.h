@@ -46,7 +46,7 @@ class TargetedMovementGeneratorMedium
     protected:
         TargetedMovementGeneratorMedium(Unit &target, float offset, float angle) :
             TargetedMovementGeneratorBase(target), _offset(offset), _angle(angle),
-            _targetReached(false), _recheckDistance(0),
+            _targetReached(false), _pathPending(false), _recheckDistance(0),
             _path(NULL)
         {
         }
@@ -71,6 +71,7 @@ class TargetedMovementGeneratorMedium
         float _offset;
         float _angle;
         bool _targetReached : 1;
+        bool _pathPending : 1;                              // moving straight, path was over map budget
 
         PathFinder* _path;
 };
@@ -61,6 +61,9 @@ HostileReference::HostileReference(Unit* pUnit, ThreatManager *pThreatManager, f
     iUnitGuid = pUnit->GetGUID();
     iOnline = true;
     iAccessible = true;
+    iHeapIndex = -1;
+    iSequence = 0;
+    iSelectionIndex = -1;
 }
 
 //============================================================
@@ -209,33 +212,190 @@ Unit* HostileReference::getSourceUnit()
 
 void ThreatContainer::clearReferences()
 {
-    for (std::list<HostileReference*>::iterator i = iThreatList.begin(); i != iThreatList.end(); ++i)
+    clearSelectionOrder();
+    for (ThreatHeap::iterator i = iThreatHeap.begin(); i != iThreatHeap.end(); ++i)
     {
         (*i)->unlink();
         delete (*i);
     }
+    iThreatHeap.clear();
+    iThreatIndex.clear();
     iThreatList.clear();
+    ++iVersion;
 }
 
 //============================================================
-// Return the HostileReference of NULL, if not found
-HostileReference* ThreatContainer::getReferenceByTarget(Unit* pVictim)
+// Higher threat first, on equal threat the older reference
+
+bool ThreatContainer::HostileReferenceSortPredicate(const HostileReference* lhs, const HostileReference* rhs)
 {
-    HostileReference* result = NULL;
-    if (!pVictim)
-        return NULL;
+    // std::list::sort ordering predicate must be: (Pred(x,y)&&Pred(y,x))==false
+    if (lhs->getThreat() != rhs->getThreat())
+        return lhs->getThreat() > rhs->getThreat();         // reverse sorting
 
-    uint64 guid = pVictim->GetGUID();
-    for (std::list<HostileReference*>::iterator i = iThreatList.begin(); i != iThreatList.end(); ++i)
+    return lhs->iSequence < rhs->iSequence;
+}
+
+void ThreatContainer::place(HostileReference* pRef, uint32 pIndex)
+{
+    iThreatHeap[pIndex] = pRef;
+    pRef->iHeapIndex = pIndex;
+}
+
+bool ThreatContainer::siftUp(uint32 pIndex)
+{
+    HostileReference* ref = iThreatHeap[pIndex];
+    uint32 start = pIndex;
+    while (pIndex > 0)
     {
-        if ((*i)->getUnitGuid() == guid)
-        {
-            result = (*i);
+        uint32 parent = (pIndex - 1) / 2;
+        if (!HostileReferenceSortPredicate(ref, iThreatHeap[parent]))
             break;
-        }
+
+        place(iThreatHeap[parent], pIndex);
+        pIndex = parent;
+    }
+    place(ref, pIndex);
+    return pIndex != start;
+}
+
+void ThreatContainer::siftDown(uint32 pIndex)
+{
+    HostileReference* ref = iThreatHeap[pIndex];
+    uint32 size = iThreatHeap.size();
+    for (;;)
+    {
+        uint32 child = 2 * pIndex + 1;
+        if (child >= size)
+            break;
+
+        if (child + 1 < size && HostileReferenceSortPredicate(iThreatHeap[child + 1], iThreatHeap[child]))
+            ++child;
+
+        if (!HostileReferenceSortPredicate(iThreatHeap[child], ref))
+            break;
+
+        place(iThreatHeap[child], pIndex);
+        pIndex = child;
+    }
+    place(ref, pIndex);
+}
+
+//============================================================
+
+void ThreatContainer::remove(HostileReference* pRef)
+{
+    int32 index = pRef->iHeapIndex;
+    if (index < 0 || uint32(index) >= iThreatHeap.size() || iThreatHeap[index] != pRef)
+        return;
+
+    HostileReference* last = iThreatHeap.back();
+    iThreatHeap.pop_back();
+    if (last != pRef)
+    {
+        place(last, index);
+        siftUp(index);
+        siftDown(last->iHeapIndex);
+    }
+    pRef->iHeapIndex = -1;
+
+    iThreatList.remove(pRef);
+    iThreatIndex.erase(pRef->getUnitGuid());
+    clearSelectionOrder();                                  // may be deleted after this
+    ++iVersion;
+}
+
+//============================================================
+
+void ThreatContainer::addReference(HostileReference* pHostileReference)
+{
+    pHostileReference->iSequence = iNextSequence++;
+    iThreatHeap.push_back(pHostileReference);
+    siftUp(iThreatHeap.size() - 1);
+
+    iThreatList.push_back(pHostileReference);
+    iThreatListSorted = false;
+    iThreatIndex[pHostileReference->getUnitGuid()] = pHostileReference;
+    ++iVersion;
+}
+
+//============================================================
+
+void ThreatContainer::threatChanged(HostileReference* pRef, bool pRaised)
+{
+    int32 index = pRef->iHeapIndex;
+    if (index < 0 || uint32(index) >= iThreatHeap.size() || iThreatHeap[index] != pRef)
+        return;
+
+    if (!siftUp(index))
+        siftDown(index);
+
+    iThreatListSorted = false;
+    if (iSelectionVersion == iVersion && !isSelectionOrderKept(pRef, pRaised))
+        ++iVersion;
+}
+
+//============================================================
+
+// true when references visited by last selection are still the highest ones, in the same order
+bool ThreatContainer::isSelectionOrderKept(HostileReference* pRef, bool pRaised) const
+{
+    if (iSelectionOrder.empty())
+        return false;
+
+    if (pRef->iSelectionIndex < 0)
+        return !HostileReferenceSortPredicate(pRef, iSelectionOrder.back());
+
+    ThreatHeap::const_iterator itr = iSelectionOrder.begin() + pRef->iSelectionIndex;
+
+    if (itr != iSelectionOrder.begin() && HostileReferenceSortPredicate(pRef, *(itr - 1)))
+        return false;
+
+    if (itr + 1 == iSelectionOrder.end())
+        return pRaised;                                     // lowered last one may fall below not visited ones
+
+    return !HostileReferenceSortPredicate(*(itr + 1), pRef);
+}
+
+//============================================================
+
+void ThreatContainer::clearSelectionOrder()
+{
+    for (ThreatHeap::iterator itr = iSelectionOrder.begin(); itr != iSelectionOrder.end(); ++itr)
+        (*itr)->iSelectionIndex = -1;
+    iSelectionOrder.clear();
+}
+
+//============================================================
+
+std::list<HostileReference*>& ThreatContainer::getThreatList()
+{
+    // some scripts erase picked references from returned list
+    if (iThreatList.size() != iThreatHeap.size())
+    {
+        iThreatList.assign(iThreatHeap.begin(), iThreatHeap.end());
+        iThreatListSorted = false;
+    }
+
+    // list sort only relinks nodes, so iterators of callers stay valid
+    if (!iThreatListSorted)
+    {
+        iThreatList.sort(HostileReferenceSortPredicate);
+        iThreatListSorted = true;
     }
 
-    return result;
+    return iThreatList;
+}
+
+//============================================================
+// Return the HostileReference of NULL, if not found
+HostileReference* ThreatContainer::getReferenceByTarget(Unit* pVictim)
+{
+    if (!pVictim)
+        return NULL;
+
+    ThreatIndex::const_iterator itr = iThreatIndex.find(pVictim->GetGUID());
+    return itr != iThreatIndex.end() ? itr->second : NULL;
 }
 
 //============================================================
@@ -267,24 +427,6 @@ void ThreatContainer::modifyThreatPercent(Unit *pVictim, int32 pPercent)
 
 //============================================================
 
-bool HostileReferenceSortPredicate(const HostileReference* lhs, const HostileReference* rhs)
-{
-    // std::list::sort ordering predicate must be: (Pred(x,y)&&Pred(y,x))==false
-    return lhs->getThreat() > rhs->getThreat();             // reverse sorting
-}
-
-//============================================================
-// Check if the list is dirty and sort if necessary
-
-void ThreatContainer::update()
-{
-    if (iDirty && iThreatList.size() >1)
-    {
-        iThreatList.sort(HostileReferenceSortPredicate);
-    }
-    iDirty = false;
-}
-
 bool DropAggro(Creature* pAttacker, Unit * target)
 {
     if (!target)
@@ -343,76 +485,133 @@ bool DropAggro(Creature* pAttacker, Unit * target)
 }
 
 //============================================================
-// return the next best victim
-// could be the current victim
+// Next reference in threat order, candidates are heap positions whose parents were already returned.
+// Selection usually ends at first or second reference, so only few candidates are ever compared.
 
-HostileReference* ThreatContainer::selectNextVictim(Creature* pAttacker, HostileReference* pCurrentVictim)
+HostileReference* ThreatContainer::nextInOrder(std::vector<uint32>& pCandidates)
 {
-    HostileReference* currentRef = NULL;
-    bool found = false;
-    bool noPriorityTargetFound = false;
+    if (pCandidates.empty())
+        return NULL;
+
+    std::vector<uint32>::iterator best = pCandidates.begin();
+    for (std::vector<uint32>::iterator itr = best + 1; itr != pCandidates.end(); ++itr)
+        if (HostileReferenceSortPredicate(iThreatHeap[*itr], iThreatHeap[*best]))
+            best = itr;
+
+    uint32 index = *best;
+    *best = pCandidates.back();
+    pCandidates.pop_back();
 
-    std::list<HostileReference*>::iterator lastRef = iThreatList.end();
-    lastRef--;
+    for (uint32 child = 2 * index + 1; child <= 2 * index + 2; ++child)
+        if (child < iThreatHeap.size())
+            pCandidates.push_back(child);
 
-    for (std::list<HostileReference*>::iterator iter = iThreatList.begin(); iter != iThreatList.end() && !found;)
+    return iThreatHeap[index];
+}
+
+//============================================================
+// Check one reference of threat ordered walk, pResult is set when selection ends at it
+
+ThreatContainer::VictimCheck ThreatContainer::checkVictim(Creature* pAttacker, HostileReference* pRef, bool pCheckDropAggro, HostileReference* pCurrentVictim, HostileReference*& pResult)
+{
+    Unit* target = pRef->getTarget();
+    ASSERT(target);                                         // if the ref has status online the target must be there !
+
+    // some units are preferred in comparison to others
+    if (pCheckDropAggro && DropAggro(pAttacker, target))
+        return VICTIM_DROPPED;
+
+    if (pAttacker->IsOutOfThreatArea(target))               // skip non attackable currently targets
+        return VICTIM_PASSED;
+
+    if (!pCurrentVictim)                                    // select any
     {
-        currentRef = (*iter);
+        pResult = pRef;
+        return VICTIM_FOUND;
+    }
 
-        Unit* target = currentRef->getTarget();
-        ASSERT(target);                                     // if the ref has status online the target must be there !
+    // select 1.3/1.1 better target in comparison current target
+    // list sorted and and we check current target, then this is best case
+    if (pCurrentVictim == pRef || pRef->getThreat() <= 1.1f * pCurrentVictim->getThreat())
+    {
+        pResult = pCurrentVictim;
+        return VICTIM_FOUND;
+    }
+
+    if (pRef->getThreat() > 1.3f * pCurrentVictim->getThreat() ||
+        pRef->getThreat() > 1.1f * pCurrentVictim->getThreat() && pAttacker->IsWithinMeleeRange(target))
+    {                                                       //implement 110% threat rule for targets in melee range
+        pResult = pRef;                                     //and 130% rule for targets in ranged distances
+        return VICTIM_FOUND;                                //for selecting alive targets
+    }
+
+    return VICTIM_PASSED;
+}
+
+//============================================================
+// return the next best victim
+// could be the current victim
 
-        // some units are preferred in comparison to others
-        if (!noPriorityTargetFound && DropAggro(pAttacker, target))
+HostileReference* ThreatContainer::selectNextVictim(Creature* pAttacker, HostileReference* pCurrentVictim)
+{
+    HostileReference* result = NULL;
+
+    // while threat changes kept order of references visited last time, walk would visit them first again.
+    // Only they are checked again, because target states and positions used by checks have no events.
+    if (iSelectionVersion == iVersion)
+    {
+        HostileReference* currentVictim = pCurrentVictim;
+        for (ThreatHeap::const_iterator itr = iSelectionOrder.begin(); itr != iSelectionOrder.end(); ++itr)
         {
-            if (iter != lastRef)
-            {
-                // current victim is a second choice target, so don't compare threat with it below
-                if (currentRef == pCurrentVictim)
-                    pCurrentVictim = NULL;
-                ++iter;
-                continue;
-            }
-            else
+            VictimCheck check = checkVictim(pAttacker, *itr, true, currentVictim, result);
+            if (check == VICTIM_FOUND)
+                return result;
+
+            if (check == VICTIM_DROPPED)
             {
-                // if we reached to this point, everyone in the threatlist is a second choice target. In such a situation the target with the highest threat should be attacked.
-                noPriorityTargetFound = true;
-                iter = iThreatList.begin();
-                continue;
+                if (uint32(itr - iSelectionOrder.begin()) + 1 == iThreatHeap.size())
+                    break;                                  // every reference dropped, full walk below handles it
+
+                if (*itr == currentVictim)
+                    currentVictim = NULL;
             }
         }
+    }
+
+    clearSelectionOrder();
+    iSelectionVersion = iVersion;
 
-        if (!pAttacker->IsOutOfThreatArea(target))           // skip non attackable currently targets
+    std::vector<uint32> candidates;
+    if (!iThreatHeap.empty())
+        candidates.push_back(0);
+
+    while (HostileReference* ref = nextInOrder(candidates))
+    {
+        ref->iSelectionIndex = iSelectionOrder.size();
+        iSelectionOrder.push_back(ref);
+
+        VictimCheck check = checkVictim(pAttacker, ref, true, pCurrentVictim, result);
+        if (check == VICTIM_FOUND)
+            return result;
+
+        if (check != VICTIM_DROPPED)
+            continue;
+
+        if (!candidates.empty())
         {
-            if (pCurrentVictim)                              // select 1.3/1.1 better target in comparison current target
-            {
-                // list sorted and and we check current target, then this is best case
-                if (pCurrentVictim == currentRef || currentRef->getThreat() <= 1.1f * pCurrentVictim->getThreat())
-                {
-                    currentRef = pCurrentVictim;            // for second case
-                    found = true;
-                    break;
-                }
-
-                if (currentRef->getThreat() > 1.3f * pCurrentVictim->getThreat() ||
-                    currentRef->getThreat() > 1.1f * pCurrentVictim->getThreat() && pAttacker->IsWithinMeleeRange(target))
-                {                                           //implement 110% threat rule for targets in melee range
-                    found = true;                           //and 130% rule for targets in ranged distances
-                    break;                                  //for selecting alive targets
-                }
-            }
-            else                                            // select any
-            {
-                found = true;
-                break;
-            }
+            // current victim is a second choice target, so don't compare threat with it below
+            if (ref == pCurrentVictim)
+                pCurrentVictim = NULL;
+            continue;
         }
-        ++iter;
+
+        // if we reached to this point, everyone in the threatlist is a second choice target. In such a situation the target with the highest threat should be attacked.
+        for (ThreatHeap::const_iterator itr = iSelectionOrder.begin(); itr != iSelectionOrder.end(); ++itr)
+            if (checkVictim(pAttacker, *itr, false, pCurrentVictim, result) == VICTIM_FOUND)
+                return result;
     }
-    if (!found)
-        currentRef = NULL;
 
-    return currentRef;
+    return NULL;
 }
 
 //============================================================
@@ -499,7 +698,6 @@ void ThreatManager::modifyThreatPercent(Unit *pVictim, int32 pPercent)
 
 Unit* ThreatManager::getHostilTarget()
 {
-    iThreatContainer.update();
     HostileReference* nextVictim = iThreatContainer.selectNextVictim((Creature*) getOwner(), getCurrentVictim());
     setCurrentVictim(nextVictim);
     return getCurrentVictim() != NULL ? getCurrentVictim()->getTarget() : NULL;
@@ -563,35 +761,29 @@ void ThreatManager::processThreatEvent(ThreatRefStatusChangeEvent* threatRefStat
     switch(threatRefStatusChangeEvent->getType())
     {
         case UEV_THREAT_REF_THREAT_CHANGE:
-            if ((getCurrentVictim() == hostileRef && threatRefStatusChangeEvent->getFValue()<0.0f) ||
-                (getCurrentVictim() != hostileRef && threatRefStatusChangeEvent->getFValue()>0.0f))
-                setDirty(true);                             // the order in the threat list might have changed
+            // the order in the threat list might have changed
+            if (hostileRef->isOnline())
+                iThreatContainer.threatChanged(hostileRef, threatRefStatusChangeEvent->getFValue() > 0.0f);
+            else
+                iThreatOfflineContainer.threatChanged(hostileRef, threatRefStatusChangeEvent->getFValue() > 0.0f);
             break;
         case UEV_THREAT_REF_ONLINE_STATUS:
             if (!hostileRef->isOnline())
             {
                 if (hostileRef == getCurrentVictim())
-                {
                     setCurrentVictim(NULL);
-                    setDirty(true);
-                }
                 iThreatContainer.remove(hostileRef);
                 iThreatOfflineContainer.addReference(hostileRef);
             }
             else
             {
-                if (getCurrentVictim() && hostileRef->getThreat() > (1.1f * getCurrentVictim()->getThreat()))
-                    setDirty(true);
-                iThreatContainer.addReference(hostileRef);
                 iThreatOfflineContainer.remove(hostileRef);
+                iThreatContainer.addReference(hostileRef);
             }
             break;
         case UEV_THREAT_REF_REMOVE_FROM_LIST:
             if (hostileRef == getCurrentVictim())
-            {
                 setCurrentVictim(NULL);
-                setDirty(true);
-            }
             if (hostileRef ->isOnline())
                 iThreatContainer.remove(hostileRef);
             else
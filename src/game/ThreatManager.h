@@ -27,6 +27,7 @@
 #include "UnitEvents.h"
 
 #include <list>
+#include <vector>
 
 //==============================================================
 
@@ -116,6 +117,8 @@ class HELLGROUND_IMPORT_EXPORT HostileReference : public Reference<Unit, ThreatM
         void sourceObjectDestroyLink();
 
     private:
+        friend class ThreatContainer;
+
         // Inform the source, that the status of that reference was changed
         void fireStatusChanged(ThreatRefStatusChangeEvent& pThreatRefStatusChangeEvent);
 
@@ -127,26 +130,60 @@ class HELLGROUND_IMPORT_EXPORT HostileReference : public Reference<Unit, ThreatM
         uint64 iUnitGuid;
         bool iOnline;
         bool iAccessible;
+        int32 iHeapIndex;                                   // position in ThreatContainer heap, -1 when not in any
+        uint32 iSequence;                                   // insert order, older reference wins on equal threat
+        int32 iSelectionIndex;                              // position in ThreatContainer selection order, -1 when not in it
 };
 
 //==============================================================
 class ThreatManager;
 
+// References are kept in a max-heap by threat, each reference knows its heap position, so a threat
+// change moves it in O(log n). Ordered std::list for scripts is sorted only when they ask for it.
 class HELLGROUND_IMPORT_EXPORT ThreatContainer
 {
     private:
-        std::list<HostileReference*> iThreatList;
-        bool iDirty;
+        typedef UNORDERED_MAP<uint64, HostileReference*> ThreatIndex;
+        typedef std::vector<HostileReference*> ThreatHeap;
+
+        ThreatHeap iThreatHeap;
+        ThreatIndex iThreatIndex;                           // target guid -> reference
+        uint32 iVersion;                                    // changed when threat order may differ from iSelectionOrder
+        uint32 iNextSequence;
+
+        std::list<HostileReference*> iThreatList;           // same references for getThreatList(), sorted on demand
+        bool iThreatListSorted;
+
+        ThreatHeap iSelectionOrder;                         // references visited by last selectNextVictim, in threat order
+        uint32 iSelectionVersion;                           // iVersion of iSelectionOrder
+
+        static bool HostileReferenceSortPredicate(const HostileReference* lhs, const HostileReference* rhs);
+
+        enum VictimCheck
+        {
+            VICTIM_DROPPED,                                 // second choice target
+            VICTIM_PASSED,                                  // can't be attacked now or has not enough threat
+            VICTIM_FOUND
+        };
+
+        HostileReference* nextInOrder(std::vector<uint32>& pCandidates);
+        bool isSelectionOrderKept(HostileReference* pRef, bool pRaised) const;
+        void clearSelectionOrder();
+        VictimCheck checkVictim(Creature* pAttacker, HostileReference* pRef, bool pCheckDropAggro, HostileReference* pCurrentVictim, HostileReference*& pResult);
+
+        void place(HostileReference* pRef, uint32 pIndex);
+        bool siftUp(uint32 pIndex);
+        void siftDown(uint32 pIndex);
     protected:
         friend class ThreatManager;
 
-        void remove(HostileReference* pRef) { iThreatList.remove(pRef); }
-        void addReference(HostileReference* pHostileReference) { iThreatList.push_back(pHostileReference); }
+        void remove(HostileReference* pRef);
+        void addReference(HostileReference* pHostileReference);
         void clearReferences();
-        // Sort the list if necessary
-        void update();
+        // move reference to its new place after its threat was changed
+        void threatChanged(HostileReference* pRef, bool pRaised);
     public:
-        ThreatContainer() { iDirty = false; }
+        ThreatContainer() : iVersion(0), iNextSequence(0), iThreatListSorted(true), iSelectionVersion(0) {}
         ~ThreatContainer() { clearReferences(); }
 
         HostileReference* addThreat(Unit* pVictim, float pThreat);
@@ -155,17 +192,14 @@ class HELLGROUND_IMPORT_EXPORT ThreatContainer
 
         HostileReference* selectNextVictim(Creature* pAttacker, HostileReference* pCurrentVictim);
 
-        void setDirty(bool pDirty) { iDirty = pDirty; }
-
-        bool isDirty() { return iDirty; }
+        bool empty() { return(iThreatHeap.empty()); }
 
-        bool empty() { return(iThreatList.empty()); }
-
-        HostileReference* getMostHated() { return iThreatList.empty() ? NULL : iThreatList.front(); }
+        HostileReference* getMostHated() { return iThreatHeap.empty() ? NULL : iThreatHeap.front(); }
 
         HostileReference* getReferenceByTarget(Unit* pVictim);
 
-        std::list<HostileReference*>& getThreatList() { return iThreatList; }
+        // sorted by threat, callers may erase from it, list is then rebuilt at next call
+        std::list<HostileReference*>& getThreatList();
 };
 
 //=================================================
@@ -201,8 +235,6 @@ class HELLGROUND_IMPORT_EXPORT ThreatManager
 
         void setCurrentVictim(HostileReference* pHostileReference);
 
-        void setDirty(bool pDirty) { iThreatContainer.setDirty(pDirty); }
-
         // methods to access the lists from the outside to do sume dirty manipulation (scriping and such)
         // I hope they are used as little as possible.
         std::list<HostileReference*>& getThreatList() { return iThreatContainer.getThreatList(); }
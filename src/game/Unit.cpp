@@ -263,7 +263,7 @@ Unit::Unit() :
     WorldObject(), i_motionMaster(this), movespline(new Movement::MoveSpline()),
     _threatManager(this), _hostileRefManager(this), m_stateMgr(this),
     IsAIEnabled(false), NeedChangeAI(false), i_AI(NULL), i_disabledAI(NULL),
-    m_procDeep(0), m_AI_locked(false), m_removedAurasCount(0)
+    m_procDeep(0), m_AI_locked(false), m_removedAurasCount(0), m_procAurasFlags(0), m_updateAurasHoles(0)
 {
     m_modAuras = new AuraList[TOTAL_AURAS];
     m_objectType |= TYPEMASK_UNIT;
@@ -296,7 +296,6 @@ Unit::Unit() :
 
     m_ObjectSlot[0] = m_ObjectSlot[1] = m_ObjectSlot[2] = m_ObjectSlot[3] = 0;
 
-    m_AurasUpdateIterator = m_Auras.end();
     m_Visibility = VISIBILITY_ON;
 
     m_interruptMask = 0;
@@ -390,13 +389,8 @@ Unit::~Unit()
     delete movespline;
 
     for (int i = 0; i < TOTAL_AURAS; i++)
-    {
-        while (!m_modAuras[i].empty())
-        {
-            delete m_modAuras[i].front();
-            m_modAuras[i].pop_front();
-        }
-    }
+        for (AuraList::iterator iter = m_modAuras[i].begin(); iter != m_modAuras[i].end(); ++iter)
+            delete *iter;
 
     delete [] m_modAuras;
 
@@ -3236,11 +3230,10 @@ uint32 Unit::GetWeaponSkillValue (WeaponAttackType attType, Unit const* target)
 
 void Unit::_DeleteAuras()
 {
-    while (!m_removedAuras.empty())
-    {
-        delete m_removedAuras.front();
-        m_removedAuras.pop_front();
-    }
+    for (AuraList::iterator iter = m_removedAuras.begin(); iter != m_removedAuras.end(); ++iter)
+        delete *iter;
+
+    m_removedAuras.clear();
 }
 
 void Unit::_UpdateSpells(uint32 time)
@@ -3258,30 +3251,45 @@ void Unit::_UpdateSpells(uint32 time)
         }
     }
 
-    // m_AurasUpdateIterator can be updated in inderect called code at aura remove to skip next planned to update but removed auras
-    AuraMap::iterator eraseIter;
-    for (m_AurasUpdateIterator = m_Auras.begin(); m_AurasUpdateIterator != m_Auras.end();)
+    // removed auras only leave NULL slot, auras added meanwhile are appended and updated since next tick
+    for (size_t i = 0, count = m_updateAuras.size(); i < count; ++i)
     {
-        Aura* i_aura = m_AurasUpdateIterator->second;
-        eraseIter = m_AurasUpdateIterator;
-        ++m_AurasUpdateIterator;                            // need shift to next for allow update if need into aura update
+        Aura* aura = m_updateAuras[i];
+        if (!aura)
+            continue;
 
-        if (i_aura)
-            i_aura->Update(time);
-        else
-            m_Auras.erase(eraseIter);
+        aura->Update(time);
+
+        // permanent auras without periodic effect are parked until something changes their state
+        if (m_updateAuras[i] == aura && !aura->NeedsUpdate())
+        {
+            m_updateAuras[i] = NULL;
+            ++m_updateAurasHoles;
+            aura->SetUpdateSlot(AURA_UPDATE_PARKED);
+        }
     }
 
-    // remove expired auras
-    for (AuraMap::iterator i = m_Auras.begin(); i != m_Auras.end();)
+    // remove expired auras, update of one aura can expire another one, so whole list is checked
+    // including auras woken meanwhile, parked auras can't be expired
+    for (size_t i = 0; i < m_updateAuras.size(); ++i)
     {
-        if (i->second->IsExpired())
-            RemoveAura(i, AURA_REMOVE_BY_EXPIRE);
-        else
-             ++i;
+        Aura* aura = m_updateAuras[i];
+        if (!aura || !aura->IsExpired())
+            continue;
+
+        spellEffectPair spair = spellEffectPair(aura->GetId(), aura->GetEffIndex());
+        for (AuraMap::iterator iter = m_Auras.lower_bound(spair); iter != m_Auras.upper_bound(spair); ++iter)
+        {
+            if (iter->second == aura)
+            {
+                RemoveAura(iter, AURA_REMOVE_BY_EXPIRE);
+                break;
+            }
+        }
     }
 
     _DeleteAuras();
+    _CompactAuraLists();
 
     if (!m_gameObj.empty())
     {
@@ -3944,9 +3952,12 @@ bool Unit::AddAura(Aura *Aur)
     // add aura, register in lists and arrays
     Aur->_AddAura();
     m_Auras.insert(AuraMap::value_type(spellEffectPair(Aur->GetId(), Aur->GetEffIndex()), Aur));
+    Aur->SetUpdateSlot(m_updateAuras.size());
+    m_updateAuras.push_back(Aur);
     if (Aur->GetModifier()->m_auraname < TOTAL_AURAS)
     {
         m_modAuras[Aur->GetModifier()->m_auraname].push_back(Aur);
+        AddProcAura(Aur);
         if (Aur->GetSpellProto()->AuraInterruptFlags)
         {
             m_interruptableAuras.push_back(Aur);
@@ -4507,15 +4518,19 @@ void Unit::RemoveAura(AuraMap::iterator &i, AuraRemoveMode mode)
     if (this->GetTypeId() == TYPEID_UNIT && this->IsAIEnabled)
         ((Creature *)this)->AI()->OnAuraRemove(Aur, false);
 
-    // if unit currently update aura list then make safe update iterator shift to next
-    if (m_AurasUpdateIterator == i)
-        ++m_AurasUpdateIterator;
-
     // some ShapeshiftBoosts at remove trigger removing other auras including parent Shapeshift aura
     // remove aura from list before to prevent deleting it before
     m_Auras.erase(i);
     ++m_removedAurasCount;                                       // internal count used by unit update
 
+    // slot is only cleared, so running update pass continues with next aura
+    if (Aur->GetUpdateSlot() >= 0)
+    {
+        m_updateAuras[Aur->GetUpdateSlot()] = NULL;
+        ++m_updateAurasHoles;
+    }
+    Aur->SetUpdateSlot(AURA_UPDATE_NONE);
+
     SpellEntry const* AurSpellEntry = Aur->GetSpellProto();
     Unit* caster = NULL;
     Aur->UnregisterSingleCastAura();
@@ -4523,7 +4538,8 @@ void Unit::RemoveAura(AuraMap::iterator &i, AuraRemoveMode mode)
     // remove from list before mods removing (prevent cyclic calls, mods added before including to aura list - use reverse order)
     if (Aur->GetModifier()->m_auraname < TOTAL_AURAS)
     {
-        m_modAuras[Aur->GetModifier()->m_auraname].remove(Aur); //**
+        RemoveFromModAuraList(m_modAuras[Aur->GetModifier()->m_auraname], Aur); //**
+        RemoveProcAura(Aur);
 
         if (Aur->GetSpellProto()->AuraInterruptFlags)
         {
@@ -10859,7 +10875,64 @@ void Unit::ApplyAuraProcTriggerDamage(Aura* aura, bool apply)
     if (apply)
         tAuraProcTriggerDamage.push_back(aura);
     else
-        tAuraProcTriggerDamage.remove(aura);
+        RemoveFromModAuraList(tAuraProcTriggerDamage, aura);
+}
+
+void Unit::RemoveFromModAuraList(AuraList& list, Aura* aura)
+{
+    // first hole registers list for compaction in next _UpdateSpells
+    if (list.remove(aura) && list.holes() == 1)
+        m_holedAuraLists.push_back(&list);
+}
+
+void Unit::WakeAuraUpdate(Aura* aura)
+{
+    if (aura->GetUpdateSlot() != AURA_UPDATE_PARKED)
+        return;
+
+    aura->SetUpdateSlot(m_updateAuras.size());
+    m_updateAuras.push_back(aura);
+}
+
+void Unit::_CompactAuraLists()
+{
+    // nothing iterates aura lists of this unit here, so their slots can be moved
+    if (m_updateAurasHoles)
+    {
+        AuraUpdateList::iterator dest = m_updateAuras.begin();
+        for (AuraUpdateList::iterator iter = m_updateAuras.begin(); iter != m_updateAuras.end(); ++iter)
+        {
+            if (!*iter)
+                continue;
+
+            (*iter)->SetUpdateSlot(dest - m_updateAuras.begin());
+            *dest++ = *iter;
+        }
+
+        m_updateAuras.erase(dest, m_updateAuras.end());
+        m_updateAurasHoles = 0;
+    }
+
+    for (std::vector<AuraList*>::iterator iter = m_holedAuraLists.begin(); iter != m_holedAuraLists.end(); ++iter)
+        (*iter)->compact();
+    m_holedAuraLists.clear();
+
+    m_scAuras.compact();
+    m_interruptableAuras.compact();
+    m_ccAuras.compact();
+}
+
+void Unit::_ClearAuraLists()
+{
+    m_Auras.clear();
+    m_procAuras.clear();
+    m_procAurasFlags = 0;
+    for (int i = 0; i < TOTAL_AURAS; i++)
+        m_modAuras[i].clear();
+
+    m_updateAuras.clear();
+    m_updateAurasHoles = 0;
+    m_holedAuraLists.clear();
 }
 
 uint32 Unit::GetCreatePowers(Powers power) const
@@ -11004,6 +11077,11 @@ struct ProcTriggeredData
 };
 
 typedef std::list< ProcTriggeredData > ProcTriggeredList;
+
+static bool ProcTriggeredDataOrder(ProcTriggeredData const& a, ProcTriggeredData const& b)
+{
+    return a.triggeredByAura_SpellPair < b.triggeredByAura_SpellPair;
+}
 typedef std::list< uint32> RemoveSpellList;
 
 // List of auras that CAN be trigger but may not exist in spell_proc_event
@@ -11179,24 +11257,41 @@ void Unit::ProcDamageAndSpellfor (bool isVictim, Unit * pTarget, uint32 procFlag
         }
     }
 
+    // no aura can proc at this event
+    if (!(procFlag & m_procAurasFlags))
+    {
+        --m_procDeep;
+        return;
+    }
+
     RemoveSpellList removedSpells;
     ProcTriggeredList procTriggered;
-    // Fill procTriggered list
-    for (AuraMap::const_iterator itr = GetAuras().begin(); itr!= GetAuras().end(); ++itr)
+    // Fill procTriggered list, only from auras indexed with matching proc flags
+    bool active = (damage > 0) || (procExtra & PROC_EX_ABSORB && (isVictim && procSpell == NULL));
+    for (ProcAuraList::const_iterator itr = m_procAuras.begin(); itr != m_procAuras.end(); ++itr)
     {
+        if (!(itr->procFlags & procFlag))
+            continue;
+
         SpellProcEventEntry const* spellProcEvent = NULL;
-        bool active = (damage > 0) || (procExtra & PROC_EX_ABSORB && (isVictim && procSpell == NULL));
-        if (!IsTriggeredAtSpellProcEvent(itr->second, procSpell, procFlag, procExtra, attType, isVictim, active, spellProcEvent))
+        if (!IsTriggeredAtSpellProcEvent(itr->aura, procSpell, procFlag, procExtra, attType, isVictim, active, spellProcEvent))
            continue;
 
-        procTriggered.push_back(ProcTriggeredData(spellProcEvent, itr->second));
+        procTriggered.push_back(ProcTriggeredData(spellProcEvent, itr->aura));
     }
+
+    // keep aura map order of handling
+    procTriggered.sort(ProcTriggeredDataOrder);
+
+    // any aura removal since list filling makes stored pointers suspect
+    uint32 removedAuras = m_removedAurasCount;
+
     // Handle effects proceed this time
     for (ProcTriggeredList::iterator i = procTriggered.begin(); i != procTriggered.end(); ++i)
     {
         // Some auras can be deleted in function called in this loop (except first, ofc)
         // Until storing auars in std::multimap to hard check deleting by another way
-        if (i != procTriggered.begin())
+        if (i != procTriggered.begin() && removedAuras != m_removedAurasCount)
         {
             bool found = false;
             AuraMap::const_iterator lower = GetAuras().lower_bound(i->triggeredByAura_SpellPair);
@@ -11348,7 +11443,14 @@ void Unit::ProcDamageAndSpellfor (bool isVictim, Unit * pTarget, uint32 procFlag
                 break;
         }
         // Remove charge (aura can be removed by triggers)
-        if (useCharges)
+        if (useCharges && removedAuras == m_removedAurasCount)
+        {
+            triggeredByAura->m_procCharges -= 1;
+            triggeredByAura->UpdateAuraCharges();
+            if (triggeredByAura->m_procCharges <= 0)
+                removedSpells.push_back(triggeredByAura->GetId());
+        }
+        else if (useCharges)
         {
             // need found aura on drop (can be dropped by triggers)
             AuraMap::const_iterator lower = GetAuras().lower_bound(i->triggeredByAura_SpellPair);
@@ -11953,6 +12055,49 @@ Pet* Unit::CreateTamedPetFrom(Creature* creatureTarget,uint32 spell_id)
     return pet;
 }
 
+// same flags as checked in IsTriggeredAtSpellProcEvent, 0 for auras which never proc
+uint32 Unit::GetAuraEventProcFlags(Aura* aura)
+{
+    Modifier *mod = aura->GetModifier();
+    if (isNonTriggerAura[mod->m_auraname])
+        return 0;
+
+    SpellProcEventEntry const* spellProcEvent = sSpellMgr.GetSpellProcEvent(aura->GetId());
+    if (!isTriggerAura[mod->m_auraname] && spellProcEvent == NULL)
+        return 0;
+
+    if (spellProcEvent && spellProcEvent->procFlags)
+        return spellProcEvent->procFlags;
+
+    return aura->GetSpellProto()->procFlags;
+}
+
+void Unit::AddProcAura(Aura* aura)
+{
+    uint32 procFlags = GetAuraEventProcFlags(aura);
+    if (!procFlags)
+        return;
+
+    m_procAuras.push_back(ProcAuraEntry(aura, procFlags));
+    m_procAurasFlags |= procFlags;
+}
+
+void Unit::RemoveProcAura(Aura* aura)
+{
+    m_procAurasFlags = 0;
+    for (ProcAuraList::iterator itr = m_procAuras.begin(); itr != m_procAuras.end();)
+    {
+        if (itr->aura == aura)
+        {
+            itr = m_procAuras.erase(itr);
+            continue;
+        }
+
+        m_procAurasFlags |= itr->procFlags;
+        ++itr;
+    }
+}
+
 bool Unit::IsTriggeredAtSpellProcEvent(Aura* aura, SpellEntry const* procSpell, uint32 procFlag, uint32 procExtra, WeaponAttackType attType, bool isVictim, bool active, SpellProcEventEntry const*& spellProcEvent)
 {
     SpellEntry const* spellProto = aura->GetSpellProto ();
@@ -12419,7 +12564,14 @@ void Unit::Kill(Unit *pVictim, bool durabilityLoss)
             if (uint32 lootid = creatureVictim->GetCreatureInfo()->lootid)
             {
                 creatureVictim->loot.setCreatureGUID(creatureVictim);
-                creatureVictim->loot.FillLoot(lootid, LootTemplates_Creature, creatureVictim->GetLootRecipient(), false);
+
+                // without group nothing needs items before the corpse is opened, most of such corpses never are
+                // instance loot is saved to DB by FillLoot at death, so it is not deferred there
+                Player* recipient = creatureVictim->GetLootRecipient();
+                if ((!recipient || !recipient->GetGroup()) && !creatureVictim->isWorldBoss() && !creatureVictim->GetMap()->Instanceable())
+                    creatureVictim->loot.SetPendingLoot(lootid);
+                else
+                    creatureVictim->loot.FillLoot(lootid, LootTemplates_Creature, recipient, false);
             }
 
             creatureVictim->loot.generateMoneyLoot(creatureVictim->GetCreatureInfo()->mingold, creatureVictim->GetCreatureInfo()->maxgold);
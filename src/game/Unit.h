@@ -32,6 +32,7 @@
 #include "FollowerReference.h"
 #include "FollowerRefManager.h"
 #include "Utilities/EventProcessor.h"
+#include "Utilities/SlotList.h"
 #include "StateMgr.h"
 #include "MotionMaster.h"
 #include "DBCStructure.h"
@@ -834,7 +835,7 @@ class HELLGROUND_IMPORT_EXPORT Unit : public WorldObject
         typedef std::set<Unit*> AttackerSet;
         typedef std::pair<uint32, uint8> spellEffectPair;
         typedef std::multimap< spellEffectPair, Aura*> AuraMap;
-        typedef std::list<Aura *> AuraList;
+        typedef SlotList<Aura *> AuraList;
         typedef std::list<DiminishingReturn> Diminishing;
         typedef std::set<AuraType> AuraTypeSet;
         typedef std::set<uint32> ComboPointHolderSet;
@@ -1434,6 +1435,8 @@ class HELLGROUND_IMPORT_EXPORT Unit : public WorldObject
         AuraMap      & GetAuras()       { return m_Auras; }
         AuraMap const& GetAuras() const { return m_Auras; }
         AuraList const& GetAurasByType(AuraType type) const { return m_modAuras[type]; }
+        // returns parked aura back to update list
+        void WakeAuraUpdate(Aura* aura);
         void ApplyAuraProcTriggerDamage(Aura* aura, bool apply);
 
         int32 GetTotalAuraModifier(AuraType auratype) const;
@@ -1630,6 +1633,9 @@ class HELLGROUND_IMPORT_EXPORT Unit : public WorldObject
 
         void _UpdateSpells(uint32 time);
         void _DeleteAuras();
+        void _CompactAuraLists();
+        void _ClearAuraLists();                             // used when loading saved auras
+        void RemoveFromModAuraList(AuraList& list, Aura* aura);
 
         void _UpdateAutoRepeatSpell();
         bool m_AutoRepeatFirstCast;
@@ -1644,9 +1650,23 @@ class HELLGROUND_IMPORT_EXPORT Unit : public WorldObject
         DeathState m_deathState;
 
         AuraMap m_Auras;
-        AuraMap::iterator m_AurasUpdateIterator;
         uint32 m_removedAurasCount;
 
+        typedef std::vector<Aura*> AuraUpdateList;
+        AuraUpdateList m_updateAuras;                       // auras which need Update(), removed ones leave NULL until compaction
+        uint32 m_updateAurasHoles;
+        std::vector<AuraList*> m_holedAuraLists;            // m_modAuras lists waiting for compaction
+
+        struct ProcAuraEntry
+        {
+            ProcAuraEntry(Aura* _aura, uint32 _procFlags) : aura(_aura), procFlags(_procFlags) {}
+            Aura* aura;
+            uint32 procFlags;
+        };
+        typedef std::vector<ProcAuraEntry> ProcAuraList;
+        ProcAuraList m_procAuras;                           // auras which can proc, with their event proc flags
+        uint32 m_procAurasFlags;                            // all proc flags of m_procAuras
+
         typedef std::list<uint64> DynObjectGUIDs;
         DynObjectGUIDs m_dynObjGUIDs;
 
@@ -1686,6 +1706,9 @@ class HELLGROUND_IMPORT_EXPORT Unit : public WorldObject
         uint32 m_state;                                     // Even derived shouldn't modify
 
     private:
+        static uint32 GetAuraEventProcFlags(Aura* aura);
+        void AddProcAura(Aura* aura);
+        void RemoveProcAura(Aura* aura);
         bool IsTriggeredAtSpellProcEvent(Aura* aura, SpellEntry const* procSpell, uint32 procFlag, uint32 procExtra, WeaponAttackType attType, bool isVictim, bool active, SpellProcEventEntry const*& spellProcEvent);
         bool HandleDummyAuraProc(  Unit *pVictim, uint32 damage, Aura* triggredByAura, SpellEntry const *procSpell, uint32 procFlag, uint32 procEx, uint32 cooldown);
         bool HandleHasteAuraProc(  Unit *pVictim, uint32 damage, Aura* triggredByAura, SpellEntry const *procSpell, uint32 procFlag, uint32 procEx, uint32 cooldown);
@@ -28,22 +28,129 @@
 #include "World.h"
 #include "Player.h"
 #include "Util.h"
+#include "AccountMgr.h"
+#include "OpcodeStats.h"
 #include "WardenBase.h"
 #include "WardenWin.h"
 
-WardenBase::WardenBase() : iCrypto(16), oCrypto(16), m_WardenCheckTimer(10000/*10 sec*/), m_WardenKickTimer(0), m_WardenDataSent(false),
-    m_initialized(false), m_checkIntervalMin(25000), m_checkIntervalMax(35000), m_maxMemChecks(3), m_maxRandomChecks(5)
+void WardenVerdictQueue::AddVerdict(WardenVerdict const& verdict)
 {
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+    m_verdicts.push_back(verdict);
+    ++m_pendingVerdicts;
 }
 
-WardenBase::~WardenBase()
+bool WardenVerdictQueue::TakeVerdicts(std::vector<WardenVerdict>& verdicts)
+{
+    if (!m_pendingVerdicts.value())
+        return false;
+
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, false);
+    verdicts.swap(m_verdicts);
+    m_pendingVerdicts = 0;
+    return true;
+}
+
+WardenVerifyRequest::WardenVerifyRequest(WardenVerdictQueue* queue, WardenResponse* response, WardenVerifyFunction function)
+    : m_queue(queue), m_response(response), m_function(function)
+{
+    m_queue->AddRef();
+}
+
+WardenVerifyRequest::~WardenVerifyRequest()
 {
-    if (Module != NULL)
+    delete m_response;
+    m_queue->Release();
+}
+
+int WardenVerifyRequest::call()
+{
+    WardenVerdict verdict;
+    verdict.actions = WARDEN_ACTION_NONE;
+    verdict.checks = m_response->checkIds.size() + 1;       // with TIMING_CHECK
+    verdict.receiveTime = m_response->receiveTime;
+
+    uint64 start = OpcodeStats::GetTimeUS();
+    try
+    {
+        m_function(*m_response, verdict);
+    }
+    catch (ByteBufferException &)
     {
-        delete[] Module->CompressedData;
-        delete Module;
-        Module = NULL;
+        sLog.outLog(LOG_WARDEN, "Malformed check response, account %u", m_response->accountId);
     }
+    verdict.verifyTime = OpcodeStats::GetTimeUS() - start;
+
+    m_queue->AddVerdict(verdict);
+    return 0;
+}
+
+WardenStats::WardenStats()
+{
+    Reset();
+}
+
+void WardenStats::AddRequest(uint32 checks)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+    ++m_requests;
+    m_checksSent += checks;
+}
+
+void WardenStats::AddVerdict(WardenVerdict const& verdict, uint64 now)
+{
+    uint64 latency = now > verdict.receiveTime ? now - verdict.receiveTime : 0;
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+    ++m_responses;
+    m_checksVerified += verdict.checks;
+    m_verifyTime += verdict.verifyTime;
+    m_maxVerifyTime = std::max(m_maxVerifyTime, verdict.verifyTime);
+    m_latency += latency;
+    m_maxLatency = std::max(m_maxLatency, latency);
+}
+
+void WardenStats::Reset()
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+    m_resetTime = time(NULL);
+    m_requests = 0;
+    m_checksSent = 0;
+    m_responses = 0;
+    m_checksVerified = 0;
+    m_verifyTime = 0;
+    m_maxVerifyTime = 0;
+    m_latency = 0;
+    m_maxLatency = 0;
+}
+
+void WardenStats::BuildReport(std::vector<std::string>& lines) const
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+    uint32 seconds = std::max<time_t>(time(NULL) - m_resetTime, 1);
+
+    char buff[256];
+    snprintf(buff, sizeof(buff), "Warden in last %u s: " UI64FMTD " requests with " UI64FMTD " checks, " UI64FMTD " responses with " UI64FMTD " checks verified (%.1f checks/s)",
+        seconds, m_requests, m_checksSent, m_responses, m_checksVerified, float(m_checksVerified) / seconds);
+    lines.push_back(buff);
+
+    snprintf(buff, sizeof(buff), "Verification: avg %u us, max %u us. Response to verdict latency: avg %u us, max %u us",
+        uint32(m_responses ? m_verifyTime / m_responses : 0), uint32(m_maxVerifyTime),
+        uint32(m_responses ? m_latency / m_responses : 0), uint32(m_maxLatency));
+    lines.push_back(buff);
+}
+
+WardenBase::WardenBase() : iCrypto(16), oCrypto(16), m_WardenCheckTimer(10000/*10 sec*/), m_WardenKickTimer(0), m_WardenDataSent(false),
+    Module(NULL), m_initialized(false), m_verdicts(new WardenVerdictQueue), m_verifyPending(false),
+    m_checkIntervalMin(25000), m_checkIntervalMax(35000), m_maxMemChecks(3), m_maxRandomChecks(5)
+{
+}
+
+WardenBase::~WardenBase()
+{
+    // module is shared, responses still being verified keep the queue alive
+    m_verdicts->Release();
     m_initialized = false;
 }
 
@@ -87,24 +194,14 @@ void WardenBase::SendModuleToClient()
 {
 //    sLog.outLog(LOG_WARDEN, "Send module to client");
 
-    // Create packet structure
-    WardenModuleTransfer pkt;
-
-    uint32 size_left = Module->CompressedSize;
-    uint32 pos = 0;
-    uint16 burst_size;
-    while (size_left > 0)
+    // chunks are prepared once per module, only RC4 stream of the session has to be applied
+    for (std::vector<WardenModuleTransfer>::const_iterator itr = Module->Chunks.begin(); itr != Module->Chunks.end(); ++itr)
     {
-        burst_size = size_left < 500 ? size_left : 500;
-        pkt.Command = WARDEN_SMSG_MODULE_CACHE;
-        pkt.DataSize = burst_size;
-        memcpy(pkt.Data, &Module->CompressedData[pos], burst_size);
-        size_left -= burst_size;
-        pos += burst_size;
+        uint16 burst_size = itr->DataSize;
 
-        EncryptData((uint8*)&pkt, burst_size + 3);
         WorldPacket pkt1(SMSG_WARDEN_DATA, burst_size + 3);
-        pkt1.append((uint8*)&pkt, burst_size + 3);
+        pkt1.append((uint8 const*)&*itr, burst_size + 3);
+        EncryptData(const_cast<uint8*>(pkt1.contents()), burst_size + 3);
         Client->SendPacket(&pkt1);
     }
 }
@@ -130,6 +227,48 @@ void WardenBase::RequestModule()
     m_WardenDataSent = true;
 }
 
+void WardenBase::QueueVerification(WardenResponse *response, WardenVerifyFunction function)
+{
+    response->receiveTime = OpcodeStats::GetTimeUS();
+    m_verifyPending = true;
+
+    WardenVerifyRequest *request = new WardenVerifyRequest(m_verdicts, response, function);
+    if (sWorld.m_warden.activated())
+    {
+        sWorld.m_warden.execute(request);
+        return;
+    }
+
+    request->call();
+    delete request;
+    ApplyVerdicts();
+}
+
+void WardenBase::ApplyVerdicts()
+{
+    std::vector<WardenVerdict> verdicts;
+    if (!m_verdicts->TakeVerdicts(verdicts))
+        return;
+
+    m_verifyPending = false;
+
+    uint64 now = OpcodeStats::GetTimeUS();
+    for (std::vector<WardenVerdict>::const_iterator itr = verdicts.begin(); itr != verdicts.end(); ++itr)
+    {
+        sWardenStats.AddVerdict(*itr, now);
+
+        if ((itr->actions & WARDEN_ACTION_KICK) && sWorld.getConfig(CONFIG_WARDEN_KICK))
+            Client->KickPlayer();
+
+        if ((itr->actions & WARDEN_ACTION_BAN) && sWorld.getConfig(CONFIG_WARDEN_BAN))
+        {
+            std::string accountname;
+            if (AccountMgr::GetName(Client->GetAccountId(), accountname))
+                sWorld.BanAccount(BAN_ACCOUNT, accountname.c_str(), "-1", itr->failedChecks, "Warden");
+        }
+    }
+}
+
 void WardenBase::Update()
 {
     if (m_initialized)
@@ -138,6 +277,11 @@ void WardenBase::Update()
         uint32 diff = ticks - m_WardenTimer;
         m_WardenTimer = ticks;
 
+        ApplyVerdicts();
+
+        if (m_verifyPending)
+            return;
+
         if (m_WardenDataSent)
         {
             // 1.5 minutes after send packet
@@ -194,6 +338,35 @@ bool WardenBase::IsValidCheckSum(uint32 checksum, const uint8 *Data, const uint1
     }
 }
 
+ClientWardenModule *WardenBase::BuildModule(const uint8 *data, uint32 len, const uint8 *key)
+{
+    ClientWardenModule *mod = new ClientWardenModule;
+
+    // data assign
+    mod->CompressedSize = len;
+    mod->CompressedData = new uint8[len];
+    memcpy(mod->CompressedData, data, len);
+    memcpy(mod->Key, key, 16);
+
+    // md5 hash
+    MD5_CTX ctx;
+    MD5_Init(&ctx);
+    MD5_Update(&ctx, mod->CompressedData, len);
+    MD5_Final((uint8*)&mod->ID, &ctx);
+
+    // split to transfer packets
+    for (uint32 pos = 0; pos < len; pos += 500)
+    {
+        WardenModuleTransfer pkt;
+        pkt.Command = WARDEN_SMSG_MODULE_CACHE;
+        pkt.DataSize = std::min<uint32>(len - pos, 500);
+        memcpy(pkt.Data, &mod->CompressedData[pos], pkt.DataSize);
+        mod->Chunks.push_back(pkt);
+    }
+
+    return mod;
+}
+
 uint32 WardenBase::BuildChecksum(const uint8* data, uint32 dataLen)
 {
     uint8 hash[20];
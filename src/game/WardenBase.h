@@ -20,8 +20,15 @@
 #ifndef HELLGROUND_WARDEN_BASE_H
 #define HELLGROUND_WARDEN_BASE_H
 
+#include <ace/Atomic_Op.h>
+#include <ace/Method_Request.h>
+#include <ace/Singleton.h>
+#include <ace/Thread_Mutex.h>
+
 #include "Auth/SARC4.h"
 #include <map>
+#include <string>
+#include <vector>
 #include "Auth/BigNumber.h"
 #include "ByteBuffer.h"
 
@@ -77,14 +84,109 @@ struct WardenHashRequest
 #pragma pack(pop)
 #endif
 
+/// Built once per module and shared by all sessions, never deleted
 struct ClientWardenModule
 {
     uint8 ID[16];
     uint8 Key[16];
     uint32 CompressedSize;
     uint8 *CompressedData;
+    std::vector<WardenModuleTransfer> Chunks;               // transfer packets before encryption
+};
+
+enum WardenAction
+{
+    WARDEN_ACTION_NONE          = 0x00,
+    WARDEN_ACTION_KICK          = 0x01,
+    WARDEN_ACTION_BAN           = 0x02
+};
+
+/// Decrypted check response with everything needed to verify it without the session
+struct WardenResponse
+{
+    ByteBuffer data;
+    std::vector<uint32> checkIds;                           // checks sent in request, in order
+    uint32 serverTicks;                                     // when request was sent
+    uint32 accountId;
+    uint64 receiveTime;                                     // microseconds
+};
+
+struct WardenVerdict
+{
+    uint8 actions;                                          // WardenAction flags, config is checked when applied
+    std::string failedChecks;                               // ban reason
+    uint32 checks;
+    uint64 receiveTime;
+    uint64 verifyTime;                                      // spent on verifying thread
+};
+
+typedef void (*WardenVerifyFunction)(WardenResponse& response, WardenVerdict& verdict);
+
+/// Verdicts of one session. Shared by the session and its responses being verified, deleted with the last reference.
+class WardenVerdictQueue
+{
+    public:
+        WardenVerdictQueue() : m_refs(1), m_pendingVerdicts(0) {}
+
+        void AddRef() { ++m_refs; }
+        void Release() { if (--m_refs == 0) delete this; }
+
+        // called by verifying threads
+        void AddVerdict(WardenVerdict const& verdict);
+
+        // session thread, doesn't lock when there is nothing to take
+        bool TakeVerdicts(std::vector<WardenVerdict>& verdicts);
+
+    private:
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_refs;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_pendingVerdicts;
+
+        ACE_Thread_Mutex m_lock;
+        std::vector<WardenVerdict> m_verdicts;
+};
+
+class WardenVerifyRequest : public ACE_Method_Request
+{
+    public:
+        WardenVerifyRequest(WardenVerdictQueue* queue, WardenResponse* response, WardenVerifyFunction function);
+        ~WardenVerifyRequest();
+
+        virtual int call();
+
+    private:
+        WardenVerdictQueue* m_queue;
+        WardenResponse* m_response;
+        WardenVerifyFunction m_function;
 };
 
+/// Realm wide warden throughput, shown by .debug warden
+class WardenStats
+{
+    public:
+        WardenStats();
+
+        void AddRequest(uint32 checks);
+        void AddVerdict(WardenVerdict const& verdict, uint64 now);
+        void Reset();
+
+        void BuildReport(std::vector<std::string>& lines) const;
+
+    private:
+        mutable ACE_Thread_Mutex m_lock;
+
+        time_t m_resetTime;
+        uint64 m_requests;
+        uint64 m_checksSent;
+        uint64 m_responses;
+        uint64 m_checksVerified;
+        uint64 m_verifyTime;
+        uint64 m_maxVerifyTime;
+        uint64 m_latency;                                   // from receiving response to applying verdict
+        uint64 m_maxLatency;
+};
+
+#define sWardenStats (*ACE_Singleton<WardenStats, ACE_Null_Mutex>::instance())
+
 class WorldSession;
 
 class WardenBase
@@ -95,7 +197,7 @@ class WardenBase
 
     public:
         WardenBase();
-        ~WardenBase();
+        virtual ~WardenBase();
 
         virtual void Init(WorldSession *pClient, BigNumber *K);
         virtual ClientWardenModule *GetModuleForClient(WorldSession *session);
@@ -114,8 +216,13 @@ class WardenBase
         static void PrintHexArray(const char *Before, const uint8 *Buffer, uint32 Len, bool BreakWithNewline);
         static bool IsValidCheckSum(uint32 checksum, const uint8 *Data, const uint16 Length, uint32 acc);
         static uint32 BuildChecksum(const uint8 *data, uint32 dataLen);
+        static ClientWardenModule *BuildModule(const uint8 *data, uint32 len, const uint8 *key);
 
     private:
+        // hands response to warden verify threads, or verifies it in place when they are disabled
+        void QueueVerification(WardenResponse *response, WardenVerifyFunction function);
+        void ApplyVerdicts();
+
         WorldSession *Client;
         uint8 InputKey[16];
         uint8 OutputKey[16];
@@ -128,6 +235,8 @@ class WardenBase
         uint32 m_WardenTimer;
         ClientWardenModule *Module;
         bool m_initialized;
+        WardenVerdictQueue *m_verdicts;
+        bool m_verifyPending;                               // no new checks until last response is verified
 
         uint32 m_checkIntervalMin;
         uint32 m_checkIntervalMax;
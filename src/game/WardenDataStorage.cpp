@@ -26,6 +26,7 @@
 #include "Util.h"
 #include "WardenDataStorage.h"
 #include "WardenWin.h"
+#include "WardenMac.h"
 #include "World.h"
 
 WardenDataStorage::WardenDataStorage()
@@ -41,6 +42,9 @@ WardenDataStorage::~WardenDataStorage()
 void WardenDataStorage::Init()
 {
     LoadWardenDataResult(false);
+
+    WardenWin::LoadModule();
+    WardenMac::LoadModule();
 }
 
 void WardenDataStorage::Cleanup()
@@ -146,6 +150,13 @@ void WardenDataStorage::LoadWardenDataResult(bool reload)
                 wr->res.SetBinary((uint8*)temp, len);
                 delete [] temp;
             }
+
+            // MEM_CHECK compares Length bytes as stored, MPQ_CHECK 20 bytes of SHA1 reversed
+            int size = type == MEM_CHECK ? wd->Length : 20;
+            size = std::max(size, wr->res.GetNumBytes());
+            uint8 *bytes = wr->res.AsByteArray(size, type != MEM_CHECK);
+            wr->bytes.assign(bytes, bytes + size);
+
             result_map[id] = wr;
         }
     }
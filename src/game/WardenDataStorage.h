@@ -23,6 +23,7 @@
 #include "ace/Singleton.h"
 
 #include <map>
+#include <vector>
 #include "Auth/BigNumber.h"
 
 struct WardenData
@@ -37,6 +38,7 @@ struct WardenData
 struct WardenDataResult
 {
     BigNumber res;                                          // MEM_CHECK
+    std::vector<uint8> bytes;                               // res in order compared with response, BigNumber is not safe to read from verify threads
 };
 
 class WardenDataStorage
@@ -72,25 +72,17 @@ void WardenMac::Init(WorldSession *pClient, BigNumber *K)
     RequestModule();
 }
 
-ClientWardenModule *WardenMac::GetModuleForClient(WorldSession *session)
-{
-    ClientWardenModule *mod = new ClientWardenModule;
-
-    uint32 len = sizeof(Module_0DBBF209A27B1E279A9FEC5C168A15F7_Data);
+ClientWardenModule *WardenMac::m_module = NULL;
 
-    // data assign
-    mod->CompressedSize = len;
-    mod->CompressedData = new uint8[len];
-    memcpy(mod->CompressedData, Module_0DBBF209A27B1E279A9FEC5C168A15F7_Data, len);
-    memcpy(mod->Key, Module_0DBBF209A27B1E279A9FEC5C168A15F7_Key, 16);
-
-    // md5 hash
-    MD5_CTX ctx;
-    MD5_Init(&ctx);
-    MD5_Update(&ctx, mod->CompressedData, len);
-    MD5_Final((uint8*)&mod->ID, &ctx);
+void WardenMac::LoadModule()
+{
+    if (!m_module)
+        m_module = BuildModule(Module_0DBBF209A27B1E279A9FEC5C168A15F7_Data, sizeof(Module_0DBBF209A27B1E279A9FEC5C168A15F7_Data), Module_0DBBF209A27B1E279A9FEC5C168A15F7_Key);
+}
 
-    return mod;
+ClientWardenModule *WardenMac::GetModuleForClient(WorldSession *session)
+{
+    return m_module;
 }
 
 void WardenMac::InitializeModule()
@@ -41,6 +41,12 @@ class WardenMac : public WardenBase
         void HandleHashResult(ByteBuffer &buff);
         void RequestData();
         void HandleData(ByteBuffer &buff);
+
+        // builds module sent to clients, called once at startup before any session exists
+        static void LoadModule();
+
+    private:
+        static ClientWardenModule *m_module;
 };
 
 #endif
@@ -85,25 +85,17 @@ void WardenWin::Init(WorldSession *pClient, BigNumber *K)
     m_maxRandomChecks = sWorld.getConfig(CONFIG_WARDEN_RANDOM_CHECK_MAX);
 }
 
-ClientWardenModule *WardenWin::GetModuleForClient(WorldSession *session)
-{
-    ClientWardenModule *mod = new ClientWardenModule;
-
-    uint32 len = sizeof(Module_79C0768D657977D697E10BAD956CCED1_Data);
-
-    // data assign
-    mod->CompressedSize = len;
-    mod->CompressedData = new uint8[len];
-    memcpy(mod->CompressedData, Module_79C0768D657977D697E10BAD956CCED1_Data, len);
-    memcpy(mod->Key, Module_79C0768D657977D697E10BAD956CCED1_Key, 16);
+ClientWardenModule *WardenWin::m_module = NULL;
 
-    // md5 hash
-    MD5_CTX ctx;
-    MD5_Init(&ctx);
-    MD5_Update(&ctx, mod->CompressedData, len);
-    MD5_Final((uint8*)&mod->ID, &ctx);
+void WardenWin::LoadModule()
+{
+    if (!m_module)
+        m_module = BuildModule(Module_79C0768D657977D697E10BAD956CCED1_Data, sizeof(Module_79C0768D657977D697E10BAD956CCED1_Data), Module_79C0768D657977D697E10BAD956CCED1_Key);
+}
 
-    return mod;
+ClientWardenModule *WardenWin::GetModuleForClient(WorldSession *session)
+{
+    return m_module;
 }
 
 void WardenWin::InitializeModule()
@@ -333,6 +325,7 @@ void WardenWin::RequestData()
     Client->SendPacket(&pkt);
 
     m_WardenDataSent = true;
+    sWardenStats.AddRequest(SendDataId.size() + 1);
 
 /*
     std::stringstream stream;
@@ -342,9 +335,6 @@ void WardenWin::RequestData()
     sLog.outLog(LOG_WARDEN, stream.str().c_str());*/
 }
 
-#include <string>
-using namespace std;
-
 void WardenWin::HandleData(ByteBuffer &buff)
 {
 //    sLog.outLog(LOG_WARDEN, "Handle data");
@@ -352,16 +342,30 @@ void WardenWin::HandleData(ByteBuffer &buff)
     m_WardenDataSent = false;
     m_WardenKickTimer = 0;
 
+    WardenResponse *response = new WardenResponse;
+    if (buff.rpos() < buff.size())
+        response->data.append(buff.contents() + buff.rpos(), buff.size() - buff.rpos());
+    response->checkIds = SendDataId;
+    response->serverTicks = ServerTicks;
+    response->accountId = Client->GetAccountId();
+
+    buff.rpos(buff.wpos());
+
+    QueueVerification(response, &WardenWin::VerifyResponse);
+}
+
+void WardenWin::VerifyResponse(WardenResponse &response, WardenVerdict &verdict)
+{
+    ByteBuffer &buff = response.data;
+
     uint16 Length;
     buff >> Length;
     uint32 Checksum;
     buff >> Checksum;
 
-    if (!IsValidCheckSum(Checksum, buff.contents() + buff.rpos(), Length, Client->GetAccountId()))
+    if (!IsValidCheckSum(Checksum, buff.contents() + buff.rpos(), Length, response.accountId))
     {
-        buff.rpos(buff.wpos());
-        if (sWorld.getConfig(CONFIG_WARDEN_KICK))
-            Client->KickPlayer();
+        verdict.actions |= WARDEN_ACTION_KICK;
         return;
     }
 
@@ -374,23 +378,15 @@ void WardenWin::HandleData(ByteBuffer &buff)
         // TODO: test it.
         if (result == 0x00)
         {
-            sLog.outLog(LOG_WARDEN, "TIMING CHECK FAIL result 0x00, account %u", Client->GetAccountId());
-            if (found && sWorld.getConfig(CONFIG_WARDEN_KICK))
-               Client->KickPlayer();
-
+            sLog.outLog(LOG_WARDEN, "TIMING CHECK FAIL result 0x00, account %u", response.accountId);
             return;
         }
 
         uint32 newClientTicks;
         buff >> newClientTicks;
 
-        uint32 ticksNow = WorldTimer::getMSTime();
-        uint32 ourTicks = newClientTicks + (ticksNow - ServerTicks);
-
-//        sLog.outLog(LOG_WARDEN, "ServerTicks %u", ticksNow);         // now
-//        sLog.outLog(LOG_WARDEN, "RequestTicks %u", ServerTicks);     // at request
-//        sLog.outLog(LOG_WARDEN, "Ticks %u", newClientTicks);         // at response
-//        sLog.outLog(LOG_WARDEN, "Ticks diff %u", ourTicks - newClientTicks);
+//        sLog.outLog(LOG_WARDEN, "RequestTicks %u", response.serverTicks);     // at request
+//        sLog.outLog(LOG_WARDEN, "Ticks %u", newClientTicks);                  // at response
     }
 
     WardenDataResult * rs;
@@ -401,7 +397,7 @@ void WardenWin::HandleData(ByteBuffer &buff)
     std::stringstream ids;
     ids << "AntiCheat failed checks: ";
 
-    for (std::vector<uint32>::iterator itr = SendDataId.begin(); itr != SendDataId.end(); ++itr)
+    for (std::vector<uint32>::iterator itr = response.checkIds.begin(); itr != response.checkIds.end(); ++itr)
     {
         rd = sWardenDataStorage.GetWardenDataById(*itr);
         rs = sWardenDataStorage.GetWardenResultById(*itr);
@@ -416,28 +412,21 @@ void WardenWin::HandleData(ByteBuffer &buff)
 
                 if (Mem_Result != 0)
                 {
-                    //sLog.outLog(LOG_WARDEN, "RESULT MEM_CHECK not 0x00, CheckId %u account Id %u", *itr, Client->GetAccountId());
+                    //sLog.outLog(LOG_WARDEN, "RESULT MEM_CHECK not 0x00, CheckId %u account Id %u", *itr, response.accountId);
                     //found = true;
                     continue;
                 }
 
-                if (memcmp(buff.contents() + buff.rpos(), rs->res.AsByteArray(0, false), rd->Length) != 0)
+                if (memcmp(buff.contents() + buff.rpos(), &rs->bytes[0], rd->Length) != 0)
                 {
-                    string tmpStrContentsRev, tmpStrContents, tmpStrByteArray;
-
-                    uint8 * tmpContentsRev = new uint8[rd->Length];
-                    uint8 * tmpContents = new uint8[rd->Length];
-                    uint8 * tmpByteArray = rs->res.AsByteArray(0, false);
+                    std::string tmpStrContents, tmpStrByteArray;
 
-                    for (int i = 0; i < rd->Length; ++i)
-                    {
-                        tmpContentsRev[i] = buff.contents() [buff.rpos() + i];
-                        tmpContents[i] = tmpContentsRev[i];
-                    }
+                    const uint8 * tmpContents = buff.contents() + buff.rpos();
+                    const uint8 * tmpByteArray = &rs->bytes[0];
 
                     for (int i =0; i < rd->Length; ++i)
                     {
-                        char * tmp = new char[2];
+                        char tmp[3];
 
                         sprintf(tmp, "%02X", tmpContents[i]);
                         tmpStrContents += tmp;
@@ -446,7 +435,7 @@ void WardenWin::HandleData(ByteBuffer &buff)
                         tmpStrByteArray += tmp;
                     }
 
-                    sLog.outLog(LOG_WARDEN, "RESULT MEM_CHECK fail CheckId %u account Id %u got: %s  should be: %s;", *itr, Client->GetAccountId(), tmpStrContents.c_str(), tmpStrByteArray.c_str());
+                    sLog.outLog(LOG_WARDEN, "RESULT MEM_CHECK fail CheckId %u account Id %u got: %s  should be: %s;", *itr, response.accountId, tmpStrContents.c_str(), tmpStrByteArray.c_str());
                     if(*itr != sWorld.getConfig(CONFIG_WARDEN_LOG_ONLY_CHECK))
                     {
                         ids << *itr << " ";
@@ -469,11 +458,11 @@ void WardenWin::HandleData(ByteBuffer &buff)
                 if (memcmp(buff.contents() + buff.rpos(), &byte, sizeof(uint8)) != 0)
                 {
                     if (type == PAGE_CHECK_A || type == PAGE_CHECK_B)
-                        sLog.outLog(LOG_WARDEN, "RESULT PAGE_CHECK fail, CheckId %u account Id %u", *itr, Client->GetAccountId());
+                        sLog.outLog(LOG_WARDEN, "RESULT PAGE_CHECK fail, CheckId %u account Id %u", *itr, response.accountId);
                     if (type == MODULE_CHECK)
-                        sLog.outLog(LOG_WARDEN, "RESULT MODULE_CHECK fail, CheckId %u account Id %u", *itr, Client->GetAccountId());
+                        sLog.outLog(LOG_WARDEN, "RESULT MODULE_CHECK fail, CheckId %u account Id %u", *itr, response.accountId);
                     if (type == DRIVER_CHECK)
-                        sLog.outLog(LOG_WARDEN, "RESULT DRIVER_CHECK fail, CheckId %u account Id %u", *itr, Client->GetAccountId());
+                        sLog.outLog(LOG_WARDEN, "RESULT DRIVER_CHECK fail, CheckId %u account Id %u", *itr, response.accountId);
                     ids << *itr << " ";
                     found = true;
                     buff.rpos(buff.rpos() + 1);
@@ -482,11 +471,11 @@ void WardenWin::HandleData(ByteBuffer &buff)
 
                 buff.rpos(buff.rpos() + 1);
 /*                if (type == PAGE_CHECK_A || type == PAGE_CHECK_B)
-                    sLog.outLog(LOG_WARDEN, "RESULT PAGE_CHECK passed CheckId %u account Id %u", *itr, Client->GetAccountId());
+                    sLog.outLog(LOG_WARDEN, "RESULT PAGE_CHECK passed CheckId %u account Id %u", *itr, response.accountId);
                 else if (type == MODULE_CHECK)
-                    sLog.outLog(LOG_WARDEN, "RESULT MODULE_CHECK passed CheckId %u account Id %u", *itr, Client->GetAccountId());
+                    sLog.outLog(LOG_WARDEN, "RESULT MODULE_CHECK passed CheckId %u account Id %u", *itr, response.accountId);
                 else if (type == DRIVER_CHECK)
-                    sLog.outLog(LOG_WARDEN, "RESULT DRIVER_CHECK passed CheckId %u account Id %u", *itr, Client->GetAccountId());
+                    sLog.outLog(LOG_WARDEN, "RESULT DRIVER_CHECK passed CheckId %u account Id %u", *itr, response.accountId);
 */                break;
             }
             case LUA_STR_CHECK:
@@ -496,7 +485,7 @@ void WardenWin::HandleData(ByteBuffer &buff)
 
                 if (Lua_Result != 0)
                 {
-                    sLog.outLog(LOG_WARDEN, "RESULT LUA_STR_CHECK fail, CheckId %u account Id %u", *itr, Client->GetAccountId());
+                    sLog.outLog(LOG_WARDEN, "RESULT LUA_STR_CHECK fail, CheckId %u account Id %u", *itr, response.accountId);
                     //found = true;
                     continue;
                 }
@@ -513,7 +502,7 @@ void WardenWin::HandleData(ByteBuffer &buff)
                     delete[] str;
                 }
                 buff.rpos(buff.rpos() + luaStrLen);         // skip string
-//                sLog.outLog(LOG_WARDEN, "RESULT LUA_STR_CHECK passed, CheckId %u account Id %u", *itr, Client->GetAccountId());
+//                sLog.outLog(LOG_WARDEN, "RESULT LUA_STR_CHECK passed, CheckId %u account Id %u", *itr, response.accountId);
                 break;
             }
             case MPQ_CHECK:
@@ -523,21 +512,21 @@ void WardenWin::HandleData(ByteBuffer &buff)
 
                 if (Mpq_Result != 0)
                 {
-                    sLog.outLog(LOG_WARDEN, "RESULT MPQ_CHECK not 0x00 account id %u", Client->GetAccountId());
+                    sLog.outLog(LOG_WARDEN, "RESULT MPQ_CHECK not 0x00 account id %u", response.accountId);
                     //found = true;
                     continue;
                 }
 
-                if (memcmp(buff.contents() + buff.rpos(), rs->res.AsByteArray(0), 20) != 0) // SHA1
+                if (memcmp(buff.contents() + buff.rpos(), &rs->bytes[0], 20) != 0) // SHA1
                 {
-                    sLog.outLog(LOG_WARDEN, "RESULT MPQ_CHECK fail, CheckId %u account Id %u", *itr, Client->GetAccountId());
+                    sLog.outLog(LOG_WARDEN, "RESULT MPQ_CHECK fail, CheckId %u account Id %u", *itr, response.accountId);
                     //found = true;
                     buff.rpos(buff.rpos() + 20);            // 20 bytes SHA1
                     continue;
                 }
 
                 buff.rpos(buff.rpos() + 20);                // 20 bytes SHA1
-//                sLog.outLog(LOG_WARDEN, "RESULT MPQ_CHECK passed, CheckId %u account Id %u", *itr, Client->GetAccountId());
+//                sLog.outLog(LOG_WARDEN, "RESULT MPQ_CHECK passed, CheckId %u account Id %u", *itr, response.accountId);
                 break;
             }
             default:                                        // should never happens
@@ -545,13 +534,10 @@ void WardenWin::HandleData(ByteBuffer &buff)
         }
     }
 
-    if (found && sWorld.getConfig(CONFIG_WARDEN_KICK))
-       Client->KickPlayer();
-
-    if (found && sWorld.getConfig(CONFIG_WARDEN_BAN))
+    // punishment depends on session, it's applied when session picks up the verdict
+    if (found)
     {
-        std::string accountname;
-        if (AccountMgr::GetName(Client->GetAccountId(), accountname))
-            sWorld.BanAccount(BAN_ACCOUNT, accountname.c_str(), "-1", ids.str(), "Warden");
+        verdict.actions |= WARDEN_ACTION_KICK | WARDEN_ACTION_BAN;
+        verdict.failedChecks = ids.str();
     }
 }
@@ -97,7 +97,15 @@ class WardenWin : public WardenBase
         void RequestData();
         void HandleData(ByteBuffer &buff);
 
+        // runs on warden verify thread, must not touch session
+        static void VerifyResponse(WardenResponse &response, WardenVerdict &verdict);
+
+        // builds module sent to clients, called once at startup before any session exists
+        static void LoadModule();
+
     private:
+        static ClientWardenModule *m_module;
+
         uint32 ServerTicks;
         std::vector<uint32> SendDataId;
         std::vector<uint32> MemCheck;
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2008-2014 Hellground <http://hellground.net/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "WhoListCache.h"
+
+#include "GuildMgr.h"
+#include "ObjectAccessor.h"
+#include "Player.h"
+#include "MapManager.h"
+#include "Util.h"
+#include "World.h"
+
+#include <algorithm>
+
+void WhoListCache::Update()
+{
+    for (uint32 i = 0; i < BG_TEAMS_COUNT; ++i)
+        m_lists[i].clear();
+
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, *HashMapHolder<Player>::GetLock());
+        HashMapHolder<Player>::MapType& m = sObjectAccessor.GetPlayers();
+        for (HashMapHolder<Player>::MapType::iterator itr = m.begin(); itr != m.end(); ++itr)
+        {
+            Player* player = itr->second;
+            if (!player->IsInWorld())
+                continue;
+
+            WhoListEntry entry;
+            entry.guid = player->GetGUID();
+            entry.permissions = player->GetSession()->GetPermissions();
+            entry.visibility = player->GetVisibility();
+            entry.level = player->getLevel();
+            entry.class_ = player->getClass();
+            entry.race = player->getRace();
+            entry.gender = player->getGender();
+            entry.zoneId = player->GetCachedZone();
+            entry.entryZoneId = 0;
+            if (player->InArena())
+                entry.entryZoneId = sTerrainMgr.GetZoneId(player->GetBattleGroundEntryPointMap(), player->GetBattleGroundEntryPointX(), player->GetBattleGroundEntryPointY(), player->GetBattleGroundEntryPointZ());
+
+            entry.name = player->GetName();
+            entry.guildName = sGuildMgr.GetGuildNameById(player->GetGuildId());
+            if (!Utf8toWStr(entry.name, entry.wname) || !Utf8toWStr(entry.guildName, entry.wguildName))
+                continue;
+
+            wstrToLower(entry.wname);
+            wstrToLower(entry.wguildName);
+
+            m_lists[player->GetTeam() == HORDE ? BG_TEAM_HORDE : BG_TEAM_ALLIANCE].push_back(entry);
+        }
+    }
+
+    for (uint32 i = 0; i < BG_TEAMS_COUNT; ++i)
+        std::sort(m_lists[i].begin(), m_lists[i].end(), LevelOrder);
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2008-2014 Hellground <http://hellground.net/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef HELLGROUND_WHOLISTCACHE_H
+#define HELLGROUND_WHOLISTCACHE_H
+
+#include <ace/Singleton.h>
+
+#include "Common.h"
+#include "BattleGround.h"
+
+#include <string>
+#include <vector>
+
+/// Copy of player data needed by /who, names are stored already lowercased for matching
+struct WhoListEntry
+{
+    uint64 guid;
+    uint64 permissions;                                     // session permissions
+    uint8 visibility;                                       // UnitVisibility
+    uint32 level;
+    uint8 class_;
+    uint8 race;
+    uint8 gender;
+    uint32 zoneId;
+    uint32 entryZoneId;                                     // zone arena was entered from, 0 when not in arena
+    std::string name;
+    std::string guildName;
+    std::wstring wname;
+    std::wstring wguildName;
+};
+
+typedef std::vector<WhoListEntry> WhoList;
+
+/// Snapshot of online players for /who queries, rebuilt periodically from World::Update.
+/// CMSG_WHO is handled in World::UpdateSessions which never runs together with the rebuild,
+/// so queries read the snapshot without taking the player map lock.
+class WhoListCache
+{
+    public:
+        /// rebuild from online players, takes player map lock once
+        void Update();
+
+        /// players of one team sorted by level
+        WhoList const& GetList(BattleGroundTeamId team) const { return m_lists[team]; }
+
+        static bool LevelOrder(WhoListEntry const& a, WhoListEntry const& b) { return a.level < b.level; }
+
+    private:
+        WhoList m_lists[BG_TEAMS_COUNT];
+};
+
+#define sWhoListCache (*ACE_Singleton<WhoListCache, ACE_Null_Mutex>::instance())
+
+#endif
@@ -55,9 +55,12 @@
 #include "GameEvent.h"
 #include "PoolManager.h"
 #include "Database/DatabaseImpl.h"
+#include "Database/DataSnapshot.h"
+#include "Mail.h"
 #include "GridNotifiersImpl.h"
 #include "CellImpl.h"
 #include "InstanceSaveMgr.h"
+#include "WorldLoader.h"
 #include "TicketMgr.h"
 #include "Util.h"
 #include "Language.h"
@@ -69,6 +72,8 @@
 #include "luaengine/HookMgr.h"
 //#include "Timer.h"
 #include "GuildMgr.h"
+#include "OpcodeStats.h"
+#include "WhoListCache.h"
 #include <tbb/parallel_for.h>
 
 extern bool StartEluna();
@@ -490,6 +495,13 @@ void World::LoadConfigSettings(bool reload)
         sLog.outString("Using DataDir %s",m_dataPath.c_str());
     }
 
+    std::string snapshotDir = sConfig.GetStringDefault("StaticDataSnapshotDir", "");
+    if (!snapshotDir.empty() && snapshotDir.at(snapshotDir.length()-1)!='/' && snapshotDir.at(snapshotDir.length()-1)!='\\')
+        snapshotDir.append("/");
+
+    if (!reload)
+        DataSnapshot::Initialize(snapshotDir);
+
     // === Load section ===
     // Performance settings
     SetPlayerLimit(sConfig.GetIntDefault("PlayerLimit", DEFAULT_PLAYER_LIMIT));
@@ -504,6 +516,7 @@ void World::LoadConfigSettings(bool reload)
     loadConfig(CONFIG_NUMTHREADS, "MapUpdate.Threads", 1);
     if (m_configs[CONFIG_NUMTHREADS] < 1)
         m_configs[CONFIG_NUMTHREADS] = 1;
+    loadConfig(CONFIG_STARTUP_LOADER_THREADS, "StartupLoader.Threads", 1);
     loadConfig(CONFIG_MAPUPDATE_MAXVISITORS, "MapUpdate.UpdateVisitorsMax", 0);
     loadConfig(CONFIG_CUMULATIVE_LOG_METHOD, "MapUpdate.CumulativeLogMethod", 0);
 
@@ -513,6 +526,10 @@ void World::LoadConfigSettings(bool reload)
     loadConfig(CONFIG_SESSION_UPDATE_VERBOSE_LOG, "SessionUpdate.VerboseLog", 0);
     loadConfig(CONFIG_SESSION_UPDATE_IDLE_KICK, "SessionUpdate.IdleKickTimer", 15*MINUTE*IN_MILISECONDS);
     loadConfig(CONFIG_SESSION_UPDATE_MIN_LOG_DIFF, "SessionUpdate.MinLogDiff", 25);
+    loadConfig(CONFIG_SESSION_UPDATE_OPCODE_STATS, "SessionUpdate.OpcodeStats", 0);
+    loadConfig(CONFIG_SESSION_UPDATE_OPCODE_STATS_DUMP, "SessionUpdate.OpcodeStats.DumpInterval", 0);
+    loadConfig(CONFIG_SESSION_UPDATE_OPCODE_STATS_SLOW, "SessionUpdate.OpcodeStats.SlowHandler", 0);
+    sOpcodeStats.SetEnabled(m_configs[CONFIG_SESSION_UPDATE_OPCODE_STATS]);
     loadConfig(CONFIG_INTERVAL_LOG_UPDATE, "RecordUpdateTimeDiffInterval", 60000);
     loadConfig(CONFIG_MIN_LOG_UPDATE, "MinRecordUpdateTimeDiff", 10);
 
@@ -568,6 +585,7 @@ void World::LoadConfigSettings(bool reload)
     loadConfig(CONFIG_ENABLE_SORT_AUCTIONS, "Auction.EnableSort", true);
     loadConfig(CONFIG_AUTOBROADCAST_INTERVAL, "AutoBroadcast.Timer", 35*MINUTE*1000);
     loadConfig(CONFIG_GROUPLEADER_RECONNECT_PERIOD, "GroupLeaderReconnectPeriod", 180);
+    loadConfig(CONFIG_GROUP_MEMBER_STATS_INTERVAL, "Group.MemberStatsInterval", 1000);
     loadConfig(CONFIG_INSTANCE_RESET_TIME_HOUR, "Instance.ResetTimeHour", 4);
     loadConfig(CONFIG_INSTANCE_UNLOAD_DELAY, "Instance.UnloadDelay", 1800000);
     loadConfig(CONFIG_MAIL_DELIVERY_DELAY, "Mail.DeliveryDelay", HOUR);
@@ -576,8 +594,12 @@ void World::LoadConfigSettings(bool reload)
     loadConfig(CONFIG_GM_MAIL, "Mail.GmInstantSend", 1);
     loadConfig(CONFIG_RETURNOLDMAILS_MODE, "Mail.OldReturnMode", 0);
     loadConfig(CONFIG_RETURNOLDMAILS_INTERVAL, "Mail.OldReturnTimer", 60);
+    loadConfig(CONFIG_RETURNOLDMAILS_CHUNK_SIZE, "Mail.OldReturnChunkSize", 500);
+    if (m_configs[CONFIG_RETURNOLDMAILS_CHUNK_SIZE] == 0)
+        m_configs[CONFIG_RETURNOLDMAILS_CHUNK_SIZE] = 1;
     loadConfig(CONFIG_GROUP_XP_DISTANCE, "MaxGroupXPDistance", 74);
     loadConfig(CONFIG_MAX_WHO, "MaxWhoListReturns", 49);
+    loadConfig(CONFIG_WHO_LIST_UPDATE_INTERVAL, "WhoList.UpdateInterval", 5000);
     loadConfig(CONFIG_NO_RESET_TALENT_COST, "NoResetTalentsCost", false);
     loadConfig(CONFIG_RABBIT_DAY, "Rabbit.Day", 0);
     loadConfig(CONFIG_SKILL_PROSPECTING, "SkillChance.Prospecting",false);
@@ -828,6 +850,7 @@ void World::LoadConfigSettings(bool reload)
     loadConfig(CONFIG_TARGET_POS_RECHECK_TIMER, "Movement.RecheckTimer", 100);
     loadConfig(CONFIG_WAYPOINT_MOVEMENT_PATHFINDING_ON_CONTINENTS, "Movement.WaypointPathfinding.Continents", true);
     loadConfig(CONFIG_WAYPOINT_MOVEMENT_PATHFINDING_IN_INSTANCES, "Movement.WaypointPathfinding.Instances", true);
+    loadConfig(CONFIG_CHASE_PATH_BUDGET, "Movement.ChasePathsPerUpdate", 100);
 
     // CoreBalancer
     loadConfig(CONFIG_COREBALANCER_ENABLED, "CoreBalancer.Enable", false);
@@ -850,6 +873,7 @@ void World::LoadConfigSettings(bool reload)
     loadConfig(CONFIG_WARDEN_CHECK_INTERVAL_MAX, "Warden.CheckIntervalMax",35000);
     loadConfig(CONFIG_WARDEN_MEM_CHECK_MAX, "Warden.MemCheckMax",3);
     loadConfig(CONFIG_WARDEN_RANDOM_CHECK_MAX, "Warden.RandomCheckMax",5);
+    loadConfig(CONFIG_WARDEN_VERIFY_THREADS, "Warden.VerifyThreads",1);
     loadConfig(CONFIG_ENABLE_PASSIVE_ANTICHEAT, "AntiCheat.Enable", 1); 
     loadConfig(CONFIG_ANTICHEAT_CUMULATIVE_DELAY, "AntiCheat.CumulativeDelay",5* IN_MILISECONDS);
     loadConfig(CONFIG_ANTICHEAT_SPEEDHACK_TOLERANCE, "AntiCheat.SpeedhackTolerance",1.00f);
@@ -1120,294 +1144,232 @@ void World::SetInitialWorldSettings()
     ///- Remove the bones after a restart
     RealmDataDatabase.PExecute("DELETE FROM corpse WHERE corpse_type = '0'");
 
-    ///- Load the DBC files
-    sLog.outString("Initialize data stores...");
-    LoadDBCStores(m_dataPath);
-    DetectDBCLang();
-
-    sLog.outString("Loading Terrain specific data...");
-    sTerrainMgr.LoadTerrainSpecifics();
-
-    sLog.outString("Loading Script Names...");
-    sScriptMgr.LoadScriptNames();
-
-    sLog.outString("Loading InstanceTemplate");
-    sObjectMgr.LoadInstanceTemplate();
-
-    sLog.outString("Loading SkillLineAbilityMultiMap Data...");
-    sSpellMgr.LoadSkillLineAbilityMap();
-
-    ///- Clean up and pack instances
-    sLog.outString("Cleaning up instances...");
-    sInstanceSaveManager.CleanupInstances();                              // must be called before `creature_respawn`/`gameobject_respawn` tables
-
-    //sLog.outString("Packing instances...");
-    //sInstanceSaveManager.PackInstances();
-
-    sLog.outString("Loading Localization strings...");
-    sObjectMgr.LoadCreatureLocales();
-    sObjectMgr.LoadGameObjectLocales();
-    sObjectMgr.LoadItemLocales();
-    sObjectMgr.LoadQuestLocales();
-    sObjectMgr.LoadNpcTextLocales();
-    sObjectMgr.LoadPageTextLocales();
-    sObjectMgr.LoadNpcOptionLocales();
-    sObjectMgr.SetDBCLocaleIndex(GetDefaultDbcLocale());        // Get once for all the locale index of DBC language (console/broadcasts)
-
-    sLog.outString("Loading Page Texts...");
-    sObjectMgr.LoadPageTexts();
-
-    sLog.outString("Loading Game Object Templates...");   // must be after LoadPageTexts
-    sObjectMgr.LoadGameobjectInfo();
-
-    sLog.outString("Loading Spell Chain Data...");
-    sSpellMgr.LoadSpellChains();
-
-    sLog.outString("Loading Spell Required Data...");
-    sSpellMgr.LoadSpellRequired();
-
-    sLog.outString("Loading Spell Elixir types...");
-    sSpellMgr.LoadSpellElixirs();
-
-    sLog.outString("Loading Spell Learn Skills...");
-    sSpellMgr.LoadSpellLearnSkills();                        // must be after LoadSpellChains
-
-    sLog.outString("Loading Spell Learn Spells...");
-    sSpellMgr.LoadSpellLearnSpells();
-
-    sLog.outString("Loading Spell Proc Event conditions...");
-    sSpellMgr.LoadSpellProcEvents();
-
-    sLog.outString("Loading Aggro Spells Definitions...");
-    sSpellMgr.LoadSpellThreats();
-
-    sLog.outString("Loading Unqueued Account List...");
-    sObjectMgr.LoadUnqueuedAccountList();
-
-    sLog.outString("Loading NPC Texts...");
-    sObjectMgr.LoadGossipText();
+    ///- Declare startup loaders in serial loading order, with more threads ordering is given only by dependencies between tasks
+    WorldLoader loader;
 
-    sLog.outString("Loading Enchant Spells Proc datas...");
-    sSpellMgr.LoadSpellEnchantProcData();
-
-    sLog.outString("Loading Item Random Enchantments Table...");
-    LoadRandomEnchantmentsTable();
-
-    sLog.outString("Loading Items...");                   // must be after LoadRandomEnchantmentsTable and LoadPageTexts
-    sObjectMgr.LoadItemPrototypes();
-
-    sLog.outString("Loading Item Texts...");
-    sObjectMgr.LoadItemTexts();
-
-    sLog.outString("Loading Creature Model Based Info Data...");
-    sObjectMgr.LoadCreatureModelInfo();
-
-    sLog.outString("Loading Equipment templates...");
-    sObjectMgr.LoadEquipmentTemplates();
-
-    sLog.outString("Loading Creature templates...");
-    sObjectMgr.LoadCreatureTemplates();
-
-    sLog.outString("Loading SpellsScriptTarget...");
-    sSpellMgr.LoadSpellScriptTarget();                       // must be after LoadCreatureTemplates and LoadGameobjectInfo
-
-    sLog.outString( "Loading Reputation Reward Rates...");
-    sObjectMgr.LoadReputationRewardRate();
-
-    sLog.outString("Loading Creature Reputation OnKill Data...");
-    sObjectMgr.LoadReputationOnKill();
-
-    sLog.outString( "Loading Reputation Spillover Data..." );
-    sObjectMgr.LoadReputationSpilloverTemplate();
-
-    sLog.outString("Loading Pet Create Spells...");
-    sObjectMgr.LoadPetCreateSpells();
-
-    sLog.outString("Loading Creature Data...");
-    sObjectMgr.LoadCreatures();
-
-    sLog.outString("Loading Creature Linked Respawn...");
-    sObjectMgr.LoadCreatureLinkedRespawn();                     // must be after LoadCreatures()
+    uint32 dbcStores = loader.AddTask("DBC stores", [this]()
+    {
+        LoadDBCStores(m_dataPath);
+        DetectDBCLang();
+    });
 
-    sLog.outString("Loading Creature Addon Data...");
-    sObjectMgr.LoadCreatureAddons();                            // must be after LoadCreatureTemplates() and LoadCreatures()
+    loader.AddTask("Terrain specific data", []() { sTerrainMgr.LoadTerrainSpecifics(); }, { dbcStores });
 
-    sLog.outString("Loading Creature Respawn Data...");   // must be after PackInstances()
-    sObjectMgr.LoadCreatureRespawnTimes();
+    uint32 scriptNames = loader.AddTask("Script Names", []() { sScriptMgr.LoadScriptNames(); });
 
-    sLog.outString("Loading Gameobject Data...");
-    sObjectMgr.LoadGameobjects();
+    loader.AddTask("InstanceTemplate", []() { sObjectMgr.LoadInstanceTemplate(); }, { dbcStores, scriptNames });
 
-    sLog.outString("Loading Gameobject Respawn Data..."); // must be after PackInstances()
-    sObjectMgr.LoadGameobjectRespawnTimes();
+    uint32 skillLineAbility = loader.AddTask("SkillLineAbilityMultiMap Data", []() { sSpellMgr.LoadSkillLineAbilityMap(); }, { dbcStores });
 
-    sLog.outString("Loading Objects Pooling Data...");
-    sPoolMgr.LoadFromDB();
+    // must be called before `creature_respawn`/`gameobject_respawn` tables
+    uint32 cleanupInstances = loader.AddTask("instances cleanup", []() { sInstanceSaveManager.CleanupInstances(); }, { dbcStores });
 
-    sLog.outString("Loading Game Event Data...");
-    sGameEventMgr.LoadFromDB();
+    // all locale loaders (and strings loaders) share locale index table, so they can't run in parallel
+    uint32 locales = loader.AddTask("Localization strings", []()
+    {
+        sObjectMgr.LoadCreatureLocales();
+        sObjectMgr.LoadGameObjectLocales();
+        sObjectMgr.LoadItemLocales();
+        sObjectMgr.LoadQuestLocales();
+        sObjectMgr.LoadNpcTextLocales();
+        sObjectMgr.LoadPageTextLocales();
+        sObjectMgr.LoadNpcOptionLocales();
+    });
 
-    sLog.outString("Loading Weather Data...");
-    sObjectMgr.LoadWeatherZoneChances();
+    // Get once for all the locale index of DBC language (console/broadcasts)
+    uint32 dbcLocaleIndex = loader.AddTask("DBC locale index", [this]() { sObjectMgr.SetDBCLocaleIndex(GetDefaultDbcLocale()); }, { dbcStores, locales });
 
-    sLog.outString("Loading Quests...");
-    sObjectMgr.LoadQuests();                                    // must be loaded after DBCs, creature_template, item_template, gameobject tables
+    uint32 pageTexts = loader.AddTask("Page Texts", []() { sObjectMgr.LoadPageTexts(); });
 
-    sLog.outString("Loading Quests Relations...");
-    sObjectMgr.LoadQuestRelations();                            // must be after quest load
+    uint32 gameobjectInfo = loader.AddTask("Game Object Templates", []() { sObjectMgr.LoadGameobjectInfo(); }, { dbcStores, scriptNames, pageTexts });
 
-    sLog.outString("Loading AreaTrigger definitions...");
-    sObjectMgr.LoadAreaTriggerTeleports();
+    uint32 spells = loader.AddTask("Spell data", []()
+    {
+        sSpellMgr.LoadSpellChains();
+        sSpellMgr.LoadSpellRequired();
+        sSpellMgr.LoadSpellElixirs();
+        sSpellMgr.LoadSpellLearnSkills();                   // must be after LoadSpellChains
+        sSpellMgr.LoadSpellLearnSpells();
+        sSpellMgr.LoadSpellProcEvents();
+        sSpellMgr.LoadSpellThreats();
+    }, { dbcStores, skillLineAbility });
 
-    sLog.outString("Loading Access Requirements...");
-    sObjectMgr.LoadAccessRequirements();                        // must be after item template load
+    loader.AddTask("Unqueued Account List", []() { sObjectMgr.LoadUnqueuedAccountList(); });
 
-    sLog.outString("Loading Quest Area Triggers...");
-    sObjectMgr.LoadQuestAreaTriggers();                         // must be after LoadQuests
+    uint32 gossipTexts = loader.AddTask("NPC Texts", []() { sObjectMgr.LoadGossipText(); });
 
-    sLog.outString("Loading Tavern Area Triggers...");
-    sObjectMgr.LoadTavernAreaTriggers();
+    loader.AddTask("Enchant Spells Proc datas", []() { sSpellMgr.LoadSpellEnchantProcData(); }, { dbcStores, spells });
 
-    sLog.outString("Loading AreaTrigger script names...");
-    sScriptMgr.LoadAreaTriggerScripts();
+    // must be after LoadRandomEnchantmentsTable and LoadPageTexts
+    uint32 items = loader.AddTask("Items", []()
+    {
+        LoadRandomEnchantmentsTable();
+        sObjectMgr.LoadItemPrototypes();
+    }, { dbcStores, scriptNames, pageTexts, spells });
 
-    sLog.outString("Loading CompletedCinematic script names...");
-    sScriptMgr.LoadCompletedCinematicScripts();
+    loader.AddTask("Item Texts", []() { sObjectMgr.LoadItemTexts(); });
 
-    sLog.outString("Loading event id script names...");
-    sScriptMgr.LoadEventIdScripts();
+    uint32 creatureModelInfo = loader.AddTask("Creature Model Based Info Data", []() { sObjectMgr.LoadCreatureModelInfo(); }, { dbcStores });
 
-    sLog.outString("Loading spell id script names...");
-    sScriptMgr.LoadSpellIdScripts();
+    uint32 equipment = loader.AddTask("Equipment templates", []() { sObjectMgr.LoadEquipmentTemplates(); }, { dbcStores });
 
-    sLog.outString("Loading Graveyard-zone links...");
-    sObjectMgr.LoadGraveyardZones();
+    uint32 creatureTemplates = loader.AddTask("Creature templates", []() { sObjectMgr.LoadCreatureTemplates(); },
+        { dbcStores, scriptNames, spells, creatureModelInfo, equipment });
 
-    sLog.outString("Loading Spell target coordinates...");
-    sSpellMgr.LoadSpellTargetPositions();
+    uint32 spellScriptTarget = loader.AddTask("SpellsScriptTarget", []() { sSpellMgr.LoadSpellScriptTarget(); }, { creatureTemplates, gameobjectInfo });
 
-    sLog.outString("Loading SpellAffect definitions...");
-    sSpellMgr.LoadSpellAffects();
+    loader.AddTask("Reputation Data", []()
+    {
+        sObjectMgr.LoadReputationRewardRate();
+        sObjectMgr.LoadReputationOnKill();
+        sObjectMgr.LoadReputationSpilloverTemplate();
+    }, { dbcStores, creatureTemplates });
 
-    sLog.outString("Loading spell pet auras...");
-    sSpellMgr.LoadSpellPetAuras();
+    uint32 petCreateSpells = loader.AddTask("Pet Create Spells", []() { sObjectMgr.LoadPetCreateSpells(); }, { creatureTemplates });
 
-    sLog.outString("Loading spell extra attributes...(TODO)");
-    sSpellMgr.LoadSpellCustomAttr();
+    // creatures, gameobjects and corpses share map object guid index
+    uint32 spawns = loader.AddTask("Creature and Gameobject Data", []()
+    {
+        sObjectMgr.LoadCreatures();
+        sObjectMgr.LoadCreatureLinkedRespawn();             // must be after LoadCreatures()
+        sObjectMgr.LoadCreatureAddons();                    // must be after LoadCreatureTemplates() and LoadCreatures()
+        sObjectMgr.LoadCreatureRespawnTimes();
+        sObjectMgr.LoadGameobjects();
+        sObjectMgr.LoadGameobjectRespawnTimes();
+    }, { creatureTemplates, gameobjectInfo, items, cleanupInstances });
 
-    sLog.outString("Loading linked spells...");
-    sSpellMgr.LoadSpellLinked();
+    uint32 poolAndEvents = loader.AddTask("Objects Pooling and Game Event Data", []()
+    {
+        sPoolMgr.LoadFromDB();
+        sGameEventMgr.LoadFromDB();
+    }, { spawns });
 
-    sLog.outString("Loading player Create Info & Level Stats...");
-    sObjectMgr.LoadPlayerInfo();
+    loader.AddTask("Weather Data", []() { sObjectMgr.LoadWeatherZoneChances(); }, { dbcStores });
 
-    sLog.outString("Loading Exploration BaseXP Data...");
-    sObjectMgr.LoadExplorationBaseXP();
+    // must be loaded after DBCs, creature_template, item_template, gameobject tables
+    uint32 quests = loader.AddTask("Quests", []()
+    {
+        sObjectMgr.LoadQuests();
+        sObjectMgr.LoadQuestRelations();                    // must be after quest load
+    }, { dbcStores, spells, creatureTemplates, items, gameobjectInfo, poolAndEvents });
 
-    sLog.outString("Loading Pet Name Parts...");
-    sObjectMgr.LoadPetNames();
+    // must be after item template load
+    uint32 areaTriggers = loader.AddTask("AreaTrigger definitions and Access Requirements", []()
+    {
+        sObjectMgr.LoadAreaTriggerTeleports();
+        sObjectMgr.LoadAccessRequirements();
+        sObjectMgr.LoadQuestAreaTriggers();                 // must be after LoadQuests
+        sObjectMgr.LoadTavernAreaTriggers();
+    }, { dbcStores, items, quests });
 
-    sLog.outString("Loading the max pet number...");
-    sObjectMgr.LoadPetNumber();
+    uint32 scriptIds = loader.AddTask("script names bindings", []()
+    {
+        sScriptMgr.LoadAreaTriggerScripts();
+        sScriptMgr.LoadCompletedCinematicScripts();
+        sScriptMgr.LoadEventIdScripts();
+        sScriptMgr.LoadSpellIdScripts();
+    }, { dbcStores, scriptNames, spells });
 
-    sLog.outString("Loading pet level stats...");
-    sObjectMgr.LoadPetLevelInfo();
+    loader.AddTask("Graveyard-zone links", []() { sObjectMgr.LoadGraveyardZones(); }, { dbcStores });
 
-    sLog.outString("Loading Player Corpses...");
-    sObjectMgr.LoadCorpses();
+    // these loaders modify spell entries (custom attributes), so they wait for every earlier loader reading spells
+    // and every later loader reading spells waits for them, keeping the serial order
+    uint32 spellsExtra = loader.AddTask("Spell extra data", []()
+    {
+        sSpellMgr.LoadSpellTargetPositions();
+        sSpellMgr.LoadSpellAffects();
+        sSpellMgr.LoadSpellPetAuras();
+        sSpellMgr.LoadSpellCustomAttr();
+        sSpellMgr.LoadSpellLinked();
+    }, { spells, items, creatureTemplates, spellScriptTarget, petCreateSpells, spawns, poolAndEvents, quests, areaTriggers, scriptIds });
 
-    sLog.outString("Loading Disabled Spells...");
-    sObjectMgr.LoadSpellDisabledEntrys();
+    loader.AddTask("player Create Info & Level Stats", []()
+    {
+        sObjectMgr.LoadPlayerInfo();
+        sObjectMgr.LoadExplorationBaseXP();
+        sObjectMgr.LoadPetNames();
+        sObjectMgr.LoadPetNumber();
+        sObjectMgr.LoadPetLevelInfo();
+    }, { dbcStores, spellsExtra, items, creatureTemplates });
 
-    sLog.outString("Loading Loot Tables...");
-    LoadLootTables();
+    loader.AddTask("Player Corpses", []() { sObjectMgr.LoadCorpses(); }, { poolAndEvents });
 
-    sLog.outString("Loading Skill Discovery Table...");
-    LoadSkillDiscoveryTable();
+    loader.AddTask("Disabled Spells", []() { sObjectMgr.LoadSpellDisabledEntrys(); }, { spellsExtra });
 
-    sLog.outString("Loading Skill Extra Item Table...");
-    LoadSkillExtraItemTable();
+    // only loot conditions add new entries to condition table
+    loader.AddTask("Loot Tables", []() { LoadLootTables(); }, { items, creatureTemplates, gameobjectInfo, quests, spellsExtra });
 
-    sLog.outString("Loading Skill Fishing base level requirements...");
-    sObjectMgr.LoadFishingBaseSkillLevel();
+    loader.AddTask("Skill Discovery and Extra Item Tables", []()
+    {
+        LoadSkillDiscoveryTable();
+        LoadSkillExtraItemTable();
+        sObjectMgr.LoadFishingBaseSkillLevel();
+    }, { dbcStores, spellsExtra, items });
 
     ///- Load dynamic data tables from the database
-    sLog.outString("Loading Auctions...");
-    sAuctionMgr.LoadAuctionItems();
-    sAuctionMgr.LoadAuctions();
-
-    sLog.outString("Loading Guilds...");
-    sGuildMgr.LoadGuilds();
-
-    sLog.outString("Loading ArenaTeams...");
-    sObjectMgr.LoadArenaTeams();
+    loader.AddTask("Auctions", []()
+    {
+        sAuctionMgr.LoadAuctionItems();
+        sAuctionMgr.LoadAuctions();
+    }, { items, spawns });
 
-    sLog.outString("Loading Groups...");
-    sObjectMgr.LoadGroups();
+    loader.AddTask("Guilds", []() { sGuildMgr.LoadGuilds(); }, { dbcStores, items });
 
-    sLog.outString("Loading ReservedNames...");
-    sObjectMgr.LoadReservedPlayersNames();
+    loader.AddTask("ArenaTeams", []() { sObjectMgr.LoadArenaTeams(); });
 
-    //sLog.outString("Loading GameObject for quests...");
-    //sObjectMgr.LoadGameObjectForQuests();
+    loader.AddTask("Groups", []() { sObjectMgr.LoadGroups(); }, { dbcStores, cleanupInstances, spawns });
 
-    sLog.outString("Loading BattleMasters...");
-    sBattleGroundMgr.LoadBattleMastersEntry();
+    loader.AddTask("ReservedNames", []() { sObjectMgr.LoadReservedPlayersNames(); });
 
-    sLog.outString("Loading GameTeleports...");
-    sObjectMgr.LoadGameTele();
+    loader.AddTask("BattleMasters", []() { sBattleGroundMgr.LoadBattleMastersEntry(); }, { creatureTemplates });
 
-    sLog.outString("Loading Npc Text Id...");
-    sObjectMgr.LoadNpcTextId();                                 // must be after load Creature and NpcText
+    loader.AddTask("GameTeleports", []() { sObjectMgr.LoadGameTele(); }, { dbcStores });
 
-    sLog.outString("Loading Npc Options...");
-    sObjectMgr.LoadNpcOptions();
+    // must be after load Creature and NpcText
+    uint32 npcTextId = loader.AddTask("Npc Text Id", []() { sObjectMgr.LoadNpcTextId(); }, { spawns, gossipTexts });
 
-    sLog.outString("Loading vendors...");
-    sObjectMgr.LoadVendors();                                   // must be after load CreatureTemplate and ItemPrototype
+    uint32 npcOptions = loader.AddTask("Npc Options", []() { sObjectMgr.LoadNpcOptions(); }, { npcTextId });
 
-    sLog.outString("Loading trainers...");
-    sObjectMgr.LoadTrainerSpell();                              // must be after load CreatureTemplate
+    uint32 npcData = loader.AddTask("vendors and trainers", []()
+    {
+        sObjectMgr.LoadVendors();                           // must be after load CreatureTemplate and ItemPrototype
+        sObjectMgr.LoadTrainerSpell();                      // must be after load CreatureTemplate
+    }, { creatureTemplates, items, spellsExtra, npcOptions });
 
-    sLog.outString("Loading opcodes cooldown...");
-    sObjectMgr.LoadOpcodesCooldown();
+    loader.AddTask("opcodes cooldown", []() { sObjectMgr.LoadOpcodesCooldown(); });
 
-    sLog.outString("Loading Waypoints...");
-    sWaypointMgr.Load();
+    uint32 waypoints = loader.AddTask("Waypoints", []() { sWaypointMgr.Load(); }, { dbcStores });
 
-    sLog.outString("Loading Creature Formations...");
-    CreatureGroupManager::LoadCreatureFormations();
+    uint32 formations = loader.AddTask("Creature Formations", []() { CreatureGroupManager::LoadCreatureFormations(); }, { spawns });
 
-    sLog.outString("Loading GM tickets...");
-    sTicketMgr.LoadGMTickets();
+    loader.AddTask("GM tickets", []() { sTicketMgr.LoadGMTickets(); });
 
     ///- Handle outdated emails (delete/return)
-    sLog.outString("Returning old mails...");
-    sObjectMgr.ReturnOrDeleteOldMails(false);
+    loader.AddTask("old mails return", []() { sObjectMgr.ReturnOrDeleteOldMails(false); }, { items });
 
-    sLog.outString("Loading Autobroadcasts...");
-    LoadAutobroadcasts();
+    loader.AddTask("Autobroadcasts", [this]() { LoadAutobroadcasts(); });
 
-    ///- Load and initialize scripts
-    sLog.outString("Loading Scripts...");
-    sScriptMgr.LoadQuestStartScripts();                         // must be after load Creature/Gameobject(Template/Data) and QuestTemplate
-    sScriptMgr.LoadQuestEndScripts();                           // must be after load Creature/Gameobject(Template/Data) and QuestTemplate
-    sScriptMgr.LoadSpellScripts();                              // must be after load Creature/Gameobject(Template/Data)
-    sScriptMgr.LoadGameObjectScripts();                         // must be after load Creature/Gameobject(Template/Data)
-    sScriptMgr.LoadEventScripts();                              // must be after load Creature/Gameobject(Template/Data)
-    sScriptMgr.LoadWaypointScripts();
+    ///- Load scripts, must be after load Creature/Gameobject(Template/Data) and QuestTemplate
+    loader.AddTask("Scripts", []()
+    {
+        sScriptMgr.LoadQuestStartScripts();
+        sScriptMgr.LoadQuestEndScripts();
+        sScriptMgr.LoadSpellScripts();
+        sScriptMgr.LoadGameObjectScripts();
+        sScriptMgr.LoadEventScripts();
+        sScriptMgr.LoadWaypointScripts();
 
-    sLog.outString("Loading Scripts text locales...");    // must be after Load*Scripts calls
-    sScriptMgr.LoadDbScriptStrings();
+        sScriptMgr.LoadDbScriptStrings();                   // must be after Load*Scripts calls
 
-    sLog.outString("Loading CreatureEventAI Texts...");
-    sCreatureEAIMgr.LoadCreatureEventAI_Texts(false);       // false, will checked in LoadCreatureEventAI_Scripts
+        sCreatureEAIMgr.LoadCreatureEventAI_Texts(false);   // false, will checked in LoadCreatureEventAI_Scripts
+        sCreatureEAIMgr.LoadCreatureEventAI_Summons(false); // false, will checked in LoadCreatureEventAI_Scripts
+        sCreatureEAIMgr.LoadCreatureEventAI_Scripts();
+    }, { spawns, poolAndEvents, quests, scriptIds, spellsExtra, dbcLocaleIndex, waypoints, formations, npcData });
 
-    sLog.outString("Loading CreatureEventAI Summons...");
-    sCreatureEAIMgr.LoadCreatureEventAI_Summons(false);     // false, will checked in LoadCreatureEventAI_Scripts
+    loader.Run(getConfig(CONFIG_STARTUP_LOADER_THREADS));
+    loader.PrintReport();
 
-    sLog.outString("Loading CreatureEventAI Scripts...");
-    sCreatureEAIMgr.LoadCreatureEventAI_Scripts();
+    DataSnapshot::Disable();
 
     sLog.outString("Initializing Scripts...");
     sScriptMgr.LoadScriptLibrary(HELLGROUND_SCRIPT_NAME);
@@ -1445,6 +1407,8 @@ void World::SetInitialWorldSettings()
     m_timers[WUPDATE_DELETECHARS].SetInterval(DAY*IN_MILISECONDS); // check for chars to delete every day
     m_timers[WUPDATE_OLDMAILS].SetInterval(getConfig(CONFIG_RETURNOLDMAILS_INTERVAL)*1000);
     m_timers[WUPDATE_ACTIVE_BANS].SetInterval(getConfig(CONFIG_ACTIVE_BANS_UPDATE_TIME));
+    m_timers[WUPDATE_OPCODE_STATS].SetInterval(getConfig(CONFIG_SESSION_UPDATE_OPCODE_STATS_DUMP)*MINUTE*IN_MILISECONDS);
+    m_timers[WUPDATE_WHO_LIST].SetInterval(getConfig(CONFIG_WHO_LIST_UPDATE_INTERVAL));
 
     //to set mailtimer to return mails every day between 4 and 5 am
     //mailtimer is increased when updating auctions
@@ -1494,6 +1458,9 @@ void World::SetInitialWorldSettings()
     sLog.outString("Loading Warden Data..." );
     sWardenDataStorage.Init();
 
+    if (getConfig(CONFIG_WARDEN_ENABLED) && getConfig(CONFIG_WARDEN_VERIFY_THREADS) && m_warden.activate(getConfig(CONFIG_WARDEN_VERIFY_THREADS)) == -1)
+        sLog.outString("Couldn't activate Warden verify threads, responses will be verified by sessions");
+
     sLog.outString("Cleanup deleted characters");
     CleanupDeletedChars();
 
@@ -1683,8 +1650,7 @@ void World::Update(uint32 diff)
         diffRecorder.RecordTimeFor("UpdateSessions");
 
         // Update groups
-        for (ObjectMgr::GroupSet::iterator itr = sObjectMgr.GetGroupSetBegin(); itr != sObjectMgr.GetGroupSetEnd(); ++itr)
-            (*itr)->Update(diff);
+        sObjectMgr.UpdateGroups(diff);
 
         diffRecorder.RecordTimeFor("UpdateGroups");
     }
@@ -1781,6 +1747,10 @@ void World::Update(uint32 diff)
 
     diffRecorder.RecordTimeFor("MapManager::update");
 
+    // map threads are done, receivers of returned mails can be touched safely
+    ProcessMailReturns();
+    diffRecorder.RecordTimeFor("ProcessMailReturns");
+
     if (accumulateMapDiff)
     {
         MAP_UPDATE_DIFF(MapUpdateDiff().PrintCumulativeMapUpdateDiff())
@@ -1836,6 +1806,25 @@ void World::Update(uint32 diff)
         stmt.addUInt8(PUNISHMENT_TROLLMUTE);
         stmt.Execute();
     }
+
+    if (getConfig(CONFIG_SESSION_UPDATE_OPCODE_STATS_DUMP) && sOpcodeStats.IsEnabled() && m_timers[WUPDATE_OPCODE_STATS].Passed())
+    {
+        m_timers[WUPDATE_OPCODE_STATS].Reset();
+
+        std::vector<std::string> report;
+        sOpcodeStats.BuildReport(20, report);
+
+        sLog.outLog(LOG_DIFF, "Opcode handler stats:");
+        for (std::vector<std::string>::const_iterator itr = report.begin(); itr != report.end(); ++itr)
+            sLog.outLog(LOG_DIFF, "  %s", itr->c_str());
+    }
+
+    // rebuilt outside of UpdateSessions, where CMSG_WHO queries read it
+    if (m_timers[WUPDATE_WHO_LIST].Passed())
+    {
+        m_timers[WUPDATE_WHO_LIST].Reset();
+        sWhoListCache.Update();
+    }
     /// </ul>
 
     // update the instance reset times
@@ -1862,7 +1851,30 @@ void World::UpdateSessions(const uint32 & diff)
         AddSession_ (sess);
 
     if (sessionThreads)
-        tbb::parallel_for(tbb::blocked_range<int>(0, m_sessions.size(), m_sessions.size()/sessionThreads), SessionsUpdater(&m_sessions, diff));
+    {
+        m_sessionUpdateList.clear();
+        for (SessionMap::iterator itr = m_sessions.begin(); itr != m_sessions.end(); ++itr)
+            if (itr->second)
+                m_sessionUpdateList.push_back(itr);
+
+        m_sessionUpdateResult.assign(m_sessionUpdateList.size(), 1);
+
+        if (!m_sessionUpdateList.empty())
+        {
+            size_t grain = std::max<size_t>(1, m_sessionUpdateList.size() / sessionThreads);
+            tbb::parallel_for(tbb::blocked_range<int>(0, m_sessionUpdateList.size(), grain), SessionsUpdater(m_sessionUpdateList, m_sessionUpdateResult, diff));
+        }
+
+        ///- remove not active sessions from the list
+        for (size_t i = 0; i < m_sessionUpdateList.size(); ++i)
+        {
+            if (!m_sessionUpdateResult[i])
+            {
+                RemoveQueuedPlayer(m_sessionUpdateList[i]->second);
+                AddSessionToRemove(m_sessionUpdateList[i]);
+            }
+        }
+    }
     else
     {
         ///- Then send an update signal to remaining ones
@@ -2504,6 +2516,17 @@ void World::ProcessCliCommands()
         zprint("TC> ");
 }
 
+void World::ProcessMailReturns()
+{
+    MailReturnHolder* holder;
+    while (mailReturnQueue.next(holder))
+    {
+        holder->m_draft->SendReturnToSender(holder->m_senderAccount, holder->m_senderGuid, holder->m_receiverGuid);
+        delete holder->m_draft;
+        delete holder;
+    }
+}
+
 void World::InitResultQueue()
 {
 
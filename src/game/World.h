@@ -34,6 +34,7 @@
 #include "DelayExecutor.h"
 #include "QueryResult.h"
 #include "WorldSession.h"
+#include "ObjectGuid.h"
 
 #include <map>
 #include <set>
@@ -52,6 +53,7 @@ class SqlResultQueue;
 class QueryResult;
 class WorldSocket;
 class AntiCheat;
+class MailDraft;
 
 // ServerMessages.dbc
 enum ServerMessageType
@@ -91,6 +93,8 @@ enum WorldTimers
     WUPDATE_DELETECHARS     = 9,
     WUPDATE_OLDMAILS        = 10,
     WUPDATE_ACTIVE_BANS     = 11,
+    WUPDATE_OPCODE_STATS    = 12,
+    WUPDATE_WHO_LIST        = 13,
 
     WUPDATE_COUNT
 };
@@ -116,6 +120,7 @@ enum WorldConfigs
     CONFIG_UPTIME_UPDATE,
 
     CONFIG_NUMTHREADS,
+    CONFIG_STARTUP_LOADER_THREADS,
     CONFIG_MAPUPDATE_MAXVISITORS,
     CONFIG_CUMULATIVE_LOG_METHOD,
 
@@ -124,6 +129,9 @@ enum WorldConfigs
     CONFIG_SESSION_UPDATE_VERBOSE_LOG,
     CONFIG_SESSION_UPDATE_IDLE_KICK,
     CONFIG_SESSION_UPDATE_MIN_LOG_DIFF,
+    CONFIG_SESSION_UPDATE_OPCODE_STATS,
+    CONFIG_SESSION_UPDATE_OPCODE_STATS_DUMP,
+    CONFIG_SESSION_UPDATE_OPCODE_STATS_SLOW,
     CONFIG_INTERVAL_LOG_UPDATE,
     CONFIG_MIN_LOG_UPDATE,
 
@@ -182,6 +190,7 @@ enum WorldConfigs
     CONFIG_ENABLE_SORT_AUCTIONS,
     CONFIG_AUTOBROADCAST_INTERVAL,
     CONFIG_GROUPLEADER_RECONNECT_PERIOD,
+    CONFIG_GROUP_MEMBER_STATS_INTERVAL,
     CONFIG_INSTANCE_RESET_TIME_HOUR,
     CONFIG_INSTANCE_UNLOAD_DELAY,
     CONFIG_MAIL_DELIVERY_DELAY,
@@ -190,8 +199,10 @@ enum WorldConfigs
     CONFIG_GM_MAIL,
     CONFIG_RETURNOLDMAILS_MODE,
     CONFIG_RETURNOLDMAILS_INTERVAL,
+    CONFIG_RETURNOLDMAILS_CHUNK_SIZE,
     CONFIG_GROUP_XP_DISTANCE,
     CONFIG_MAX_WHO,
+    CONFIG_WHO_LIST_UPDATE_INTERVAL,
     CONFIG_MIN_PETITION_SIGNS,
     CONFIG_NO_RESET_TALENT_COST,
     CONFIG_QUEST_LOW_LEVEL_HIDE_DIFF,
@@ -352,6 +363,7 @@ enum WorldConfigs
     CONFIG_TARGET_POS_RECHECK_TIMER,
     CONFIG_WAYPOINT_MOVEMENT_PATHFINDING_ON_CONTINENTS,
     CONFIG_WAYPOINT_MOVEMENT_PATHFINDING_IN_INSTANCES,
+    CONFIG_CHASE_PATH_BUDGET,
 
     // CoreBalancer
     CONFIG_COREBALANCER_ENABLED,
@@ -374,6 +386,7 @@ enum WorldConfigs
     CONFIG_WARDEN_CHECK_INTERVAL_MAX,
     CONFIG_WARDEN_MEM_CHECK_MAX,
     CONFIG_WARDEN_RANDOM_CHECK_MAX,
+    CONFIG_WARDEN_VERIFY_THREADS,
     CONFIG_ENABLE_PASSIVE_ANTICHEAT,
     CONFIG_ANTICHEAT_CUMULATIVE_DELAY,
 
@@ -552,6 +565,18 @@ struct CliCommandHolder
     ~CliCommandHolder() { delete[] m_command; }
 };
 
+/// Expired mail returned by map thread, sent on world thread because it allocates mail id and may fill other player mailbox
+struct MailReturnHolder
+{
+    MailDraft* m_draft;
+    uint32 m_senderAccount;
+    ObjectGuid m_senderGuid;
+    ObjectGuid m_receiverGuid;
+
+    MailReturnHolder(MailDraft* draft, uint32 senderAccount, ObjectGuid senderGuid, ObjectGuid receiverGuid)
+        : m_draft(draft), m_senderAccount(senderAccount), m_senderGuid(senderGuid), m_receiverGuid(receiverGuid) {}
+};
+
 // ye place for this sucks
 #define MAX_PVP_RANKS 14
 
@@ -576,7 +601,9 @@ enum CumulateMapDiff
 
     DIFF_MAP_SPECIAL_DATA_UPDATE = 10,
 
-    DIFF_MAX_CUMULATIVE_INFO     = 11
+    DIFF_CHASE_PATH_DEFERRED     = 11,                      // count of chase paths over budget, not time
+
+    DIFF_MAX_CUMULATIVE_INFO     = 12
 };
 
 typedef ACE_Atomic_Op<ACE_Thread_Mutex, uint32> atomic_uint;
@@ -666,6 +693,7 @@ class HELLGROUND_EXPORT World
         ~World();
 
         DelayExecutor m_ac;
+        DelayExecutor m_warden;                             // verifies warden responses
 
         uint32 m_honorRanks[MAX_PVP_RANKS];
 
@@ -837,6 +865,13 @@ class HELLGROUND_EXPORT World
         void UpdateResultQueue();
         void InitResultQueue();
 
+        // draft is deleted after sending
+        void QueueMailReturn(MailDraft* draft, uint32 senderAccount, ObjectGuid senderGuid, ObjectGuid receiverGuid)
+        {
+            mailReturnQueue.add(new MailReturnHolder(draft, senderAccount, senderGuid, receiverGuid));
+        }
+        void ProcessMailReturns();
+
         void ForceGameEventUpdate();
 
         void UpdateRealmCharCount(uint32 accid);
@@ -910,6 +945,8 @@ class HELLGROUND_EXPORT World
         uint32 sessionThreads;
 
         std::list<SessionMap::iterator> removedSessions;
+        std::vector<SessionMap::iterator> m_sessionUpdateList; // snapshot of m_sessions for parallel update
+        std::vector<uint8> m_sessionUpdateResult;              // per snapshot entry: 1 if session should be kept
 
         //atomic op counter for active scripts amount
         ACE_Atomic_Op<ACE_Thread_Mutex, long> m_scheduledScripts;
@@ -965,6 +1002,9 @@ class HELLGROUND_EXPORT World
         // CLI command holder to be thread safe
         ACE_Based::LockedQueue<CliCommandHolder*, ACE_Thread_Mutex> cliCmdQueue;
 
+        // mails returned by map threads
+        ACE_Based::LockedQueue<MailReturnHolder*, ACE_Thread_Mutex> mailReturnQueue;
+
         // next daily quests reset time
         time_t m_NextDailyQuestReset;
 
@@ -994,33 +1034,21 @@ extern uint32 realmID;
 class SessionsUpdater
 {
 private:
-    SessionMap * sessions;
+    std::vector<SessionMap::iterator> const& sessions;
+    std::vector<uint8>& results;
     uint32 diff;
 
 public:
-    SessionsUpdater(SessionMap * sess, uint32 diff) : sessions(sess), diff(diff) {}
+    SessionsUpdater(std::vector<SessionMap::iterator> const& sess, std::vector<uint8>& res, uint32 diff) : sessions(sess), results(res), diff(diff) {}
 
+    // every range writes only its own result slots, removing is done afterwards by World::UpdateSessions()
     void operator () (const tbb::blocked_range<int>& r) const
     {
-        SessionMap::iterator itr = sessions->begin();
-        advance(itr, r.begin());
-        SessionMap::iterator itrEnd = sessions->begin();
-        advance(itrEnd, r.end());
-
-        for (; itr != itrEnd; ++itr)
+        for (int i = r.begin(); i != r.end(); ++i)
         {
-            if (!itr->second)
-                continue;
-
-            ///- and remove not active sessions from the list
-            WorldSession * pSession = itr->second;
+            WorldSession * pSession = sessions[i]->second;
             WorldSessionFilter updater(pSession);
-            if (!pSession->Update(diff, updater))    // As interval = 0
-            {
-                sWorld.RemoveQueuedPlayer(pSession);
-
-                sWorld.AddSessionToRemove(itr);
-            }
+            results[i] = pSession->Update(diff, updater) ? 1 : 0;    // As interval = 0
         }
     }
 };
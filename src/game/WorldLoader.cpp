@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2008-2014 Hellground <http://hellground.net/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "WorldLoader.h"
+
+#include "Database/DatabaseEnv.h"
+#include "Log.h"
+#include "ProgressBar.h"
+#include "Threading.h"
+#include "Timer.h"
+
+class WorldLoaderRunnable : public ACE_Based::Runnable
+{
+    public:
+        WorldLoaderRunnable(WorldLoader& loader) : m_loader(loader) {}
+
+        void run()
+        {
+            GameDataDatabase.ThreadStart();                    // let thread do safe mySQL requests (one connection call enough)
+
+            m_loader.WorkerLoop();
+
+            GameDataDatabase.ThreadEnd();
+        }
+
+    private:
+        WorldLoader& m_loader;
+};
+
+WorldLoader::WorldLoader() : m_remaining(0), m_totalTime(0), m_mutex(), m_condition(m_mutex)
+{
+}
+
+uint32 WorldLoader::AddTask(char const* name, LoadFunction function, TaskList const& depends)
+{
+    uint32 id = m_tasks.size();
+    m_tasks.push_back(LoaderTask(name, function));
+
+    for (TaskList::const_iterator itr = depends.begin(); itr != depends.end(); ++itr)
+    {
+        // tasks can depend only on already registered ones, so graph can't contain cycles
+        ASSERT(*itr < id);
+
+        m_tasks[*itr].dependents.push_back(id);
+        ++m_tasks[id].waitingFor;
+    }
+
+    return id;
+}
+
+void WorldLoader::ExecuteTask(LoaderTask& task)
+{
+    sLog.outString("Loading %s...", task.name.c_str());
+
+    uint32 startTime = WorldTimer::getMSTime();
+    task.function();
+    task.elapsed = WorldTimer::getMSTimeDiffToNow(startTime);
+}
+
+void WorldLoader::Run(uint32 threads)
+{
+    uint32 startTime = WorldTimer::getMSTime();
+
+    if (threads < 2)
+    {
+        for (std::vector<LoaderTask>::iterator itr = m_tasks.begin(); itr != m_tasks.end(); ++itr)
+            ExecuteTask(*itr);
+
+        m_totalTime = WorldTimer::getMSTimeDiffToNow(startTime);
+        return;
+    }
+
+    m_remaining = m_tasks.size();
+    for (uint32 i = 0; i < m_tasks.size(); ++i)
+        if (!m_tasks[i].waitingFor)
+            m_ready.push_back(i);
+
+    // bars from concurrent loaders would overwrite each other
+    bool showBars = BarGoLink::GetOutputState();
+    BarGoLink::SetOutputState(false);
+
+    sLog.outString("Running %u startup loaders on %u threads...", uint32(m_tasks.size()), threads);
+
+    std::vector<ACE_Based::Thread*> workers;
+    for (uint32 i = 0; i < threads; ++i)
+        workers.push_back(new ACE_Based::Thread(new WorldLoaderRunnable(*this)));
+
+    for (std::vector<ACE_Based::Thread*>::iterator itr = workers.begin(); itr != workers.end(); ++itr)
+    {
+        (*itr)->wait();
+        delete *itr;
+    }
+
+    BarGoLink::SetOutputState(showBars);
+
+    m_totalTime = WorldTimer::getMSTimeDiffToNow(startTime);
+}
+
+void WorldLoader::WorkerLoop()
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_mutex);
+
+    while (m_remaining)
+    {
+        if (m_ready.empty())
+        {
+            m_condition.wait();
+            continue;
+        }
+
+        LoaderTask& task = m_tasks[m_ready.front()];
+        m_ready.pop_front();
+
+        m_mutex.release();
+        ExecuteTask(task);
+        m_mutex.acquire();
+
+        for (TaskList::const_iterator itr = task.dependents.begin(); itr != task.dependents.end(); ++itr)
+            if (!--m_tasks[*itr].waitingFor)
+                m_ready.push_back(*itr);
+
+        --m_remaining;
+        m_condition.broadcast();
+    }
+}
+
+static bool SortByElapsed(std::pair<uint32, std::string const*> const& a, std::pair<uint32, std::string const*> const& b)
+{
+    return a.first > b.first;
+}
+
+void WorldLoader::PrintReport() const
+{
+    std::vector<std::pair<uint32, std::string const*> > times;
+    uint32 sum = 0;
+
+    for (std::vector<LoaderTask>::const_iterator itr = m_tasks.begin(); itr != m_tasks.end(); ++itr)
+    {
+        times.push_back(std::make_pair(itr->elapsed, &itr->name));
+        sum += itr->elapsed;
+    }
+
+    std::sort(times.begin(), times.end(), SortByElapsed);
+
+    sLog.outString();
+    sLog.outString("Startup loaders: %u ms total, %u ms summed over %u tasks", m_totalTime, sum, uint32(m_tasks.size()));
+    for (std::vector<std::pair<uint32, std::string const*> >::const_iterator itr = times.begin(); itr != times.end(); ++itr)
+        sLog.outString("  %8u ms  %s", itr->first, itr->second->c_str());
+    sLog.outString();
+}
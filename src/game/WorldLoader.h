@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2008-2014 Hellground <http://hellground.net/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef HELLGROUND_WORLDLOADER_H
+#define HELLGROUND_WORLDLOADER_H
+
+#include <ace/Thread_Mutex.h>
+#include <ace/Condition_Thread_Mutex.h>
+
+#include "Common.h"
+
+#include <deque>
+#include <functional>
+#include <vector>
+
+/// Startup loaders declared as tasks with explicit dependencies.
+/// Every task is started only after all tasks it depends on finished,
+/// independent tasks are executed on a pool of worker threads.
+class WorldLoader
+{
+    public:
+        typedef std::function<void ()> LoadFunction;
+        typedef std::vector<uint32> TaskList;
+
+        WorldLoader();
+
+        /// Register a loader, dependencies must be already registered tasks.
+        /// returns id of the task to be used in dependency lists
+        uint32 AddTask(char const* name, LoadFunction function, TaskList const& depends = TaskList());
+
+        /// Execute all registered tasks and wait for them to finish,
+        /// with less than 2 threads tasks are executed in registration order
+        void Run(uint32 threads);
+
+        /// Print time spent in each task, longest first
+        void PrintReport() const;
+
+    private:
+        friend class WorldLoaderRunnable;
+
+        struct LoaderTask
+        {
+            LoaderTask(char const* n, LoadFunction f) : name(n), function(f), waitingFor(0), elapsed(0) {}
+
+            std::string name;
+            LoadFunction function;
+            TaskList dependents;
+            uint32 waitingFor;
+            uint32 elapsed;
+        };
+
+        void ExecuteTask(LoaderTask& task);
+        void WorkerLoop();
+
+        std::vector<LoaderTask> m_tasks;
+        std::deque<uint32> m_ready;
+        uint32 m_remaining;
+        uint32 m_totalTime;
+
+        ACE_Thread_Mutex m_mutex;
+        ACE_Condition_Thread_Mutex m_condition;
+};
+
+#endif
@@ -48,6 +48,7 @@
 #include "WardenChat.h"
 #include "luaengine/HookMgr.h"
 #include "GuildMgr.h"
+#include "OpcodeStats.h"
 
 bool MapSessionFilter::Process(WorldPacket * packet)
 {
@@ -265,6 +266,9 @@ void WorldSession::QueuePacket(WorldPacket* new_packet)
         i->second.SetCurrent(0);
     }
 
+    if (sOpcodeStats.IsEnabled())
+        new_packet->SetReceivedTime(OpcodeStats::GetTimeUS());
+
     _recvQueue.add(new_packet);
 }
 
@@ -350,6 +354,7 @@ bool WorldSession::Update(uint32 diff, PacketFilter& updater)
 {
     RecordSessionTimeDiff(NULL);
     uint32 verbose = sWorld.getConfig(CONFIG_SESSION_UPDATE_VERBOSE_LOG);
+    bool opcodeStats = sOpcodeStats.IsEnabled();
     std::vector<VerboseLogInfo> packetOpcodeInfo;
 
     if (updater.ProcessTimersUpdate())
@@ -385,6 +390,8 @@ bool WorldSession::Update(uint32 diff, PacketFilter& updater)
     {
         while (m_Socket && !m_Socket->IsClosed() && _recvQueue.next(packet, updater))
         {
+            uint64 handleStart = opcodeStats ? OpcodeStats::GetTimeUS() : 0;
+
             if (verbose > 0)
             {
                 RecordVerboseTimeDiff(true);
@@ -394,6 +401,21 @@ bool WorldSession::Update(uint32 diff, PacketFilter& updater)
             else
                 ProcessPacket(packet);
 
+            if (opcodeStats)
+            {
+                uint64 handleEnd = OpcodeStats::GetTimeUS();
+                uint64 received = packet->GetReceivedTime();
+                uint64 queueTime = received && received < handleStart ? handleStart - received : 0;
+                uint64 handleTime = handleEnd > handleStart ? handleEnd - handleStart : 0;
+                sOpcodeStats.RecordPacket(packet->GetOpcode(), queueTime, handleTime, packet->size());
+
+                uint32 slowHandler = sWorld.getConfig(CONFIG_SESSION_UPDATE_OPCODE_STATS_SLOW);
+                if (slowHandler && handleTime >= slowHandler * 1000)
+                    sLog.outLog(LOG_DIFF, "Slow handler %s (0x%.4X): %u us, queued %u us, %u bytes. Accid %u, player %s",
+                        LookupOpcodeName(packet->GetOpcode()), packet->GetOpcode(), uint32(handleTime), uint32(queueTime),
+                        uint32(packet->size()), GetAccountId(), GetPlayerName());
+            }
+
             delete packet;
         }
     }
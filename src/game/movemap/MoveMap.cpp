@@ -24,8 +24,21 @@
 #include "MoveMap.h"
 #include "MoveMapSharedDefines.h"
 
+#include <ace/Atomic_Op.h>
+#include <ace/TSS_T.h>
+
 namespace MMAP
 {
+    struct NavMeshThreadSlot
+    {
+        NavMeshThreadSlot() : index(0) {}
+
+        uint32 index;
+    };
+
+    static ACE_TSS<NavMeshThreadSlot> threadSlot;
+    static ACE_Atomic_Op<ACE_Thread_Mutex, long> threadCounter(0);
+
     // ######################## MMapFactory ########################
     // our global singelton copy
     MMapManager *g_MMapManager = NULL;
@@ -109,12 +122,17 @@ namespace MMAP
 
     bool MMapManager::loadMap(uint32 mapId, int32 x, int32 y)
     {
-        // make sure the mmap is loaded and ready to load tiles
-        if(!loadMapData(mapId))
-            return false;
+        MMapData* mmap = NULL;
+        {
+            ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, false);
 
-        // get this mmap data
-        MMapData* mmap = loadedMMaps[mapId];
+            // make sure the mmap is loaded and ready to load tiles
+            if(!loadMapData(mapId))
+                return false;
+
+            // get this mmap data
+            mmap = loadedMMaps[mapId];
+        }
         ASSERT(mmap->navMesh);
 
         // check if we already have this tile loaded
@@ -192,15 +210,21 @@ namespace MMAP
 
     bool MMapManager::unloadMap(uint32 mapId, int32 x, int32 y)
     {
-        // check if we have this map loaded
-        if (loadedMMaps.find(mapId) == loadedMMaps.end())
+        MMapData* mmap = NULL;
         {
-            // file may not exist, therefore not loaded
-            sLog.outDebug("MMAP:unloadMap: Asked to unload not loaded navmesh map. %03u%02i%02i.mmtile", mapId, x, y);
-            return false;
-        }
+            ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, false);
 
-        MMapData* mmap = loadedMMaps[mapId];
+            // check if we have this map loaded
+            MMapDataSet::iterator itr = loadedMMaps.find(mapId);
+            if (itr == loadedMMaps.end())
+            {
+                // file may not exist, therefore not loaded
+                sLog.outDebug("MMAP:unloadMap: Asked to unload not loaded navmesh map. %03u%02i%02i.mmtile", mapId, x, y);
+                return false;
+            }
+
+            mmap = itr->second;
+        }
 
         // check if we have this tile loaded
         uint32 packedGridPos = packTileID(x, y);
@@ -235,6 +259,8 @@ namespace MMAP
 
     bool MMapManager::unloadMap(uint32 mapId)
     {
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, false);
+
         if (loadedMMaps.find(mapId) == loadedMMaps.end())
         {
             // file may not exist, therefore not loaded
@@ -257,6 +283,7 @@ namespace MMAP
             }
         }
 
+        ++m_unloadGeneration;
         delete mmap;
         loadedMMaps.erase(mapId);
         sLog.outDetail("MMAP:unloadMap: Unloaded %03i.mmap", mapId);
@@ -264,62 +291,111 @@ namespace MMAP
         return true;
     }
 
-    bool MMapManager::unloadMapInstance(uint32 mapId, uint32 instanceId)
+    dtNavMesh const* MMapManager::GetNavMesh(uint32 mapId)
     {
-        // check if we have this map loaded
-        if (loadedMMaps.find(mapId) == loadedMMaps.end())
-        {
-            // file may not exist, therefore not loaded
-            sLog.outDebug("MMAP:unloadMapInstance: Asked to unload not loaded navmesh map %03u", mapId);
-            return false;
-        }
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, NULL);
 
-        MMapData* mmap = loadedMMaps[mapId];
-        if (mmap->navMeshQueries.find(instanceId) == mmap->navMeshQueries.end())
+        MMapDataSet::const_iterator itr = loadedMMaps.find(mapId);
+        if (itr == loadedMMaps.end())
+            return NULL;
+
+        return itr->second->navMesh;
+    }
+
+    NavMeshThreadData* MMapManager::GetThreadData(uint32 mapId)
+    {
+        uint32 thread = GetThreadIndex();
+
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, NULL);
+
+        MMapDataSet::const_iterator itr = loadedMMaps.find(mapId);
+        if (itr == loadedMMaps.end())
+            return NULL;
+
+        MMapData* mmap = itr->second;
+        NavMeshQuerySet::const_iterator query = mmap->navMeshQueries.find(thread);
+        if (query != mmap->navMeshQueries.end())
+            return query->second;
+
+        // allocate mesh query
+        dtNavMeshQuery* navMeshQuery = dtAllocNavMeshQuery();
+        ASSERT(navMeshQuery);
+        if(DT_SUCCESS != navMeshQuery->init(mmap->navMesh, 1024))
         {
-            sLog.outDebug("MMAP:unloadMapInstance: Asked to unload not loaded dtNavMeshQuery mapId %03u instanceId %u", mapId, instanceId);
-            return false;
+            dtFreeNavMeshQuery(navMeshQuery);
+            sLog.outLog(LOG_DEFAULT, "ERROR: MMAP:GetThreadData: Failed to initialize dtNavMeshQuery for mapId %03u thread %u", mapId, thread);
+            return NULL;
         }
 
-        dtNavMeshQuery* query = mmap->navMeshQueries[instanceId];
+        sLog.outDetail("MMAP:GetThreadData: created dtNavMeshQuery for mapId %03u thread %u", mapId, thread);
 
-        dtFreeNavMeshQuery(query);
-        mmap->navMeshQueries.erase(instanceId);
-        sLog.outDetail("MMAP:unloadMapInstance: Unloaded mapId %03u instanceId %u", mapId, instanceId);
+        NavMeshThreadData* data = new NavMeshThreadData(navMeshQuery);
+        mmap->navMeshQueries.insert(std::pair<uint32, NavMeshThreadData*>(thread, data));
+        return data;
+    }
 
-        return true;
+    dtNavMeshQuery const* MMapManager::GetNavMeshQuery(uint32 mapId)
+    {
+        NavMeshThreadData* data = GetThreadData(mapId);
+        return data ? data->query : NULL;
     }
 
-    dtNavMesh const* MMapManager::GetNavMesh(uint32 mapId)
+    uint32 MMapManager::GetThreadIndex()
     {
-        if (loadedMMaps.find(mapId) == loadedMMaps.end())
-            return NULL;
+        NavMeshThreadSlot* slot = threadSlot.ts_object();
+        if (!slot)
+        {
+            slot = new NavMeshThreadSlot;
+            threadSlot.ts_object(slot);
+        }
 
-        return loadedMMaps[mapId]->navMesh;
+        if (!slot->index)
+            slot->index = ++threadCounter;
+
+        return slot->index;
     }
 
-    dtNavMeshQuery const* MMapManager::GetNavMeshQuery(uint32 mapId, uint32 instanceId)
+    // ######################## NavMeshThreadData ########################
+    static uint32 PathCacheSlot(dtPolyRef startPoly, dtPolyRef endPoly)
     {
-        if (loadedMMaps.find(mapId) == loadedMMaps.end())
-            return NULL;
+        uint64 key = uint64(startPoly) * 0x9E3779B97F4A7C15ULL ^ uint64(endPoly);
+        return uint32(key ^ (key >> 32)) % NAV_PATH_CACHE_SIZE;
+    }
 
-        MMapData* mmap = loadedMMaps[mapId];
-        if (mmap->navMeshQueries.find(instanceId) == mmap->navMeshQueries.end())
+    bool NavMeshThreadData::FindCachedPath(dtNavMesh const* navMesh, dtPolyRef startPoly, dtPolyRef endPoly, dtQueryFilter const& filter,
+                                           dtPolyRef* path, uint32& length, uint32 maxLength)
+    {
+        NavPathCacheEntry& entry = pathCache[PathCacheSlot(startPoly, endPoly)];
+        if (!entry.length || entry.length > maxLength || entry.startPoly != startPoly || entry.endPoly != endPoly ||
+            entry.includeFlags != filter.getIncludeFlags() || entry.excludeFlags != filter.getExcludeFlags())
+            return false;
+
+        // tiles on the way could be reloaded, then refs have different salt
+        for (uint32 i = 0; i < entry.length; ++i)
         {
-             // allocate mesh query
-            dtNavMeshQuery* query = dtAllocNavMeshQuery();
-            ASSERT(query);
-            if(DT_SUCCESS != query->init(mmap->navMesh, 1024))
+            if (!navMesh->isValidPolyRef(entry.path[i]))
             {
-                dtFreeNavMeshQuery(query);
-                sLog.outLog(LOG_DEFAULT, "ERROR: MMAP:GetNavMeshQuery: Failed to initialize dtNavMeshQuery for mapId %03u instanceId %u", mapId, instanceId);
-                return NULL;
+                entry.length = 0;
+                return false;
             }
-
-            sLog.outDetail("MMAP:GetNavMeshQuery: created dtNavMeshQuery for mapId %03u instanceId %u", mapId, instanceId);
-            mmap->navMeshQueries.insert(std::pair<uint32, dtNavMeshQuery*>(instanceId, query));
         }
 
-        return mmap->navMeshQueries[instanceId];
+        memcpy(path, entry.path, entry.length * sizeof(dtPolyRef));
+        length = entry.length;
+        return true;
+    }
+
+    void NavMeshThreadData::CachePath(dtPolyRef startPoly, dtPolyRef endPoly, dtQueryFilter const& filter, dtPolyRef const* path, uint32 length)
+    {
+        if (!length || length > NAV_PATH_CACHE_MAX_LENGTH)
+            return;
+
+        NavPathCacheEntry& entry = pathCache[PathCacheSlot(startPoly, endPoly)];
+        entry.startPoly = startPoly;
+        entry.endPoly = endPoly;
+        entry.includeFlags = filter.getIncludeFlags();
+        entry.excludeFlags = filter.getExcludeFlags();
+        entry.length = length;
+        memcpy(entry.path, path, length * sizeof(dtPolyRef));
     }
 }
@@ -20,6 +20,9 @@
 #ifndef HELLGROUND_MOVE_MAP_H
 #define HELLGROUND_MOVE_MAP_H
 
+#include <ace/Atomic_Op.h>
+#include <ace/Thread_Mutex.h>
+
 #include "Utilities/UnorderedMap.h"
 
 #include "../../dep/recastnavigation/Detour/Include/DetourAlloc.h"
@@ -41,7 +44,38 @@ inline void dtCustomFree(void* ptr)
 namespace MMAP
 {
     typedef UNORDERED_MAP<uint32, dtTileRef> MMapTileSet;
-    typedef UNORDERED_MAP<uint32, dtNavMeshQuery*> NavMeshQuerySet;
+
+    // size of poly path cache of every worker thread on every map
+    #define NAV_PATH_CACHE_SIZE         64
+    // must not be lower than MAX_PATH_LENGTH of PathFinder
+    #define NAV_PATH_CACHE_MAX_LENGTH   74
+
+    struct NavPathCacheEntry
+    {
+        dtPolyRef startPoly;
+        dtPolyRef endPoly;
+        uint16 includeFlags;
+        uint16 excludeFlags;
+        uint32 length;                                      // 0 for unused entry
+        dtPolyRef path[NAV_PATH_CACHE_MAX_LENGTH];
+    };
+
+    // dtNavMeshQuery with recently found poly paths, used only by single thread
+    struct NavMeshThreadData
+    {
+        NavMeshThreadData(dtNavMeshQuery* q) : query(q) { memset(pathCache, 0, sizeof(pathCache)); }
+        ~NavMeshThreadData() { dtFreeNavMeshQuery(query); }
+
+        // copies cached path between given polys into path, fails when any of its polys was unloaded meanwhile
+        bool FindCachedPath(dtNavMesh const* navMesh, dtPolyRef startPoly, dtPolyRef endPoly, dtQueryFilter const& filter,
+                            dtPolyRef* path, uint32& length, uint32 maxLength);
+        void CachePath(dtPolyRef startPoly, dtPolyRef endPoly, dtQueryFilter const& filter, dtPolyRef const* path, uint32 length);
+
+        dtNavMeshQuery* query;
+        NavPathCacheEntry pathCache[NAV_PATH_CACHE_SIZE];
+    };
+
+    typedef UNORDERED_MAP<uint32, NavMeshThreadData*> NavMeshQuerySet;
 
     // dummy struct to hold map's mmap data
     struct MMapData
@@ -50,7 +84,7 @@ namespace MMAP
         ~MMapData()
         {
             for (NavMeshQuerySet::iterator i = navMeshQueries.begin(); i != navMeshQueries.end(); ++i)
-                dtFreeNavMeshQuery(i->second);
+                delete i->second;
 
             if (navMesh)
                 dtFreeNavMesh(navMesh);
@@ -58,8 +92,9 @@ namespace MMAP
 
         dtNavMesh* navMesh;
 
-        // we have to use single dtNavMeshQuery for every instance, since those are not thread safe
-        NavMeshQuerySet navMeshQueries;     // instanceId to query
+        // dtNavMeshQuery is not thread safe, so every thread updating maps has its own
+        // shared by all instances of the map, they use the same navmesh
+        NavMeshQuerySet navMeshQueries;     // thread index to query
         MMapTileSet mmapLoadedTiles;        // maps [map grid coords] to [dtTile]
     };
 
@@ -71,26 +106,36 @@ namespace MMAP
     class MMapManager
     {
         public:
-            MMapManager() : loadedTiles(0) {}
+            MMapManager() : loadedTiles(0), m_unloadGeneration(0) {}
             ~MMapManager();
 
             bool loadMap(uint32 mapId, int32 x, int32 y);
             bool unloadMap(uint32 mapId, int32 x, int32 y);
             bool unloadMap(uint32 mapId);
-            bool unloadMapInstance(uint32 mapId, uint32 instanceId);
 
-            // the returned [dtNavMeshQuery const*] is NOT threadsafe
-            dtNavMeshQuery const* GetNavMeshQuery(uint32 mapId, uint32 instanceId);
+            // query and path cache of calling thread, valid until the map is unloaded
+            // must not be passed to other threads
+            NavMeshThreadData* GetThreadData(uint32 mapId);
+            dtNavMeshQuery const* GetNavMeshQuery(uint32 mapId);
             dtNavMesh const* GetNavMesh(uint32 mapId);
 
+            // small unique number of calling thread, never 0
+            static uint32 GetThreadIndex();
+
+            // changed by every map unload, thread data taken before a change may be already freed
+            uint32 GetUnloadGeneration() const { return uint32(m_unloadGeneration.value()); }
+
             uint32 getLoadedTilesCount() const { return loadedTiles; }
             uint32 getLoadedMapsCount() const { return loadedMMaps.size(); }
         private:
             bool loadMapData(uint32 mapId);
             uint32 packTileID(int32 x, int32 y);
 
+            // guards loadedMMaps and query sets, tiles are guarded by terrain grid locks
+            ACE_Thread_Mutex m_lock;
             MMapDataSet loadedMMaps;
             uint32 loadedTiles;
+            ACE_Atomic_Op<ACE_Thread_Mutex, long> m_unloadGeneration;
     };
 
     // static class
@@ -20,27 +20,23 @@
 #include "MoveMap.h"
 #include "GridMap.h"
 #include "Creature.h"
+#include "Map.h"
 #include "PathFinder.h"
 #include "Log.h"
 
+#include <ace/OS_NS_sys_time.h>
+
 #include "../recastnavigation/Detour/Include/DetourCommon.h"
 
 ////////////////// PathFinder //////////////////
 PathFinder::PathFinder(const Unit* owner) :
     m_polyLength(0), m_type(PATHFIND_BLANK),
     m_useStraightPath(false), m_forceDestination(false), m_pointPathLimit(MAX_POINT_PATH_LENGTH),
-    m_sourceUnit(owner), m_navMesh(NULL), m_navMeshQuery(NULL)
+    m_sourceUnit(owner), m_navMesh(NULL), m_navMeshQuery(NULL), m_threadData(NULL), m_queryThread(0), m_queryMapId(0), m_queryGeneration(0), m_cachedPath(false)
 {
     //DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::PathInfo for %u \n", m_sourceUnit->GetGUIDLow());
 
-    if (m_sourceUnit->GetTerrain() && m_sourceUnit->GetTerrain()->IsPathFindingEnabled())
-    {
-        uint32 mapId = m_sourceUnit->GetMapId();
-        MMAP::MMapManager* mmap = MMAP::MMapFactory::createOrGetMMapManager();
-        m_navMesh = mmap->GetNavMesh(mapId);
-        m_navMeshQuery = mmap->GetNavMeshQuery(mapId, m_sourceUnit->GetInstanceId());
-    }
-
+    // navmesh query is taken on first calculate(), most of finders (every spell has one) never need it
     createFilter();
 }
 
@@ -66,6 +62,8 @@ bool PathFinder::calculate(float destX, float destY, float destZ, bool forceDest
 
     m_forceDestination = forceDest;
 
+    updateNavMeshQuery();
+
     //DEBUG_FILTER_LOG(LOG_FILTER_PATHFINDING, "++ PathFinder::calculate() for %u \n", m_sourceUnit->GetGUIDLow());
 
     // make sure navMesh works - we can run on map w/o mmap
@@ -95,7 +93,16 @@ bool PathFinder::calculate(float destX, float destY, float destZ, bool forceDest
     else
     {
         // target moved, so we need to update the poly path
+        ACE_Time_Value startTime = ACE_OS::gettimeofday();
+        m_cachedPath = false;
+
         BuildPolyPath(start, dest);
+
+        if (m_sourceUnit->IsInWorld())
+        {
+            ACE_Time_Value elapsed = ACE_OS::gettimeofday() - startTime;
+            m_sourceUnit->GetMap()->CountPathfinding(uint64(elapsed.sec()) * 1000000 + elapsed.usec(), m_cachedPath);
+        }
         return true;
     }
 }
@@ -381,23 +388,30 @@ void PathFinder::BuildPolyPath(const Vector3 &startPos, const Vector3 &endPos)
         // free and invalidate old path data
         clear();
 
-        dtStatus dtResult = m_navMeshQuery->findPath(
-                startPoly,          // start polygon
-                endPoly,            // end polygon
-                startPoint,         // start position
-                endPoint,           // end position
-                &m_filter,           // polygon search filter
-                m_pathPolyRefs,     // [out] path
-                (int*)&m_polyLength,
-                MAX_PATH_LENGTH);   // max number of polygons in output path
-
-        if (!m_polyLength || dtResult != DT_SUCCESS)
+        // many units chase or charge between the same polygons, reuse path found for any of them
+        m_cachedPath = m_threadData->FindCachedPath(m_navMesh, startPoly, endPoly, m_filter, m_pathPolyRefs, m_polyLength, MAX_PATH_LENGTH);
+        if (!m_cachedPath)
         {
-            // only happens if we passed bad data to findPath(), or navmesh is messed up
-            sLog.outLog(LOG_DEFAULT, "ERROR: %u's Path Build failed: 0 length path", m_sourceUnit->GetGUIDLow());
-            BuildShortcut();
-            m_type = PATHFIND_NOPATH;
-            return;
+            dtStatus dtResult = m_navMeshQuery->findPath(
+                    startPoly,          // start polygon
+                    endPoly,            // end polygon
+                    startPoint,         // start position
+                    endPoint,           // end position
+                    &m_filter,           // polygon search filter
+                    m_pathPolyRefs,     // [out] path
+                    (int*)&m_polyLength,
+                    MAX_PATH_LENGTH);   // max number of polygons in output path
+
+            if (!m_polyLength || dtResult != DT_SUCCESS)
+            {
+                // only happens if we passed bad data to findPath(), or navmesh is messed up
+                sLog.outLog(LOG_DEFAULT, "ERROR: %u's Path Build failed: 0 length path", m_sourceUnit->GetGUIDLow());
+                BuildShortcut();
+                m_type = PATHFIND_NOPATH;
+                return;
+            }
+
+            m_threadData->CachePath(startPoly, endPoly, m_filter, m_pathPolyRefs, m_polyLength);
         }
     }
 
@@ -575,6 +589,34 @@ NavTerrain PathFinder::getNavTerrain(float x, float y, float z)
     }
 }
 
+void PathFinder::updateNavMeshQuery()
+{
+    // owner can be updated by different threads over time, query has to belong to the current one
+    uint32 thread = MMAP::MMapManager::GetThreadIndex();
+    uint32 mapId = m_sourceUnit->GetMapId();
+    MMAP::MMapManager* mmap = MMAP::MMapFactory::createOrGetMMapManager();
+
+    // unloaded map frees thread data of all threads, even if the same map is loaded again later
+    uint32 generation = mmap->GetUnloadGeneration();
+    if (m_queryThread == thread && m_queryMapId == mapId && m_queryGeneration == generation)
+        return;
+
+    m_queryThread = thread;
+    m_queryMapId = mapId;
+    m_queryGeneration = generation;
+    m_navMesh = NULL;
+    m_navMeshQuery = NULL;
+    m_threadData = NULL;
+
+    if (!m_sourceUnit->GetTerrain() || !m_sourceUnit->GetTerrain()->IsPathFindingEnabled())
+        return;
+
+    m_navMesh = mmap->GetNavMesh(mapId);
+    m_threadData = mmap->GetThreadData(mapId);
+    if (m_threadData)
+        m_navMeshQuery = m_threadData->query;
+}
+
 bool PathFinder::HaveTile(const Vector3 &p) const
 {
     int tx, ty;
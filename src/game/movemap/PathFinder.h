@@ -31,6 +31,11 @@ using Movement::PointsArray;
 
 class Unit;
 
+namespace MMAP
+{
+    struct NavMeshThreadData;
+}
+
 // 74*4.0f=296y  number_of_points*interval = max_path_len
 // this is way more than actual evade range
 // I think we can safely cut those down even more
@@ -95,6 +100,11 @@ class PathFinder
         const Unit* const       m_sourceUnit;       // the unit that is moving
         const dtNavMesh*        m_navMesh;          // the nav mesh
         const dtNavMeshQuery*   m_navMeshQuery;     // the nav mesh query used to find the path
+        MMAP::NavMeshThreadData* m_threadData;      // owner of m_navMeshQuery, with cache of recent paths
+        uint32                  m_queryThread;      // thread m_navMeshQuery belongs to
+        uint32                  m_queryMapId;       // map m_navMeshQuery was taken for
+        uint32                  m_queryGeneration;  // mmap unload generation m_navMeshQuery was taken in
+        bool                    m_cachedPath;       // last poly path was taken from cache
 
         dtQueryFilter m_filter;                     // use single filter for all movements, update it when needed
 
@@ -116,6 +126,8 @@ class PathFinder
         dtPolyRef getPolyByLocation(const float* point, float *distance) const;
         bool HaveTile(const Vector3 &p) const;
 
+        void updateNavMeshQuery();
+
         void BuildPolyPath(const Vector3 &startPos, const Vector3 &endPos);
         void BuildPointPath(const float *startPoint, const float *endPoint);
         void BuildShortcut();
@@ -0,0 +1,328 @@
+/*
+ * Copyright (C) 2008-2014 Hellground <http://hellground.net/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/// \addtogroup bench Container microbenchmarks
+/// @{
+/// \file
+
+#include "Bench.h"
+#include "Utilities/SlotList.h"
+
+#include <list>
+#include <map>
+#include <vector>
+
+// Unit::_UpdateSpells and GetTotalAuraModifier with std::multimap + std::list (before) and with
+// update list, parked passive auras and SlotList per aura type (now), on a raid-like aura set
+
+#define BENCH_AURA_TYPES    40
+#define BENCH_UNITS         2000
+#define BENCH_TICKS         600
+#define BENCH_DIFF          100
+
+// state of Aura used by Update(), IsExpired() and NeedsUpdate()
+struct BenchAura
+{
+    BenchAura(uint32 _id, uint32 _type, int32 _duration, int32 _amplitude, int32 _amount) :
+        id(_id), type(_type), duration(_duration), permanent(_duration < 0), amplitude(_amplitude),
+        periodicTimer(_amplitude), amount(_amount), ticks(0), slot(-1) {}
+
+    bool IsExpired() const { return !duration && !permanent; }
+    bool NeedsUpdate() const { return duration > 0 || IsExpired() || amplitude; }
+
+    void Update(uint32 diff)
+    {
+        if (duration > 0)
+        {
+            duration -= diff;
+            if (duration < 0)
+                duration = 0;
+        }
+
+        if (amplitude)
+        {
+            periodicTimer -= diff;
+            if (periodicTimer <= 0)
+            {
+                ++ticks;
+                periodicTimer += amplitude;
+            }
+        }
+    }
+
+    uint32 id;
+    uint32 type;
+    int32 duration;
+    bool permanent;
+    int32 amplitude;
+    int32 periodicTimer;
+    int32 amount;
+    uint32 ticks;
+    int32 slot;
+};
+
+typedef std::pair<uint32, uint8> BenchAuraKey;
+typedef std::multimap<BenchAuraKey, BenchAura*> BenchAuraMap;
+
+// talents and passives, long buffs, dots reapplied at expire and permanent regen effects
+static void AddBenchAuras(uint32 unit, std::vector<BenchAura*>& auras)
+{
+    for (uint32 i = 0; i < 50; ++i)
+        auras.push_back(new BenchAura(1000 + i, i % 30, -1, 0, int32(i + unit % 7)));
+    for (uint32 i = 0; i < 6; ++i)
+        auras.push_back(new BenchAura(2000 + i, 30 + i, 1800000, 0, 10));
+    for (uint32 i = 0; i < 4; ++i)
+        auras.push_back(new BenchAura(3000 + i, 36, 5000 + 2500 * i + unit % 1000, 1000 + 500 * i, 5));
+    for (uint32 i = 0; i < 2; ++i)
+        auras.push_back(new BenchAura(4000 + i, 37 + i, -1, 2000, 1));
+}
+
+static uint32 const queryTypes[] = { 0, 3, 5, 8, 11, 14, 17, 20, 23, 30, 33, 36 };
+
+class OldAuraUnit
+{
+    public:
+        explicit OldAuraUnit(uint32 unit) : m_ticks(0)
+        {
+            std::vector<BenchAura*> auras;
+            AddBenchAuras(unit, auras);
+            for (std::vector<BenchAura*>::iterator itr = auras.begin(); itr != auras.end(); ++itr)
+                Add(*itr);
+        }
+
+        ~OldAuraUnit()
+        {
+            for (BenchAuraMap::iterator itr = m_auras.begin(); itr != m_auras.end(); ++itr)
+                delete itr->second;
+        }
+
+        void Add(BenchAura* aura)
+        {
+            m_auras.insert(BenchAuraMap::value_type(BenchAuraKey(aura->id, 0), aura));
+            m_modAuras[aura->type].push_back(aura);
+        }
+
+        uint64 Update(uint32 diff)
+        {
+            for (BenchAuraMap::iterator itr = m_auras.begin(); itr != m_auras.end(); ++itr)
+                itr->second->Update(diff);
+
+            std::vector<BenchAura*> reapply;
+            for (BenchAuraMap::iterator itr = m_auras.begin(); itr != m_auras.end();)
+            {
+                BenchAura* aura = itr->second;
+                if (!aura->IsExpired())
+                {
+                    ++itr;
+                    continue;
+                }
+
+                m_auras.erase(itr++);
+                m_modAuras[aura->type].remove(aura);
+                reapply.push_back(new BenchAura(aura->id, aura->type, 15000, aura->amplitude, aura->amount));
+                m_ticks += aura->ticks;
+                delete aura;
+            }
+
+            for (std::vector<BenchAura*>::iterator itr = reapply.begin(); itr != reapply.end(); ++itr)
+                Add(*itr);
+
+            uint64 sum = 0;
+            for (uint32 i = 0; i < sizeof(queryTypes) / sizeof(queryTypes[0]); ++i)
+                for (std::list<BenchAura*>::const_iterator itr = m_modAuras[queryTypes[i]].begin(); itr != m_modAuras[queryTypes[i]].end(); ++itr)
+                    sum += (*itr)->amount;
+
+            return sum;
+        }
+
+        uint64 GetTicks() const
+        {
+            uint64 ticks = m_ticks;
+            for (BenchAuraMap::const_iterator itr = m_auras.begin(); itr != m_auras.end(); ++itr)
+                ticks += itr->second->ticks;
+            return ticks;
+        }
+
+    private:
+        BenchAuraMap m_auras;
+        std::list<BenchAura*> m_modAuras[BENCH_AURA_TYPES];
+        uint64 m_ticks;
+};
+
+class NewAuraUnit
+{
+    public:
+        typedef SlotList<BenchAura*> AuraList;
+
+        explicit NewAuraUnit(uint32 unit) : m_holes(0), m_ticks(0)
+        {
+            std::vector<BenchAura*> auras;
+            AddBenchAuras(unit, auras);
+            for (std::vector<BenchAura*>::iterator itr = auras.begin(); itr != auras.end(); ++itr)
+                Add(*itr);
+        }
+
+        ~NewAuraUnit()
+        {
+            for (BenchAuraMap::iterator itr = m_auras.begin(); itr != m_auras.end(); ++itr)
+                delete itr->second;
+        }
+
+        void Add(BenchAura* aura)
+        {
+            m_auras.insert(BenchAuraMap::value_type(BenchAuraKey(aura->id, 0), aura));
+            aura->slot = m_updateAuras.size();
+            m_updateAuras.push_back(aura);
+            m_modAuras[aura->type].push_back(aura);
+        }
+
+        void Remove(BenchAuraMap::iterator itr)
+        {
+            BenchAura* aura = itr->second;
+            m_auras.erase(itr);
+            if (aura->slot >= 0)
+            {
+                m_updateAuras[aura->slot] = NULL;
+                ++m_holes;
+            }
+
+            AuraList& list = m_modAuras[aura->type];
+            if (list.remove(aura) && list.holes() == 1)
+                m_holedLists.push_back(&list);
+
+            m_ticks += aura->ticks;
+            delete aura;
+        }
+
+        uint64 Update(uint32 diff)
+        {
+            for (size_t i = 0, count = m_updateAuras.size(); i < count; ++i)
+            {
+                BenchAura* aura = m_updateAuras[i];
+                if (!aura)
+                    continue;
+
+                aura->Update(diff);
+                if (!aura->NeedsUpdate())
+                {
+                    m_updateAuras[i] = NULL;
+                    ++m_holes;
+                    aura->slot = -2;
+                }
+            }
+
+            std::vector<BenchAura*> reapply;
+            for (size_t i = 0; i < m_updateAuras.size(); ++i)
+            {
+                BenchAura* aura = m_updateAuras[i];
+                if (!aura || !aura->IsExpired())
+                    continue;
+
+                BenchAuraKey key(aura->id, 0);
+                for (BenchAuraMap::iterator itr = m_auras.lower_bound(key); itr != m_auras.upper_bound(key); ++itr)
+                {
+                    if (itr->second == aura)
+                    {
+                        reapply.push_back(new BenchAura(aura->id, aura->type, 15000, aura->amplitude, aura->amount));
+                        Remove(itr);
+                        break;
+                    }
+                }
+            }
+
+            if (m_holes)
+            {
+                std::vector<BenchAura*>::iterator dest = m_updateAuras.begin();
+                for (std::vector<BenchAura*>::iterator itr = m_updateAuras.begin(); itr != m_updateAuras.end(); ++itr)
+                {
+                    if (!*itr)
+                        continue;
+
+                    (*itr)->slot = dest - m_updateAuras.begin();
+                    *dest++ = *itr;
+                }
+
+                m_updateAuras.erase(dest, m_updateAuras.end());
+                m_holes = 0;
+            }
+
+            for (std::vector<AuraList*>::iterator itr = m_holedLists.begin(); itr != m_holedLists.end(); ++itr)
+                (*itr)->compact();
+            m_holedLists.clear();
+
+            for (std::vector<BenchAura*>::iterator itr = reapply.begin(); itr != reapply.end(); ++itr)
+                Add(*itr);
+
+            uint64 sum = 0;
+            for (uint32 i = 0; i < sizeof(queryTypes) / sizeof(queryTypes[0]); ++i)
+                for (AuraList::const_iterator itr = m_modAuras[queryTypes[i]].begin(); itr != m_modAuras[queryTypes[i]].end(); ++itr)
+                    sum += (*itr)->amount;
+
+            return sum;
+        }
+
+        uint64 GetTicks() const
+        {
+            uint64 ticks = m_ticks;
+            for (BenchAuraMap::const_iterator itr = m_auras.begin(); itr != m_auras.end(); ++itr)
+                ticks += itr->second->ticks;
+            return ticks;
+        }
+
+    private:
+        BenchAuraMap m_auras;
+        std::vector<BenchAura*> m_updateAuras;
+        uint32 m_holes;
+        std::vector<AuraList*> m_holedLists;
+        AuraList m_modAuras[BENCH_AURA_TYPES];
+        uint64 m_ticks;
+};
+
+template<class U>
+static uint64 RunAuraUnits(double& elapsedMS)
+{
+    std::vector<U*> units;
+    for (uint32 i = 0; i < BENCH_UNITS; ++i)
+        units.push_back(new U(i));
+
+    uint64 checksum = 0;
+    BenchClock clock;
+    for (uint32 tick = 0; tick < BENCH_TICKS; ++tick)
+        for (typename std::vector<U*>::iterator itr = units.begin(); itr != units.end(); ++itr)
+            checksum += (*itr)->Update(BENCH_DIFF);
+    elapsedMS = clock.GetElapsedMS();
+
+    for (typename std::vector<U*>::iterator itr = units.begin(); itr != units.end(); ++itr)
+    {
+        checksum += (*itr)->GetTicks();
+        delete *itr;
+    }
+
+    return checksum;
+}
+
+bool RunAuraBench()
+{
+    double oldMS, newMS;
+    uint64 oldChecksum = RunAuraUnits<OldAuraUnit>(oldMS);
+    uint64 newChecksum = RunAuraUnits<NewAuraUnit>(newMS);
+
+    PrintBenchResult("aura update + 12 stat queries, 62 auras", oldMS, newMS, oldChecksum, newChecksum);
+    return oldChecksum == newChecksum;
+}
+/// @}
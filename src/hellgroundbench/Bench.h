@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2008-2014 Hellground <http://hellground.net/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/// \addtogroup bench Container microbenchmarks
+/// @{
+/// \file
+
+#ifndef HELLGROUND_BENCH_H
+#define HELLGROUND_BENCH_H
+
+#include "Platform/Define.h"
+
+#include <ctime>
+
+/// Processor time of one benchmark run, benchmarks are single threaded
+class BenchClock
+{
+    public:
+        BenchClock() : m_start(clock()) {}
+
+        double GetElapsedMS() const { return double(clock() - m_start) * 1000.0 / CLOCKS_PER_SEC; }
+
+    private:
+        clock_t m_start;
+};
+
+// prints timings of old and new implementation, checksums must match to prove both did the same work
+void PrintBenchResult(char const* name, double oldMS, double newMS, uint64 oldChecksum, uint64 newChecksum);
+
+// every benchmark returns false when checksums of compared implementations differ
+bool RunAuraBench();
+bool RunThreatBench();
+bool RunProcBench();
+bool RunChannelBench();
+bool RunLootBench();
+bool RunSocialBench();
+
+#endif
+/// @}
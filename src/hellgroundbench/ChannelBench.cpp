@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2008-2014 Hellground <http://hellground.net/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/// \addtogroup bench Container microbenchmarks
+/// @{
+/// \file
+
+#include "Bench.h"
+
+#include <tbb/concurrent_hash_map.h>
+
+#include <map>
+#include <vector>
+
+// Channel::SendToAll looking up every member in global player map (before) against member list
+// with Player pointers cached on join (now), for messages sent into 3000 member trade channel
+
+#define BENCH_CHANNEL_MEMBERS   3000
+#define BENCH_CHANNEL_MESSAGES  2000
+
+// Player state used by SendToAll, every 10th player ignores someone
+struct BenchChannelPlayer
+{
+    explicit BenchChannelPlayer(uint64 _guid) : guid(_guid), received(0)
+    {
+        if (guid % 10 == 0)
+        {
+            ignored[uint32(guid * 7 % BENCH_CHANNEL_MEMBERS + 1)] = 1;
+            ignored[uint32(guid * 13 % BENCH_CHANNEL_MEMBERS + 1)] = 1;
+        }
+    }
+
+    bool HasIgnore(uint32 guid) const { return ignored.find(guid) != ignored.end(); }
+    void SendPacketToSelf(uint32 size) { received += size; }
+
+    uint64 guid;
+    std::map<uint32, uint8> ignored;                        // PlayerSocial map
+    uint64 received;
+};
+
+// HashMapHolder<Player> behind sObjectMgr.GetPlayer
+typedef tbb::concurrent_hash_map<uint64, BenchChannelPlayer*> BenchPlayerMap;
+
+static BenchChannelPlayer* FindBenchPlayer(BenchPlayerMap const& players, uint64 guid)
+{
+    BenchPlayerMap::const_accessor a;
+    if (players.find(a, guid))
+        return a->second;
+
+    return NULL;
+}
+
+class OldChannel
+{
+    public:
+        explicit OldChannel(BenchPlayerMap const& objects) : m_objects(objects) {}
+
+        void Join(BenchChannelPlayer* plr) { m_players[plr->guid] = 0; }
+
+        void SendToAll(uint32 size, uint64 p)
+        {
+            for (std::map<uint64, uint8>::const_iterator i = m_players.begin(); i != m_players.end(); ++i)
+            {
+                BenchChannelPlayer* plr = FindBenchPlayer(m_objects, i->first);
+                if (plr)
+                {
+                    if (!p || !plr->HasIgnore(uint32(p)))
+                        plr->SendPacketToSelf(size);
+                }
+            }
+        }
+
+    private:
+        BenchPlayerMap const& m_objects;
+        std::map<uint64, uint8> m_players;
+};
+
+class NewChannel
+{
+    public:
+        explicit NewChannel(BenchPlayerMap const&) {}
+
+        void Join(BenchChannelPlayer* plr)
+        {
+            PlayerInfo& info = m_players[plr->guid];
+            info.plr = plr;
+            m_members.push_back(&info);
+        }
+
+        void SendToAll(uint32 size, uint64 p)
+        {
+            uint32 ignoreGuid = uint32(p);
+            for (std::vector<PlayerInfo*>::const_iterator i = m_members.begin(); i != m_members.end(); ++i)
+            {
+                BenchChannelPlayer* plr = (*i)->plr;
+                if (plr)
+                {
+                    if (!p || !plr->HasIgnore(ignoreGuid))
+                        plr->SendPacketToSelf(size);
+                }
+            }
+        }
+
+    private:
+        struct PlayerInfo
+        {
+            PlayerInfo() : plr(NULL) {}
+            BenchChannelPlayer* plr;
+        };
+
+        std::map<uint64, PlayerInfo> m_players;
+        std::vector<PlayerInfo*> m_members;
+};
+
+template<class C>
+static uint64 RunChannelMessages(double& elapsedMS)
+{
+    BenchPlayerMap objects;
+    std::vector<BenchChannelPlayer*> players;
+    for (uint64 guid = 1; guid <= BENCH_CHANNEL_MEMBERS; ++guid)
+    {
+        players.push_back(new BenchChannelPlayer(guid));
+        BenchPlayerMap::accessor a;
+        objects.insert(a, guid);
+        a->second = players.back();
+    }
+
+    C channel(objects);
+    for (std::vector<BenchChannelPlayer*>::iterator itr = players.begin(); itr != players.end(); ++itr)
+        channel.Join(*itr);
+
+    uint32 seed = 99;
+    BenchClock clock;
+    for (uint32 i = 0; i < BENCH_CHANNEL_MESSAGES; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        channel.SendToAll(40 + (seed >> 16) % 200, 1 + (seed >> 8) % BENCH_CHANNEL_MEMBERS);
+    }
+    elapsedMS = clock.GetElapsedMS();
+
+    uint64 checksum = 0;
+    for (std::vector<BenchChannelPlayer*>::iterator itr = players.begin(); itr != players.end(); ++itr)
+    {
+        checksum += (*itr)->received * (*itr)->guid;
+        delete *itr;
+    }
+
+    return checksum;
+}
+
+bool RunChannelBench()
+{
+    double oldMS, newMS;
+    uint64 oldChecksum = RunChannelMessages<OldChannel>(oldMS);
+    uint64 newChecksum = RunChannelMessages<NewChannel>(newMS);
+
+    PrintBenchResult("channel 3000 members, 2000 messages", oldMS, newMS, oldChecksum, newChecksum);
+    return oldChecksum == newChecksum;
+}
+/// @}
@@ -0,0 +1,416 @@
+/*
+ * Copyright (C) 2008-2014 Hellground <http://hellground.net/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/// \addtogroup bench Container microbenchmarks
+/// @{
+/// \file
+
+#include "Bench.h"
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <vector>
+
+// LootGroup::Roll walking explicitly chanced entries (before) against alias table sampling (now), and
+// creature loot rolled at every kill (before) against loot rolled when corpse is opened first time (now)
+
+#define BENCH_LOOT_ROLLS        1000000
+#define BENCH_LOOT_KILLS        20000
+#define BENCH_LOOT_OPEN_EVERY   10
+
+// rolls of both implementations differ, so roll benchmark compares frequencies with expected chances
+#define BENCH_LOOT_TOLERANCE    0.002
+
+// mtRand replacement, same sequence for every run
+class BenchRandom
+{
+    public:
+        explicit BenchRandom(uint64 seed) : m_seed(seed) {}
+
+        uint32 Next()
+        {
+            m_seed = m_seed * ACE_UINT64_LITERAL(6364136223846793005) + ACE_UINT64_LITERAL(1442695040888963407);
+            return uint32(m_seed >> 32);
+        }
+
+        uint32 urand(uint32 min, uint32 max) { return min + Next() % (max - min + 1); }
+        double rand_norm() { return Next() / 4294967296.0; }
+        double rand_chance() { return rand_norm() * 100.0; }
+
+    private:
+        uint64 m_seed;
+};
+
+struct BenchLootStoreItem
+{
+    BenchLootStoreItem(uint32 _itemid, float _chance, uint8 _mincount, uint8 _maxcount)
+        : itemid(_itemid), chance(_chance), mincount(_mincount), maxcount(_maxcount) {}
+
+    uint32 itemid;
+    float chance;
+    uint8 mincount;
+    uint8 maxcount;
+};
+
+typedef std::vector<BenchLootStoreItem> BenchLootStoreItemList;
+
+struct BenchLoot
+{
+    BenchLoot() : pendingLootId(0) {}
+
+    void AddItem(BenchLootStoreItem const& item, BenchRandom& rnd)
+    {
+        items.push_back(std::make_pair(item.itemid, rnd.urand(item.mincount, item.maxcount)));
+    }
+
+    void clear()
+    {
+        items.clear();
+        unique_items.clear();
+        pendingLootId = 0;
+    }
+
+    std::vector<std::pair<uint32, uint32> > items;
+    std::set<uint32> unique_items;
+    uint32 pendingLootId;
+};
+
+class BenchLootGroup
+{
+    public:
+        void AddEntry(BenchLootStoreItem const& item)
+        {
+            if (item.chance != 0)
+                ExplicitlyChanced.push_back(item);
+            else
+                EqualChanced.push_back(item);
+        }
+
+        // same as LootGroup::BuildAliasTable
+        void BuildAliasTable()
+        {
+            std::vector<float> weights;
+            float total = 0.0f;
+
+            for (BenchLootStoreItemList::const_iterator i = ExplicitlyChanced.begin(); i != ExplicitlyChanced.end(); ++i)
+            {
+                float weight = std::min(i->chance, std::max(0.0f, 100.0f - total));
+                weights.push_back(weight);
+                total += weight;
+            }
+            weights.push_back(std::max(0.0f, 100.0f - total));
+            total = std::max(total, 100.0f);
+
+            uint32 size = weights.size();
+            AliasChance.assign(size, 1.0f);
+            AliasIndex.resize(size);
+
+            std::vector<uint32> small, large;
+            for (uint32 i = 0; i < size; ++i)
+            {
+                AliasIndex[i] = i;
+                weights[i] = weights[i] * size / total;
+                if (weights[i] < 1.0f)
+                    small.push_back(i);
+                else
+                    large.push_back(i);
+            }
+
+            while (!small.empty() && !large.empty())
+            {
+                uint32 less = small.back();
+                small.pop_back();
+                uint32 more = large.back();
+
+                AliasChance[less] = weights[less];
+                AliasIndex[less] = more;
+
+                weights[more] -= 1.0f - weights[less];
+                if (weights[more] < 1.0f)
+                {
+                    large.pop_back();
+                    small.push_back(more);
+                }
+            }
+        }
+
+        // LootGroup::Roll before alias tables
+        BenchLootStoreItem const* RollOld(std::set<uint32>& except, BenchRandom& rnd) const
+        {
+            if (!ExplicitlyChanced.empty())
+            {
+                float Roll = rnd.rand_chance();
+
+                std::vector<uint32> allowed;
+                float notAllowedChance = 0;
+                int counter = 0;
+                for (BenchLootStoreItemList::const_iterator i = ExplicitlyChanced.begin(); i != ExplicitlyChanced.end(); ++i)
+                {
+                    if (except.find(i->itemid) != except.end())
+                        notAllowedChance += i->chance;
+                    else
+                        allowed.push_back(counter);
+                    counter++;
+                }
+                if (notAllowedChance >= 100.0f)
+                    return NULL;
+
+                Roll = (100.0f - notAllowedChance) * Roll / 100.0f;
+
+                for (std::vector<uint32>::const_iterator i = allowed.begin(); i != allowed.end(); ++i)
+                {
+                    BenchLootStoreItem const* item = &ExplicitlyChanced[*i];
+                    Roll -= item->chance;
+                    if (Roll < 0)
+                        return item;
+                }
+            }
+            if (!EqualChanced.empty())
+            {
+                std::vector<uint32> allowed;
+
+                int counter = 0;
+                for (BenchLootStoreItemList::const_iterator i = EqualChanced.begin(); i != EqualChanced.end(); ++i)
+                {
+                    if (except.find(i->itemid) == except.end())
+                        allowed.push_back(counter);
+                    counter++;
+                }
+
+                if (!allowed.empty())
+                    return &EqualChanced[allowed[rnd.urand(0, allowed.size() - 1)]];
+            }
+
+            return NULL;
+        }
+
+        // LootGroup::Roll now, no unique item of the group in loot yet
+        BenchLootStoreItem const* RollNew(std::set<uint32>& except, BenchRandom& rnd) const
+        {
+            if (!AliasIndex.empty() && !HasExcepted(except))
+            {
+                uint32 column = rnd.urand(0, AliasIndex.size() - 1);
+                if (rnd.rand_norm() >= AliasChance[column])
+                    column = AliasIndex[column];
+
+                if (column < ExplicitlyChanced.size())
+                    return &ExplicitlyChanced[column];
+
+                if (EqualChanced.empty())
+                    return NULL;
+
+                return &EqualChanced[rnd.urand(0, EqualChanced.size() - 1)];
+            }
+
+            return RollOld(except, rnd);
+        }
+
+        // chance of every entry as sequential roll gives it, last one is empty drop
+        void GetExpectedChances(std::vector<double>& chances) const
+        {
+            chances.clear();
+            double total = 0.0;
+            for (BenchLootStoreItemList::const_iterator i = ExplicitlyChanced.begin(); i != ExplicitlyChanced.end(); ++i)
+            {
+                double chance = std::min(double(i->chance), std::max(0.0, 100.0 - total));
+                chances.push_back(chance / 100.0);
+                total += chance;
+            }
+
+            double missed = std::max(0.0, 100.0 - total) / 100.0;
+            for (uint32 i = 0; i < EqualChanced.size(); ++i)
+                chances.push_back(missed / EqualChanced.size());
+            chances.push_back(EqualChanced.empty() ? missed : 0.0);
+        }
+
+        // position of rolled entry in GetExpectedChances
+        uint32 GetIndex(BenchLootStoreItem const* item) const
+        {
+            if (!item)
+                return ExplicitlyChanced.size() + EqualChanced.size();
+
+            if (item >= &ExplicitlyChanced[0] && item < &ExplicitlyChanced[0] + ExplicitlyChanced.size())
+                return item - &ExplicitlyChanced[0];
+
+            return ExplicitlyChanced.size() + (item - &EqualChanced[0]);
+        }
+
+    private:
+        bool HasExcepted(std::set<uint32> const& except) const
+        {
+            if (except.empty())
+                return false;
+
+            for (BenchLootStoreItemList::const_iterator i = ExplicitlyChanced.begin(); i != ExplicitlyChanced.end(); ++i)
+                if (except.find(i->itemid) != except.end())
+                    return true;
+
+            for (BenchLootStoreItemList::const_iterator i = EqualChanced.begin(); i != EqualChanced.end(); ++i)
+                if (except.find(i->itemid) != except.end())
+                    return true;
+
+            return false;
+        }
+
+        BenchLootStoreItemList ExplicitlyChanced;
+        BenchLootStoreItemList EqualChanced;
+
+        std::vector<float> AliasChance;
+        std::vector<uint32> AliasIndex;
+};
+
+// trash mob template, ungrouped drops plus green group and grey group
+class BenchLootTemplate
+{
+    public:
+        BenchLootTemplate() : Groups(2)
+        {
+            static float const entryChances[] = { 40.0f, 25.0f, 12.0f, 5.0f, 2.0f, 1.0f, 0.5f, 0.2f, 0.1f, 0.02f };
+            for (uint32 i = 0; i < sizeof(entryChances) / sizeof(entryChances[0]); ++i)
+                Entries.push_back(BenchLootStoreItem(1000 + i, entryChances[i], 1, i < 2 ? 3 : 1));
+
+            static float const greenChances[] = { 0.5f, 1.0f, 2.0f, 2.0f, 3.0f, 5.0f, 5.0f, 8.0f, 10.0f, 10.0f, 12.0f, 15.0f };
+            for (uint32 i = 0; i < sizeof(greenChances) / sizeof(greenChances[0]); ++i)
+                Groups[0].AddEntry(BenchLootStoreItem(2000 + i, greenChances[i], 1, 1));
+            for (uint32 i = 0; i < 8; ++i)
+                Groups[0].AddEntry(BenchLootStoreItem(2100 + i, 0.0f, 1, 1));
+
+            // badly filled group over 100%, last entry is never rolled
+            static float const greyChances[] = { 30.0f, 30.0f, 25.0f, 20.0f, 15.0f };
+            for (uint32 i = 0; i < sizeof(greyChances) / sizeof(greyChances[0]); ++i)
+                Groups[1].AddEntry(BenchLootStoreItem(3000 + i, greyChances[i], 1, 2));
+
+            for (std::vector<BenchLootGroup>::iterator i = Groups.begin(); i != Groups.end(); ++i)
+                i->BuildAliasTable();
+        }
+
+        void Process(BenchLoot& loot, BenchRandom& rnd) const
+        {
+            for (BenchLootStoreItemList::const_iterator i = Entries.begin(); i != Entries.end(); ++i)
+                if (i->chance > rnd.rand_chance() && loot.unique_items.find(i->itemid) == loot.unique_items.end())
+                    loot.AddItem(*i, rnd);
+
+            for (std::vector<BenchLootGroup>::const_iterator i = Groups.begin(); i != Groups.end(); ++i)
+                if (BenchLootStoreItem const* item = i->RollOld(loot.unique_items, rnd))
+                    loot.AddItem(*item, rnd);
+        }
+
+        std::vector<BenchLootGroup> const& GetGroups() const { return Groups; }
+
+    private:
+        BenchLootStoreItemList Entries;
+        std::vector<BenchLootGroup> Groups;
+};
+
+template<bool alias>
+static uint64 RunGroupRolls(BenchLootTemplate const& tmpl, double& elapsedMS)
+{
+    std::vector<BenchLootGroup> const& groups = tmpl.GetGroups();
+    std::vector<std::vector<uint32> > counts(groups.size());
+    for (uint32 i = 0; i < groups.size(); ++i)
+    {
+        std::vector<double> chances;
+        groups[i].GetExpectedChances(chances);
+        counts[i].assign(chances.size(), 0);
+    }
+
+    BenchRandom rnd(7);
+    std::set<uint32> except;
+    BenchClock clock;
+    for (uint32 n = 0; n < BENCH_LOOT_ROLLS; ++n)
+    {
+        for (uint32 i = 0; i < groups.size(); ++i)
+        {
+            BenchLootStoreItem const* item = alias ? groups[i].RollNew(except, rnd) : groups[i].RollOld(except, rnd);
+            ++counts[i][groups[i].GetIndex(item)];
+        }
+    }
+    elapsedMS = clock.GetElapsedMS();
+
+    // number of entries rolled with expected frequency, both implementations must get all of them
+    uint64 checksum = 0;
+    for (uint32 i = 0; i < groups.size(); ++i)
+    {
+        std::vector<double> chances;
+        groups[i].GetExpectedChances(chances);
+        for (uint32 j = 0; j < chances.size(); ++j)
+            if (fabs(double(counts[i][j]) / BENCH_LOOT_ROLLS - chances[j]) < BENCH_LOOT_TOLERANCE)
+                ++checksum;
+    }
+
+    return checksum;
+}
+
+// AoE farming, every kill leaves corpse and only some of them are opened before despawn
+template<bool lazy>
+static uint64 RunKills(BenchLootTemplate const& tmpl, double& elapsedMS)
+{
+    std::vector<BenchLoot> corpses(BENCH_LOOT_KILLS);
+    uint64 checksum = 0;
+
+    BenchClock clock;
+    for (uint32 i = 0; i < BENCH_LOOT_KILLS; ++i)
+    {
+        if (lazy)
+            corpses[i].pendingLootId = 1;
+        else
+        {
+            BenchRandom rnd(i + 1);                         // own sequence per corpse, so both runs drop the same
+            tmpl.Process(corpses[i], rnd);
+        }
+    }
+
+    for (uint32 i = 0; i < BENCH_LOOT_KILLS; i += BENCH_LOOT_OPEN_EVERY)
+    {
+        BenchLoot& loot = corpses[i];
+        if (loot.pendingLootId)
+        {
+            loot.pendingLootId = 0;
+            BenchRandom rnd(i + 1);
+            tmpl.Process(loot, rnd);
+        }
+
+        for (std::vector<std::pair<uint32, uint32> >::const_iterator itr = loot.items.begin(); itr != loot.items.end(); ++itr)
+            checksum += itr->first * itr->second;
+    }
+
+    for (std::vector<BenchLoot>::iterator itr = corpses.begin(); itr != corpses.end(); ++itr)
+        itr->clear();
+    elapsedMS = clock.GetElapsedMS();
+
+    return checksum;
+}
+
+bool RunLootBench()
+{
+    BenchLootTemplate tmpl;
+
+    double oldRollMS, newRollMS;
+    uint64 oldRollChecksum = RunGroupRolls<false>(tmpl, oldRollMS);
+    uint64 newRollChecksum = RunGroupRolls<true>(tmpl, newRollMS);
+
+    double oldKillMS, newKillMS;
+    uint64 oldKillChecksum = RunKills<false>(tmpl, oldKillMS);
+    uint64 newKillChecksum = RunKills<true>(tmpl, newKillMS);
+
+    PrintBenchResult("loot group roll, 20 + 5 entries", oldRollMS, newRollMS, oldRollChecksum, newRollChecksum);
+    PrintBenchResult("loot 20000 kills, 1/10 opened", oldKillMS, newKillMS, oldKillChecksum, newKillChecksum);
+    return oldRollChecksum == newRollChecksum && oldKillChecksum == newKillChecksum;
+}
+/// @}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2008-2014 Hellground <http://hellground.net/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/// \addtogroup bench Container microbenchmarks
+/// @{
+/// \file
+
+#include "Bench.h"
+
+#include <cstdio>
+#include <cstring>
+
+struct BenchEntry
+{
+    char const* name;
+    bool (*run)();
+};
+
+static BenchEntry const benches[] =
+{
+    { "auras",   &RunAuraBench },
+    { "threat",  &RunThreatBench },
+    { "procs",   &RunProcBench },
+    { "channel", &RunChannelBench },
+    { "loot",    &RunLootBench },
+    { "social",  &RunSocialBench },
+    { NULL,      NULL }
+};
+
+void PrintBenchResult(char const* name, double oldMS, double newMS, uint64 oldChecksum, uint64 newChecksum)
+{
+    printf("%-40s old %9.1f ms  new %9.1f ms  speedup %5.2fx%s\n", name, oldMS, newMS,
+        newMS > 0.0 ? oldMS / newMS : 0.0, oldChecksum != newChecksum ? "  CHECKSUM MISMATCH" : "");
+}
+
+/// Runs benchmarks given by name, all when none given
+int main(int argc, char** argv)
+{
+    bool ok = true;
+    for (BenchEntry const* bench = benches; bench->name; ++bench)
+    {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; ++i)
+            if (!strcmp(argv[i], bench->name))
+                selected = true;
+
+        if (selected && !bench->run())
+            ok = false;
+    }
+
+    return ok ? 0 : 1;
+}
+/// @}
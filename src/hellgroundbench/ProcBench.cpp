@@ -0,0 +1,349 @@
+/*
+ * Copyright (C) 2008-2014 Hellground <http://hellground.net/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/// \addtogroup bench Container microbenchmarks
+/// @{
+/// \file
+
+#include "Bench.h"
+#include "Utilities/UnorderedMap.h"
+
+#include <list>
+#include <map>
+#include <vector>
+
+// Unit::ProcDamageAndSpellfor filling triggered list from whole aura map and checking every triggered
+// aura again in aura map (before) against proc aura index with removal counter (now), on raid-buffed
+// players receiving generated melee and spell combat events
+
+#define BENCH_PROC_UNITS    25
+#define BENCH_PROC_EVENTS   400000
+
+#define BENCH_PROC_MELEE_HIT        0x00000004
+#define BENCH_PROC_TAKEN_MELEE_HIT  0x00000008
+#define BENCH_PROC_SPELL_HIT        0x00010000
+#define BENCH_PROC_TAKEN_SPELL_HIT  0x00020000
+#define BENCH_PROC_PERIODIC         0x00040000
+
+#define BENCH_AURA_NAMES    64
+#define BENCH_AURA_TRIGGER  42                              // like SPELL_AURA_PROC_TRIGGER_SPELL
+
+// state of Aura and its SpellEntry used by IsTriggeredAtSpellProcEvent
+struct BenchProcAura
+{
+    BenchProcAura(uint32 _id, uint32 _effIndex, uint32 _auraName, uint32 _procFlags) :
+        id(_id), effIndex(_effIndex), auraName(_auraName), procFlags(_procFlags), procs(0) {}
+
+    uint32 id;
+    uint32 effIndex;
+    uint32 auraName;
+    uint32 procFlags;                                       // SpellEntry::procFlags
+    uint32 procs;
+};
+
+typedef std::pair<uint32, uint32> BenchSpellEffectPair;
+typedef std::multimap<BenchSpellEffectPair, BenchProcAura*> BenchProcAuraMap;
+
+// spell_proc_event and aura name tables of InitTriggerAuraData
+class BenchProcData
+{
+    public:
+        BenchProcData()
+        {
+            for (uint32 i = 0; i < BENCH_AURA_NAMES; ++i)
+            {
+                isTriggerAura[i] = i == BENCH_AURA_TRIGGER || i == BENCH_AURA_TRIGGER + 1;
+                isNonTriggerAura[i] = i == 0;
+            }
+
+            // custom flags for some talents
+            for (uint32 i = 0; i < 5; ++i)
+                procEvents[3000 + i] = i % 2 ? BENCH_PROC_SPELL_HIT : BENCH_PROC_MELEE_HIT | BENCH_PROC_SPELL_HIT;
+        }
+
+        uint32 GetProcEvent(uint32 spellId) const
+        {
+            UNORDERED_MAP<uint32, uint32>::const_iterator itr = procEvents.find(spellId);
+            return itr != procEvents.end() ? itr->second : 0;
+        }
+
+        // IsTriggeredAtSpellProcEvent up to IsSpellProcEventCanTriggeredBy
+        bool IsTriggered(BenchProcAura const* aura, uint32 procFlag, uint32& procEvent) const
+        {
+            procEvent = GetProcEvent(aura->id);
+
+            if (isNonTriggerAura[aura->auraName])
+                return false;
+
+            if (!isTriggerAura[aura->auraName] && !procEvent)
+                return false;
+
+            uint32 eventProcFlag = procEvent ? procEvent : aura->procFlags;
+            if (!eventProcFlag)
+                return false;
+
+            return (eventProcFlag & procFlag) != 0;
+        }
+
+        // GetAuraEventProcFlags
+        uint32 GetAuraEventProcFlags(BenchProcAura const* aura) const
+        {
+            if (isNonTriggerAura[aura->auraName])
+                return 0;
+
+            uint32 procEvent = GetProcEvent(aura->id);
+            if (!isTriggerAura[aura->auraName] && !procEvent)
+                return 0;
+
+            return procEvent ? procEvent : aura->procFlags;
+        }
+
+    private:
+        bool isTriggerAura[BENCH_AURA_NAMES];
+        bool isNonTriggerAura[BENCH_AURA_NAMES];
+        UNORDERED_MAP<uint32, uint32> procEvents;
+};
+
+// raid buffs, talents and passives without proc, then weapon enchants, trinkets and proc talents
+static void AddBenchProcAuras(uint32 unit, std::vector<BenchProcAura*>& auras)
+{
+    for (uint32 i = 0; i < 34; ++i)
+        auras.push_back(new BenchProcAura(1000 + i * 7 + unit % 3, i % 3, 1 + i % 30, 0));
+    for (uint32 i = 0; i < 6; ++i)
+        auras.push_back(new BenchProcAura(2000 + i, 0, BENCH_AURA_TRIGGER + i % 2,
+            i < 3 ? BENCH_PROC_MELEE_HIT : BENCH_PROC_TAKEN_MELEE_HIT | BENCH_PROC_TAKEN_SPELL_HIT));
+    for (uint32 i = 0; i < 5; ++i)
+        auras.push_back(new BenchProcAura(3000 + i, 1, 4, 0));
+}
+
+struct BenchProcTriggered
+{
+    BenchProcTriggered(uint32 _procEvent, BenchProcAura* _aura) :
+        procEvent(_procEvent), aura(_aura), spellPair(_aura->id, _aura->effIndex) {}
+
+    uint32 procEvent;
+    BenchProcAura* aura;
+    BenchSpellEffectPair spellPair;
+};
+
+typedef std::list<BenchProcTriggered> BenchProcTriggeredList;
+
+static bool BenchProcTriggeredOrder(BenchProcTriggered const& a, BenchProcTriggered const& b)
+{
+    return a.spellPair < b.spellPair;
+}
+
+// handles proc and counts it, aura with custom proc event also counts its flags
+static uint64 HandleBenchProc(BenchProcTriggered const& triggered)
+{
+    ++triggered.aura->procs;
+    return triggered.aura->id + triggered.procEvent;
+}
+
+class OldProcUnit
+{
+    public:
+        OldProcUnit(uint32 unit, BenchProcData const& data) : m_data(data)
+        {
+            std::vector<BenchProcAura*> auras;
+            AddBenchProcAuras(unit, auras);
+            for (std::vector<BenchProcAura*>::iterator itr = auras.begin(); itr != auras.end(); ++itr)
+                m_auras.insert(BenchProcAuraMap::value_type(BenchSpellEffectPair((*itr)->id, (*itr)->effIndex), *itr));
+        }
+
+        ~OldProcUnit()
+        {
+            for (BenchProcAuraMap::iterator itr = m_auras.begin(); itr != m_auras.end(); ++itr)
+                delete itr->second;
+        }
+
+        uint64 Proc(uint32 procFlag)
+        {
+            BenchProcTriggeredList procTriggered;
+            for (BenchProcAuraMap::const_iterator itr = m_auras.begin(); itr != m_auras.end(); ++itr)
+            {
+                uint32 procEvent;
+                if (!m_data.IsTriggered(itr->second, procFlag, procEvent))
+                    continue;
+
+                procTriggered.push_back(BenchProcTriggered(procEvent, itr->second));
+            }
+
+            uint64 sum = 0;
+            for (BenchProcTriggeredList::const_iterator i = procTriggered.begin(); i != procTriggered.end(); ++i)
+            {
+                if (i != procTriggered.begin())
+                {
+                    bool found = false;
+                    BenchProcAuraMap::const_iterator lower = m_auras.lower_bound(i->spellPair);
+                    BenchProcAuraMap::const_iterator upper = m_auras.upper_bound(i->spellPair);
+                    for (BenchProcAuraMap::const_iterator itr = lower; itr != upper; ++itr)
+                    {
+                        if (itr->second == i->aura)
+                        {
+                            found = true;
+                            break;
+                        }
+                    }
+
+                    if (!found)
+                        continue;
+                }
+
+                sum += HandleBenchProc(*i);
+            }
+
+            return sum;
+        }
+
+    private:
+        BenchProcData const& m_data;
+        BenchProcAuraMap m_auras;
+};
+
+class NewProcUnit
+{
+    public:
+        NewProcUnit(uint32 unit, BenchProcData const& data) : m_data(data), m_procAurasFlags(0), m_removedAurasCount(0)
+        {
+            std::vector<BenchProcAura*> auras;
+            AddBenchProcAuras(unit, auras);
+            for (std::vector<BenchProcAura*>::iterator itr = auras.begin(); itr != auras.end(); ++itr)
+            {
+                m_auras.insert(BenchProcAuraMap::value_type(BenchSpellEffectPair((*itr)->id, (*itr)->effIndex), *itr));
+
+                uint32 procFlags = m_data.GetAuraEventProcFlags(*itr);
+                if (!procFlags)
+                    continue;
+
+                m_procAuras.push_back(ProcAuraEntry(*itr, procFlags));
+                m_procAurasFlags |= procFlags;
+            }
+        }
+
+        ~NewProcUnit()
+        {
+            for (BenchProcAuraMap::iterator itr = m_auras.begin(); itr != m_auras.end(); ++itr)
+                delete itr->second;
+        }
+
+        uint64 Proc(uint32 procFlag)
+        {
+            if (!(procFlag & m_procAurasFlags))
+                return 0;
+
+            BenchProcTriggeredList procTriggered;
+            for (std::vector<ProcAuraEntry>::const_iterator itr = m_procAuras.begin(); itr != m_procAuras.end(); ++itr)
+            {
+                if (!(itr->procFlags & procFlag))
+                    continue;
+
+                uint32 procEvent;
+                if (!m_data.IsTriggered(itr->aura, procFlag, procEvent))
+                    continue;
+
+                procTriggered.push_back(BenchProcTriggered(procEvent, itr->aura));
+            }
+
+            procTriggered.sort(BenchProcTriggeredOrder);
+
+            uint32 removedAuras = m_removedAurasCount;
+
+            uint64 sum = 0;
+            for (BenchProcTriggeredList::const_iterator i = procTriggered.begin(); i != procTriggered.end(); ++i)
+            {
+                if (i != procTriggered.begin() && removedAuras != m_removedAurasCount)
+                {
+                    bool found = false;
+                    BenchProcAuraMap::const_iterator lower = m_auras.lower_bound(i->spellPair);
+                    BenchProcAuraMap::const_iterator upper = m_auras.upper_bound(i->spellPair);
+                    for (BenchProcAuraMap::const_iterator itr = lower; itr != upper; ++itr)
+                    {
+                        if (itr->second == i->aura)
+                        {
+                            found = true;
+                            break;
+                        }
+                    }
+
+                    if (!found)
+                        continue;
+                }
+
+                sum += HandleBenchProc(*i);
+            }
+
+            return sum;
+        }
+
+    private:
+        struct ProcAuraEntry
+        {
+            ProcAuraEntry(BenchProcAura* _aura, uint32 _procFlags) : aura(_aura), procFlags(_procFlags) {}
+            BenchProcAura* aura;
+            uint32 procFlags;
+        };
+
+        BenchProcData const& m_data;
+        BenchProcAuraMap m_auras;
+        std::vector<ProcAuraEntry> m_procAuras;
+        uint32 m_procAurasFlags;
+        uint32 m_removedAurasCount;
+};
+
+// melee hits done and taken, spell hits and periodic ticks spread over raid members
+template<class U>
+static uint64 RunProcEvents(BenchProcData const& data, double& elapsedMS)
+{
+    std::vector<U*> units;
+    for (uint32 i = 0; i < BENCH_PROC_UNITS; ++i)
+        units.push_back(new U(i, data));
+
+    uint32 seed = 777;
+    uint64 checksum = 0;
+    BenchClock clock;
+    for (uint32 i = 0; i < BENCH_PROC_EVENTS; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        uint32 roll = (seed >> 16) % 100;
+        uint32 procFlag = roll < 40 ? BENCH_PROC_MELEE_HIT :
+            roll < 60 ? BENCH_PROC_TAKEN_MELEE_HIT :
+            roll < 80 ? BENCH_PROC_SPELL_HIT :
+            roll < 90 ? BENCH_PROC_TAKEN_SPELL_HIT : BENCH_PROC_PERIODIC;
+
+        checksum += units[i % BENCH_PROC_UNITS]->Proc(procFlag);
+    }
+    elapsedMS = clock.GetElapsedMS();
+
+    for (typename std::vector<U*>::iterator itr = units.begin(); itr != units.end(); ++itr)
+        delete *itr;
+
+    return checksum;
+}
+
+bool RunProcBench()
+{
+    BenchProcData data;
+    double oldMS, newMS;
+    uint64 oldChecksum = RunProcEvents<OldProcUnit>(data, oldMS);
+    uint64 newChecksum = RunProcEvents<NewProcUnit>(data, newMS);
+
+    PrintBenchResult("proc events, 45 auras, 11 can proc", oldMS, newMS, oldChecksum, newChecksum);
+    return oldChecksum == newChecksum;
+}
+/// @}
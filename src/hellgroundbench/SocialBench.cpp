@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2008-2014 Hellground <http://hellground.net/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/// \addtogroup bench Container microbenchmarks
+/// @{
+/// \file
+
+#include "Bench.h"
+#include "Utilities/UnorderedMap.h"
+
+#include <ace/Guard_T.h>
+#include <ace/Thread_Mutex.h>
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// SocialMgr::BroadcastToFriendListers searching social list of every loaded player (before) against
+// reverse friend index (now), for 3000 players logging in one by one and changing zones afterwards
+
+#define BENCH_PLAYERS       3000
+#define BENCH_FRIENDS       25
+#define BENCH_ZONE_CHANGES  5
+
+#define BENCH_SOCIAL_FRIEND 0x01
+
+// FriendInfo and PlayerSocial kept by SocialMgr
+struct BenchFriendInfo
+{
+    BenchFriendInfo() : flags(0) {}
+    explicit BenchFriendInfo(uint32 _flags) : flags(_flags) {}
+
+    uint32 flags;
+    std::string note;
+};
+
+typedef std::map<uint32, BenchFriendInfo> BenchPlayerSocialMap;
+typedef std::map<uint32, BenchPlayerSocialMap> BenchSocialMap;
+
+// friend list of player as it comes from character_social, unique by friend, every 5th entry is ignored player
+static void BuildBenchSocial(uint32 guid, uint32& seed, std::vector<std::pair<uint32, uint32> >& rows)
+{
+    rows.clear();
+    std::set<uint32> listed;
+    for (uint32 i = 0; i < BENCH_FRIENDS; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        uint32 friendGuid = 1 + (seed >> 8) % BENCH_PLAYERS;
+        if (friendGuid == guid || !listed.insert(friendGuid).second)
+            continue;
+
+        rows.push_back(std::make_pair(friendGuid, i % 5 ? uint32(BENCH_SOCIAL_FRIEND) : 0));
+    }
+}
+
+class OldSocialMgr
+{
+    public:
+        void LoadFromDB(uint32 guid, std::vector<std::pair<uint32, uint32> > const& rows)
+        {
+            BenchPlayerSocialMap& social = m_socialMap[guid];
+            for (std::vector<std::pair<uint32, uint32> >::const_iterator itr = rows.begin(); itr != rows.end(); ++itr)
+                social[itr->first] = BenchFriendInfo(itr->second);
+        }
+
+        uint64 BroadcastToFriendListers(uint32 guid)
+        {
+            uint64 sent = 0;
+            for (BenchSocialMap::const_iterator itr = m_socialMap.begin(); itr != m_socialMap.end(); ++itr)
+            {
+                BenchPlayerSocialMap::const_iterator itr2 = itr->second.find(guid);
+                if (itr2 != itr->second.end() && (itr2->second.flags & BENCH_SOCIAL_FRIEND))
+                    sent += itr->first;
+            }
+
+            return sent;
+        }
+
+    private:
+        BenchSocialMap m_socialMap;
+};
+
+class NewSocialMgr
+{
+    public:
+        typedef std::set<uint32> FriendListerSet;
+        typedef UNORDERED_MAP<uint32, FriendListerSet> FriendListersMap;
+
+        void LoadFromDB(uint32 guid, std::vector<std::pair<uint32, uint32> > const& rows)
+        {
+            BenchPlayerSocialMap& social = m_socialMap[guid];
+            for (std::vector<std::pair<uint32, uint32> >::const_iterator itr = rows.begin(); itr != rows.end(); ++itr)
+            {
+                social[itr->first] = BenchFriendInfo(itr->second);
+                if (itr->second & BENCH_SOCIAL_FRIEND)
+                    AddFriendLister(itr->first, guid);
+            }
+        }
+
+        uint64 BroadcastToFriendListers(uint32 guid)
+        {
+            std::vector<uint32> listers;
+            {
+                ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_friendListersLock, 0);
+                FriendListersMap::const_iterator itr = m_friendListers.find(guid);
+                if (itr == m_friendListers.end())
+                    return 0;
+
+                listers.assign(itr->second.begin(), itr->second.end());
+            }
+
+            uint64 sent = 0;
+            for (std::vector<uint32>::const_iterator itr = listers.begin(); itr != listers.end(); ++itr)
+                sent += *itr;
+
+            return sent;
+        }
+
+    private:
+        void AddFriendLister(uint32 friendGuid, uint32 listerGuid)
+        {
+            ACE_GUARD(ACE_Thread_Mutex, guard, m_friendListersLock);
+            m_friendListers[friendGuid].insert(listerGuid);
+        }
+
+        BenchSocialMap m_socialMap;
+        FriendListersMap m_friendListers;
+        ACE_Thread_Mutex m_friendListersLock;
+};
+
+// every player loads his social list and tells his friend listers he is online, then changes zones
+template<class M>
+static uint64 RunLoginWave(double& loginMS, double& zoneMS)
+{
+    M mgr;
+    uint32 seed = 4321;
+    uint64 checksum = 0;
+    std::vector<std::pair<uint32, uint32> > rows;
+
+    BenchClock loginClock;
+    for (uint32 guid = 1; guid <= BENCH_PLAYERS; ++guid)
+    {
+        BuildBenchSocial(guid, seed, rows);
+        mgr.LoadFromDB(guid, rows);
+        checksum += mgr.BroadcastToFriendListers(guid);
+    }
+    loginMS = loginClock.GetElapsedMS();
+
+    BenchClock zoneClock;
+    for (uint32 i = 0; i < BENCH_ZONE_CHANGES; ++i)
+        for (uint32 guid = 1; guid <= BENCH_PLAYERS; ++guid)
+            checksum += mgr.BroadcastToFriendListers(guid);
+    zoneMS = zoneClock.GetElapsedMS();
+
+    return checksum;
+}
+
+bool RunSocialBench()
+{
+    double oldLoginMS, oldZoneMS, newLoginMS, newZoneMS;
+    uint64 oldChecksum = RunLoginWave<OldSocialMgr>(oldLoginMS, oldZoneMS);
+    uint64 newChecksum = RunLoginWave<NewSocialMgr>(newLoginMS, newZoneMS);
+
+    PrintBenchResult("social 3000 player login wave", oldLoginMS, newLoginMS, oldChecksum, newChecksum);
+    PrintBenchResult("social 3000 players, 5 zone changes", oldZoneMS, newZoneMS, oldChecksum, newChecksum);
+    return oldChecksum == newChecksum;
+}
+/// @}
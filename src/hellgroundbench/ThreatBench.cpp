@@ -0,0 +1,459 @@
+/*
+ * Copyright (C) 2008-2014 Hellground <http://hellground.net/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/// \addtogroup bench Container microbenchmarks
+/// @{
+/// \file
+
+#include "Bench.h"
+
+#include <list>
+#include <vector>
+
+// ThreatContainer with std::list sorted on every dirty update (list::sort and insertion by splice)
+// against indexed heap with cached selection order, for 40 attackers gaining threat every tick
+
+#define BENCH_ATTACKERS     40
+#define BENCH_THREAT_TICKS  200000
+
+// HostileReference state used by ThreatContainer, DropAggro() and IsOutOfThreatArea() are flags here
+struct BenchRef
+{
+    BenchRef(uint32 _id) : threat(0.0f), id(_id), sequence(_id), heapIndex(-1), selectionIndex(-1), dropAggro(false), outOfArea(false), melee(_id < 10) {}
+
+    float threat;
+    uint32 id;
+    uint32 sequence;
+    int32 heapIndex;
+    int32 selectionIndex;
+    bool dropAggro;
+    bool outOfArea;
+    bool melee;
+};
+
+static bool HigherThreat(BenchRef const* lhs, BenchRef const* rhs)
+{
+    if (lhs->threat != rhs->threat)
+        return lhs->threat > rhs->threat;
+
+    return lhs->sequence < rhs->sequence;
+}
+
+enum BenchVictimCheck
+{
+    BENCH_VICTIM_DROPPED,
+    BENCH_VICTIM_PASSED,
+    BENCH_VICTIM_FOUND
+};
+
+// same rules as ThreatContainer::checkVictim
+static BenchVictimCheck CheckVictim(BenchRef* ref, bool checkDropAggro, BenchRef* currentVictim, BenchRef*& result)
+{
+    if (checkDropAggro && ref->dropAggro)
+        return BENCH_VICTIM_DROPPED;
+
+    if (ref->outOfArea)
+        return BENCH_VICTIM_PASSED;
+
+    if (!currentVictim)
+    {
+        result = ref;
+        return BENCH_VICTIM_FOUND;
+    }
+
+    if (currentVictim == ref || ref->threat <= 1.1f * currentVictim->threat)
+    {
+        result = currentVictim;
+        return BENCH_VICTIM_FOUND;
+    }
+
+    if (ref->threat > 1.3f * currentVictim->threat || ref->threat > 1.1f * currentVictim->threat && ref->melee)
+    {
+        result = ref;
+        return BENCH_VICTIM_FOUND;
+    }
+
+    return BENCH_VICTIM_PASSED;
+}
+
+class ListThreatContainer
+{
+    public:
+        explicit ListThreatContainer(bool splice) : m_splice(splice), m_dirty(false), m_victim(NULL) {}
+
+        void Add(BenchRef* ref) { m_list.push_back(ref); }
+
+        void AddThreat(BenchRef* ref, float threat)
+        {
+            ref->threat += threat;
+            if ((m_victim == ref && threat < 0.0f) || (m_victim != ref && threat > 0.0f))
+                m_dirty = true;
+        }
+
+        BenchRef* SelectVictim()
+        {
+            if (m_dirty && m_list.size() > 1)
+            {
+                if (m_splice)
+                    SpliceSort();
+                else
+                    m_list.sort(HigherThreat);
+            }
+            m_dirty = false;
+
+            BenchRef* currentVictim = m_victim;
+            BenchRef* result = NULL;
+            bool noPriorityTargetFound = false;
+            std::list<BenchRef*>::iterator lastRef = m_list.end();
+            --lastRef;
+
+            for (std::list<BenchRef*>::iterator iter = m_list.begin(); iter != m_list.end();)
+            {
+                BenchVictimCheck check = CheckVictim(*iter, !noPriorityTargetFound, currentVictim, result);
+                if (check == BENCH_VICTIM_FOUND)
+                    break;
+
+                if (check == BENCH_VICTIM_DROPPED)
+                {
+                    if (iter == lastRef)
+                    {
+                        noPriorityTargetFound = true;
+                        iter = m_list.begin();
+                        continue;
+                    }
+
+                    if (*iter == currentVictim)
+                        currentVictim = NULL;
+                }
+                ++iter;
+            }
+
+            m_victim = result;
+            return result;
+        }
+
+    private:
+        void SpliceSort()
+        {
+            std::list<BenchRef*>::iterator itr = m_list.begin();
+            ++itr;
+            while (itr != m_list.end())
+            {
+                std::list<BenchRef*>::iterator current = itr++;
+                std::list<BenchRef*>::iterator pos = current;
+                while (pos != m_list.begin())
+                {
+                    std::list<BenchRef*>::iterator prev = pos;
+                    --prev;
+                    if (!HigherThreat(*current, *prev))
+                        break;
+                    pos = prev;
+                }
+
+                if (pos != current)
+                    m_list.splice(pos, m_list, current);
+            }
+        }
+
+        std::list<BenchRef*> m_list;
+        bool m_splice;
+        bool m_dirty;
+        BenchRef* m_victim;
+};
+
+class HeapThreatContainer
+{
+    public:
+        HeapThreatContainer() : m_version(0), m_selectionVersion(0), m_victim(NULL) {}
+
+        void Add(BenchRef* ref)
+        {
+            m_heap.push_back(ref);
+            SiftUp(m_heap.size() - 1);
+            ++m_version;
+        }
+
+        void AddThreat(BenchRef* ref, float threat)
+        {
+            ref->threat += threat;
+            if (threat == 0.0f)
+                return;
+
+            if (!SiftUp(ref->heapIndex))
+                SiftDown(ref->heapIndex);
+
+            if (m_selectionVersion == m_version && !IsSelectionOrderKept(ref, threat > 0.0f))
+                ++m_version;
+        }
+
+        BenchRef* SelectVictim()
+        {
+            m_victim = Select(m_victim);
+            return m_victim;
+        }
+
+    private:
+        BenchRef* Select(BenchRef* currentVictim)
+        {
+            BenchRef* result = NULL;
+            if (m_selectionVersion == m_version)
+            {
+                BenchRef* victim = currentVictim;
+                for (std::vector<BenchRef*>::const_iterator itr = m_selectionOrder.begin(); itr != m_selectionOrder.end(); ++itr)
+                {
+                    BenchVictimCheck check = CheckVictim(*itr, true, victim, result);
+                    if (check == BENCH_VICTIM_FOUND)
+                        return result;
+
+                    if (check == BENCH_VICTIM_DROPPED)
+                    {
+                        if (uint32(itr - m_selectionOrder.begin()) + 1 == m_heap.size())
+                            break;
+
+                        if (*itr == victim)
+                            victim = NULL;
+                    }
+                }
+            }
+
+            for (std::vector<BenchRef*>::iterator itr = m_selectionOrder.begin(); itr != m_selectionOrder.end(); ++itr)
+                (*itr)->selectionIndex = -1;
+            m_selectionOrder.clear();
+            m_selectionVersion = m_version;
+
+            std::vector<uint32> candidates;
+            if (!m_heap.empty())
+                candidates.push_back(0);
+
+            while (BenchRef* ref = NextInOrder(candidates))
+            {
+                ref->selectionIndex = m_selectionOrder.size();
+                m_selectionOrder.push_back(ref);
+
+                BenchVictimCheck check = CheckVictim(ref, true, currentVictim, result);
+                if (check == BENCH_VICTIM_FOUND)
+                    return result;
+
+                if (check != BENCH_VICTIM_DROPPED)
+                    continue;
+
+                if (!candidates.empty())
+                {
+                    if (ref == currentVictim)
+                        currentVictim = NULL;
+                    continue;
+                }
+
+                for (std::vector<BenchRef*>::const_iterator itr = m_selectionOrder.begin(); itr != m_selectionOrder.end(); ++itr)
+                    if (CheckVictim(*itr, false, currentVictim, result) == BENCH_VICTIM_FOUND)
+                        return result;
+            }
+
+            return NULL;
+        }
+
+        bool IsSelectionOrderKept(BenchRef* ref, bool raised) const
+        {
+            if (m_selectionOrder.empty())
+                return false;
+
+            if (ref->selectionIndex < 0)
+                return !HigherThreat(ref, m_selectionOrder.back());
+
+            std::vector<BenchRef*>::const_iterator itr = m_selectionOrder.begin() + ref->selectionIndex;
+
+            if (itr != m_selectionOrder.begin() && HigherThreat(ref, *(itr - 1)))
+                return false;
+
+            if (itr + 1 == m_selectionOrder.end())
+                return raised;
+
+            return !HigherThreat(*(itr + 1), ref);
+        }
+
+        BenchRef* NextInOrder(std::vector<uint32>& candidates)
+        {
+            if (candidates.empty())
+                return NULL;
+
+            std::vector<uint32>::iterator best = candidates.begin();
+            for (std::vector<uint32>::iterator itr = best + 1; itr != candidates.end(); ++itr)
+                if (HigherThreat(m_heap[*itr], m_heap[*best]))
+                    best = itr;
+
+            uint32 index = *best;
+            *best = candidates.back();
+            candidates.pop_back();
+
+            for (uint32 child = 2 * index + 1; child <= 2 * index + 2; ++child)
+                if (child < m_heap.size())
+                    candidates.push_back(child);
+
+            return m_heap[index];
+        }
+
+        void Place(BenchRef* ref, uint32 index)
+        {
+            m_heap[index] = ref;
+            ref->heapIndex = index;
+        }
+
+        bool SiftUp(uint32 index)
+        {
+            BenchRef* ref = m_heap[index];
+            uint32 start = index;
+            while (index > 0)
+            {
+                uint32 parent = (index - 1) / 2;
+                if (!HigherThreat(ref, m_heap[parent]))
+                    break;
+
+                Place(m_heap[parent], index);
+                index = parent;
+            }
+            Place(ref, index);
+            return index != start;
+        }
+
+        void SiftDown(uint32 index)
+        {
+            BenchRef* ref = m_heap[index];
+            uint32 size = m_heap.size();
+            for (;;)
+            {
+                uint32 child = 2 * index + 1;
+                if (child >= size)
+                    break;
+
+                if (child + 1 < size && HigherThreat(m_heap[child + 1], m_heap[child]))
+                    ++child;
+
+                if (!HigherThreat(m_heap[child], ref))
+                    break;
+
+                Place(m_heap[child], index);
+                index = child;
+            }
+            Place(ref, index);
+        }
+
+        std::vector<BenchRef*> m_heap;
+        uint32 m_version;
+        std::vector<BenchRef*> m_selectionOrder;
+        uint32 m_selectionVersion;
+        BenchRef* m_victim;
+};
+
+// every attacker gains threat each swingTicks ticks with changing ranking, some get gouged or run out of area
+template<class C>
+static uint64 RunThreatContainer(C& container, uint32 ticks, uint32 swingTicks, double& elapsedMS)
+{
+    std::vector<BenchRef*> refs;
+    for (uint32 i = 0; i < BENCH_ATTACKERS; ++i)
+    {
+        refs.push_back(new BenchRef(i));
+        container.Add(refs.back());
+    }
+
+    uint32 seed = 12345;
+    uint64 checksum = 0;
+    BenchClock clock;
+    for (uint32 tick = 0; tick < ticks; ++tick)
+    {
+        for (uint32 i = tick % swingTicks; i < BENCH_ATTACKERS; i += swingTicks)
+        {
+            seed = seed * 1103515245 + 12345;
+            // tank keeps most threat, damage dealers climb at different rates
+            float threat = i == 0 ? 900.0f * swingTicks : float((seed >> 16) % 800 * swingTicks);
+            container.AddThreat(refs[i], threat);
+        }
+
+        if (tick % 50 == 0)
+            refs[(tick / 50) % BENCH_ATTACKERS]->dropAggro = true;
+        if (tick % 50 == 10)
+            refs[(tick / 50) % BENCH_ATTACKERS]->dropAggro = false;
+        refs[(tick / 7) % BENCH_ATTACKERS]->outOfArea = tick % 7 < 3;
+
+        if (BenchRef* victim = container.SelectVictim())
+            checksum += victim->id;
+    }
+    elapsedMS = clock.GetElapsedMS();
+
+    for (std::vector<BenchRef*>::iterator itr = refs.begin(); itr != refs.end(); ++itr)
+        delete *itr;
+
+    return checksum;
+}
+
+// boss in long fight with stable threat, only selection is done
+template<class C>
+static uint64 RunQuietThreatContainer(C& container, uint32 ticks, double& elapsedMS)
+{
+    std::vector<BenchRef*> refs;
+    for (uint32 i = 0; i < BENCH_ATTACKERS; ++i)
+    {
+        refs.push_back(new BenchRef(i));
+        container.Add(refs.back());
+        container.AddThreat(refs.back(), float(1000 * (BENCH_ATTACKERS - i)));
+    }
+
+    uint64 checksum = 0;
+    BenchClock clock;
+    for (uint32 tick = 0; tick < ticks; ++tick)
+        if (BenchRef* victim = container.SelectVictim())
+            checksum += victim->id;
+    elapsedMS = clock.GetElapsedMS();
+
+    for (std::vector<BenchRef*>::iterator itr = refs.begin(); itr != refs.end(); ++itr)
+        delete *itr;
+
+    return checksum;
+}
+
+// old list::sort (before), splice insertion and heap on same fight
+static bool RunThreatFight(char const* sortName, char const* spliceName, uint32 swingTicks)
+{
+    double sortMS, spliceMS, heapMS;
+    ListThreatContainer sortList(false);
+    ListThreatContainer spliceList(true);
+    HeapThreatContainer heap;
+    uint64 sortChecksum = RunThreatContainer(sortList, BENCH_THREAT_TICKS, swingTicks, sortMS);
+    uint64 spliceChecksum = RunThreatContainer(spliceList, BENCH_THREAT_TICKS, swingTicks, spliceMS);
+    uint64 heapChecksum = RunThreatContainer(heap, BENCH_THREAT_TICKS, swingTicks, heapMS);
+
+    PrintBenchResult(sortName, sortMS, heapMS, sortChecksum, heapChecksum);
+    PrintBenchResult(spliceName, spliceMS, heapMS, spliceChecksum, heapChecksum);
+    return sortChecksum == heapChecksum && spliceChecksum == heapChecksum;
+}
+
+bool RunThreatBench()
+{
+    bool ok = RunThreatFight("threat 40, all each tick, sort vs heap", "threat 40, all each tick, splice vs heap", 1);
+    ok = RunThreatFight("threat 40, 1/20 each tick, sort vs heap", "threat 40, 1/20 each tick, splice vs heap", 20) && ok;
+
+    double quietListMS, quietHeapMS;
+    ListThreatContainer quietList(true);
+    HeapThreatContainer quietHeap;
+    uint64 quietListChecksum = RunQuietThreatContainer(quietList, BENCH_THREAT_TICKS * 10, quietListMS);
+    uint64 quietHeapChecksum = RunQuietThreatContainer(quietHeap, BENCH_THREAT_TICKS * 10, quietHeapMS);
+
+    PrintBenchResult("threat 40, no threat change", quietListMS, quietHeapMS, quietListChecksum, quietHeapChecksum);
+
+    return ok && quietListChecksum == quietHeapChecksum;
+}
+/// @}
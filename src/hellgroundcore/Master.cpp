@@ -162,6 +162,9 @@ int Master::Run()
     GameDataDatabase.EnableLogging();
     AccountsDatabase.EnableLogging();
 
+    // from now log files are written by background thread (if enabled)
+    sLog.StartAsyncWriter();
+
     ACE_SIGACTION action;
     action.sa_handler = _OnSignal;
     action.sa_flags = 0; //SA_RESTART
@@ -335,6 +338,8 @@ int Master::Run()
     GameDataDatabase.HaltDelayThread();
     AccountsDatabase.HaltDelayThread();
 
+    sLog.StopAsyncWriter();
+
     // Exit the process with specified return value
     return World::GetExitCode();
 }
@@ -350,7 +355,10 @@ bool Master::_StartDB()
         return false;
     }
 
-    int nConnections = sConfig.GetIntDefault("WorldDatabaseConnections", 1);
+    // parallel startup loaders query world and character databases at the same time
+    int loaderThreads = sConfig.GetIntDefault("StartupLoader.Threads", 1);
+
+    int nConnections = std::max(sConfig.GetIntDefault("WorldDatabaseConnections", 1), loaderThreads);
     sLog.outString("World Database: total connections: %i", nConnections + 1);
 
     ///- Initialise the world database
@@ -366,7 +374,7 @@ bool Master::_StartDB()
         sLog.outLog(LOG_DEFAULT, "ERROR: Character Database not specified in configuration file");
         return false;
     }
-    nConnections = sConfig.GetIntDefault("CharacterDatabaseConnections", 1);
+    nConnections = std::max(sConfig.GetIntDefault("CharacterDatabaseConnections", 1), loaderThreads);
     sLog.outString("Character Database: total connections: %i", nConnections + 1);
 
     ///- Initialise the Character database
@@ -72,6 +72,7 @@ void WorldRunnable::run()
     }
 
     sWorld.m_ac.deactivate();                               // Stop Anticheat Delay Executor
+    sWorld.m_warden.deactivate();                           // Stop Warden verify threads
     sWorld.KickAll();                                       // save and kick all players
     sWorld.UpdateSessions(uint32(1));                       // real players unload required UpdateSessions call
 
@@ -26,6 +26,7 @@
 #include "Log.h"
 #include "RealmList.h"
 #include "AuthSocket.h"
+#include "AuthWorker.h"
 #include "AuthCodes.h"
 #include "TOTP.h"
 #include "PatchHandler.h"
@@ -192,11 +193,16 @@ AuthSocket::AuthSocket()
 
     _build = 0;
     patch_ = ACE_INVALID_HANDLE;
+
+    socketId_ = sAuthWorker.RegisterSocket(this);
+    taskPending_ = false;
 }
 
-/// Close patch file descriptor before leaving
+/// Close patch file descriptor and drop result of pending task before leaving
 AuthSocket::~AuthSocket()
 {
+    sAuthWorker.UnregisterSocket(socketId_);
+
     if(patch_ != ACE_INVALID_HANDLE)
         ACE_OS::close(patch_);
 }
@@ -213,6 +219,10 @@ void AuthSocket::OnRead()
     uint8 _cmd;
     while (1)
     {
+        ///- Next command is handled after the pending task is finished
+        if (taskPending_)
+            return;
+
         if(!recv_soft((char *)&_cmd, 1))
             return;
 
@@ -248,43 +258,24 @@ void AuthSocket::OnRead()
     }
 }
 
-/// Make the SRP6 calculation from hash in dB
-void AuthSocket::_SetVSFields(const std::string& rI)
+void AuthSocket::ScheduleTask(AuthTask* task)
 {
-    s.SetRand(s_BYTE_SIZE * 8);
-
-    BigNumber I;
-    I.SetHexStr(rI.c_str());
-
-    // In case of leading zeros in the rI hash, restore them
-    uint8 mDigest[SHA_DIGEST_LENGTH];
-    memset(mDigest, 0, SHA_DIGEST_LENGTH);
-    if (I.GetNumBytes() <= SHA_DIGEST_LENGTH)
-        memcpy(mDigest, I.AsByteArray(), I.GetNumBytes());
-
-    std::reverse(mDigest, mDigest + SHA_DIGEST_LENGTH);
-
-    Sha1Hash sha;
-    sha.UpdateData(s.AsByteArray(), s.GetNumBytes());
-    sha.UpdateData(mDigest, SHA_DIGEST_LENGTH);
-    sha.Finalize();
-    BigNumber x;
-    x.SetBinary(sha.GetDigest(), sha.GetLength());
-    v = g.ModExp(x, N);
-    // No SQL injection (username escaped)
-    const char *v_hex, *s_hex;
-    v_hex = v.AsHexStr();
-    s_hex = s.AsHexStr();
+    taskPending_ = true;
+    sAuthWorker.Schedule(task);
+}
 
-    AccountsDatabase.DirectPExecute("UPDATE account_session SET v = '%s', s = '%s' WHERE username = '%s'", v_hex, s_hex, _safelogin.c_str() );
+void AuthSocket::FinishTask(AuthTask* task)
+{
+    taskPending_ = false;
 
-    OPENSSL_free((void*)v_hex);
-    OPENSSL_free((void*)s_hex);
+    ///- Handle commands received while the task was processed
+    if (task->Finish(*this))
+        OnRead();
 }
 
-void AuthSocket::SendProof(Sha1Hash sha)
+static void BuildProof(ByteBuffer& pkt, uint16 build, Sha1Hash& sha)
 {
-    switch(_build)
+    switch(build)
     {
         case 5875:                                          // 1.12.1
         case 6005:                                          // 1.12.2
@@ -295,7 +286,7 @@ void AuthSocket::SendProof(Sha1Hash sha)
             proof.error = 0;
             proof.unk2 = 0x00;
 
-            send((char *)&proof, sizeof(proof));
+            pkt.append((uint8 const*)&proof, sizeof(proof));
             break;
         }
         case 8606:                                          // 2.4.3
@@ -314,118 +305,110 @@ void AuthSocket::SendProof(Sha1Hash sha)
             proof.surveyId = 0x00000000;
             proof.unkFlags = 0x0000;
 
-            send((char *)&proof, sizeof(proof));
+            pkt.append((uint8 const*)&proof, sizeof(proof));
             break;
         }
     }
 }
 
+static void BuildProofError(ByteBuffer& pkt, uint16 build)
+{
+    if (build > 6005)                                       // > 1.12.2
+    {
+        uint8 data[4] = { CMD_AUTH_LOGON_PROOF, WOW_FAIL_UNKNOWN_ACCOUNT, 3, 0};
+        pkt.append(data, sizeof(data));
+    }
+    else
+    {
+        // 1.x not react incorrectly at 4-byte message use 3 as real error
+        uint8 data[2] = { CMD_AUTH_LOGON_PROOF, WOW_FAIL_UNKNOWN_ACCOUNT};
+        pkt.append(data, sizeof(data));
+    }
+}
+
 #ifdef REGEX_NAMESPACE
 PatternList AuthSocket::pattern_banned = PatternList();
 #endif
 
-/// Logon Challenge command handler
-bool AuthSocket::_HandleLogonChallenge()
+/// Account checks and SRP6 values of logon challenge
+class LogonChallengeTask : public AuthTask
 {
-    DEBUG_LOG("Entering _HandleLogonChallenge");
-    if (recv_len() < sizeof(sAuthLogonChallenge_C))
-        return false;
-
-    ///- Read the first 4 bytes (header) to get the length of the remaining of the packet
-    std::vector<uint8> buf;
-    buf.resize(4);
-
-    recv((char *)&buf[0], 4);
-
-    EndianConvert(*((uint16*)(buf[0])));
-    uint16 remaining = ((sAuthLogonChallenge_C *)&buf[0])->size;
-    DEBUG_LOG("[AuthChallenge] got header, body is %#04x bytes", remaining);
-
-    if ((remaining < sizeof(sAuthLogonChallenge_C) - buf.size()) || (recv_len() < remaining))
-        return false;
-
-    //No big fear of memory outage (size is int16, i.e. < 65536)
-    buf.resize(remaining + buf.size() + 1);
-    buf[buf.size() - 1] = 0;
-    sAuthLogonChallenge_C *ch = (sAuthLogonChallenge_C*)&buf[0];
-
-    ///- Read the remaining of the packet
-    recv((char *)&buf[4], remaining);
-    DEBUG_LOG("[AuthChallenge] got full packet, %#04x bytes", ch->size);
-    DEBUG_LOG("[AuthChallenge] name(%d): '%s'", ch->I_len, ch->I);
-
-    // BigEndian code, nop in little endian case
-    // size already converted
-    EndianConvert(*((uint32*)(&ch->gamename[0])));
-    EndianConvert(ch->build);
-    EndianConvert(*((uint32*)(&ch->platform[0])));
-    EndianConvert(*((uint32*)(&ch->os[0])));
-    EndianConvert(*((uint32*)(&ch->country[0])));
-    EndianConvert(ch->timezone_bias);
-    EndianConvert(*((uint32*)(&ch->ip[0])));
-
-    std::stringstream tmpLocalIp;
-    tmpLocalIp << (uint32)ch->ip[0] << "." << (uint32)ch->ip[1] << "." << (uint32)ch->ip[2] << "." << (uint32)ch->ip[3];
-
-    localIp_ = tmpLocalIp.str();
-
-    ByteBuffer pkt;
+    public:
+        explicit LogonChallengeTask(AuthSocket& socket) : AuthTask(socket.socketId_),
+            m_login(socket._login), m_safelogin(socket._safelogin), m_address(socket.get_remote_address()),
+            m_localizationName(socket._localizationName), N(socket.N), g(socket.g), m_permissionMask(PERM_PLAYER), m_success(false) {}
+
+        void Process();
+        bool Finish(AuthSocket& socket);
+
+    private:
+        void SetVSFields(const std::string& rI);
+
+        std::string m_login;
+        std::string m_safelogin;
+        std::string m_address;
+        std::string m_localizationName;
+        BigNumber N, g;
+
+        // applied to socket when account may log in
+        BigNumber s, v;
+        BigNumber b, B;
+        std::string m_tokenKey;
+        uint64 m_permissionMask;
+        bool m_success;
+};
 
-    _login = (const char*)ch->I;
-    _build = ch->build;
-    std::string operatingSystem_ = (const char*)ch->os;
+/// Make the SRP6 calculation from hash in dB
+void LogonChallengeTask::SetVSFields(const std::string& rI)
+{
+    s.SetRand(AuthSocket::s_BYTE_SIZE * 8);
 
-    // Restore string order as its byte order is reversed
-    std::reverse(operatingSystem_.begin(), operatingSystem_.end());
+    BigNumber I;
+    I.SetHexStr(rI.c_str());
 
-    if (operatingSystem_ == "Win")
-        OS = CLIENT_OS_WIN;
-    else if (operatingSystem_ == "OSX")
-        OS = CLIENT_OS_OSX;
-    else if (sRealmList.GetChatboxOsName() != "" && operatingSystem_ == sRealmList.GetChatboxOsName())
-        OS = CLIENT_OS_CHAT;
-    else {
-        sLog.outLog(LOG_WARDEN, "Client %s got unsupported operating system (%s)", _login.c_str(), operatingSystem_.c_str());
-        return false;
-    }
+    // In case of leading zeros in the rI hash, restore them
+    uint8 mDigest[SHA_DIGEST_LENGTH];
+    memset(mDigest, 0, SHA_DIGEST_LENGTH);
+    if (I.GetNumBytes() <= SHA_DIGEST_LENGTH)
+        memcpy(mDigest, I.AsByteArray(), I.GetNumBytes());
 
-    ///- Normalize account name
-    //utf8ToUpperOnlyLatin(_login); -- client already send account in expected form
+    std::reverse(mDigest, mDigest + SHA_DIGEST_LENGTH);
 
-    //Escape the user login to avoid further SQL injection
-    //Memory will be freed on AuthSocket object destruction
-    _safelogin = _login;
-    AccountsDatabase.escape_string(_safelogin);
+    Sha1Hash sha;
+    sha.UpdateData(s.AsByteArray(), s.GetNumBytes());
+    sha.UpdateData(mDigest, SHA_DIGEST_LENGTH);
+    sha.Finalize();
+    BigNumber x;
+    x.SetBinary(sha.GetDigest(), sha.GetLength());
+    v = g.ModExp(x, N);
+    // No SQL injection (username escaped)
+    const char *v_hex, *s_hex;
+    v_hex = v.AsHexStr();
+    s_hex = s.AsHexStr();
 
-    pkt << (uint8) CMD_AUTH_LOGON_CHALLENGE;
-    pkt << (uint8) 0x00;
+    AccountsDatabase.DirectPExecute("UPDATE account_session SET v = '%s', s = '%s' WHERE username = '%s'", v_hex, s_hex, m_safelogin.c_str() );
 
-    std::string address = get_remote_address();
+    OPENSSL_free((void*)v_hex);
+    OPENSSL_free((void*)s_hex);
+}
 
-#ifdef REGEX_NAMESPACE
-    for (PatternList::const_iterator i = pattern_banned.begin(); i != pattern_banned.end(); ++i)
-    {
-        if (REGEX_NAMESPACE::regex_match(address.c_str(), i->first) && REGEX_NAMESPACE::regex_match(localIp_.c_str(), i->second))
-        {
-            pkt<< (uint8) WOW_FAIL_UNKNOWN_ACCOUNT;
-            send((char const*)pkt.contents(), pkt.size());
-            return true;
-        }
-    }
-#endif
+void LogonChallengeTask::Process()
+{
+    m_reply << (uint8) CMD_AUTH_LOGON_CHALLENGE;
+    m_reply << (uint8) 0x00;
 
     ///- Verify that this IP is not in the ip_banned table
     // No SQL injection possible (paste the IP address as passed by the socket)
     AccountsDatabase.Execute("DELETE FROM ip_banned WHERE unbandate<=UNIX_TIMESTAMP() AND unbandate<>bandate");
+    std::string address = m_address;
     AccountsDatabase.escape_string(address);
     QueryResultAutoPtr result = AccountsDatabase.PQuery("SELECT * FROM ip_banned WHERE ip = '%s'", address.c_str());
 
     if (result) // ip banned
     {
-        sLog.outBasic("[AuthChallenge] Banned ip %s tries to login!", get_remote_address().c_str());
-        pkt << uint8(WOW_FAIL_BANNED);
-        send((char const*)pkt.contents(), pkt.size());
-        return true;
+        sLog.outBasic("[AuthChallenge] Banned ip %s tries to login!", m_address.c_str());
+        m_reply << uint8(WOW_FAIL_BANNED);
+        return;
     }
 
     ///- Get the account details from the account table
@@ -433,13 +416,12 @@ bool AuthSocket::_HandleLogonChallenge()
 
     result = AccountsDatabase.PQuery("SELECT pass_hash, account.account_id, account_state_id, token_key, last_ip, permission_mask, email "
                                      "FROM account JOIN account_permissions ON account.account_id = account_permissions.account_id "
-                                     "WHERE username = '%s'", _safelogin.c_str());
+                                     "WHERE username = '%s'", m_safelogin.c_str());
 
     if (!result)    // account not exists
     {
-        pkt<< uint8(WOW_FAIL_UNKNOWN_ACCOUNT);
-        send((char const*)pkt.contents(), pkt.size());
-        return true;
+        m_reply << uint8(WOW_FAIL_UNKNOWN_ACCOUNT);
+        return;
     }
 
     Field * fields = result->Fetch();
@@ -449,14 +431,13 @@ bool AuthSocket::_HandleLogonChallenge()
     {
         case ACCOUNT_STATE_IP_LOCKED:
         {
-            DEBUG_LOG("[AuthChallenge] Account '%s' is locked to IP - '%s'", _login.c_str(), (*result)[3].GetString());
-            DEBUG_LOG("[AuthChallenge] Player address is '%s'", get_remote_address().c_str());
-            if (strcmp(fields[4].GetString(), get_remote_address().c_str()))
+            DEBUG_LOG("[AuthChallenge] Account '%s' is locked to IP - '%s'", m_login.c_str(), (*result)[3].GetString());
+            DEBUG_LOG("[AuthChallenge] Player address is '%s'", m_address.c_str());
+            if (strcmp(fields[4].GetString(), m_address.c_str()))
             {
                 DEBUG_LOG("[AuthChallenge] Account IP differs");
-                    pkt << (uint8) WOW_FAIL_LOCKED_ENFORCED;
-                send((char const*)pkt.contents(), pkt.size());
-                return true;
+                m_reply << (uint8) WOW_FAIL_LOCKED_ENFORCED;
+                return;
             }
             else
             {
@@ -466,12 +447,11 @@ bool AuthSocket::_HandleLogonChallenge()
         }
         case ACCOUNT_STATE_FROZEN:
         {
-            pkt << uint8(WOW_FAIL_SUSPENDED);
-            send((char const*)pkt.contents(), pkt.size());
-            return true;
+            m_reply << uint8(WOW_FAIL_SUSPENDED);
+            return;
         }
         default:
-            DEBUG_LOG("[AuthChallenge] Account '%s' is not locked to ip or frozen", _login.c_str());
+            DEBUG_LOG("[AuthChallenge] Account '%s' is not locked to ip or frozen", m_login.c_str());
             break;
     }
     ///- If the account is banned, reject the logon attempt
@@ -484,33 +464,30 @@ bool AuthSocket::_HandleLogonChallenge()
     {
         if((*banresult)[0].GetUInt64() == (*banresult)[1].GetUInt64())
         {
-            pkt << uint8(WOW_FAIL_BANNED);
-            sLog.outBasic("[AuthChallenge] Banned account %s tries to login!", _login.c_str ());
+            m_reply << uint8(WOW_FAIL_BANNED);
+            sLog.outBasic("[AuthChallenge] Banned account %s tries to login!", m_login.c_str ());
         }
         else
         {
-            pkt << uint8(WOW_FAIL_SUSPENDED);
-            sLog.outBasic("[AuthChallenge] Temporarily banned account %s tries to login!", _login.c_str ());
+            m_reply << uint8(WOW_FAIL_SUSPENDED);
+            sLog.outBasic("[AuthChallenge] Temporarily banned account %s tries to login!", m_login.c_str ());
         }
 
-        send((char const*)pkt.contents(), pkt.size());
-        return true;
+        return;
     }
 
     QueryResultAutoPtr  emailbanresult = AccountsDatabase.PQuery("SELECT email FROM email_banned WHERE email = '%s'", (*result)[5].GetString());
     if (emailbanresult)
     {
-        pkt << uint8(WOW_FAIL_BANNED);
-        sLog.outBasic("[AuthChallenge] Account %s with banned email %s tries to login!", _login.c_str (), (*emailbanresult)[0].GetString());
-
-        send((char const*)pkt.contents(), pkt.size());
-        return true;
+        m_reply << uint8(WOW_FAIL_BANNED);
+        sLog.outBasic("[AuthChallenge] Account %s with banned email %s tries to login!", m_login.c_str (), (*emailbanresult)[0].GetString());
+        return;
     }
 
     ///- Get the password from the account table, upper it, and make the SRP6 calculation
     std::string rI = fields[0].GetCppString();
 
-    _SetVSFields(rI);
+    SetVSFields(rI);
 
     b.SetRand(19 * 8);
     BigNumber gmod = g.ModExp(b, N);
@@ -522,135 +499,221 @@ bool AuthSocket::_HandleLogonChallenge()
     unk3.SetRand(16 * 8);
 
     ///- Fill the response packet with the result
-    pkt << uint8(WOW_SUCCESS);
+    m_reply << uint8(WOW_SUCCESS);
 
     // B may be calculated < 32B so we force minimal length to 32B
-    pkt.append(B.AsByteArray(32), 32);      // 32 bytes
-    pkt << uint8(1);
-    pkt.append(g.AsByteArray(), 1);
-    pkt << uint8(32);
-    pkt.append(N.AsByteArray(32), 32);
-    pkt.append(s.AsByteArray(), s.GetNumBytes());// 32 bytes
-    pkt.append(unk3.AsByteArray(16), 16);
+    m_reply.append(B.AsByteArray(32), 32);      // 32 bytes
+    m_reply << uint8(1);
+    m_reply.append(g.AsByteArray(), 1);
+    m_reply << uint8(32);
+    m_reply.append(N.AsByteArray(32), 32);
+    m_reply.append(s.AsByteArray(), s.GetNumBytes());// 32 bytes
+    m_reply.append(unk3.AsByteArray(16), 16);
     uint8 securityFlags = 0;
     // Check if token is used
-    _tokenKey = fields[3].GetString();
-        if (!_tokenKey.empty())
+    m_tokenKey = fields[3].GetString();
+        if (!m_tokenKey.empty())
             securityFlags = 4;
 
-    pkt << uint8(securityFlags);            // security flags (0x0...0x04)
+    m_reply << uint8(securityFlags);            // security flags (0x0...0x04)
 
     if (securityFlags & 0x01)                // PIN input
     {
-        pkt << uint32(0);
-        pkt << uint64(0) << uint64(0);      // 16 bytes hash?
+        m_reply << uint32(0);
+        m_reply << uint64(0) << uint64(0);      // 16 bytes hash?
     }
 
     if (securityFlags & 0x02)                // Matrix input
     {
-        pkt << uint8(0);
-        pkt << uint8(0);
-        pkt << uint8(0);
-        pkt << uint8(0);
-        pkt << uint64(0);
+        m_reply << uint8(0);
+        m_reply << uint8(0);
+        m_reply << uint8(0);
+        m_reply << uint8(0);
+        m_reply << uint64(0);
     }
 
     if (securityFlags & 0x04)                // Security token input
-        pkt << uint8(1);
+        m_reply << uint8(1);
 
-    accountPermissionMask_ = fields[4].GetUInt64();
+    m_permissionMask = fields[4].GetUInt64();
 
-    _localizationName.resize(4);
-    for (int i = 0; i < 4; ++i)
-        _localizationName[i] = ch->country[4-i-1];
+    sLog.outBasic("[AuthChallenge] account %s is using '%s' locale (%u)", m_login.c_str (), m_localizationName.c_str(), GetLocaleByName(m_localizationName));
+
+    m_success = true;
+}
 
-    sLog.outBasic("[AuthChallenge] account %s is using '%c%c%c%c' locale (%u)", _login.c_str (), ch->country[3], ch->country[2], ch->country[1], ch->country[0], GetLocaleByName(_localizationName));
+bool LogonChallengeTask::Finish(AuthSocket& socket)
+{
+    if (m_success)
+    {
+        socket.s = s;
+        socket.v = v;
+        socket.b = b;
+        socket.B = B;
+        socket._tokenKey = m_tokenKey;
+        socket.accountPermissionMask_ = m_permissionMask;
+    }
 
-    send((char const*)pkt.contents(), pkt.size());
+    SendReply(socket);
     return true;
 }
 
-/// Logon Proof command handler
-bool AuthSocket::_HandleLogonProof()
+/// Logon Challenge command handler
+bool AuthSocket::_HandleLogonChallenge()
 {
-    DEBUG_LOG("Entering _HandleLogonProof");
-    ///- Read the packet
-    sAuthLogonProof_C lp;
-    if(!recv((char *)&lp, sizeof(sAuthLogonProof_C)))
+    DEBUG_LOG("Entering _HandleLogonChallenge");
+    if (recv_len() < sizeof(sAuthLogonChallenge_C))
         return false;
 
-    ///- Check if the client has one of the expected version numbers
-    bool valid_version = FindBuildInfo(_build) != NULL;
+    ///- Read the first 4 bytes (header) to get the length of the remaining of the packet
+    std::vector<uint8> buf;
+    buf.resize(4);
 
-    /// <ul><li> If the client has no valid version
-    if(!valid_version)
-    {
-        if (this->patch_ != ACE_INVALID_HANDLE)
-            return false;
+    recv((char *)&buf[0], 4);
 
-        ///- Check if we have the apropriate patch on the disk
-        // file looks like: 65535enGB.mpq
-        char tmp[64];
+    EndianConvert(*((uint16*)(buf[0])));
+    uint16 remaining = ((sAuthLogonChallenge_C *)&buf[0])->size;
+    DEBUG_LOG("[AuthChallenge] got header, body is %#04x bytes", remaining);
 
-        snprintf(tmp, 24, "./patches/%d%s.mpq", _build, _localizationName.c_str());
+    if ((remaining < sizeof(sAuthLogonChallenge_C) - buf.size()) || (recv_len() < remaining))
+        return false;
 
-        char filename[PATH_MAX];
-        if (ACE_OS::realpath(tmp, filename) != NULL)
-        {
-            patch_ = ACE_OS::open(filename, GENERIC_READ | FILE_FLAG_SEQUENTIAL_SCAN);
-        }
+    //No big fear of memory outage (size is int16, i.e. < 65536)
+    buf.resize(remaining + buf.size() + 1);
+    buf[buf.size() - 1] = 0;
+    sAuthLogonChallenge_C *ch = (sAuthLogonChallenge_C*)&buf[0];
 
-        if (patch_ == ACE_INVALID_HANDLE)
+    ///- Read the remaining of the packet
+    recv((char *)&buf[4], remaining);
+    DEBUG_LOG("[AuthChallenge] got full packet, %#04x bytes", ch->size);
+    DEBUG_LOG("[AuthChallenge] name(%d): '%s'", ch->I_len, ch->I);
+
+    // BigEndian code, nop in little endian case
+    // size already converted
+    EndianConvert(*((uint32*)(&ch->gamename[0])));
+    EndianConvert(ch->build);
+    EndianConvert(*((uint32*)(&ch->platform[0])));
+    EndianConvert(*((uint32*)(&ch->os[0])));
+    EndianConvert(*((uint32*)(&ch->country[0])));
+    EndianConvert(ch->timezone_bias);
+    EndianConvert(*((uint32*)(&ch->ip[0])));
+
+    std::stringstream tmpLocalIp;
+    tmpLocalIp << (uint32)ch->ip[0] << "." << (uint32)ch->ip[1] << "." << (uint32)ch->ip[2] << "." << (uint32)ch->ip[3];
+
+    localIp_ = tmpLocalIp.str();
+
+    ByteBuffer pkt;
+
+    _login = (const char*)ch->I;
+    _build = ch->build;
+    std::string operatingSystem_ = (const char*)ch->os;
+
+    // Restore string order as its byte order is reversed
+    std::reverse(operatingSystem_.begin(), operatingSystem_.end());
+
+    if (operatingSystem_ == "Win")
+        OS = CLIENT_OS_WIN;
+    else if (operatingSystem_ == "OSX")
+        OS = CLIENT_OS_OSX;
+    else if (sRealmList.GetChatboxOsName() != "" && operatingSystem_ == sRealmList.GetChatboxOsName())
+        OS = CLIENT_OS_CHAT;
+    else {
+        sLog.outLog(LOG_WARDEN, "Client %s got unsupported operating system (%s)", _login.c_str(), operatingSystem_.c_str());
+        return false;
+    }
+
+    ///- Normalize account name
+    //utf8ToUpperOnlyLatin(_login); -- client already send account in expected form
+
+    //Escape the user login to avoid further SQL injection
+    //Memory will be freed on AuthSocket object destruction
+    _safelogin = _login;
+    AccountsDatabase.escape_string(_safelogin);
+
+    pkt << (uint8) CMD_AUTH_LOGON_CHALLENGE;
+    pkt << (uint8) 0x00;
+
+    std::string address = get_remote_address();
+
+#ifdef REGEX_NAMESPACE
+    for (PatternList::const_iterator i = pattern_banned.begin(); i != pattern_banned.end(); ++i)
+    {
+        if (REGEX_NAMESPACE::regex_match(address.c_str(), i->first) && REGEX_NAMESPACE::regex_match(localIp_.c_str(), i->second))
         {
-            // no patch found
-            ByteBuffer pkt;
-            pkt << (uint8) CMD_AUTH_LOGON_CHALLENGE;
-            pkt << (uint8) 0x00;
-            pkt << (uint8) WOW_FAIL_VERSION_INVALID;
-            DEBUG_LOG("[AuthChallenge] %u is not a valid client version!", _build);
-            DEBUG_LOG("[AuthChallenge] Patch %s not found", tmp);
+            pkt<< (uint8) WOW_FAIL_UNKNOWN_ACCOUNT;
             send((char const*)pkt.contents(), pkt.size());
             return true;
         }
+    }
+#endif
 
-        XFER_INIT xferh;
+    _localizationName.resize(4);
+    for (int i = 0; i < 4; ++i)
+        _localizationName[i] = ch->country[4-i-1];
 
-        ACE_OFF_T file_size = ACE_OS::filesize(this->patch_);
+    ScheduleTask(new LogonChallengeTask(*this));
+    return true;
+}
 
-        if (file_size == -1)
+/// SRP6 verification and account update of logon proof
+class LogonProofTask : public AuthTask
+{
+    public:
+        LogonProofTask(AuthSocket& socket, sAuthLogonProof_C const& lp, BigNumber const& proofA, std::string const& token) : AuthTask(socket.socketId_),
+            N(socket.N), s(socket.s), g(socket.g), v(socket.v), b(socket.b), B(socket.B), A(proofA),
+            m_login(socket._login), m_safelogin(socket._safelogin), m_tokenKey(socket._tokenKey), m_token(token),
+            m_address(socket.get_remote_address()), m_localIp(socket.localIp_), m_localizationName(socket._localizationName),
+            m_build(socket._build), m_OS(socket.OS), m_authed(false), m_tokenFailed(false)
         {
-            close_connection();
-            return false;
+            memcpy(m_M1, lp.M1, 20);
+            m_securityFlags = lp.securityFlags;
         }
 
-        if (!PatchCache::instance()->GetHash(tmp, (uint8*)&xferh.md5))
+        void Process();
+        bool Finish(AuthSocket& socket);
+
+    private:
+        void FailedLogin();
+
+        BigNumber N, s, g, v;
+        BigNumber b, B;
+        BigNumber A;
+        BigNumber K;
+        uint8 m_M1[20];
+        uint8 m_securityFlags;
+
+        std::string m_login;
+        std::string m_safelogin;
+        std::string m_tokenKey;
+        std::string m_token;
+        std::string m_address;
+        std::string m_localIp;
+        std::string m_localizationName;
+        uint16 m_build;
+        uint8 m_OS;
+
+        bool m_authed;
+        bool m_tokenFailed;
+};
+
+void LogonProofTask::Process()
+{
+    // Check auth token
+    if ((m_securityFlags & 0x04) || !m_tokenKey.empty())
+    {
+        unsigned int validToken = TOTP::GenerateToken(m_tokenKey.c_str());
+        unsigned int incomingToken = atoi(m_token.c_str());
+        if (validToken != incomingToken)
         {
-            // calculate patch md5, happens if patch was added while realmd was running
-            PatchCache::instance()->LoadPatchMD5(tmp);
-            PatchCache::instance()->GetHash(tmp, (uint8*)&xferh.md5);
+            uint8 data[4] = { CMD_AUTH_LOGON_PROOF, WOW_FAIL_UNKNOWN_ACCOUNT, 3, 0};
+            m_reply.append(data, sizeof(data));
+            m_tokenFailed = true;
+            return;
         }
-
-        uint8 data[2] = { CMD_AUTH_LOGON_PROOF, WOW_FAIL_VERSION_UPDATE};
-        send((const char*)data, sizeof(data));
-
-        memcpy(&xferh, "0\x05Patch", 7);
-        xferh.cmd = CMD_XFER_INITIATE;
-        xferh.file_size = file_size;
-
-        send((const char*)&xferh, sizeof(xferh));
-        return true;
     }
-    /// </ul>
 
     ///- Continue the SRP6 calculation based on data received from the client
-    BigNumber A;
-
-    A.SetBinary(lp.A, 32);
-
-    // SRP safeguard: abort if A==0
-    if (A.isZero())
-        return false;
-
     Sha1Hash sha;
     sha.UpdateBigNumbers(&A, &B, NULL);
     sha.Finalize();
@@ -669,25 +732,6 @@ bool AuthSocket::_HandleLogonProof()
     sha.Initialize();
     sha.UpdateData(t1, 16);
     sha.Finalize();
-        
-	// Check auth token
-        if ((lp.securityFlags & 0x04) || !_tokenKey.empty())
-        {
-            uint8 size;
-            recv((char*)&size, 1);
-            char* token = new char[size + 1];
-            token[size] = '\0';
-            recv(token, size);
-            unsigned int validToken = TOTP::GenerateToken(_tokenKey.c_str());
-            unsigned int incomingToken = atoi(token);
-            delete[] token;
-            if (validToken != incomingToken)
-            {
-                char data[4] = { CMD_AUTH_LOGON_PROOF, WOW_FAIL_UNKNOWN_ACCOUNT, 3, 0};
-                send(data, sizeof(data));
-                return false;
-            }
-        }
     for (int i = 0; i < 20; ++i)
     {
         vK[i * 2] = sha.GetDigest()[i];
@@ -722,7 +766,7 @@ bool AuthSocket::_HandleLogonProof()
     t3.SetBinary(hash, 20);
 
     sha.Initialize();
-    sha.UpdateData(_login);
+    sha.UpdateData(m_login);
     sha.Finalize();
     uint8 t4[SHA_DIGEST_LENGTH];
     memcpy(t4, sha.GetDigest(), SHA_DIGEST_LENGTH);
@@ -736,111 +780,261 @@ bool AuthSocket::_HandleLogonProof()
     M.SetBinary(sha.GetDigest(), 20);
 
     ///- Check if SRP6 results match (password is correct), else send an error
-    if (!memcmp(M.AsByteArray(), lp.M1, 20))
+    if (memcmp(M.AsByteArray(), m_M1, 20))
+    {
+        FailedLogin();
+        return;
+    }
+
+    sLog.outBasic("User '%s' successfully authenticated", m_login.c_str());
+
+    ///- Update the sessionkey, last_ip, last login time and reset number of failed logins in the account table for this account
+    // No SQL injection (escaped user name) and IP address as received by socket
+    QueryResultAutoPtr result = AccountsDatabase.PQuery("SELECT account_id FROM account WHERE username = '%s'", m_safelogin.c_str());
+
+    if (!result)
     {
-        sLog.outBasic("User '%s' successfully authenticated", _login.c_str());
+        BuildProofError(m_reply, m_build);
+        return;
+    }
+
+    uint32 accId = result->Fetch()->GetUInt32();
+
+    const char* K_hex = K.AsHexStr();
+
+    // direct to be sure that values will be set before character choose, this will slow down logging in a bit ;p
+    AccountsDatabase.DirectPExecute("UPDATE account_session SET session_key = '%s' WHERE account_id = '%u'", K_hex, accId);
+
+    OPENSSL_free((void*)K_hex);
+
+    static SqlStatementID updateAccount;
+    SqlStatement stmt = AccountsDatabase.CreateStatement(updateAccount, "UPDATE account SET last_ip = ?, last_local_ip = ?, last_login = NOW(), locale_id = ?, failed_logins = 0, client_os_version_id = ? WHERE account_id = ?");
+    stmt.addString(m_address.c_str());
+    stmt.addString(m_localIp.c_str());
+    stmt.addUInt8(uint8(GetLocaleByName(m_localizationName)));
+    stmt.addUInt8(m_OS);
+    stmt.addUInt32(accId);
+    stmt.DirectExecute();
+
+    ///- Finish SRP6 and send the final result to the client
+    sha.Initialize();
+    sha.UpdateBigNumbers(&A, &M, &K, NULL);
+    sha.Finalize();
 
-        ///- Update the sessionkey, last_ip, last login time and reset number of failed logins in the account table for this account
-        // No SQL injection (escaped user name) and IP address as received by socket
-        const char* K_hex = K.AsHexStr();
+    BuildProof(m_reply, m_build, sha);
 
-        QueryResultAutoPtr result = AccountsDatabase.PQuery("SELECT account_id FROM account WHERE username = '%s'", _safelogin.c_str());
+    m_authed = true;
+}
+
+void LogonProofTask::FailedLogin()
+{
+    BuildProofError(m_reply, m_build);
+    sLog.outBasic("[AuthChallenge] account %s tried to login with wrong password!",m_login.c_str ());
+
+    if (!sRealmList.GetWrongPassCount())
+        return;
 
-        if (!result)
+    static SqlStatementID updateAccountFailedLogins;
+    //Increment number of failed logins by one and if it reaches the limit temporarily ban that account or IP
+    SqlStatement stmt = AccountsDatabase.CreateStatement(updateAccountFailedLogins, "UPDATE account SET failed_logins = failed_logins + 1 WHERE username = ?");
+    stmt.addString(m_login);
+    stmt.Execute();
+
+    if (QueryResultAutoPtr loginfail = AccountsDatabase.PQuery("SELECT account_id, failed_logins FROM account WHERE username = '%s'", m_safelogin.c_str()))
+    {
+        Field* fields = loginfail->Fetch();
+        uint32 failed_logins = fields[1].GetUInt32();
+
+        if (failed_logins >= sRealmList.GetWrongPassCount())
         {
-            if (_build > 6005)                                  // > 1.12.2
+            if (sRealmList.GetWrongPassBanType())
             {
-                char data[4] = { CMD_AUTH_LOGON_PROOF, WOW_FAIL_UNKNOWN_ACCOUNT, 3, 0};
-                send(data, sizeof(data));
+                uint32 acc_id = fields[0].GetUInt32();
+                AccountsDatabase.PExecute("INSERT INTO account_punishment VALUES ('%u', '%u', UNIX_TIMESTAMP(), UNIX_TIMESTAMP()+%u, 'Realm', 'Incorrect password for: %u times. Ban for: %u seconds', '1')",
+                                        acc_id, PUNISHMENT_BAN, sRealmList.GetWrongPassBanTime(), failed_logins, sRealmList.GetWrongPassBanTime());
+                sLog.outBasic("[AuthChallenge] account %s got banned for '%u' seconds because it failed to authenticate '%u' times",
+                    m_login.c_str(), sRealmList.GetWrongPassBanTime(), failed_logins);
             }
             else
             {
-                // 1.x not react incorrectly at 4-byte message use 3 as real error
-                char data[2] = { CMD_AUTH_LOGON_PROOF, WOW_FAIL_UNKNOWN_ACCOUNT};
-                send(data, sizeof(data));
+                std::string current_ip = m_address;
+                AccountsDatabase.escape_string(current_ip);
+                AccountsDatabase.PExecute("INSERT INTO ip_banned VALUES ('%s',UNIX_TIMESTAMP(),UNIX_TIMESTAMP()+'%u','Realm','Incorrect password for: %u times. Ban for: %u seconds')",
+                    current_ip.c_str(), sRealmList.GetWrongPassBanTime(), failed_logins, sRealmList.GetWrongPassBanTime());
+                sLog.outBasic("[AuthChallenge] IP %s got banned for '%u' seconds because account %s failed to authenticate '%u' times",
+                    current_ip.c_str(), sRealmList.GetWrongPassBanTime(), m_login.c_str(), failed_logins);
             }
-            return true;
         }
+    }
+}
 
-        uint32 accId = result->Fetch()->GetUInt32();
+bool LogonProofTask::Finish(AuthSocket& socket)
+{
+    if (m_tokenFailed)
+    {
+        SendReply(socket);
+        return false;
+    }
 
-        // direct to be sure that values will be set before character choose, this will slow down logging in a bit ;p
-        AccountsDatabase.DirectPExecute("UPDATE account_session SET session_key = '%s' WHERE account_id = '%u'", K_hex, accId);
+    socket.K = K;
 
-        static SqlStatementID updateAccount;
-        SqlStatement stmt = AccountsDatabase.CreateStatement(updateAccount, "UPDATE account SET last_ip = ?, last_local_ip = ?, last_login = NOW(), locale_id = ?, failed_logins = 0, client_os_version_id = ? WHERE account_id = ?");
-        std::string tmpIp = get_remote_address();
-        stmt.addString(tmpIp.c_str());
-        stmt.addString(localIp_.c_str());
-        stmt.addUInt8(uint8(GetLocaleByName(_localizationName)));
-        stmt.addUInt8(OS);
-        stmt.addUInt32(accId);
-        stmt.DirectExecute();
+    ///- Set _authed to true!
+    if (m_authed)
+        socket._authed = true;
 
-        OPENSSL_free((void*)K_hex);
+    SendReply(socket);
+    return true;
+}
 
-        ///- Finish SRP6 and send the final result to the client
-        sha.Initialize();
-        sha.UpdateBigNumbers(&A, &M, &K, NULL);
-        sha.Finalize();
+/// Logon Proof command handler
+bool AuthSocket::_HandleLogonProof()
+{
+    DEBUG_LOG("Entering _HandleLogonProof");
+    ///- Read the packet
+    sAuthLogonProof_C lp;
+    if(!recv((char *)&lp, sizeof(sAuthLogonProof_C)))
+        return false;
 
-        SendProof(sha);
+    ///- Check if the client has one of the expected version numbers
+    bool valid_version = FindBuildInfo(_build) != NULL;
 
-        ///- Set _authed to true!
-        _authed = true;
-    }
-    else
+    /// <ul><li> If the client has no valid version
+    if(!valid_version)
     {
-        if (_build > 6005)                                  // > 1.12.2
+        if (this->patch_ != ACE_INVALID_HANDLE)
+            return false;
+
+        ///- Check if we have the apropriate patch on the disk
+        // file looks like: 65535enGB.mpq
+        char tmp[64];
+
+        snprintf(tmp, 24, "./patches/%d%s.mpq", _build, _localizationName.c_str());
+
+        char filename[PATH_MAX];
+        if (ACE_OS::realpath(tmp, filename) != NULL)
         {
-            char data[4] = { CMD_AUTH_LOGON_PROOF, WOW_FAIL_UNKNOWN_ACCOUNT, 3, 0};
-            send(data, sizeof(data));
+            patch_ = ACE_OS::open(filename, GENERIC_READ | FILE_FLAG_SEQUENTIAL_SCAN);
         }
-        else
+
+        if (patch_ == ACE_INVALID_HANDLE)
         {
-            // 1.x not react incorrectly at 4-byte message use 3 as real error
-            char data[2] = { CMD_AUTH_LOGON_PROOF, WOW_FAIL_UNKNOWN_ACCOUNT};
-            send(data, sizeof(data));
+            // no patch found
+            ByteBuffer pkt;
+            pkt << (uint8) CMD_AUTH_LOGON_CHALLENGE;
+            pkt << (uint8) 0x00;
+            pkt << (uint8) WOW_FAIL_VERSION_INVALID;
+            DEBUG_LOG("[AuthChallenge] %u is not a valid client version!", _build);
+            DEBUG_LOG("[AuthChallenge] Patch %s not found", tmp);
+            send((char const*)pkt.contents(), pkt.size());
+            return true;
         }
-        sLog.outBasic("[AuthChallenge] account %s tried to login with wrong password!",_login.c_str ());
 
-        
-        if (sRealmList.GetWrongPassCount())
-        {
-            static SqlStatementID updateAccountFailedLogins;
-            //Increment number of failed logins by one and if it reaches the limit temporarily ban that account or IP
-            SqlStatement stmt = AccountsDatabase.CreateStatement(updateAccountFailedLogins, "UPDATE account SET failed_logins = failed_logins + 1 WHERE username = ?");
-            stmt.addString(_login);
-            stmt.Execute();
+        XFER_INIT xferh;
 
-            if (QueryResultAutoPtr loginfail = AccountsDatabase.PQuery("SELECT account_id, failed_logins FROM account WHERE username = '%s'", _safelogin.c_str()))
-            {
-                Field* fields = loginfail->Fetch();
-                uint32 failed_logins = fields[1].GetUInt32();
+        ACE_OFF_T file_size = ACE_OS::filesize(this->patch_);
 
-                if (failed_logins >= sRealmList.GetWrongPassCount())
-                {
-                    if (sRealmList.GetWrongPassBanType())
-                    {
-                        uint32 acc_id = fields[0].GetUInt32();
-                        AccountsDatabase.PExecute("INSERT INTO account_punishment VALUES ('%u', '%u', UNIX_TIMESTAMP(), UNIX_TIMESTAMP()+%u, 'Realm', 'Incorrect password for: %u times. Ban for: %u seconds', '1')",
-                                                acc_id, PUNISHMENT_BAN, sRealmList.GetWrongPassBanTime(), failed_logins, sRealmList.GetWrongPassBanTime());
-                        sLog.outBasic("[AuthChallenge] account %s got banned for '%u' seconds because it failed to authenticate '%u' times",
-                            _login.c_str(), sRealmList.GetWrongPassBanTime(), failed_logins);
-                    }
-                    else
-                    {
-                        std::string current_ip = get_remote_address();
-                        AccountsDatabase.escape_string(current_ip);
-                        AccountsDatabase.PExecute("INSERT INTO ip_banned VALUES ('%s',UNIX_TIMESTAMP(),UNIX_TIMESTAMP()+'%u','Realm','Incorrect password for: %u times. Ban for: %u seconds')",
-                            current_ip.c_str(), sRealmList.GetWrongPassBanTime(), failed_logins, sRealmList.GetWrongPassBanTime());
-                        sLog.outBasic("[AuthChallenge] IP %s got banned for '%u' seconds because account %s failed to authenticate '%u' times",
-                            current_ip.c_str(), sRealmList.GetWrongPassBanTime(), _login.c_str(), failed_logins);
-                    }
-                }
-            }
+        if (file_size == -1)
+        {
+            close_connection();
+            return false;
+        }
+
+        if (!PatchCache::instance()->GetHash(tmp, (uint8*)&xferh.md5))
+        {
+            // calculate patch md5, happens if patch was added while realmd was running
+            PatchCache::instance()->LoadPatchMD5(tmp);
+            PatchCache::instance()->GetHash(tmp, (uint8*)&xferh.md5);
         }
+
+        uint8 data[2] = { CMD_AUTH_LOGON_PROOF, WOW_FAIL_VERSION_UPDATE};
+        send((const char*)data, sizeof(data));
+
+        memcpy(&xferh, "0\x05Patch", 7);
+        xferh.cmd = CMD_XFER_INITIATE;
+        xferh.file_size = file_size;
+
+        send((const char*)&xferh, sizeof(xferh));
+        return true;
+    }
+    /// </ul>
+
+    ///- SRP safeguard: abort if A==0
+    BigNumber A;
+    A.SetBinary(lp.A, 32);
+    if (A.isZero())
+        return false;
+
+    ///- Token is checked together with SRP6 results on auth worker thread
+    std::string token;
+    if ((lp.securityFlags & 0x04) || !_tokenKey.empty())
+    {
+        uint8 size = 0;
+        recv((char*)&size, 1);
+        char* tokenData = new char[size + 1];
+        tokenData[size] = '\0';
+        recv(tokenData, size);
+        token = tokenData;
+        delete[] tokenData;
+    }
+
+    ScheduleTask(new LogonProofTask(*this, lp, A, token));
+    return true;
+}
+
+/// Session key lookup of reconnect challenge
+class ReconnectChallengeTask : public AuthTask
+{
+    public:
+        explicit ReconnectChallengeTask(AuthSocket& socket) : AuthTask(socket.socketId_),
+            m_login(socket._login), m_safelogin(socket._safelogin), m_found(false) {}
+
+        void Process();
+        bool Finish(AuthSocket& socket);
+
+    private:
+        std::string m_login;
+        std::string m_safelogin;
+
+        std::string m_sessionKey;
+        BigNumber m_reconnectProof;
+        bool m_found;
+};
+
+void ReconnectChallengeTask::Process()
+{
+    QueryResultAutoPtr  result = AccountsDatabase.PQuery("SELECT session_key FROM account JOIN account_session ON account.account_id = account_session.account_id WHERE username = '%s'", m_safelogin.c_str());
+
+    // Stop if the account is not found
+    if (!result)
+    {
+        sLog.outLog(LOG_DEFAULT, "ERROR: [ERROR] user %s tried to login and we cannot find his session key in the database.", m_login.c_str());
+        return;
+    }
+
+    Field* fields = result->Fetch ();
+    m_sessionKey = fields[0].GetCppString();
+
+    ///- Sending response
+    m_reply << uint8(CMD_AUTH_RECONNECT_CHALLENGE);
+    m_reply << uint8(0x00);
+    m_reconnectProof.SetRand(16 * 8);
+    m_reply.append(m_reconnectProof.AsByteArray(16),16);    // 16 bytes random
+    m_reply << uint64(0x00) << uint64(0x00);                // 16 bytes zeros
+    m_found = true;
+}
+
+bool ReconnectChallengeTask::Finish(AuthSocket& socket)
+{
+    if (!m_found)
+    {
+        socket.close_connection();
+        return false;
     }
+
+    socket.K.SetHexStr(m_sessionKey.c_str());
+    socket._reconnectProof = m_reconnectProof;
+
+    SendReply(socket);
     return true;
 }
 
@@ -882,27 +1076,7 @@ bool AuthSocket::_HandleReconnectChallenge()
     EndianConvert(ch->build);
     _build = ch->build;
 
-    QueryResultAutoPtr  result = AccountsDatabase.PQuery("SELECT session_key FROM account JOIN account_session ON account.account_id = account_session.account_id WHERE username = '%s'", _safelogin.c_str());
-
-    // Stop if the account is not found
-    if (!result)
-    {
-        sLog.outLog(LOG_DEFAULT, "ERROR: [ERROR] user %s tried to login and we cannot find his session key in the database.", _login.c_str());
-        close_connection();
-        return false;
-    }
-
-    Field* fields = result->Fetch ();
-    K.SetHexStr (fields[0].GetString ());
-
-    ///- Sending response
-    ByteBuffer pkt;
-    pkt << uint8(CMD_AUTH_RECONNECT_CHALLENGE);
-    pkt << uint8(0x00);
-    _reconnectProof.SetRand(16 * 8);
-    pkt.append(_reconnectProof.AsByteArray(16),16);         // 16 bytes random
-    pkt << uint64(0x00) << uint64(0x00);                    // 16 bytes zeros
-    send((char const*)pkt.contents(), pkt.size());
+    ScheduleTask(new ReconnectChallengeTask(*this));
     return true;
 }
 
@@ -949,47 +1123,90 @@ bool AuthSocket::_HandleReconnectProof()
     }
 }
 
-/// %Realm List command handler
-bool AuthSocket::_HandleRealmList()
+/// Account and character counts lookup of realm list, the list itself is built on reactor thread
+class RealmListTask : public AuthTask
 {
-    DEBUG_LOG("Entering _HandleRealmList");
-    if (recv_len() < 5)
-        return false;
+    public:
+        explicit RealmListTask(AuthSocket& socket) : AuthTask(socket.socketId_),
+            m_login(socket._login), m_safelogin(socket._safelogin), m_found(false) {}
 
-    recv_skip(5);
+        void Process();
+        bool Finish(AuthSocket& socket);
+
+    private:
+        std::string m_login;
+        std::string m_safelogin;
+
+        RealmCharacterCounts m_characterCounts;
+        bool m_found;
+};
 
+void RealmListTask::Process()
+{
     ///- Get the user id (else close the connection)
     // No SQL injection (escaped user name)
 
-    QueryResultAutoPtr  result = AccountsDatabase.PQuery("SELECT account_id, pass_hash FROM account WHERE username = '%s'", _safelogin.c_str());
+    QueryResultAutoPtr  result = AccountsDatabase.PQuery("SELECT account_id FROM account WHERE username = '%s'", m_safelogin.c_str());
     if (!result)
     {
-        sLog.outLog(LOG_DEFAULT, "ERROR: [ERROR] user %s tried to login and we cannot find him in the database.",_login.c_str());
-        close_connection();
-        return false;
+        sLog.outLog(LOG_DEFAULT, "ERROR: [ERROR] user %s tried to login and we cannot find him in the database.",m_login.c_str());
+        return;
     }
 
     uint32 id = (*result)[0].GetUInt32();
-    std::string rI = (*result)[1].GetCppString();
+    m_found = true;
+
+    // character counts on all realms with single query instead of one per realm
+    result = AccountsDatabase.PQuery("SELECT realm_id, characters_count FROM realm_characters WHERE account_id = '%u'", id);
+    if (result)
+    {
+        do
+        {
+            Field *fields = result->Fetch();
+            m_characterCounts[fields[0].GetUInt32()] = fields[1].GetUInt8();
+        }
+        while (result->NextRow());
+    }
+}
+
+bool RealmListTask::Finish(AuthSocket& socket)
+{
+    if (!m_found)
+    {
+        socket.close_connection();
+        return false;
+    }
 
     ///- Update realm list if need
     sRealmList.UpdateIfNeed();
 
     ///- Circle through realms in the RealmList and construct the return packet (including # of user characters in each realm)
     ByteBuffer pkt;
-    LoadRealmlist(pkt, id);
+    socket.LoadRealmlist(pkt, m_characterCounts);
 
     ByteBuffer hdr;
     hdr << uint8(CMD_REALM_LIST);
     hdr << uint16(pkt.size());
     hdr.append(pkt);
 
-    send((char const*)hdr.contents(), hdr.size());
+    socket.send((char const*)hdr.contents(), hdr.size());
+    return true;
+}
 
+/// %Realm List command handler
+bool AuthSocket::_HandleRealmList()
+{
+    DEBUG_LOG("Entering _HandleRealmList");
+    if (recv_len() < 5)
+        return false;
+
+    recv_skip(5);
+
+    ScheduleTask(new RealmListTask(*this));
     return true;
 }
 
-void AuthSocket::LoadRealmlist(ByteBuffer &pkt, uint32 acctid)
+void AuthSocket::LoadRealmlist(ByteBuffer &pkt, RealmCharacterCounts &characterCounts)
 {
     switch (_build)
     {
@@ -1001,17 +1218,7 @@ void AuthSocket::LoadRealmlist(ByteBuffer &pkt, uint32 acctid)
 
             for (RealmList::RealmMap::const_iterator  i = sRealmList.begin(); i != sRealmList.end(); ++i)
             {
-                uint8 AmountOfCharacters;
-
-                // No SQL injection. id of realm is controlled by the database.
-                QueryResultAutoPtr result = AccountsDatabase.PQuery( "SELECT characters_count FROM realm_characters WHERE realm_id = '%u' AND account_id = '%u'", i->second.m_ID, acctid);
-                if (result)
-                {
-                    Field *fields = result->Fetch();
-                    AmountOfCharacters = fields[0].GetUInt8();
-                }
-                else
-                    AmountOfCharacters = 0;
+                uint8 AmountOfCharacters = characterCounts[i->second.m_ID];
 
                 bool ok_build = std::find(i->second.realmbuilds.begin(), i->second.realmbuilds.end(), _build) != i->second.realmbuilds.end();
 
@@ -1061,17 +1268,7 @@ void AuthSocket::LoadRealmlist(ByteBuffer &pkt, uint32 acctid)
 
             for (RealmList::RealmMap::const_iterator  i = sRealmList.begin(); i != sRealmList.end(); ++i)
             {
-                uint8 AmountOfCharacters;
-
-                // No SQL injection. id of realm is controlled by the database.
-                QueryResultAutoPtr result = AccountsDatabase.PQuery("SELECT characters_count FROM realm_characters WHERE realm_id = '%u' AND account_id = '%u'", i->second.m_ID, acctid);
-                if (result)
-                {
-                    Field *fields = result->Fetch();
-                    AmountOfCharacters = fields[0].GetUInt8();
-                }
-                else
-                    AmountOfCharacters = 0;
+                uint8 AmountOfCharacters = characterCounts[i->second.m_ID];
 
                 bool ok_build = std::find(i->second.realmbuilds.begin(), i->second.realmbuilds.end(), _build) != i->second.realmbuilds.end();
 
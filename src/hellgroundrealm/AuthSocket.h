@@ -34,13 +34,27 @@
 
 #include "BufferedSocket.h"
 
+#include <map>
+
 #ifdef REGEX_NAMESPACE
 typedef std::list<std::pair<REGEX_NAMESPACE::regex, REGEX_NAMESPACE::regex > > PatternList; // <IP pattern, LocalIP pattern>
 #endif
 
+class AuthTask;
+
+/// characters count of account by realm id
+typedef std::map<uint32, uint8> RealmCharacterCounts;
+
 /// Handle login commands
+/// Account lookups and SRP6 math of logon commands run as AuthTask on auth worker threads,
+/// no more commands are handled by socket until its pending task is finished.
 class AuthSocket: public BufferedSocket
 {
+    friend class LogonChallengeTask;
+    friend class LogonProofTask;
+    friend class ReconnectChallengeTask;
+    friend class RealmListTask;
+
     public:
         const static int s_BYTE_SIZE = 32;
 
@@ -49,8 +63,10 @@ class AuthSocket: public BufferedSocket
 
         void OnAccept();
         void OnRead();
-        void SendProof(Sha1Hash sha);
-        void LoadRealmlist(ByteBuffer &pkt, uint32 acctid);
+        void LoadRealmlist(ByteBuffer &pkt, RealmCharacterCounts &characterCounts);
+
+        // called by sAuthWorker on reactor thread
+        void FinishTask(AuthTask* task);
 
         bool _HandleLogonChallenge();
         bool _HandleLogonProof();
@@ -63,13 +79,15 @@ class AuthSocket: public BufferedSocket
         bool _HandleXferCancel();
         bool _HandleXferAccept();
 
-        void _SetVSFields(const std::string& rI);
-
 #ifdef REGEX_NAMESPACE
         static PatternList pattern_banned;
 #endif
 
     private:
+        void ScheduleTask(AuthTask* task);
+
+        uint32 socketId_;
+        bool taskPending_;
 
         BigNumber N, s, g, v;
         BigNumber b, B;
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2008-2014 Hellground <http://hellground.net/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/** \file
+    \ingroup realmd
+*/
+
+#include "AuthWorker.h"
+#include "AuthSocket.h"
+#include "Database/DatabaseEnv.h"
+#include "Log.h"
+
+#include <ace/Method_Request.h>
+#include <ace/Reactor.h>
+
+extern DatabaseType AccountsDatabase;
+
+class ADBThreadStartReq : public ACE_Method_Request
+{
+    public:
+        ADBThreadStartReq() {}
+        virtual int call(void)
+        {
+            AccountsDatabase.ThreadStart();
+            return 0;
+        }
+};
+
+class ADBThreadEndReq : public ACE_Method_Request
+{
+    public:
+        ADBThreadEndReq() {}
+        virtual int call(void)
+        {
+            AccountsDatabase.ThreadEnd();
+            return 0;
+        }
+};
+
+class AuthTaskRequest : public ACE_Method_Request
+{
+    public:
+        AuthTaskRequest(AuthWorker& worker, AuthTask* task) : m_worker(worker), m_task(task) {}
+
+        virtual int call(void)
+        {
+            m_task->Process();
+            m_worker.Complete(m_task);
+            return 0;
+        }
+
+    private:
+        AuthWorker& m_worker;
+        AuthTask* m_task;
+};
+
+void AuthTask::SendReply(AuthSocket& socket)
+{
+    if (!m_reply.empty())
+        socket.send((char const*)m_reply.contents(), m_reply.size());
+}
+
+AuthWorker::AuthWorker() : m_nextSocketId(0)
+{
+}
+
+bool AuthWorker::Initialize(uint32 threads)
+{
+    if (!threads)
+        return true;
+
+    if (m_executor.activate(threads, new ADBThreadStartReq, new ADBThreadEndReq) == -1)
+        return false;
+
+    sLog.outString("Using %u auth worker threads", threads);
+    return true;
+}
+
+void AuthWorker::Shutdown()
+{
+    if (m_executor.activated())
+        m_executor.deactivate();
+}
+
+uint32 AuthWorker::RegisterSocket(AuthSocket* socket)
+{
+    // 0 is never used, ids are not reused before counter wraps
+    if (!++m_nextSocketId)
+        ++m_nextSocketId;
+
+    m_sockets[m_nextSocketId] = socket;
+    return m_nextSocketId;
+}
+
+void AuthWorker::UnregisterSocket(uint32 socketId)
+{
+    m_sockets.erase(socketId);
+}
+
+void AuthWorker::Schedule(AuthTask* task)
+{
+    if (m_executor.activated())
+    {
+        m_executor.execute(new AuthTaskRequest(*this, task));
+        return;
+    }
+
+    // result is still applied through notification, so socket never finishes task inside of its own command handler
+    task->Process();
+    Complete(task);
+}
+
+void AuthWorker::Complete(AuthTask* task)
+{
+    bool notify;
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+        // notification is already pending when queue is not empty
+        notify = m_completed.empty();
+        m_completed.push_back(task);
+    }
+
+    if (notify)
+        ACE_Reactor::instance()->notify(this);
+}
+
+int AuthWorker::handle_exception(ACE_HANDLE)
+{
+    std::vector<AuthTask*> completed;
+    {
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, 0);
+        completed.swap(m_completed);
+    }
+
+    for (std::vector<AuthTask*>::iterator itr = completed.begin(); itr != completed.end(); ++itr)
+    {
+        SocketMap::iterator socket = m_sockets.find((*itr)->GetSocketId());
+        if (socket != m_sockets.end())
+            socket->second->FinishTask(*itr);
+
+        delete *itr;
+    }
+
+    return 0;
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2008-2014 Hellground <http://hellground.net/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/// \addtogroup realmd
+/// @{
+/// \file
+
+#ifndef HELLGROUND_AUTHWORKER_H
+#define HELLGROUND_AUTHWORKER_H
+
+#include "Common.h"
+#include "ByteBuffer.h"
+#include "DelayExecutor.h"
+
+#include <ace/Event_Handler.h>
+#include <ace/Singleton.h>
+#include <ace/Thread_Mutex.h>
+
+#include <map>
+#include <vector>
+
+class AuthSocket;
+
+/// Account lookups and SRP6 math of one auth command. Process() runs on an auth worker thread
+/// and works only with data copied from the socket, because the socket may be closed meanwhile.
+class AuthTask
+{
+    public:
+        explicit AuthTask(uint32 socketId) : m_socketId(socketId) {}
+        virtual ~AuthTask() {}
+
+        uint32 GetSocketId() const { return m_socketId; }
+
+        // worker thread
+        virtual void Process() = 0;
+
+        // reactor thread, returns false when socket should not handle more input
+        virtual bool Finish(AuthSocket& socket) = 0;
+
+    protected:
+        void SendReply(AuthSocket& socket);
+
+        ByteBuffer m_reply;                                 // built by Process(), sent by Finish()
+
+    private:
+        uint32 m_socketId;
+};
+
+/// Runs auth tasks on worker threads and hands results back to the reactor thread through reactor notification
+class AuthWorker : public ACE_Event_Handler
+{
+    public:
+        AuthWorker();
+
+        // with 0 threads tasks are processed on reactor thread
+        bool Initialize(uint32 threads);
+        void Shutdown();
+
+        // reactor thread
+        uint32 RegisterSocket(AuthSocket* socket);
+        void UnregisterSocket(uint32 socketId);
+        void Schedule(AuthTask* task);
+
+        // worker thread
+        void Complete(AuthTask* task);
+
+        // reactor thread, finishes completed tasks of sockets which are still connected
+        int handle_exception(ACE_HANDLE);
+
+    private:
+        typedef std::map<uint32, AuthSocket*> SocketMap;
+
+        DelayExecutor m_executor;
+
+        SocketMap m_sockets;                                // used only by reactor thread
+        uint32 m_nextSocketId;
+
+        ACE_Thread_Mutex m_lock;                            // guards completed tasks
+        std::vector<AuthTask*> m_completed;
+};
+
+#define sAuthWorker (*ACE_Singleton<AuthWorker, ACE_Null_Mutex>::instance())
+
+#endif
+/// @}
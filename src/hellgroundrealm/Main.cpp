@@ -28,6 +28,7 @@
 #include "Config/Config.h"
 #include "Log.h"
 #include "AuthSocket.h"
+#include "AuthWorker.h"
 #include "SystemConfig.h"
 #include "revision.h"
 #include "Util.h"
@@ -40,6 +41,8 @@
 #include <ace/ACE.h>
 #include <ace/Acceptor.h>
 #include <ace/SOCK_Acceptor.h>
+#include <ace/Thread.h>
+#include <ace/Thread_Mutex.h>
 
 #include <ace/Get_Opt.h>
 
@@ -65,6 +68,8 @@ RunModes runMode = MODE_NORMAL;
 bool StartDB();
 void UnhookSignals();
 void HookSignals();
+void InitCryptoLocks();
+void CleanupCryptoLocks();
 
 bool stopEvent = false;                                     ///< Setting it to true stops the server
 
@@ -264,6 +269,16 @@ extern int main(int argc, char **argv)
     // set expired bans to inactive
     AccountsDatabase.Execute("DELETE FROM ip_banned WHERE expiration_date <= UNIX_TIMESTAMP() AND expiration_date <> punishment_date");
 
+    ///- OpenSSL is used by auth worker threads at the same time, it must be able to lock its internal state
+    InitCryptoLocks();
+
+    ///- Launch auth worker threads, account queries and SRP6 math of logon commands run there
+    if (!sAuthWorker.Initialize(sConfig.GetIntDefault("AuthWorker.Threads", 2)))
+    {
+        sLog.outLog(LOG_DEFAULT, "ERROR: Cannot start auth worker threads");
+        return 1;
+    }
+
     ///- Launch the listening network socket
     ACE_Acceptor<AuthSocket, ACE_SOCK_Acceptor> acceptor;
 
@@ -358,8 +373,10 @@ extern int main(int argc, char **argv)
 #endif
     }
 
-    ///- Wait for the delay thread to exit
+    ///- Wait for auth worker threads and the delay thread to exit
+    sAuthWorker.Shutdown();
     AccountsDatabase.HaltDelayThread();
+    CleanupCryptoLocks();
 
     ///- Remove signal handling before leaving
     UnhookSignals();
@@ -400,7 +417,10 @@ bool StartDB()
 
     //sLog.outString("Database: %s", dbstring.c_str() );
 
-    if(!AccountsDatabase.Initialize(dbstring.c_str()))
+    // each auth worker thread may query login database at the same time
+    int nConnections = std::max(sConfig.GetIntDefault("AuthWorker.Threads", 2), 1);
+
+    if(!AccountsDatabase.Initialize(dbstring.c_str(), nConnections))
     {
         sLog.outLog(LOG_DEFAULT, "ERROR: Cannot connect to database");
         return false;
@@ -429,6 +449,56 @@ void UnhookSignals()
     #endif
 }
 
+// OpenSSL 1.1 and newer locks by itself, older versions use callbacks set by application
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+static std::vector<ACE_Thread_Mutex*> cryptoLocks;
+
+static void CryptoLockingCallback(int mode, int type, const char* /*file*/, int /*line*/)
+{
+    if (mode & CRYPTO_LOCK)
+        cryptoLocks[type]->acquire();
+    else
+        cryptoLocks[type]->release();
+}
+
+#if OPENSSL_VERSION_NUMBER < 0x10000000L
+static unsigned long CryptoThreadIdCallback()
+{
+    return (unsigned long)ACE_Thread::self();
+}
+#endif
+#endif
+
+/// Install OpenSSL locking callbacks before any other thread uses OpenSSL
+void InitCryptoLocks()
+{
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+    cryptoLocks.resize(CRYPTO_num_locks());
+    for (int i = 0; i < CRYPTO_num_locks(); ++i)
+        cryptoLocks[i] = new ACE_Thread_Mutex();
+
+#if OPENSSL_VERSION_NUMBER < 0x10000000L
+    CRYPTO_set_id_callback(&CryptoThreadIdCallback);
+#endif
+    CRYPTO_set_locking_callback(&CryptoLockingCallback);
+#endif
+}
+
+/// Remove OpenSSL locking callbacks after all threads using OpenSSL are stopped
+void CleanupCryptoLocks()
+{
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+    CRYPTO_set_locking_callback(NULL);
+#if OPENSSL_VERSION_NUMBER < 0x10000000L
+    CRYPTO_set_id_callback(NULL);
+#endif
+
+    for (std::vector<ACE_Thread_Mutex*>::iterator itr = cryptoLocks.begin(); itr != cryptoLocks.end(); ++itr)
+        delete *itr;
+    cryptoLocks.clear();
+#endif
+}
+
 void RealmList::Initialize()
 {
     m_UpdateInterval = sConfig.GetIntDefault("RealmsStateUpdateDelay", 20);
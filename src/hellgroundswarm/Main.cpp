@@ -0,0 +1,335 @@
+/*
+ * Copyright (C) 2008-2014 Hellground <http://hellground.net/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/// \addtogroup swarm Client swarm load generator
+/// @{
+/// \file
+
+#include "Common.h"
+#include "SwarmBot.h"
+#include "SwarmStats.h"
+#include "Threading.h"
+#include "Timer.h"
+
+#include <ace/ACE.h>
+#include <ace/Get_Opt.h>
+#include <ace/Handle_Set.h>
+
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+volatile bool stopEvent = false;                            ///< Setting it to true stops all bots
+
+/// Print out the usage string for this program on the console.
+void usage(const char *prog)
+{
+    printf("Usage: \n %s [<options>]\n"
+        "    -r host:port             realm server address (default 127.0.0.1:3724)\n"
+        "    -m realm_name            realm to join (default first in realm list)\n"
+        "    -a prefix                account name prefix (default SWARM)\n"
+        "    -p password              password of all accounts (default SWARM)\n"
+        "    -o first                 index of first account (default 1)\n"
+        "    -n bots                  number of bots (default 100)\n"
+        "    -t threads               number of bot threads (default 4)\n"
+        "    -l logins                logins per second (default 20)\n"
+        "    -f path_file             recorded paths, 'x y z' per line, paths separated by empty line\n"
+        "    -c seconds               chat interval, 0 disables (default 30)\n"
+        "    -s spell_id              spell cast on self, 0 disables (default 2457)\n"
+        "    -u guid                  auctioneer guid to search auctions at (default none)\n"
+        "    -i seconds               report interval (default 10)\n"
+        "    -d seconds               stop after given time (default run until interrupted)\n"
+        "    -g count                 print SQL creating accounts for count bots and exit\n"
+        , prog);
+}
+
+void OnSignal(int s)
+{
+    switch (s)
+    {
+        case SIGINT:
+        case SIGTERM:
+            stopEvent = true;
+            break;
+    }
+
+    signal(s, OnSignal);
+}
+
+/// Recorded positions are converted to offsets from first point of each path
+bool LoadPaths(char const* fileName, std::vector<SwarmPath>& paths)
+{
+    std::ifstream file(fileName);
+    if (!file)
+        return false;
+
+    SwarmPath path;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (!line.empty() && line[0] == '#')
+            continue;
+
+        float x, y, z;
+        std::istringstream point(line);
+        if (!(point >> x >> y >> z))
+        {
+            if (!path.empty())
+                paths.push_back(path);
+            path.clear();
+            continue;
+        }
+
+        if (path.empty())
+            path.push_back(SwarmPathPoint(x, y, z));
+        else
+            path.push_back(SwarmPathPoint(x - path.front().x, y - path.front().y, z - path.front().z));
+    }
+
+    if (!path.empty())
+        paths.push_back(path);
+
+    for (std::vector<SwarmPath>::iterator itr = paths.begin(); itr != paths.end(); ++itr)
+        itr->front() = SwarmPathPoint(0.0f, 0.0f, 0.0f);
+
+    return !paths.empty();
+}
+
+/// Accounts are created the same way as by .account create
+void PrintAccountSQL(SwarmConfig const& config, uint32 count)
+{
+    std::string password = config.password;
+    std::transform(password.begin(), password.end(), password.begin(), ::toupper);
+
+    for (uint32 i = 0; i < count; ++i)
+    {
+        std::string name = SwarmBot::GetAccountName(config.accountPrefix, config.firstAccount + i);
+        printf("INSERT INTO account(username, pass_hash, join_date) VALUES ('%s', SHA1(CONCAT('%s', ':', '%s')), NOW());\n",
+            name.c_str(), name.c_str(), password.c_str());
+    }
+}
+
+/// Owns a share of bots, logs them in at configured rate and polls their world sockets
+class SwarmRunnable : public ACE_Based::Runnable
+{
+    public:
+        SwarmRunnable(SwarmConfig const& config, uint32 thread) : m_loginDelay(0)
+        {
+            for (uint32 i = thread; i < config.botCount; i += config.threads)
+                m_bots.push_back(new SwarmBot(config, i));
+
+            if (config.loginsPerSecond)
+                m_loginDelay = 1000 * config.threads / config.loginsPerSecond;
+        }
+
+        ~SwarmRunnable()
+        {
+            for (std::vector<SwarmBot*>::iterator itr = m_bots.begin(); itr != m_bots.end(); ++itr)
+                delete *itr;
+        }
+
+        void run()
+        {
+            size_t started = 0;
+            uint32 nextLogin = WorldTimer::getMSTime();
+
+            while (!stopEvent)
+            {
+                uint32 now = WorldTimer::getMSTime();
+                if (now >= nextLogin)
+                {
+                    SwarmBot* bot = NULL;
+                    if (started < m_bots.size())
+                        bot = m_bots[started++];
+                    else
+                    {
+                        for (size_t i = 0; i < started; ++i)
+                        {
+                            if (m_bots[i]->GetState() == BOT_OFFLINE && now >= m_bots[i]->GetReconnectTime())
+                            {
+                                bot = m_bots[i];
+                                break;
+                            }
+                        }
+                    }
+
+                    if (bot)
+                    {
+                        bot->Connect();
+                        nextLogin = WorldTimer::getMSTime() + m_loginDelay;
+                    }
+                }
+
+                ACE_Handle_Set readSet;
+                for (std::vector<SwarmBot*>::const_iterator itr = m_bots.begin(); itr != m_bots.end(); ++itr)
+                    if ((*itr)->GetHandle() != ACE_INVALID_HANDLE)
+                        readSet.set_bit((*itr)->GetHandle());
+
+                int ready = 0;
+                if (readSet.num_set())
+                {
+                    ACE_Time_Value timeout(0, 20000);
+                    ready = ACE::select(int(readSet.max_set()) + 1, readSet, &timeout);
+                }
+                else
+                    ACE_Based::Thread::Sleep(20);
+
+                now = WorldTimer::getMSTime();
+                for (std::vector<SwarmBot*>::iterator itr = m_bots.begin(); itr != m_bots.end(); ++itr)
+                {
+                    ACE_HANDLE handle = (*itr)->GetHandle();
+                    if (ready > 0 && handle != ACE_INVALID_HANDLE && readSet.is_set(handle))
+                        (*itr)->HandleInput();
+
+                    (*itr)->Update(now);
+                }
+            }
+
+            for (std::vector<SwarmBot*>::iterator itr = m_bots.begin(); itr != m_bots.end(); ++itr)
+                (*itr)->Disconnect();
+        }
+
+    private:
+        std::vector<SwarmBot*> m_bots;
+        uint32 m_loginDelay;                                // per thread, threads log in concurrently
+};
+
+/// Launch the swarm
+extern int main(int argc, char **argv)
+{
+    SwarmConfig config;
+    char const* pathFile = NULL;
+    uint32 reportInterval = 10;
+    uint32 duration = 0;
+    uint32 generate = 0;
+
+    ACE_Get_Opt cmd_opts(argc, argv, ":r:m:a:p:o:n:t:l:f:c:s:u:i:d:g:");
+
+    int option;
+    while ((option = cmd_opts()) != EOF)
+    {
+        switch (option)
+        {
+            case 'r':
+            {
+                std::string address = cmd_opts.opt_arg();
+                std::string::size_type pos = address.find(':');
+                config.realmHost = address.substr(0, pos);
+                if (pos != std::string::npos)
+                    config.realmPort = uint16(atoi(address.c_str() + pos + 1));
+                break;
+            }
+            case 'm': config.realmName = cmd_opts.opt_arg(); break;
+            case 'a': config.accountPrefix = cmd_opts.opt_arg(); break;
+            case 'p': config.password = cmd_opts.opt_arg(); break;
+            case 'o': config.firstAccount = atoi(cmd_opts.opt_arg()); break;
+            case 'n': config.botCount = atoi(cmd_opts.opt_arg()); break;
+            case 't': config.threads = atoi(cmd_opts.opt_arg()); break;
+            case 'l': config.loginsPerSecond = atoi(cmd_opts.opt_arg()); break;
+            case 'f': pathFile = cmd_opts.opt_arg(); break;
+            case 'c': config.chatInterval = atoi(cmd_opts.opt_arg()) * 1000; break;
+            case 's': config.castSpell = atoi(cmd_opts.opt_arg()); break;
+            case 'u': config.auctioneerGuid = strtoull(cmd_opts.opt_arg(), NULL, 10); break;
+            case 'i': reportInterval = atoi(cmd_opts.opt_arg()); break;
+            case 'd': duration = atoi(cmd_opts.opt_arg()); break;
+            case 'g': generate = atoi(cmd_opts.opt_arg()); break;
+            case ':':
+                printf("Runtime-Error: -%c option requires an input argument\n", cmd_opts.opt_opt());
+                usage(argv[0]);
+                return 1;
+            default:
+                printf("Runtime-Error: bad format of commandline arguments\n");
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (generate)
+    {
+        PrintAccountSQL(config, generate);
+        return 0;
+    }
+
+    if (!config.threads)
+        config.threads = 1;
+    if (!reportInterval)
+        reportInterval = 10;
+
+    if (config.botCount + 64 > FD_SETSIZE)
+        printf("Warning: %u bots exceed select() limit of %u handles, rebuild with larger FD_SETSIZE\n", config.botCount, FD_SETSIZE);
+
+    if (pathFile)
+    {
+        if (!LoadPaths(pathFile, config.paths))
+        {
+            printf("Could not load paths from %s.\n", pathFile);
+            return 1;
+        }
+    }
+    else
+    {
+        // walk around a 10 yard square near login position
+        SwarmPath square;
+        square.push_back(SwarmPathPoint(0.0f, 0.0f, 0.0f));
+        square.push_back(SwarmPathPoint(10.0f, 0.0f, 0.0f));
+        square.push_back(SwarmPathPoint(10.0f, 10.0f, 0.0f));
+        square.push_back(SwarmPathPoint(0.0f, 10.0f, 0.0f));
+        config.paths.push_back(square);
+    }
+
+    printf("Starting %u bots on %u threads against %s:%u, %u paths loaded\n", config.botCount, config.threads,
+        config.realmHost.c_str(), config.realmPort, uint32(config.paths.size()));
+
+    signal(SIGINT, OnSignal);
+    signal(SIGTERM, OnSignal);
+
+    std::vector<ACE_Based::Thread*> threads;
+    for (uint32 i = 0; i < config.threads; ++i)
+        threads.push_back(new ACE_Based::Thread(new SwarmRunnable(config, i)));
+
+    uint32 startTime = WorldTimer::getMSTime();
+    uint32 lastReport = startTime;
+    while (!stopEvent)
+    {
+        ACE_Based::Thread::Sleep(100);
+
+        uint32 now = WorldTimer::getMSTime();
+        if (WorldTimer::getMSTimeDiff(lastReport, now) >= reportInterval * 1000)
+        {
+            printf("[%u s] ", WorldTimer::getMSTimeDiff(startTime, now) / 1000);
+            sSwarmStats.Report(WorldTimer::getMSTimeDiff(lastReport, now));
+            lastReport = now;
+        }
+
+        if (duration && WorldTimer::getMSTimeDiff(startTime, now) >= duration * 1000)
+            stopEvent = true;
+    }
+
+    for (std::vector<ACE_Based::Thread*>::iterator itr = threads.begin(); itr != threads.end(); ++itr)
+    {
+        (*itr)->wait();
+        delete *itr;
+    }
+
+    printf("Swarm stopped.\n");
+    return 0;
+}
+
+/// @}
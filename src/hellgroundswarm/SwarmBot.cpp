@@ -0,0 +1,870 @@
+/*
+ * Copyright (C) 2008-2014 Hellground <http://hellground.net/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "SwarmBot.h"
+#include "SwarmStats.h"
+
+#include "Auth/AuthCrypt.h"
+#include "Auth/Sha1.h"
+#include "Timer.h"
+#include "Util.h"
+
+#include <ace/INET_Addr.h>
+#include <ace/SOCK_Connector.h>
+#include <ace/os_include/netinet/os_tcp.h>
+
+#include <algorithm>
+#include <cmath>
+
+#define SWARM_CLIENT_BUILD      8606
+#define SWARM_NET_TIMEOUT       10                          // seconds, realm handshake and blocking sends
+#define SWARM_RUN_SPEED         7.0f
+#define SWARM_HEARTBEAT         500
+#define SWARM_PING_INTERVAL     30000                       // server counts pings sent more often than every 27s as overspeed
+#define SWARM_RECV_CHUNK        16384
+
+enum SwarmRealmCommands
+{
+    CMD_AUTH_LOGON_CHALLENGE    = 0x00,
+    CMD_AUTH_LOGON_PROOF        = 0x01,
+    CMD_REALM_LIST              = 0x10
+};
+
+enum SwarmResponseCodes
+{
+    AUTH_OK                     = 0x0C,
+    AUTH_WAIT_QUEUE             = 0x1B,
+    CHAR_CREATE_SUCCESS         = 0x2F
+};
+
+#define REALM_FLAG_SPECIFYBUILD 0x04
+
+#define CHAT_MSG_SYSTEM         0x00
+#define CHAT_MSG_SAY            0x01
+#define LANG_ORCISH             1
+#define LANG_COMMON             7
+
+#define MOVEFLAG_FORWARD        0x00000001
+
+#define SERVER_DIFF_PREFIX      "Update time diff: "
+
+SwarmConfig::SwarmConfig() : realmHost("127.0.0.1"), realmPort(3724), accountPrefix("SWARM"), password("SWARM"), firstAccount(1),
+    botCount(100), threads(4), loginsPerSecond(20), chatInterval(30000), castInterval(20000), castSpell(2457), auctionInterval(60000),
+    auctioneerGuid(0), probeInterval(5000), tickInterval(5000), reconnectDelay(10000)
+{
+}
+
+void SwarmCrypt::Init(BigNumber* K)
+{
+    AuthCrypt::GenerateKey(m_key, K);
+    m_send_i = m_send_j = m_recv_i = m_recv_j = 0;
+    m_initialized = true;
+}
+
+// inverse of AuthCrypt::DecryptRecv
+void SwarmCrypt::EncryptSend(uint8* data)
+{
+    if (!m_initialized)
+        return;
+
+    for (size_t t = 0; t < CRYPTED_SEND_LEN; ++t)
+    {
+        m_send_i %= sizeof(m_key);
+        uint8 x = (data[t] ^ m_key[m_send_i]) + m_send_j;
+        ++m_send_i;
+        data[t] = m_send_j = x;
+    }
+}
+
+// inverse of AuthCrypt::EncryptSend
+void SwarmCrypt::DecryptRecv(uint8* data)
+{
+    if (!m_initialized)
+        return;
+
+    for (size_t t = 0; t < CRYPTED_RECV_LEN; ++t)
+    {
+        m_recv_i %= sizeof(m_key);
+        uint8 x = (data[t] - m_recv_j) ^ m_key[m_recv_i];
+        ++m_recv_i;
+        m_recv_j = data[t];
+        data[t] = x;
+    }
+}
+
+static bool RecvAll(ACE_SOCK_Stream& stream, void* data, size_t size)
+{
+    ACE_Time_Value timeout(SWARM_NET_TIMEOUT);
+    return stream.recv_n(data, size, &timeout) == ssize_t(size);
+}
+
+static bool SendAll(ACE_SOCK_Stream& stream, void const* data, size_t size)
+{
+    ACE_Time_Value timeout(SWARM_NET_TIMEOUT);
+    return stream.send_n(data, size, &timeout) == ssize_t(size);
+}
+
+static void SplitAddress(std::string const& address, std::string& host, uint16& port)
+{
+    std::string::size_type pos = address.find(':');
+    host = address.substr(0, pos);
+    port = pos == std::string::npos ? 8085 : uint16(atoi(address.c_str() + pos + 1));
+}
+
+SwarmBot::SwarmBot(SwarmConfig const& config, uint32 index) : m_config(config), m_index(index), m_state(BOT_OFFLINE),
+    m_recvBuffer(SWARM_RECV_CHUNK), m_recvSize(0), m_headerDecrypted(false), m_guid(0), m_race(0), m_tickProbe(false),
+    m_path(NULL), m_pathPoint(0), m_homeX(0.0f), m_homeY(0.0f), m_homeZ(0.0f), m_x(0.0f), m_y(0.0f), m_z(0.0f), m_o(0.0f),
+    m_reconnectTime(0), m_lastMove(0), m_nextHeartbeat(0), m_nextChat(0), m_nextCast(0), m_nextAuction(0), m_nextProbe(0),
+    m_nextPing(0), m_nextTick(0), m_pingSeq(0), m_loginSent(0), m_querySent(0), m_auctionSent(0), m_pingSent(0)
+{
+    m_account = GetAccountName(config.accountPrefix, config.firstAccount + index);
+}
+
+SwarmBot::~SwarmBot()
+{
+    Disconnect();
+}
+
+std::string SwarmBot::GetAccountName(std::string const& prefix, uint32 index)
+{
+    char buff[16];
+    snprintf(buff, sizeof(buff), "%u", index);
+
+    std::string name = prefix + buff;
+    std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+    return name;
+}
+
+bool SwarmBot::Connect()
+{
+    m_loginSent = SwarmStats::GetTimeUS();
+
+    std::string host;
+    uint16 port;
+    if (!RealmLogin(host, port) || !ConnectWorld(host, port))
+    {
+        sSwarmStats.AddLoginFailure();
+        Disconnect();
+        return false;
+    }
+
+    m_state = BOT_AUTH_CHALLENGE;
+    return true;
+}
+
+void SwarmBot::Disconnect()
+{
+    if (m_state == BOT_IN_WORLD)
+        sSwarmStats.RemoveOnline();
+
+    if (m_tickProbe)
+        sSwarmStats.ReleaseTickProbe(m_index);
+
+    m_world.close();
+    m_crypt.Reset();
+
+    m_state = BOT_OFFLINE;
+    m_recvSize = 0;
+    m_headerDecrypted = false;
+    m_tickProbe = false;
+    m_querySent = m_auctionSent = m_pingSent = 0;
+    m_reconnectTime = WorldTimer::getMSTime() + m_config.reconnectDelay;
+}
+
+bool SwarmBot::RealmLogin(std::string& worldHost, uint16& worldPort)
+{
+    ACE_SOCK_Stream realm;
+    ACE_SOCK_Connector connector;
+    ACE_INET_Addr addr(m_config.realmPort, m_config.realmHost.c_str());
+    ACE_Time_Value timeout(SWARM_NET_TIMEOUT);
+
+    if (connector.connect(realm, addr, &timeout) == -1)
+        return false;
+
+    bool result = RealmHandshake(realm, worldHost, worldPort);
+    realm.close();
+    return result;
+}
+
+bool SwarmBot::RealmHandshake(ACE_SOCK_Stream& realm, std::string& worldHost, uint16& worldPort)
+{
+    std::string password = m_config.password;
+    std::transform(password.begin(), password.end(), password.begin(), ::toupper);
+
+    ///- Logon challenge, layout of sAuthLogonChallenge_C
+    ByteBuffer pkt;
+    pkt << uint8(CMD_AUTH_LOGON_CHALLENGE);
+    pkt << uint8(8);
+    pkt << uint16(30 + m_account.size());                   // size of data following this field
+    pkt.append("WoW", 4);
+    pkt << uint8(2) << uint8(4) << uint8(3);
+    pkt << uint16(SWARM_CLIENT_BUILD);
+    pkt.append("68x", 4);                                   // platform and os are sent reversed
+    pkt.append("niW", 4);
+    pkt.append("SUne", 4);
+    pkt << uint32(0);                                       // timezone bias
+    pkt << uint32(0x0100007F);                              // ip, not used by realm
+    pkt << uint8(m_account.size());
+    pkt.append(m_account.c_str(), m_account.size());
+
+    if (!SendAll(realm, pkt.contents(), pkt.size()))
+        return false;
+
+    // cmd, unk, error - on error nothing else follows
+    uint8 head[3];
+    if (!RecvAll(realm, head, sizeof(head)) || head[2] != 0)
+        return false;
+
+    // B[32], g_len, g, N_len, N[32], s[32], unk[16], securityFlags
+    uint8 challenge[116];
+    if (!RecvAll(realm, challenge, sizeof(challenge)) || challenge[115] != 0)
+        return false;
+
+    BigNumber B, g, N, s, k(3);
+    B.SetBinary(challenge, 32);
+    g.SetBinary(challenge + 33, 1);
+    N.SetBinary(challenge + 35, 32);
+    s.SetBinary(challenge + 67, 32);
+
+    ///- Client side of SRP6, see AuthSocket::_HandleLogonProof for server side
+    Sha1Hash sha;
+    sha.UpdateData(m_account + ":" + password);
+    sha.Finalize();
+    uint8 passHash[SHA_DIGEST_LENGTH];
+    memcpy(passHash, sha.GetDigest(), SHA_DIGEST_LENGTH);
+
+    sha.Initialize();
+    sha.UpdateData(s.AsByteArray(), s.GetNumBytes());
+    sha.UpdateData(passHash, SHA_DIGEST_LENGTH);
+    sha.Finalize();
+    BigNumber x;
+    x.SetBinary(sha.GetDigest(), sha.GetLength());
+
+    BigNumber a;
+    a.SetRand(19 * 8);
+    BigNumber A = g.ModExp(a, N);
+
+    sha.Initialize();
+    sha.UpdateBigNumbers(&A, &B, NULL);
+    sha.Finalize();
+    BigNumber u;
+    u.SetBinary(sha.GetDigest(), 20);
+
+    // S = (B - k * g^x) ^ (a + u * x), N added to keep base positive
+    BigNumber kgx = (g.ModExp(x, N) * k) % N;
+    BigNumber base = ((B + N) - kgx) % N;
+    BigNumber S = base.ModExp(a + u * x, N);
+
+    uint8 t[32];
+    uint8 t1[16];
+    uint8 vK[40];
+    memcpy(t, S.AsByteArray(32), 32);
+    for (int i = 0; i < 16; ++i)
+        t1[i] = t[i * 2];
+    sha.Initialize();
+    sha.UpdateData(t1, 16);
+    sha.Finalize();
+    for (int i = 0; i < 20; ++i)
+        vK[i * 2] = sha.GetDigest()[i];
+    for (int i = 0; i < 16; ++i)
+        t1[i] = t[i * 2 + 1];
+    sha.Initialize();
+    sha.UpdateData(t1, 16);
+    sha.Finalize();
+    for (int i = 0; i < 20; ++i)
+        vK[i * 2 + 1] = sha.GetDigest()[i];
+    m_sessionKey.SetBinary(vK, 40);
+
+    uint8 hash[20];
+    sha.Initialize();
+    sha.UpdateBigNumbers(&N, NULL);
+    sha.Finalize();
+    memcpy(hash, sha.GetDigest(), 20);
+    sha.Initialize();
+    sha.UpdateBigNumbers(&g, NULL);
+    sha.Finalize();
+    for (int i = 0; i < 20; ++i)
+        hash[i] ^= sha.GetDigest()[i];
+    BigNumber t3;
+    t3.SetBinary(hash, 20);
+
+    sha.Initialize();
+    sha.UpdateData(m_account);
+    sha.Finalize();
+    uint8 t4[SHA_DIGEST_LENGTH];
+    memcpy(t4, sha.GetDigest(), SHA_DIGEST_LENGTH);
+
+    sha.Initialize();
+    sha.UpdateBigNumbers(&t3, NULL);
+    sha.UpdateData(t4, SHA_DIGEST_LENGTH);
+    sha.UpdateBigNumbers(&s, &A, &B, &m_sessionKey, NULL);
+    sha.Finalize();
+
+    ///- Logon proof, layout of sAuthLogonProof_C
+    pkt.clear();
+    pkt << uint8(CMD_AUTH_LOGON_PROOF);
+    pkt.append(A.AsByteArray(32), 32);
+    pkt.append(sha.GetDigest(), 20);
+    uint8 crc[20];
+    memset(crc, 0, sizeof(crc));
+    pkt.append(crc, sizeof(crc));
+    pkt << uint8(0);                                        // number of keys
+    pkt << uint8(0);                                        // security flags
+
+    if (!SendAll(realm, pkt.contents(), pkt.size()))
+        return false;
+
+    // cmd, error - then M2[20], account flags, survey id, unk flags
+    uint8 proof[32];
+    if (!RecvAll(realm, proof, 2) || proof[1] != 0 || !RecvAll(realm, proof + 2, 30))
+        return false;
+
+    ///- Realm list
+    pkt.clear();
+    pkt << uint8(CMD_REALM_LIST);
+    pkt << uint32(0);
+
+    if (!SendAll(realm, pkt.contents(), pkt.size()))
+        return false;
+
+    uint8 listHead[3];
+    if (!RecvAll(realm, listHead, sizeof(listHead)) || listHead[0] != CMD_REALM_LIST)
+        return false;
+
+    uint16 listSize = listHead[1] | (listHead[2] << 8);
+    if (!listSize)
+        return false;
+
+    ByteBuffer list(listSize);
+    list.resize(listSize);
+    if (!RecvAll(realm, const_cast<uint8*>(list.contents()), listSize))
+        return false;
+
+    try
+    {
+        list.read_skip<uint32>();
+        uint16 count;
+        list >> count;
+
+        for (uint16 i = 0; i < count; ++i)
+        {
+            uint8 icon, lock, flags, characters, timezone, id;
+            std::string name, address;
+            float population;
+
+            list >> icon >> lock >> flags >> name >> address >> population >> characters >> timezone >> id;
+            if (flags & REALM_FLAG_SPECIFYBUILD)
+                list.read_skip(5);
+
+            if (m_config.realmName.empty() || m_config.realmName == name)
+            {
+                SplitAddress(address, worldHost, worldPort);
+                return true;
+            }
+        }
+    }
+    catch (ByteBufferException&)
+    {
+    }
+
+    return false;
+}
+
+bool SwarmBot::ConnectWorld(std::string const& host, uint16 port)
+{
+    ACE_SOCK_Connector connector;
+    ACE_INET_Addr addr(port, host.c_str());
+    ACE_Time_Value timeout(SWARM_NET_TIMEOUT);
+
+    if (connector.connect(m_world, addr, &timeout) == -1)
+        return false;
+
+    int nodelay = 1;
+    m_world.set_option(ACE_IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+    return true;
+}
+
+bool SwarmBot::HandleInput()
+{
+    if (m_recvBuffer.size() - m_recvSize < SWARM_RECV_CHUNK / 4)
+        m_recvBuffer.resize(m_recvBuffer.size() + SWARM_RECV_CHUNK);
+
+    ssize_t received = m_world.recv(&m_recvBuffer[m_recvSize], m_recvBuffer.size() - m_recvSize);
+    if (received <= 0)
+    {
+        if (received < 0 && (errno == EWOULDBLOCK || errno == EINTR))
+            return true;
+
+        sSwarmStats.AddDisconnect();
+        Disconnect();
+        return false;
+    }
+
+    m_recvSize += received;
+
+    ///- Server header is uint16 size (big endian, includes opcode) and uint16 opcode
+    size_t offset = 0;
+    while (m_recvSize - offset >= 4)
+    {
+        uint8* header = &m_recvBuffer[offset];
+        if (!m_headerDecrypted)
+        {
+            m_crypt.DecryptRecv(header);
+            m_headerDecrypted = true;
+        }
+
+        uint16 size = (header[0] << 8) | header[1];
+        uint16 opcode = header[2] | (header[3] << 8);
+
+        if (size < 2)
+        {
+            sSwarmStats.AddDisconnect();
+            Disconnect();
+            return false;
+        }
+
+        if (m_recvSize - offset < size_t(size) + 2)
+            break;
+
+        WorldPacket packet(opcode, size - 2);
+        if (size > 2)
+            packet.append(header + 4, size - 2);
+
+        offset += size + 2;
+        m_headerDecrypted = false;
+        sSwarmStats.AddBytesIn(size + 2);
+
+        try
+        {
+            HandlePacket(packet);
+        }
+        catch (ByteBufferException&)
+        {
+        }
+
+        // handler may drop connection and with it the buffer
+        if (m_state == BOT_OFFLINE)
+            return false;
+    }
+
+    if (offset)
+    {
+        memmove(&m_recvBuffer[0], &m_recvBuffer[offset], m_recvSize - offset);
+        m_recvSize -= offset;
+    }
+
+    return true;
+}
+
+void SwarmBot::SendPacket(WorldPacket const& packet)
+{
+    if (m_state == BOT_OFFLINE)
+        return;
+
+    ///- Client header is uint16 size (big endian, includes opcode) and uint32 opcode
+    uint16 size = packet.size() + 4;
+    uint32 opcode = packet.GetOpcode();
+
+    ByteBuffer buffer(size + 2);
+    buffer << uint8(size >> 8) << uint8(size & 0xFF) << opcode;
+    m_crypt.EncryptSend(const_cast<uint8*>(buffer.contents()));
+
+    if (packet.size())
+        buffer.append(packet.contents(), packet.size());
+
+    if (!SendAll(m_world, buffer.contents(), buffer.size()))
+    {
+        sSwarmStats.AddDisconnect();
+        Disconnect();
+        return;
+    }
+
+    sSwarmStats.AddBytesOut(buffer.size());
+}
+
+void SwarmBot::HandlePacket(WorldPacket& packet)
+{
+    switch (packet.GetOpcode())
+    {
+        case SMSG_AUTH_CHALLENGE:
+            HandleAuthChallenge(packet);
+            break;
+        case SMSG_AUTH_RESPONSE:
+            HandleAuthResponse(packet);
+            break;
+        case SMSG_CHAR_ENUM:
+            HandleCharEnum(packet);
+            break;
+        case SMSG_CHAR_CREATE:
+            HandleCharCreate(packet);
+            break;
+        case SMSG_LOGIN_VERIFY_WORLD:
+            HandleLoginVerifyWorld(packet);
+            break;
+        case SMSG_MESSAGECHAT:
+            HandleMessageChat(packet);
+            break;
+        case SMSG_QUERY_TIME_RESPONSE:
+            if (m_querySent)
+                sSwarmStats.AddLatency(LATENCY_QUERY_TIME, SwarmStats::GetTimeUS() - m_querySent);
+            m_querySent = 0;
+            break;
+        case SMSG_AUCTION_LIST_RESULT:
+            if (m_auctionSent)
+                sSwarmStats.AddLatency(LATENCY_AUCTION, SwarmStats::GetTimeUS() - m_auctionSent);
+            m_auctionSent = 0;
+            break;
+        case SMSG_PONG:
+            if (m_pingSent)
+                sSwarmStats.AddLatency(LATENCY_PING, SwarmStats::GetTimeUS() - m_pingSent);
+            m_pingSent = 0;
+            break;
+        default:                                            // world state is not tracked, warden requests are left unanswered
+            break;
+    }
+}
+
+void SwarmBot::HandleAuthChallenge(WorldPacket& packet)
+{
+    if (m_state != BOT_AUTH_CHALLENGE)
+        return;
+
+    uint32 serverSeed;
+    packet >> serverSeed;
+
+    uint32 clientSeed = urand(0, 0xFFFFFFFF);
+    uint32 t = 0;
+
+    Sha1Hash sha;
+    sha.UpdateData(m_account);
+    sha.UpdateData((uint8*)&t, 4);
+    sha.UpdateData((uint8*)&clientSeed, 4);
+    sha.UpdateData((uint8*)&serverSeed, 4);
+    sha.UpdateBigNumbers(&m_sessionKey, NULL);
+    sha.Finalize();
+
+    // no addon data, server skips addon info when it is missing
+    WorldPacket data(CMSG_AUTH_SESSION, 4 + 4 + m_account.size() + 1 + 4 + 20);
+    data << uint32(SWARM_CLIENT_BUILD);
+    data << uint32(0);
+    data << m_account;
+    data << clientSeed;
+    data.append(sha.GetDigest(), 20);
+    SendPacket(data);
+
+    // everything after auth session is crypted in both directions
+    m_crypt.Init(&m_sessionKey);
+    m_state = BOT_AUTH_RESPONSE;
+}
+
+void SwarmBot::HandleAuthResponse(WorldPacket& packet)
+{
+    uint8 code;
+    packet >> code;
+
+    if (code == AUTH_WAIT_QUEUE)
+        return;
+
+    if (code != AUTH_OK)
+    {
+        sSwarmStats.AddLoginFailure();
+        Disconnect();
+        return;
+    }
+
+    WorldPacket data(CMSG_CHAR_ENUM, 0);
+    SendPacket(data);
+    m_state = BOT_CHAR_ENUM;
+}
+
+void SwarmBot::HandleCharEnum(WorldPacket& packet)
+{
+    if (m_state != BOT_CHAR_ENUM)
+        return;
+
+    uint8 count;
+    packet >> count;
+
+    if (!count)
+    {
+        SendCharCreate();
+        return;
+    }
+
+    std::string name;
+    packet >> m_guid;
+    packet >> name;
+    packet >> m_race;
+
+    WorldPacket data(CMSG_PLAYER_LOGIN, 8);
+    data << m_guid;
+    SendPacket(data);
+    m_state = BOT_LOGIN;
+}
+
+void SwarmBot::SendCharCreate()
+{
+    // names may contain only letters, so account index is written in base 26
+    std::string name = "Sw";
+    uint32 index = m_config.firstAccount + m_index;
+    do
+    {
+        name += char('a' + index % 26);
+        index /= 26;
+    }
+    while (index);
+
+    while (name.size() < 4)
+        name += 'a';
+
+    uint8 race = (m_index & 1) ? 2 : 1;                     // orc or human, both can be warriors
+
+    WorldPacket data(CMSG_CHAR_CREATE, name.size() + 1 + 9);
+    data << name;
+    data << uint8(race);
+    data << uint8(1);                                       // class warrior
+    data << uint8(m_index & 1);                             // gender
+    data << uint8(0) << uint8(0) << uint8(0) << uint8(0) << uint8(0);
+    data << uint8(0);                                       // outfit id
+    SendPacket(data);
+    m_state = BOT_CHAR_CREATE;
+}
+
+void SwarmBot::HandleCharCreate(WorldPacket& packet)
+{
+    if (m_state != BOT_CHAR_CREATE)
+        return;
+
+    uint8 code;
+    packet >> code;
+
+    if (code != CHAR_CREATE_SUCCESS)
+    {
+        printf("Bot %s: character create failed with code 0x%02X\n", m_account.c_str(), code);
+        sSwarmStats.AddLoginFailure();
+        Disconnect();
+        return;
+    }
+
+    WorldPacket data(CMSG_CHAR_ENUM, 0);
+    SendPacket(data);
+    m_state = BOT_CHAR_ENUM;
+}
+
+void SwarmBot::HandleLoginVerifyWorld(WorldPacket& packet)
+{
+    if (m_state != BOT_LOGIN)
+        return;
+
+    uint32 mapId;
+    packet >> mapId;
+    packet >> m_homeX >> m_homeY >> m_homeZ >> m_o;
+
+    m_x = m_homeX;
+    m_y = m_homeY;
+    m_z = m_homeZ;
+
+    m_state = BOT_IN_WORLD;
+    sSwarmStats.AddOnline();
+    sSwarmStats.AddLatency(LATENCY_LOGIN, SwarmStats::GetTimeUS() - m_loginSent);
+
+    m_tickProbe = sSwarmStats.ClaimTickProbe(m_index);
+
+    // spread periodic actions of bots logged in at the same time
+    uint32 now = WorldTimer::getMSTime();
+    uint32 spread = m_index * 7919;
+    m_lastMove = now;
+    m_nextHeartbeat = now + SWARM_HEARTBEAT;
+    m_nextChat = now + (m_config.chatInterval ? spread % m_config.chatInterval : 0);
+    m_nextCast = now + (m_config.castInterval ? spread % m_config.castInterval : 0);
+    m_nextAuction = now + (m_config.auctionInterval ? spread % m_config.auctionInterval : 0);
+    m_nextProbe = now + (m_config.probeInterval ? spread % m_config.probeInterval : 0);
+    m_nextPing = now + spread % SWARM_PING_INTERVAL;
+    m_nextTick = now;
+
+    m_path = m_config.paths.empty() ? NULL : &m_config.paths[m_index % m_config.paths.size()];
+    m_pathPoint = 0;
+    if (m_path && m_path->size() > 1)
+        SendMovement(MSG_MOVE_START_FORWARD);
+}
+
+void SwarmBot::HandleMessageChat(WorldPacket& packet)
+{
+    if (!m_tickProbe)
+        return;
+
+    uint8 type;
+    packet >> type;
+    if (type != CHAT_MSG_SYSTEM)
+        return;
+
+    std::string text;
+    packet.read_skip<uint32>();                             // language
+    packet.read_skip<uint64>();
+    packet.read_skip<uint32>();
+    packet.read_skip<uint64>();
+    packet.read_skip<uint32>();                             // text length
+    packet >> text;
+
+    if (text.compare(0, sizeof(SERVER_DIFF_PREFIX) - 1, SERVER_DIFF_PREFIX) == 0)
+        sSwarmStats.AddServerDiff(atoi(text.c_str() + sizeof(SERVER_DIFF_PREFIX) - 1));
+}
+
+void SwarmBot::SendMovement(uint16 opcode)
+{
+    WorldPacket data(opcode, 4 + 1 + 4 + 4 * 4 + 4);
+    data << uint32(opcode == MSG_MOVE_STOP ? 0 : MOVEFLAG_FORWARD);
+    data << uint8(0);
+    data << uint32(WorldTimer::getMSTime());
+    data << m_x << m_y << m_z << m_o;
+    data << uint32(0);                                      // fall time
+    SendPacket(data);
+}
+
+void SwarmBot::SendChat(char const* text)
+{
+    WorldPacket data(CMSG_MESSAGECHAT, 4 + 4 + strlen(text) + 1);
+    data << uint32(CHAT_MSG_SAY);
+    data << uint32(IsAlliance() ? LANG_COMMON : LANG_ORCISH);
+    data << text;
+    SendPacket(data);
+}
+
+void SwarmBot::UpdateMovement(uint32 now)
+{
+    uint32 diff = WorldTimer::getMSTimeDiff(m_lastMove, now);
+    m_lastMove = now;
+
+    if (!m_path || m_path->size() < 2)
+        return;
+
+    float distance = SWARM_RUN_SPEED * diff / 1000.0f;
+    while (distance > 0.0f)
+    {
+        SwarmPathPoint const& point = (*m_path)[m_pathPoint];
+        float dx = m_homeX + point.x - m_x;
+        float dy = m_homeY + point.y - m_y;
+        float dz = m_homeZ + point.z - m_z;
+        float left = sqrt(dx * dx + dy * dy + dz * dz);
+
+        if (left > 0.01f)
+        {
+            m_o = atan2(dy, dx);
+            if (m_o < 0.0f)
+                m_o += 2 * M_PI;
+        }
+
+        if (left > distance)
+        {
+            m_x += dx * distance / left;
+            m_y += dy * distance / left;
+            m_z += dz * distance / left;
+            break;
+        }
+
+        m_x += dx;
+        m_y += dy;
+        m_z += dz;
+        distance -= left;
+        m_pathPoint = (m_pathPoint + 1) % m_path->size();
+
+        // path of identical points, nowhere to go
+        if (!m_pathPoint && left <= 0.01f)
+            break;
+    }
+
+    if (now >= m_nextHeartbeat)
+    {
+        SendMovement(MSG_MOVE_HEARTBEAT);
+        m_nextHeartbeat = now + SWARM_HEARTBEAT;
+    }
+}
+
+void SwarmBot::Update(uint32 now)
+{
+    if (m_state != BOT_IN_WORLD)
+        return;
+
+    UpdateMovement(now);
+
+    if (m_config.chatInterval && now >= m_nextChat)
+    {
+        char text[64];
+        snprintf(text, sizeof(text), "swarm %s checking in", m_account.c_str());
+        SendChat(text);
+        m_nextChat = now + m_config.chatInterval;
+    }
+
+    if (m_config.castInterval && m_config.castSpell && now >= m_nextCast)
+    {
+        WorldPacket data(CMSG_CAST_SPELL, 4 + 1 + 4);
+        data << uint32(m_config.castSpell);
+        data << uint8(0);                                   // cast count
+        data << uint32(0);                                  // target mask self
+        SendPacket(data);
+        m_nextCast = now + m_config.castInterval;
+    }
+
+    // auctioneer answers only to players in interaction range, unanswered search is dropped at next interval
+    if (m_config.auctioneerGuid && m_config.auctionInterval && now >= m_nextAuction)
+    {
+        WorldPacket hello(MSG_AUCTION_HELLO, 8);
+        hello << uint64(m_config.auctioneerGuid);
+        SendPacket(hello);
+
+        WorldPacket data(CMSG_AUCTION_LIST_ITEMS, 8 + 4 + 1 + 2 + 16 + 3);
+        data << uint64(m_config.auctioneerGuid);
+        data << uint32(0);                                  // list from
+        data << "";                                         // searched name
+        data << uint8(0) << uint8(0);                       // level min, max
+        data << uint32(0xFFFFFFFF);                         // inventory type
+        data << uint32(0xFFFFFFFF);                         // item class
+        data << uint32(0xFFFFFFFF);                         // item subclass
+        data << uint32(0xFFFFFFFF);                         // quality
+        data << uint8(0) << uint8(0);                       // usable, is full
+        data << uint8(0);                                   // sort count
+        SendPacket(data);
+
+        m_auctionSent = SwarmStats::GetTimeUS();
+        m_nextAuction = now + m_config.auctionInterval;
+    }
+
+    if (m_config.probeInterval && now >= m_nextProbe)
+    {
+        WorldPacket data(CMSG_QUERY_TIME, 0);
+        SendPacket(data);
+        m_querySent = SwarmStats::GetTimeUS();
+        m_nextProbe = now + m_config.probeInterval;
+    }
+
+    if (now >= m_nextPing)
+    {
+        WorldPacket data(CMSG_PING, 8);
+        data << uint32(++m_pingSeq);
+        data << uint32(0);                                  // latency
+        SendPacket(data);
+        m_pingSent = SwarmStats::GetTimeUS();
+        m_nextPing = now + SWARM_PING_INTERVAL;
+    }
+
+    if (m_tickProbe && m_config.tickInterval && now >= m_nextTick)
+    {
+        SendChat(".server info");
+        m_nextTick = now + m_config.tickInterval;
+    }
+}
@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) 2008-2014 Hellground <http://hellground.net/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef HELLGROUND_SWARMBOT_H
+#define HELLGROUND_SWARMBOT_H
+
+#include <ace/SOCK_Stream.h>
+
+#include "Common.h"
+#include "Auth/BigNumber.h"
+#include "WorldPacket.h"
+
+#include <string>
+#include <vector>
+
+// subset of game opcodes used by bots, game/Opcodes.h is not linked into swarm
+enum SwarmOpcodes
+{
+    CMSG_CHAR_CREATE            = 0x036,
+    CMSG_CHAR_ENUM              = 0x037,
+    SMSG_CHAR_CREATE            = 0x03A,
+    SMSG_CHAR_ENUM              = 0x03B,
+    CMSG_PLAYER_LOGIN           = 0x03D,
+    CMSG_MESSAGECHAT            = 0x095,
+    SMSG_MESSAGECHAT            = 0x096,
+    MSG_MOVE_START_FORWARD      = 0x0B5,
+    MSG_MOVE_STOP               = 0x0B7,
+    MSG_MOVE_HEARTBEAT          = 0x0EE,
+    CMSG_CAST_SPELL             = 0x12E,
+    CMSG_QUERY_TIME             = 0x1CE,
+    SMSG_QUERY_TIME_RESPONSE    = 0x1CF,
+    CMSG_PING                   = 0x1DC,
+    SMSG_PONG                   = 0x1DD,
+    SMSG_AUTH_CHALLENGE         = 0x1EC,
+    CMSG_AUTH_SESSION           = 0x1ED,
+    SMSG_AUTH_RESPONSE          = 0x1EE,
+    SMSG_LOGIN_VERIFY_WORLD     = 0x236,
+    MSG_AUCTION_HELLO           = 0x255,
+    CMSG_AUCTION_LIST_ITEMS     = 0x258,
+    SMSG_AUCTION_LIST_RESULT    = 0x25C
+};
+
+struct SwarmPathPoint
+{
+    SwarmPathPoint(float _x, float _y, float _z) : x(_x), y(_y), z(_z) {}
+
+    float x, y, z;
+};
+
+/// offsets from first recorded point, replayed relative to position bot logged in at
+typedef std::vector<SwarmPathPoint> SwarmPath;
+
+struct SwarmConfig
+{
+    SwarmConfig();
+
+    std::string realmHost;
+    uint16 realmPort;
+    std::string realmName;                                  // empty means first realm in list
+    std::string accountPrefix;
+    std::string password;
+    uint32 firstAccount;
+    uint32 botCount;
+    uint32 threads;
+    uint32 loginsPerSecond;
+    uint32 chatInterval;                                    // all intervals in milliseconds, 0 disables action
+    uint32 castInterval;
+    uint32 castSpell;
+    uint32 auctionInterval;
+    uint64 auctioneerGuid;
+    uint32 probeInterval;                                   // CMSG_QUERY_TIME round trip
+    uint32 tickInterval;                                    // .server info
+    uint32 reconnectDelay;
+
+    std::vector<SwarmPath> paths;
+};
+
+enum SwarmBotState
+{
+    BOT_OFFLINE,
+    BOT_AUTH_CHALLENGE,                                     // waiting for SMSG_AUTH_CHALLENGE
+    BOT_AUTH_RESPONSE,
+    BOT_CHAR_ENUM,
+    BOT_CHAR_CREATE,
+    BOT_LOGIN,                                              // waiting for SMSG_LOGIN_VERIFY_WORLD
+    BOT_IN_WORLD
+};
+
+/// Client side header crypt, mirror of AuthCrypt with directions swapped
+class SwarmCrypt
+{
+    public:
+        SwarmCrypt() : m_initialized(false) {}
+
+        static const size_t CRYPTED_SEND_LEN = 6;
+        static const size_t CRYPTED_RECV_LEN = 4;
+
+        void Init(BigNumber* K);
+        void Reset() { m_initialized = false; }
+
+        void EncryptSend(uint8* data);
+        void DecryptRecv(uint8* data);
+
+    private:
+        uint8 m_key[20];
+        uint8 m_send_i, m_send_j, m_recv_i, m_recv_j;
+        bool m_initialized;
+};
+
+/// One simulated client. Bots are owned and updated by a single swarm thread,
+/// realm handshake and world connect are blocking, world traffic is polled by the owner.
+class SwarmBot
+{
+    public:
+        SwarmBot(SwarmConfig const& config, uint32 index);
+        ~SwarmBot();
+
+        uint32 GetIndex() const { return m_index; }
+        SwarmBotState GetState() const { return m_state; }
+        ACE_HANDLE GetHandle() const { return m_state == BOT_OFFLINE ? ACE_INVALID_HANDLE : m_world.get_handle(); }
+
+        /// realm SRP6 login and world connect, returns false and schedules reconnect on failure
+        bool Connect();
+        void Disconnect();
+
+        /// read everything available on world socket, to be called only when socket is readable
+        bool HandleInput();
+
+        /// send periodic traffic of bot in world
+        void Update(uint32 now);
+
+        /// offline bot may try to connect again after this time
+        uint32 GetReconnectTime() const { return m_reconnectTime; }
+
+        /// accounts are named prefix + index
+        static std::string GetAccountName(std::string const& prefix, uint32 index);
+
+    private:
+        bool RealmLogin(std::string& worldHost, uint16& worldPort);
+        bool RealmHandshake(ACE_SOCK_Stream& realm, std::string& worldHost, uint16& worldPort);
+        bool ConnectWorld(std::string const& host, uint16 port);
+
+        void SendPacket(WorldPacket const& packet);
+        void HandlePacket(WorldPacket& packet);
+
+        void HandleAuthChallenge(WorldPacket& packet);
+        void HandleAuthResponse(WorldPacket& packet);
+        void HandleCharEnum(WorldPacket& packet);
+        void HandleCharCreate(WorldPacket& packet);
+        void HandleLoginVerifyWorld(WorldPacket& packet);
+        void HandleMessageChat(WorldPacket& packet);
+
+        void SendCharCreate();
+        void SendMovement(uint16 opcode);
+        void SendChat(char const* text);
+        void UpdateMovement(uint32 now);
+
+        bool IsAlliance() const { return m_race == 1 || m_race == 3 || m_race == 4 || m_race == 7 || m_race == 11; }
+
+        SwarmConfig const& m_config;
+        uint32 m_index;
+        std::string m_account;
+
+        SwarmBotState m_state;
+        ACE_SOCK_Stream m_world;
+        SwarmCrypt m_crypt;
+        BigNumber m_sessionKey;
+
+        std::vector<uint8> m_recvBuffer;
+        size_t m_recvSize;
+        bool m_headerDecrypted;                             // header of first packet in buffer is already decrypted
+
+        uint64 m_guid;
+        uint8 m_race;
+        bool m_tickProbe;
+
+        SwarmPath const* m_path;
+        uint32 m_pathPoint;
+        float m_homeX, m_homeY, m_homeZ;
+        float m_x, m_y, m_z, m_o;
+
+        uint32 m_reconnectTime;
+        uint32 m_lastMove;
+        uint32 m_nextHeartbeat;
+        uint32 m_nextChat;
+        uint32 m_nextCast;
+        uint32 m_nextAuction;
+        uint32 m_nextProbe;
+        uint32 m_nextPing;
+        uint32 m_nextTick;
+        uint32 m_pingSeq;
+
+        // send times in microseconds, 0 when nothing is pending
+        uint64 m_loginSent;
+        uint64 m_querySent;
+        uint64 m_auctionSent;
+        uint64 m_pingSent;
+};
+
+#endif
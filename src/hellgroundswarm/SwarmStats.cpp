@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2008-2014 Hellground <http://hellground.net/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "SwarmStats.h"
+
+#include <ace/OS_NS_sys_time.h>
+
+#include <algorithm>
+#include <cstdio>
+
+static char const* LatencyName(SwarmLatency type)
+{
+    switch (type)
+    {
+        case LATENCY_LOGIN:         return "login";
+        case LATENCY_QUERY_TIME:    return "query time";
+        case LATENCY_AUCTION:       return "auction list";
+        case LATENCY_PING:          return "ping";
+        default:                    break;
+    }
+    return "unknown";
+}
+
+// samples must be sorted
+static uint32 Percentile(std::vector<uint32> const& samples, uint32 percent)
+{
+    size_t index = samples.size() * percent / 100;
+    if (index >= samples.size())
+        index = samples.size() - 1;
+
+    return samples[index];
+}
+
+SwarmStats::SwarmStats() : m_bytesIn(0), m_bytesOut(0), m_packetsIn(0), m_packetsOut(0), m_online(0),
+    m_loginFailures(0), m_disconnects(0), m_lastBytesIn(0), m_lastBytesOut(0), m_lastPacketsIn(0), m_lastPacketsOut(0),
+    m_tickProbeOwner(0)
+{
+}
+
+uint64 SwarmStats::GetTimeUS()
+{
+    ACE_Time_Value now = ACE_OS::gettimeofday();
+    return uint64(now.sec()) * 1000000 + now.usec();
+}
+
+void SwarmStats::AddLatency(SwarmLatency type, uint64 time)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+    m_samples[type].push_back(uint32(std::min<uint64>(time, 0xFFFFFFFF)));
+}
+
+void SwarmStats::AddServerDiff(uint32 diff)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+    m_serverDiffs.push_back(diff);
+}
+
+bool SwarmStats::ClaimTickProbe(uint32 botIndex)
+{
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_lock, false);
+    if (m_tickProbeOwner && m_tickProbeOwner != botIndex + 1)
+        return false;
+
+    m_tickProbeOwner = botIndex + 1;
+    return true;
+}
+
+void SwarmStats::ReleaseTickProbe(uint32 botIndex)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+    if (m_tickProbeOwner == botIndex + 1)
+        m_tickProbeOwner = 0;
+}
+
+void SwarmStats::Report(uint32 elapsed)
+{
+    std::vector<uint32> samples[MAX_SWARM_LATENCY];
+    std::vector<uint32> serverDiffs;
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+        for (uint32 i = 0; i < MAX_SWARM_LATENCY; ++i)
+            samples[i].swap(m_samples[i]);
+        serverDiffs.swap(m_serverDiffs);
+    }
+
+    long bytesIn = m_bytesIn.value();
+    long bytesOut = m_bytesOut.value();
+    long packetsIn = m_packetsIn.value();
+    long packetsOut = m_packetsOut.value();
+
+    float seconds = elapsed ? elapsed / 1000.0f : 1.0f;
+
+    printf("bots online: %ld, login failures: %ld, disconnects: %ld\n", m_online.value(), m_loginFailures.value(), m_disconnects.value());
+    printf("  in : %8.1f KB/s %7.0f packets/s\n", (bytesIn - m_lastBytesIn) / 1024.0f / seconds, (packetsIn - m_lastPacketsIn) / seconds);
+    printf("  out: %8.1f KB/s %7.0f packets/s\n", (bytesOut - m_lastBytesOut) / 1024.0f / seconds, (packetsOut - m_lastPacketsOut) / seconds);
+
+    if (!serverDiffs.empty())
+    {
+        uint64 sum = 0;
+        for (std::vector<uint32>::const_iterator itr = serverDiffs.begin(); itr != serverDiffs.end(); ++itr)
+            sum += *itr;
+
+        printf("  server update time: last %u ms, avg %u ms, max %u ms\n", serverDiffs.back(), uint32(sum / serverDiffs.size()),
+            *std::max_element(serverDiffs.begin(), serverDiffs.end()));
+    }
+
+    for (uint32 i = 0; i < MAX_SWARM_LATENCY; ++i)
+    {
+        if (samples[i].empty())
+            continue;
+
+        std::sort(samples[i].begin(), samples[i].end());
+        printf("  rtt %-12s: %6u samples, p50 %7.1f ms, p90 %7.1f ms, p99 %7.1f ms, max %7.1f ms\n",
+            LatencyName(SwarmLatency(i)), uint32(samples[i].size()), Percentile(samples[i], 50) / 1000.0f,
+            Percentile(samples[i], 90) / 1000.0f, Percentile(samples[i], 99) / 1000.0f, samples[i].back() / 1000.0f);
+    }
+
+    fflush(stdout);
+
+    m_lastBytesIn = bytesIn;
+    m_lastBytesOut = bytesOut;
+    m_lastPacketsIn = packetsIn;
+    m_lastPacketsOut = packetsOut;
+}
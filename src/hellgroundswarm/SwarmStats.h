@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2008-2014 Hellground <http://hellground.net/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef HELLGROUND_SWARMSTATS_H
+#define HELLGROUND_SWARMSTATS_H
+
+#include <ace/Atomic_Op.h>
+#include <ace/Singleton.h>
+#include <ace/Thread_Mutex.h>
+
+#include "Common.h"
+
+#include <vector>
+
+enum SwarmLatency
+{
+    LATENCY_LOGIN       = 0,                                // realm challenge to SMSG_LOGIN_VERIFY_WORLD
+    LATENCY_QUERY_TIME  = 1,                                // handled in world update, includes tick wait
+    LATENCY_AUCTION     = 2,                                // auction list search
+    LATENCY_PING        = 3,                                // answered directly by network thread
+    MAX_SWARM_LATENCY
+};
+
+/// Counters shared by all bot threads, printed and reset by main thread every report interval.
+class SwarmStats
+{
+    public:
+        SwarmStats();
+
+        static uint64 GetTimeUS();
+
+        void AddBytesIn(uint32 bytes) { m_bytesIn += bytes; ++m_packetsIn; }
+        void AddBytesOut(uint32 bytes) { m_bytesOut += bytes; ++m_packetsOut; }
+
+        void AddOnline() { ++m_online; }
+        void RemoveOnline() { --m_online; }
+        void AddLoginFailure() { ++m_loginFailures; }
+        void AddDisconnect() { ++m_disconnects; }
+
+        /// times in microseconds
+        void AddLatency(SwarmLatency type, uint64 time);
+
+        /// World::m_updateTime as reported by .server info
+        void AddServerDiff(uint32 diff);
+
+        /// only one bot at a time asks server for its update time
+        bool ClaimTickProbe(uint32 botIndex);
+        void ReleaseTickProbe(uint32 botIndex);
+
+        /// print counters gathered since last call, elapsed in milliseconds
+        void Report(uint32 elapsed);
+
+    private:
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_bytesIn;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_bytesOut;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_packetsIn;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_packetsOut;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_online;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_loginFailures;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_disconnects;
+
+        // totals printed by previous report, used only by main thread
+        long m_lastBytesIn;
+        long m_lastBytesOut;
+        long m_lastPacketsIn;
+        long m_lastPacketsOut;
+
+        ACE_Thread_Mutex m_lock;                            // guards samples and tick probe owner
+        std::vector<uint32> m_samples[MAX_SWARM_LATENCY];
+        std::vector<uint32> m_serverDiffs;
+        uint32 m_tickProbeOwner;                            // bot index + 1, 0 when nobody
+};
+
+#define sSwarmStats (*ACE_Singleton<SwarmStats, ACE_Null_Mutex>::instance())
+
+#endif
@@ -26,50 +26,46 @@
 
 DBCFileLoader::DBCFileLoader()
 {
+    mapping = NULL;
     data = NULL;
     fieldsOffset = NULL;
 }
 
 bool DBCFileLoader::Load(const char *filename, const char *fmt)
 {
-    uint32 header;
-    if (data)
+    data = NULL;
+    delete mapping;
+    delete [] fieldsOffset;
+    fieldsOffset = NULL;
+
+    // private writable mapping, stores may patch records used in place
+    mapping = new ACE_Mem_Map;
+    if (mapping->map(filename, static_cast<size_t>(-1), O_RDONLY, ACE_DEFAULT_FILE_PERMS, PROT_READ | PROT_WRITE, ACE_MAP_PRIVATE) == -1)
     {
-        delete [] data;
-        data=NULL;
+        delete mapping;
+        mapping = NULL;
+        return false;
     }
 
-    FILE * f=fopen(filename, "rb");
-    if (!f)
+    uint32 header[5];
+    if (mapping->size() < sizeof(header))
         return false;
 
-    if (fread(&header, 4, 1, f) != 1)                             // Number of records
-        return false;
+    memcpy(header, mapping->addr(), sizeof(header));
+    for (uint8 i = 0; i < 5; ++i)
+        EndianConvert(header[i]);
 
-    EndianConvert(header);
-    if (header!=0x43424457)
+    if (header[0]!=0x43424457)
         return false;                                       //'WDBC'
 
-    if (fread(&recordCount, 4, 1, f) != 1)                        // Number of records
-        return false;
-
-    EndianConvert(recordCount);
+    recordCount = header[1];                                // Number of records
+    fieldCount = header[2];                                 // Number of fields
+    recordSize = header[3];                                 // Size of a record
+    stringSize = header[4];                                 // String size
 
-    if (fread(&fieldCount, 4, 1, f) !=1)                         // Number of fields
+    if (mapping->size() < sizeof(header) + uint64(recordSize)*recordCount + stringSize)
         return false;
 
-    EndianConvert(fieldCount);
-
-    if (fread(&recordSize, 4, 1, f) != 1)                         // Size of a record
-        return false;
-
-    EndianConvert(recordSize);
-
-    if (fread(&stringSize, 4, 1, f) != 1)                         // String size
-        return false;
-
-    EndianConvert(stringSize);
-
     fieldsOffset = new uint32[fieldCount];
     fieldsOffset[0] = 0;
     for (uint32 i = 1; i < fieldCount; i++)
@@ -81,24 +77,41 @@ bool DBCFileLoader::Load(const char *filename, const char *fmt)
             fieldsOffset[i] += 4;
     }
 
-    data = new unsigned char[recordSize*recordCount+stringSize];
+    data = (unsigned char*)mapping->addr() + sizeof(header);
     stringTable = data + recordSize*recordCount;
-
-    if (fread(data, recordSize*recordCount+stringSize, 1, f) != 1)
-        return false;
-
-    fclose(f);
     return true;
 }
 
 DBCFileLoader::~DBCFileLoader()
 {
-    if (data)
-        delete [] data;
+    delete mapping;
     if (fieldsOffset)
         delete [] fieldsOffset;
 }
 
+ACE_Mem_Map* DBCFileLoader::ReleaseMapping()
+{
+    ACE_Mem_Map* released = mapping;
+    mapping = NULL;
+    return released;
+}
+
+bool DBCFileLoader::IsInPlaceFormat(const char* format) const
+{
+#if HELLGROUND_ENDIAN == HELLGROUND_BIGENDIAN
+    return false;
+#else
+    if (strlen(format) != fieldCount || GetFormatRecordSize(format) != recordSize)
+        return false;
+
+    for (uint32 x = 0; format[x]; ++x)
+        if (format[x] != FT_INT && format[x] != FT_FLOAT && format[x] != FT_IND && format[x] != FT_BYTE)
+            return false;
+
+    return true;
+#endif
+}
+
 DBCFileLoader::Record DBCFileLoader::getRecord(size_t id)
 {
     ASSERT(data);
@@ -180,7 +193,9 @@ char* DBCFileLoader::AutoProduceData(const char* format, uint32& records, char**
         indexTable = new ptr[recordCount];
     }
 
-    char* dataTable = new char[recordCount*recordsize];
+    // file records have exactly structure layout, only index table is needed
+    bool inPlace = IsInPlaceFormat(format);
+    char* dataTable = inPlace ? (char*)data : new char[recordCount*recordsize];
 
     uint32 offset = 0;
 
@@ -193,6 +208,12 @@ char* DBCFileLoader::AutoProduceData(const char* format, uint32& records, char**
         else
             indexTable[y] = &dataTable[offset];
 
+        if (inPlace)
+        {
+            offset += recordsize;
+            continue;
+        }
+
         for (uint32 x = 0; x < fieldCount; ++x)
         {
             switch (format[x])
@@ -221,14 +242,13 @@ char* DBCFileLoader::AutoProduceData(const char* format, uint32& records, char**
     return dataTable;
 }
 
-char* DBCFileLoader::AutoProduceStrings(const char* format, char* dataTable)
+uint32 DBCFileLoader::AutoProduceStrings(const char* format, char* dataTable)
 {
     if (strlen(format) != fieldCount)
-        return NULL;
-
-    char* stringPool= new char[stringSize];
-    memcpy(stringPool, stringTable, stringSize);
+        return 0;
 
+    // strings are used directly from mapped file, so pages of unused locales are never read
+    uint32 filled = 0;
     uint32 offset=0;
 
     for (uint32 y = 0; y < recordCount; ++y)
@@ -249,13 +269,13 @@ char* DBCFileLoader::AutoProduceStrings(const char* format, char* dataTable)
                     char** slot = (char**)(&dataTable[offset]);
                     if (!*slot || !**slot)
                     {
-                        const char * st = getRecord(y).getString(x);
-                        *slot = stringPool+(st-(const char*)stringTable);
+                        *slot = const_cast<char*>(getRecord(y).getString(x));
+                        ++filled;
                     }
                     offset += sizeof(char*);
                     break;
             }
     }
 
-    return stringPool;
+    return filled;
 }
@@ -25,6 +25,8 @@
 #include "Utilities/ByteConverter.h"
 #include <Log.h>
 
+#include <ace/Mem_Map.h>
+
 enum
 {
     FT_NA='x',                                              //not used or unknown, 4 byte size
@@ -94,10 +96,16 @@ class DBCFileLoader
         uint32 GetCols() const { return fieldCount; }
         uint32 GetOffset(size_t id) const { return (fieldsOffset != NULL && id < fieldCount) ? fieldsOffset[id] : 0; }
         bool IsLoaded() {return (data!=NULL);}
+        /// records can be used directly from mapped file when format has no strings and skipped fields
+        bool IsInPlaceFormat(const char* fmt) const;
         char* AutoProduceData(const char* fmt, uint32& count, char**& indexTable);
-        char* AutoProduceStrings(const char* fmt, char* dataTable);
+        /// points string fields into mapped string block, returns amount of filled fields
+        uint32 AutoProduceStrings(const char* fmt, char* dataTable);
+        /// caller takes ownership of file mapping, needed while produced data or strings are in use
+        ACE_Mem_Map* ReleaseMapping();
         static uint32 GetFormatRecordSize(const char * format, int32 * index_pos = NULL);
     private:
+        ACE_Mem_Map* mapping;
 
         uint32 recordSize;
         uint32 recordCount;
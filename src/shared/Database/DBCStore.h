@@ -25,9 +25,9 @@
 template<class T>
 class DBCStorage
 {
-    typedef std::list<char*> StringPoolList;
+    typedef std::list<ACE_Mem_Map*> FileMappingList;
     public:
-        explicit DBCStorage(const char *f) : nCount(0), fieldCount(0), fmt(f), indexTable(NULL), m_dataTable(NULL) { }
+        explicit DBCStorage(const char *f) : nCount(0), fieldCount(0), fmt(f), indexTable(NULL), m_dataTable(NULL), m_dataInPlace(false) { }
         ~DBCStorage() { Clear(); }
 
         T const* LookupEntry(uint32 id) const { return (id>=nCount)?NULL:indexTable[id]; }
@@ -43,8 +43,10 @@ class DBCStorage
                 return false;
 
             fieldCount = dbc.GetCols();
+            m_dataInPlace = dbc.IsInPlaceFormat(fmt);
             m_dataTable = (T*)dbc.AutoProduceData(fmt, nCount, (char**&)indexTable);
-            m_stringPoolList.push_back(dbc.AutoProduceStrings(fmt, (char*)m_dataTable));
+            if (dbc.AutoProduceStrings(fmt, (char*)m_dataTable) || m_dataInPlace)
+                m_fileMappingList.push_back(dbc.ReleaseMapping());
 
             // error in dbc file at loading if NULL
             return indexTable!=NULL;
@@ -61,7 +63,9 @@ class DBCStorage
             if(!dbc.Load(fn, fmt))
                 return false;
 
-            m_stringPoolList.push_back(dbc.AutoProduceStrings(fmt, (char*)m_dataTable));
+            // keep locale file mapped only if some string points into it
+            if (dbc.AutoProduceStrings(fmt, (char*)m_dataTable))
+                m_fileMappingList.push_back(dbc.ReleaseMapping());
 
             return true;
         }
@@ -73,13 +77,14 @@ class DBCStorage
 
             delete[] ((char*)indexTable);
             indexTable = NULL;
-            delete[] ((char*)m_dataTable);
+            if (!m_dataInPlace)
+                delete[] ((char*)m_dataTable);
             m_dataTable = NULL;
 
-            while(!m_stringPoolList.empty())
+            while(!m_fileMappingList.empty())
             {
-                delete[] m_stringPoolList.front();
-                m_stringPoolList.pop_front();
+                delete m_fileMappingList.front();
+                m_fileMappingList.pop_front();
             }
             nCount = 0;
         }
@@ -90,6 +95,7 @@ class DBCStorage
         char const* fmt;
         T** indexTable;
         T* m_dataTable;
-        StringPoolList m_stringPoolList;
+        bool m_dataInPlace;                                 // records are used directly from file mapping
+        FileMappingList m_fileMappingList;
 };
 #endif
@@ -0,0 +1,319 @@
+/*
+ * Copyright (C) 2008-2014 Hellground <http://hellground.net/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "DataSnapshot.h"
+#include "Database/DatabaseEnv.h"
+
+#include <ace/Mem_Map.h>
+
+extern DatabaseType GameDataDatabase;
+
+#define RESULT_SNAPSHOT_MAGIC       0x52534748              // "HGSR"
+#define RESULT_SNAPSHOT_VERSION     1
+#define RESULT_SNAPSHOT_NULL_FIELD  0xFFFFFFFF
+
+// result snapshot file: header, source version, field types, then for every row
+// and field its length (or RESULT_SNAPSHOT_NULL_FIELD) and null terminated value
+struct ResultSnapshotHeader
+{
+    uint32 magic;
+    uint32 version;
+    uint32 sqlHash;                                         // query text, changes with selected columns
+    uint32 versionLength;
+    uint32 fieldCount;
+    uint32 reserved;
+    uint64 rowCount;
+};
+
+std::string DataSnapshot::snapshotDir;
+std::map<std::string, std::string> DataSnapshot::tableVersions;
+
+static uint32 HashQuery(char const* sql)
+{
+    uint32 hash = 2166136261u;                              // FNV-1a
+    for (; *sql; ++sql)
+        hash = (hash ^ uint8(*sql)) * 16777619u;
+
+    return hash;
+}
+
+void DataSnapshot::Initialize(std::string const& dir)
+{
+    snapshotDir = dir;
+    tableVersions.clear();
+
+    if (!IsEnabled())
+        return;
+
+    // information_schema is cheap compared to reading tables, UPDATE_TIME changes with every write to table
+    // and CREATE_TIME with every ALTER. Tables without known update time are always loaded from SQL.
+    QueryResultAutoPtr result = GameDataDatabase.Query("SELECT TABLE_NAME, UNIX_TIMESTAMP(CREATE_TIME), UNIX_TIMESTAMP(UPDATE_TIME) "
+        "FROM information_schema.TABLES WHERE TABLE_SCHEMA = DATABASE()");
+    if (!result)
+    {
+        sLog.outLog(LOG_DEFAULT, "ERROR: Can't read world table versions, static data snapshots disabled");
+        snapshotDir.clear();
+        return;
+    }
+
+    do
+    {
+        Field* fields = result->Fetch();
+        if (fields[1].IsNULL() || fields[2].IsNULL())
+            continue;
+
+        tableVersions[fields[0].GetCppString()] = fields[1].GetCppString() + "/" + fields[2].GetCppString();
+    }
+    while (result->NextRow());
+
+    sLog.outString("Using static data snapshots from %s", snapshotDir.c_str());
+}
+
+void DataSnapshot::Disable()
+{
+    snapshotDir.clear();
+    tableVersions.clear();
+}
+
+bool DataSnapshot::GetSourceVersion(char const* tables, std::string& version)
+{
+    version.clear();
+
+    std::string names(tables);
+    std::string::size_type start = 0;
+    while (start <= names.size())
+    {
+        std::string::size_type end = names.find(',', start);
+        if (end == std::string::npos)
+            end = names.size();
+
+        std::string table = names.substr(start, end - start);
+        std::map<std::string, std::string>::const_iterator itr = tableVersions.find(table);
+        if (itr == tableVersions.end())
+            return false;
+
+        version += table + "=" + itr->second + ";";
+        start = end + 1;
+    }
+
+    return true;
+}
+
+QueryResultAutoPtr DataSnapshot::Query(char const* name, char const* tables, char const* sql)
+{
+    std::string version;
+    if (!IsEnabled() || !GetSourceVersion(tables, version))
+        return GameDataDatabase.Query(sql);
+
+    std::string fileName = GetFileName(name);
+    uint32 sqlHash = HashQuery(sql);
+
+    if (QueryResultSnapshot* snapshot = QueryResultSnapshot::Open(fileName, version, sqlHash))
+    {
+        sLog.outString("Loaded `%s` from snapshot", name);
+        return QueryResultAutoPtr(snapshot);
+    }
+
+    QueryResultAutoPtr result = GameDataDatabase.Query(sql);
+    if (!result)
+        return result;
+
+    // saving walks whole result, rows are then read back from new file
+    if (SaveResult(fileName, version, sqlHash, result))
+        if (QueryResultSnapshot* snapshot = QueryResultSnapshot::Open(fileName, version, sqlHash))
+            return QueryResultAutoPtr(snapshot);
+
+    return GameDataDatabase.Query(sql);
+}
+
+bool DataSnapshot::SaveResult(std::string const& fileName, std::string const& version, uint32 sqlHash, QueryResultAutoPtr result)
+{
+    std::string tmpName = fileName + ".tmp";
+
+    FILE* file = fopen(tmpName.c_str(), "wb");
+    if (!file)
+    {
+        sLog.outLog(LOG_DEFAULT, "ERROR: Can't create snapshot file %s", tmpName.c_str());
+        return false;
+    }
+
+    ResultSnapshotHeader header;
+    header.magic = RESULT_SNAPSHOT_MAGIC;
+    header.version = RESULT_SNAPSHOT_VERSION;
+    header.sqlHash = sqlHash;
+    header.versionLength = version.size();
+    header.fieldCount = result->GetFieldCount();
+    header.reserved = 0;
+    header.rowCount = result->GetRowCount();
+
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(version.c_str(), version.size(), 1, file);
+
+    Field* fields = result->Fetch();
+    for (uint32 x = 0; x < header.fieldCount; ++x)
+    {
+        uint8 type = fields[x].GetType();
+        fwrite(&type, sizeof(type), 1, file);
+    }
+
+    uint64 rows = 0;
+    do
+    {
+        fields = result->Fetch();
+        for (uint32 x = 0; x < header.fieldCount; ++x)
+        {
+            char const* value = fields[x].GetString();
+            uint32 len = value ? strlen(value) : RESULT_SNAPSHOT_NULL_FIELD;
+            fwrite(&len, sizeof(len), 1, file);
+            if (value)
+                fwrite(value, len + 1, 1, file);
+        }
+        ++rows;
+    }
+    while (result->NextRow());
+
+    bool failed = ferror(file) != 0 || rows != header.rowCount;
+    fclose(file);
+
+    // replace old snapshot only with complete file
+    remove(fileName.c_str());
+    if (failed || rename(tmpName.c_str(), fileName.c_str()) != 0)
+    {
+        remove(tmpName.c_str());
+        sLog.outLog(LOG_DEFAULT, "ERROR: Can't write snapshot file %s", fileName.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+QueryResultSnapshot* QueryResultSnapshot::Open(std::string const& fileName, std::string const& version, uint32 sqlHash)
+{
+    ACE_Mem_Map* mapping = new ACE_Mem_Map;
+    if (mapping->map(fileName.c_str(), static_cast<size_t>(-1), O_RDONLY, ACE_DEFAULT_FILE_PERMS, PROT_READ, ACE_MAP_PRIVATE) == -1)
+    {
+        delete mapping;
+        return NULL;
+    }
+
+    char const* pos = (char const*)mapping->addr();
+    char const* end = pos + mapping->size();
+
+    ResultSnapshotHeader header;
+    if (mapping->size() < sizeof(header))
+    {
+        delete mapping;
+        return NULL;
+    }
+
+    memcpy(&header, pos, sizeof(header));
+    pos += sizeof(header);
+
+    if (header.magic != RESULT_SNAPSHOT_MAGIC || header.version != RESULT_SNAPSHOT_VERSION || header.sqlHash != sqlHash ||
+        header.versionLength != version.size() || !header.fieldCount || !header.rowCount ||
+        uint64(end - pos) < uint64(header.versionLength) + header.fieldCount || version.compare(0, version.size(), pos, header.versionLength) != 0)
+    {
+        delete mapping;
+        return NULL;
+    }
+    pos += header.versionLength;
+
+    char const* types = pos;
+    pos += header.fieldCount;
+
+    // check whole file once, rows are then read without bound checks
+    char const* rows = pos;
+    uint64 count = 0;
+    while (pos < end)
+    {
+        for (uint32 x = 0; x < header.fieldCount && pos; ++x)
+        {
+            uint32 len;
+            if (end - pos < ptrdiff_t(sizeof(len)))
+            {
+                pos = NULL;
+                break;
+            }
+
+            memcpy(&len, pos, sizeof(len));
+            pos += sizeof(len);
+
+            if (len == RESULT_SNAPSHOT_NULL_FIELD)
+                continue;
+
+            if (uint64(end - pos) <= len || pos[len] != '\0')
+                pos = NULL;
+            else
+                pos += len + 1;
+        }
+
+        if (!pos)
+            break;
+
+        ++count;
+    }
+
+    if (!pos || count != header.rowCount)
+    {
+        sLog.outLog(LOG_DEFAULT, "ERROR: Snapshot file %s is broken, loading from database", fileName.c_str());
+        delete mapping;
+        return NULL;
+    }
+
+    QueryResultSnapshot* result = new QueryResultSnapshot(mapping, rows, end, header.rowCount, header.fieldCount);
+    for (uint32 x = 0; x < header.fieldCount; ++x)
+        result->mCurrentRow[x].SetType(Field::DataTypes(uint8(types[x])));
+
+    result->NextRow();
+    return result;
+}
+
+QueryResultSnapshot::QueryResultSnapshot(ACE_Mem_Map* mapping, char const* rows, char const* end, uint64 rowCount, uint32 fieldCount) :
+    QueryResult(rowCount, fieldCount), mMapping(mapping), mPos(rows), mEnd(end)
+{
+    mCurrentRow = new Field[mFieldCount];
+}
+
+QueryResultSnapshot::~QueryResultSnapshot()
+{
+    delete [] mCurrentRow;
+    delete mMapping;
+}
+
+bool QueryResultSnapshot::NextRow()
+{
+    if (mPos >= mEnd)
+        return false;
+
+    for (uint32 i = 0; i < mFieldCount; i++)
+    {
+        uint32 len;
+        memcpy(&len, mPos, sizeof(len));
+        mPos += sizeof(len);
+
+        if (len == RESULT_SNAPSHOT_NULL_FIELD)
+            mCurrentRow[i].SetValue(NULL);
+        else
+        {
+            mCurrentRow[i].SetValue(mPos);
+            mPos += len + 1;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2008-2014 Hellground <http://hellground.net/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef HELLGROUND_DATASNAPSHOT_H
+#define HELLGROUND_DATASNAPSHOT_H
+
+#include "Common.h"
+#include "Database/QueryResult.h"
+
+#include <map>
+
+class ACE_Mem_Map;
+
+/// Binary snapshots of static world tables, used at startup instead of SQL while source tables are unchanged
+class DataSnapshot
+{
+    public:
+        // empty dir disables snapshots, reads version stamps of all world tables once
+        static void Initialize(std::string const& dir);
+        static bool IsEnabled() { return !snapshotDir.empty(); }
+        // versions are read only once, so reloads after startup must always read SQL
+        static void Disable();
+
+        static std::string GetFileName(char const* name) { return snapshotDir + name + ".snapshot"; }
+
+        // version of comma separated source tables, false when some table has no known update time
+        static bool GetSourceVersion(char const* tables, std::string& version);
+
+        // same as GameDataDatabase.Query(sql), but result is read from snapshot file while source tables are unchanged
+        static QueryResultAutoPtr Query(char const* name, char const* tables, char const* sql);
+
+    private:
+        static bool SaveResult(std::string const& fileName, std::string const& version, uint32 sqlHash, QueryResultAutoPtr result);
+
+        static std::string snapshotDir;
+        static std::map<std::string, std::string> tableVersions;   // filled by Initialize, read only afterwards
+};
+
+/// Result set mapped from snapshot file, fields point directly into the mapping
+class QueryResultSnapshot : public QueryResult
+{
+    public:
+        // NULL when file is missing, outdated or broken
+        static QueryResultSnapshot* Open(std::string const& fileName, std::string const& version, uint32 sqlHash);
+
+        ~QueryResultSnapshot();
+
+        bool NextRow();
+
+    private:
+        QueryResultSnapshot(ACE_Mem_Map* mapping, char const* rows, char const* end, uint64 rowCount, uint32 fieldCount);
+
+        ACE_Mem_Map* mMapping;
+        char const* mPos;
+        char const* mEnd;
+};
+
+#endif
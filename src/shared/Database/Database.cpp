@@ -415,11 +415,21 @@ bool Database::BeginTransaction()
         return false;
 
     //initiate transaction on current thread
-    //currently we do not support queued transactions
+    //currently we do not support queued transactions, except inside of BeginNestedTransaction()
     m_TransStorage->init();
     return true;
 }
 
+bool Database::BeginNestedTransaction()
+{
+    if (!m_pAsyncConn)
+        return false;
+
+    //initiate transaction which BeginTransaction/CommitTransaction pairs of called methods will join
+    m_TransStorage->initNested();
+    return true;
+}
+
 bool Database::CommitTransaction()
 {
     if (!m_pAsyncConn)
@@ -429,6 +439,10 @@ bool Database::CommitTransaction()
     if(!m_TransStorage->get())
         return false;
 
+    //inner level of nested transaction, outermost commit will execute it
+    if(!m_TransStorage->leave())
+        return true;
+
     //if async execution is not available
     if(!m_bAllowAsyncTransactions)
         return CommitTransactionDirect();
@@ -640,15 +654,41 @@ Database::TransHelper::~TransHelper()
 
 SqlTransaction * Database::TransHelper::init()
 {
-    ASSERT(!m_pTrans);   //if we will get a nested transaction request - we MUST fix code!!!
+    if(m_pTrans)
+    {
+        ASSERT(m_nestLevel);   //if we will get a nested transaction request outside of BeginNestedTransaction - we MUST fix code!!!
+        ++m_nestLevel;
+        return m_pTrans;
+    }
+
+    m_pTrans = new SqlTransaction;
+    return m_pTrans;
+}
+
+SqlTransaction * Database::TransHelper::initNested()
+{
+    ASSERT(!m_pTrans);
     m_pTrans = new SqlTransaction;
+    m_nestLevel = 1;
     return m_pTrans;
 }
 
+bool Database::TransHelper::leave()
+{
+    if(m_nestLevel > 1)
+    {
+        --m_nestLevel;
+        return false;
+    }
+
+    return true;
+}
+
 SqlTransaction * Database::TransHelper::detach()
 {
     SqlTransaction * pRes = m_pTrans;
     m_pTrans = NULL;
+    m_nestLevel = 0;
     return pRes;
 }
 
@@ -659,4 +699,5 @@ void Database::TransHelper::reset()
         delete m_pTrans;
         m_pTrans = NULL;
     }
+    m_nestLevel = 0;
 }
@@ -185,6 +185,8 @@ class Database
         bool PExecuteLog(const char *format,...) ATTR_PRINTF(2,3);
 
         bool BeginTransaction();
+        //transaction joined by BeginTransaction/CommitTransaction pairs until its own CommitTransaction
+        bool BeginNestedTransaction();
         bool CommitTransaction();
         bool RollbackTransaction();
         //for sync transaction execution
@@ -240,11 +242,16 @@ class Database
         class TransHelper
         {
             public:
-                TransHelper() : m_pTrans(NULL) {}
+                TransHelper() : m_pTrans(NULL), m_nestLevel(0) {}
                 ~TransHelper();
 
                 //initializes new SqlTransaction object
+                //joins already opened transaction only when it was created by initNested()
                 SqlTransaction * init();
+                //initializes new SqlTransaction object which later init() calls will join
+                SqlTransaction * initNested();
+                //leaves one nesting level, returns true when outermost level was reached
+                bool leave();
                 //gets pointer on current transaction object. Returns NULL if transaction was not initiated
                 SqlTransaction * get() const { return m_pTrans; }
                 //detaches SqlTransaction object allocated by init() function
@@ -256,6 +263,7 @@ class Database
 
             private:
                 SqlTransaction * m_pTrans;
+                uint32 m_nestLevel;
         };
 
         //per-thread based storage for SqlTransaction object initialization - no locking is required
@@ -20,8 +20,35 @@
 #include "SQLStorage.h"
 #include "SQLStorageImpl.h"
 
+#include <ace/Mem_Map.h>
+
 extern DatabaseType GameDataDatabase;
 
+#define SQLSTORAGE_SNAPSHOT_MAGIC   0x53534748              // "HGSS"
+#define SQLSTORAGE_SNAPSHOT_VERSION 2
+
+// snapshot file: header, source version, dst format, entries, records and string block,
+// each block aligned to 8 bytes. String fields of stored records hold offsets into string block.
+struct SQLStorageSnapshotHeader
+{
+    uint32 magic;
+    uint32 version;
+    uint32 pointerSize;                                     // raw records are only valid for same build
+    uint32 salt;
+    uint32 versionLength;
+    uint32 recordSize;
+    uint32 recordCount;
+    uint32 maxEntry;
+    uint32 numFields;
+    uint32 stringsSize;
+};
+
+static inline size_t SnapshotAlign(size_t size)
+{
+    return (size + 7) & ~size_t(7);
+}
+
+
 const char CreatureInfosrcfmt[]="iiiiiiisssiiiiiiifiiiffiffiiiiiiiiiiiffiiiiiiiiiiiiiiiiiiiisiilliiis";
 const char CreatureInfodstfmt[]="iiiiiiisssiiiiiiifiiiffiffiiiiiiiiiiiffiiiiiiiiiiiiiiiiiiiisiilliiii";
 const char CreatureDataAddonInfofmt[]="iiiiiiiis";
@@ -55,7 +82,7 @@ void SQLStorage::EraseEntry(uint32 id)
         if (dst_format[x]==FT_STRING)
         {
             if(pIndex[id])
-                delete [] *(char**)((char*)(pIndex[id])+offset);
+                FreeString(*(char**)((char*)(pIndex[id])+offset));
 
             offset += sizeof(char*);
         }
@@ -77,7 +104,7 @@ void SQLStorage::Free ()
         {
             for(uint32 y=0;y<MaxEntry;y++)
                 if(pIndex[y])
-                    delete [] *(char**)((char*)(pIndex[y])+offset);
+                    FreeString(*(char**)((char*)(pIndex[y])+offset));
 
             offset += sizeof(char*);
         }
@@ -90,6 +117,270 @@ void SQLStorage::Free ()
 
     delete [] pIndex;
     delete [] data;
+    delete snapshot;
+
+    pIndex = NULL;
+    data = NULL;
+    snapshot = NULL;
+    MaxEntry = 0;
+}
+
+void SQLStorage::FreeString(char const* str) const
+{
+    if (!IsMapped(str))
+        delete [] str;
+}
+
+bool SQLStorage::IsMapped(char const* ptr) const
+{
+    if (!snapshot)
+        return false;
+
+    char const* begin = (char const*)snapshot->addr();
+    return ptr >= begin && ptr < begin + snapshot->size();
+}
+
+uint32 SQLStorage::GetRecordSize() const
+{
+    uint32 size = 0;
+    for (uint32 x = 0; x < iNumFields; x++)
+        if (dst_format[x] == FT_STRING)
+            size += sizeof(char*);
+        else if (dst_format[x] == FT_LOGIC)
+            size += sizeof(bool);
+        else if (dst_format[x] == FT_BYTE)
+            size += sizeof(char);
+        else
+            size += 4;
+
+    return size;
+}
+
+bool SQLStorage::LoadSnapshot(std::string const& version, uint32 salt)
+{
+    std::string fileName = DataSnapshot::GetFileName(table);
+
+    // private writable mapping, loaders fix up records in place and only touched pages are copied
+    ACE_Mem_Map* mapping = new ACE_Mem_Map;
+    if (mapping->map(fileName.c_str(), static_cast<size_t>(-1), O_RDONLY, ACE_DEFAULT_FILE_PERMS, PROT_READ | PROT_WRITE, ACE_MAP_PRIVATE) == -1)
+    {
+        delete mapping;
+        return false;
+    }
+
+    char* begin = (char*)mapping->addr();
+    size_t size = mapping->size();
+
+    SQLStorageSnapshotHeader header;
+    if (size < sizeof(header))
+    {
+        delete mapping;
+        return false;
+    }
+
+    memcpy(&header, begin, sizeof(header));
+
+    size_t versionPos = sizeof(header);
+    size_t formatPos = versionPos + header.versionLength;
+    size_t entriesPos = SnapshotAlign(formatPos + header.numFields);
+    size_t recordsPos = SnapshotAlign(entriesPos + size_t(header.recordCount) * sizeof(uint32));
+    size_t stringsPos = SnapshotAlign(recordsPos + size_t(header.recordCount) * header.recordSize);
+
+    if (header.magic != SQLSTORAGE_SNAPSHOT_MAGIC || header.version != SQLSTORAGE_SNAPSHOT_VERSION ||
+        header.pointerSize != sizeof(char*) || header.salt != salt || header.recordSize != GetRecordSize() ||
+        header.numFields != iNumFields || stringsPos + header.stringsSize != size ||
+        header.versionLength != version.size() || version.compare(0, version.size(), begin + versionPos, header.versionLength) != 0 ||
+        memcmp(begin + formatPos, dst_format, iNumFields) != 0)
+    {
+        sLog.outString("Snapshot of table `%s` is outdated, loading from database", table);
+        delete mapping;
+        return false;
+    }
+
+    char const* strings = begin + stringsPos;
+    // every string is null terminated, so string block must end with terminator
+    bool broken = header.stringsSize && strings[header.stringsSize - 1] != '\0';
+
+    char** index = new char*[header.maxEntry];
+    memset(index, 0, header.maxEntry * sizeof(char*));
+
+    for (uint32 i = 0; i < header.recordCount && !broken; ++i)
+    {
+        uint32 entry;
+        memcpy(&entry, begin + entriesPos + i * sizeof(uint32), sizeof(entry));
+        if (entry >= header.maxEntry || index[entry])
+        {
+            broken = true;
+            break;
+        }
+
+        char* p = begin + recordsPos + size_t(i) * header.recordSize;
+
+        // turn stored string offsets into pointers
+        uint32 offset = 0;
+        for (uint32 x = 0; x < iNumFields; x++)
+            if (dst_format[x] == FT_STRING)
+            {
+                size_t strOffset;
+                memcpy(&strOffset, p + offset, sizeof(strOffset));
+                if (strOffset >= header.stringsSize)
+                {
+                    broken = true;
+                    break;
+                }
+
+                *(char const**)(p + offset) = strings + strOffset;
+                offset += sizeof(char*);
+            }
+            else if (dst_format[x] == FT_LOGIC)
+                offset += sizeof(bool);
+            else if (dst_format[x] == FT_BYTE)
+                offset += sizeof(char);
+            else
+                offset += 4;
+
+        index[entry] = p;
+    }
+
+    if (broken)
+    {
+        sLog.outLog(LOG_DEFAULT, "ERROR: Snapshot file %s is broken, loading `%s` from database", fileName.c_str(), table);
+        delete [] index;
+        delete mapping;
+        return false;
+    }
+
+    pIndex = index;
+    snapshot = mapping;
+    MaxEntry = header.maxEntry;
+    RecordCount = header.recordCount;
+
+    sLog.outString("Loaded table `%s` from snapshot", table);
+    return true;
+}
+
+void SQLStorage::SaveSnapshot(std::string const& version, uint32 salt) const
+{
+    std::string fileName = DataSnapshot::GetFileName(table);
+    std::string tmpName = fileName + ".tmp";
+
+    FILE* file = fopen(tmpName.c_str(), "wb");
+    if (!file)
+    {
+        sLog.outLog(LOG_DEFAULT, "ERROR: Can't create snapshot file %s", tmpName.c_str());
+        return;
+    }
+
+    SQLStorageSnapshotHeader header;
+    header.magic = SQLSTORAGE_SNAPSHOT_MAGIC;
+    header.version = SQLSTORAGE_SNAPSHOT_VERSION;
+    header.pointerSize = sizeof(char*);
+    header.salt = salt;
+    header.versionLength = version.size();
+    header.recordSize = GetRecordSize();
+    header.recordCount = 0;
+    header.maxEntry = MaxEntry;
+    header.numFields = iNumFields;
+    header.stringsSize = 0;
+
+    for (uint32 y = 0; y < MaxEntry; y++)
+    {
+        if (!pIndex[y])
+            continue;
+
+        ++header.recordCount;
+
+        uint32 offset = 0;
+        for (uint32 x = 0; x < iNumFields; x++)
+            if (dst_format[x] == FT_STRING)
+            {
+                header.stringsSize += strlen(*(char**)(pIndex[y] + offset)) + 1;
+                offset += sizeof(char*);
+            }
+            else if (dst_format[x] == FT_LOGIC)
+                offset += sizeof(bool);
+            else if (dst_format[x] == FT_BYTE)
+                offset += sizeof(char);
+            else
+                offset += 4;
+    }
+
+    static char const padding[8] = { 0 };
+    size_t pos = sizeof(header) + version.size() + iNumFields;
+
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(version.c_str(), version.size(), 1, file);
+    fwrite(dst_format, iNumFields, 1, file);
+    fwrite(padding, SnapshotAlign(pos) - pos, 1, file);
+
+    for (uint32 y = 0; y < MaxEntry; y++)
+        if (pIndex[y])
+            fwrite(&y, sizeof(y), 1, file);
+
+    pos = size_t(header.recordCount) * sizeof(uint32);
+    fwrite(padding, SnapshotAlign(pos) - pos, 1, file);
+
+    std::vector<char> record(header.recordSize);
+    size_t strOffset = 0;
+    for (uint32 y = 0; y < MaxEntry; y++)
+    {
+        if (!pIndex[y])
+            continue;
+
+        memcpy(&record[0], pIndex[y], header.recordSize);
+
+        uint32 offset = 0;
+        for (uint32 x = 0; x < iNumFields; x++)
+            if (dst_format[x] == FT_STRING)
+            {
+                memcpy(&record[offset], &strOffset, sizeof(strOffset));
+                strOffset += strlen(*(char**)(pIndex[y] + offset)) + 1;
+                offset += sizeof(char*);
+            }
+            else if (dst_format[x] == FT_LOGIC)
+                offset += sizeof(bool);
+            else if (dst_format[x] == FT_BYTE)
+                offset += sizeof(char);
+            else
+                offset += 4;
+
+        fwrite(&record[0], header.recordSize, 1, file);
+    }
+
+    pos = size_t(header.recordCount) * header.recordSize;
+    fwrite(padding, SnapshotAlign(pos) - pos, 1, file);
+
+    for (uint32 y = 0; y < MaxEntry; y++)
+    {
+        if (!pIndex[y])
+            continue;
+
+        uint32 offset = 0;
+        for (uint32 x = 0; x < iNumFields; x++)
+            if (dst_format[x] == FT_STRING)
+            {
+                char const* str = *(char**)(pIndex[y] + offset);
+                fwrite(str, strlen(str) + 1, 1, file);
+                offset += sizeof(char*);
+            }
+            else if (dst_format[x] == FT_LOGIC)
+                offset += sizeof(bool);
+            else if (dst_format[x] == FT_BYTE)
+                offset += sizeof(char);
+            else
+                offset += 4;
+    }
+
+    bool failed = ferror(file) != 0;
+    fclose(file);
+
+    // replace old snapshot only with complete file
+    remove(fileName.c_str());
+    if (failed || rename(tmpName.c_str(), fileName.c_str()) != 0)
+    {
+        remove(tmpName.c_str());
+        sLog.outLog(LOG_DEFAULT, "ERROR: Can't write snapshot file %s", fileName.c_str());
+    }
 }
 
 void SQLStorage::Load()
@@ -23,6 +23,8 @@
 #include "Common.h"
 #include "Database/DatabaseEnv.h"
 
+class ACE_Mem_Map;
+
 class SQLStorage
 {
     template<class T>
@@ -70,13 +72,23 @@ class SQLStorage
         void Free();
 
         void EraseEntry(uint32 id);
+
+        // string fields replaced by loaders must be freed here, strings of snapshot records live in mapped file
+        void FreeString(char const* str) const;
     private:
+        uint32 GetRecordSize() const;
+
+        bool IsMapped(char const* ptr) const;
+        bool LoadSnapshot(std::string const& version, uint32 salt);
+        void SaveSnapshot(std::string const& version, uint32 salt) const;
+
         void init(const char * _entry_field, const char * sqlname)
         {
             entry_field = _entry_field;
             table=sqlname;
             data=NULL;
             pIndex=NULL;
+            snapshot=NULL;
             iNumFields = strlen(src_format);
             MaxEntry = 0;
         }
@@ -84,6 +96,7 @@ class SQLStorage
         char** pIndex;
 
         char *data;
+        ACE_Mem_Map* snapshot;                              // records point into it when loaded from snapshot
         const char *src_format;
         const char *dst_format;
         const char *table;
@@ -109,6 +122,9 @@ struct SQLStorageLoaderBase
         template<class D>
             void convert_from_str(uint32 field_pos, char* src, D& dst);
         void convert_str_to_str(uint32 field_pos, char* src, char *&dst);
+
+        // loaders converting values with external state (script names) must change snapshot key with it
+        uint32 snapshotSalt() const { return 0; }
     private:
         template<class V>
             void storeValue(V value, SQLStorage &store, char *p, uint32 x, uint32 &offset);
@@ -23,6 +23,7 @@
 #include "ProgressBar.h"
 #include "Log.h"
 #include "DBCFileLoader.h"
+#include "DataSnapshot.h"
 
 template<class T>
 template<class S, class D>
@@ -126,6 +127,13 @@ void SQLStorageLoaderBase<T>::Load(SQLStorage &store)
 {
     uint32 maxi;
     Field *fields;
+
+    std::string version;
+    uint32 salt = static_cast<T*>(this)->snapshotSalt();
+    bool useSnapshot = DataSnapshot::IsEnabled() && DataSnapshot::GetSourceVersion(store.table, version);
+    if (useSnapshot && store.LoadSnapshot(version, salt))
+        return;
+
     QueryResultAutoPtr result = GameDataDatabase.PQuery("SELECT MAX(%s) FROM %s", store.entry_field, store.table);
     if(!result)
     {
@@ -153,7 +161,6 @@ void SQLStorageLoaderBase<T>::Load(SQLStorage &store)
         return;
     }
 
-    uint32 recordsize = 0;
     uint32 offset = 0;
 
     if(store.iNumFields != result->GetFieldCount())
@@ -163,18 +170,7 @@ void SQLStorageLoaderBase<T>::Load(SQLStorage &store)
         exit(1);                                            // Stop server at loading broken or non-compatible table.
     }
 
-    //get struct size
-    uint32 sc=0;
-    uint32 bo=0;
-    uint32 bb=0;
-    for(uint32 x=0; x< store.iNumFields; x++)
-        if(store.dst_format[x]==FT_STRING)
-            ++sc;
-        else if (store.dst_format[x]==FT_LOGIC)
-            ++bo;
-        else if (store.dst_format[x]==FT_BYTE)
-            ++bb;
-    recordsize=(store.iNumFields-sc-bo-bb)*4+sc*sizeof(char*)+bo*sizeof(bool)+bb*sizeof(char);
+    uint32 recordsize = store.GetRecordSize();
 
     char** newIndex=new char*[maxi];
     memset(newIndex,0,maxi*sizeof(char*));
@@ -211,6 +207,9 @@ void SQLStorageLoaderBase<T>::Load(SQLStorage &store)
     store.pIndex = newIndex;
     store.MaxEntry = maxi;
     store.data = _data;
+
+    if (useSnapshot)
+        store.SaveSnapshot(version, salt);
 }
 
 #endif
@@ -24,8 +24,63 @@
 
 #include "Common.h"
 #include "Config/Config.h"
+#include "Threading.h"
 #include "Util.h"
 
+#include <ace/OS_NS_time.h>
+#include <ace/TSS_T.h>
+
+#define LOG_RECORD_SIZE 512
+
+// line formatted by the calling thread, longer lines are allocated separately
+struct LogRecord
+{
+    uint8 log;
+    char* longText;
+    char text[LOG_RECORD_SIZE];
+};
+
+// single producer (owner thread) / single consumer (writer thread) queue
+struct LogRing
+{
+    explicit LogRing(uint32 size) : records(size), head(0), tail(0), dropped(0) {}
+
+    std::vector<LogRecord> records;
+    ACE_Atomic_Op<ACE_Thread_Mutex, long> head;             // next record to fill, changed only by owner
+    ACE_Atomic_Op<ACE_Thread_Mutex, long> tail;             // next record to write, changed only by writer
+    ACE_Atomic_Op<ACE_Thread_Mutex, long> dropped;          // lines lost because ring was full
+};
+
+// rings are owned by Log, slot only remembers which one belongs to the thread
+struct LogRingSlot
+{
+    LogRingSlot() : ring(NULL) {}
+
+    LogRing* ring;
+};
+
+typedef ACE_TSS<LogRingSlot> LogRingSlotTSS;
+
+static LogRingSlotTSS logRingSlot;
+
+class LogWriterRunnable : public ACE_Based::Runnable
+{
+    public:
+        explicit LogWriterRunnable(Log& log) : m_log(log) {}
+
+        void run()
+        {
+            while (m_log.m_async)
+            {
+                ACE_Based::Thread::Sleep(m_log.m_asyncFlushInterval);
+                m_log.WriteQueued();
+            }
+        }
+
+    private:
+        Log& m_log;
+};
+
 const char* logToStr[LOG_MAX_FILES][3] =
 {     // file name conf    mode  timestamp conf name
     { "GMLogFile",          "a", "GmLogTimestamp" },    // LOG_GM
@@ -50,10 +105,14 @@ const char* logToStr[LOG_MAX_FILES][3] =
     { "RaceChangeLogFile",  "a", NULL }                 // LOG_RACE_CHANGE
 };
 
-Log::Log() : m_includeTime(false), m_gmlog_per_account(false)
+Log::Log() : m_includeTime(false), m_gmlog_per_account(false), m_async(false), m_asyncBufferSize(0), m_asyncFlushInterval(0),
+    m_rotateSize(0), m_droppedReported(0), m_writerThread(NULL)
 {
     for (uint8 i = LOG_DEFAULT; i < LOG_MAX_FILES; i++)
+    {
         logFile[i] = NULL;
+        m_fileSize[i] = 0;
+    }
 
     Initialize();
 }
@@ -409,6 +468,19 @@ void Log::outLog(LogNames log, const char * str, ...)
     if (!str)
         return;
 
+    // crash log must be on disk before process dies
+    if (m_async && log != LOG_CRASH)
+    {
+        if (logFile[log])
+        {
+            va_list ap;
+            va_start(ap, str);
+            QueueLine(log, str, ap);
+            va_end(ap);
+        }
+        return;
+    }
+
     if (logFile[log])
     {
         // check for errors
@@ -434,6 +506,180 @@ void Log::outLog(LogNames log, const char * str, ...)
     }
 }
 
+void Log::StartAsyncWriter()
+{
+    if (m_async || !sConfig.GetBoolDefault("LogAsync.Enable", false))
+        return;
+
+    m_asyncBufferSize = sConfig.GetIntDefault("LogAsync.BufferSize", 1024);
+    if (m_asyncBufferSize < 16)
+        m_asyncBufferSize = 16;
+
+    m_asyncFlushInterval = sConfig.GetIntDefault("LogAsync.FlushInterval", 500);
+    if (!m_asyncFlushInterval)
+        m_asyncFlushInterval = 1;
+
+    m_rotateSize = uint64(sConfig.GetIntDefault("LogAsync.RotateSize", 0)) * 1024 * 1024;
+
+    for (uint8 i = LOG_DEFAULT; i < LOG_MAX_FILES; ++i)
+    {
+        if (logFile[i] && !fseek(logFile[i], 0, SEEK_END))
+            m_fileSize[i] = ftell(logFile[i]);
+    }
+
+    m_async = true;
+    m_writerThread = new ACE_Based::Thread(new LogWriterRunnable(*this));
+}
+
+void Log::StopAsyncWriter()
+{
+    if (!m_async)
+        return;
+
+    m_async = false;
+    m_writerThread->wait();
+    delete m_writerThread;
+    m_writerThread = NULL;
+
+    WriteQueued();
+}
+
+void Log::QueueLine(LogNames log, const char * str, va_list ap)
+{
+    LogRingSlot* slot = logRingSlot.ts_object();
+    if (!slot)
+    {
+        slot = new LogRingSlot;
+        logRingSlot.ts_object(slot);
+    }
+
+    if (!slot->ring)
+    {
+        slot->ring = new LogRing(m_asyncBufferSize);
+
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_ringsLock);
+        m_rings.push_back(slot->ring);
+    }
+
+    LogRing* ring = slot->ring;
+    long head = ring->head.value();
+    if (head - ring->tail.value() >= long(ring->records.size()))
+    {
+        ++ring->dropped;
+        return;
+    }
+
+    LogRecord& record = ring->records[head % ring->records.size()];
+    record.log = log;
+    record.longText = NULL;
+
+    // producers run concurrently, localtime() would share its static buffer
+    time_t t = time(NULL);
+    tm aTm;
+    ACE_OS::localtime_r(&t, &aTm);
+    int stamp = snprintf(record.text, LOG_RECORD_SIZE, "%-4d-%02d-%02d %02d:%02d:%02d ", aTm.tm_year+1900, aTm.tm_mon+1, aTm.tm_mday, aTm.tm_hour, aTm.tm_min, aTm.tm_sec);
+
+    va_list ap2;
+    va_copy(ap2, ap);
+    int len = vsnprintf(record.text + stamp, LOG_RECORD_SIZE - stamp, str, ap);
+    if (len >= LOG_RECORD_SIZE - stamp)
+    {
+        record.longText = new char[stamp + len + 1];
+        memcpy(record.longText, record.text, stamp);
+        vsnprintf(record.longText + stamp, len + 1, str, ap2);
+    }
+    va_end(ap2);
+
+    ++ring->head;
+}
+
+void Log::WriteQueued()
+{
+    std::vector<LogRing*> rings;
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_ringsLock);
+        rings = m_rings;
+    }
+
+    bool written[LOG_MAX_FILES] = { false };
+    uint32 dropped = 0;
+
+    for (std::vector<LogRing*>::iterator itr = rings.begin(); itr != rings.end(); ++itr)
+    {
+        LogRing* ring = *itr;
+        long head = ring->head.value();
+        for (long tail = ring->tail.value(); tail != head; ++tail)
+        {
+            LogRecord& record = ring->records[tail % ring->records.size()];
+            WriteLine(LogNames(record.log), record.longText ? record.longText : record.text);
+            written[record.log] = true;
+
+            delete [] record.longText;
+            record.longText = NULL;
+        }
+        ring->tail = head;
+        dropped += ring->dropped.value();
+    }
+
+    if (dropped != m_droppedReported && logFile[LOG_DEFAULT])
+    {
+        outTimestamp(logFile[LOG_DEFAULT]);
+        fprintf(logFile[LOG_DEFAULT], "ERROR: Log: %u lines dropped, LogAsync.BufferSize is too small\n", dropped - m_droppedReported);
+        written[LOG_DEFAULT] = true;
+        m_droppedReported = dropped;
+    }
+
+    for (uint8 i = LOG_DEFAULT; i < LOG_MAX_FILES; ++i)
+        if (written[i] && logFile[i])
+            fflush(logFile[i]);
+}
+
+void Log::WriteLine(LogNames log, const char * text)
+{
+    if (!logFile[log])
+        return;
+
+    // status file holds only last line
+    if (log == LOG_STATUS)
+        logFile[log] = freopen(logFileNames[log].c_str(), logToStr[log][1], logFile[log]);
+
+    if (fputs(text, logFile[log]) < 0)
+    {
+        // if error reopen file
+        logFile[log] = freopen(logFileNames[log].c_str(), logToStr[log][1], logFile[log]);
+        if (!logFile[log])
+            return;
+
+        fputs(text, logFile[log]);
+    }
+    fputc('\n', logFile[log]);
+
+    m_fileSize[log] += strlen(text) + 1;
+    if (m_rotateSize && m_fileSize[log] >= m_rotateSize)
+        RotateLogFile(log);
+}
+
+void Log::RotateLogFile(LogNames log)
+{
+    // these files are written also directly by other Log methods, so writer can't swap them
+    if (log == LOG_DEFAULT || log == LOG_GM || log == LOG_STATUS || log == LOG_CRASH)
+        return;
+
+    fclose(logFile[log]);
+
+    std::string rotated = logFileNames[log];
+    size_t dot_pos = rotated.find_last_of(".");
+    if (dot_pos != rotated.npos)
+        rotated.insert(dot_pos, "_" + GetTimestampStr());
+    else
+        rotated += "_" + GetTimestampStr();
+
+    rename(logFileNames[log].c_str(), rotated.c_str());
+
+    logFile[log] = fopen(logFileNames[log].c_str(), logToStr[log][1]);
+    m_fileSize[log] = 0;
+}
+
 void outstring_log(const char * str, ...)
 {
     if (!str)
@@ -25,6 +25,8 @@
 #include "ace/Thread_Mutex.h"
 #include "Common.h"
 
+#include <cstdarg>
+
 // bitmask
 enum LogFilters
 {
@@ -59,6 +61,13 @@ enum LogNames
     LOG_MAX_FILES
 };
 
+struct LogRing;
+
+namespace ACE_Based
+{
+    class Thread;
+}
+
 class Log
 {
     friend class ACE_Singleton<Log, ACE_Thread_Mutex>;
@@ -105,7 +114,19 @@ class Log
 
         bool IsLogEnabled(LogNames log) const { return logFile[log] != NULL; }
 
+        /// from now outLog() only queues lines for writer thread, LOG_CRASH stays synchronous
+        void StartAsyncWriter();
+        /// stop writer thread and write everything still queued
+        void StopAsyncWriter();
+
     private:
+        friend class LogWriterRunnable;
+
+        void QueueLine(LogNames log, const char * str, va_list ap);
+        void WriteQueued();
+        void WriteLine(LogNames log, const char * text);
+        void RotateLogFile(LogNames log);
+
         FILE* openLogFile(LogNames log);
         FILE* openGmlogPerAccount(uint32 account);
 
@@ -128,6 +149,18 @@ class Log
 
         std::string m_gmlog_filename_format;
         std::string m_whisplog_filename_format;
+
+        // async writer, each thread calling outLog() owns one ring
+        volatile bool m_async;
+        uint32 m_asyncBufferSize;                           // lines per thread
+        uint32 m_asyncFlushInterval;
+        uint64 m_rotateSize;                                // 0 - no rotation
+        uint64 m_fileSize[LOG_MAX_FILES];
+        uint32 m_droppedReported;
+
+        ACE_Thread_Mutex m_ringsLock;                       // guards only list of rings
+        std::vector<LogRing*> m_rings;
+        ACE_Based::Thread* m_writerThread;
 };
 
 #define sLog (*ACE_Singleton<Log, ACE_Thread_Mutex>::instance())
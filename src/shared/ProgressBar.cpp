@@ -31,7 +31,7 @@ char const* const BarGoLink::full  = "*";
 
 BarGoLink::~BarGoLink()
 {
-    if (!m_showOutput)
+    if (!m_enabled)
         return;
 
     printf( "\n" );
@@ -44,10 +44,16 @@ void BarGoLink::SetOutputState(bool on)
     m_showOutput = on;
 }
 
+bool BarGoLink::GetOutputState()
+{
+    return m_showOutput;
+}
+
 BarGoLink::BarGoLink(int row_count, bool on)
 {
-    m_showOutput = on;
-    if (!m_showOutput)
+    // global state from config is kept, bar itself can only disable output
+    m_enabled = on && m_showOutput;
+    if (!m_enabled)
         return;
 
     rec_no    = 0;
@@ -70,7 +76,7 @@ BarGoLink::BarGoLink(int row_count, bool on)
 
 void BarGoLink::step()
 {
-    if (!m_showOutput)
+    if (!m_enabled)
         return;
 
     int i, n;
@@ -32,6 +32,7 @@ class BarGoLink
 
         void step();
         static void SetOutputState(bool on);
+        static bool GetOutputState();
 
     private:
         static char const * const empty;
@@ -39,6 +40,7 @@ class BarGoLink
 
         static bool m_showOutput;
 
+        bool m_enabled;
         int rec_no;
         int rec_pos;
         int num_rec;
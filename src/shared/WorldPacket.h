@@ -28,12 +28,12 @@ class WorldPacket : public ByteBuffer
 {
     public:
                                                             // just container for later use
-        WorldPacket()                                       : ByteBuffer(0), m_opcode(0)
+        WorldPacket()                                       : ByteBuffer(0), m_opcode(0), m_receivedTime(0)
         {
         }
-        explicit WorldPacket(uint16 opcode, size_t res=200) : ByteBuffer(res), m_opcode(opcode) { }
+        explicit WorldPacket(uint16 opcode, size_t res=200) : ByteBuffer(res), m_opcode(opcode), m_receivedTime(0) { }
                                                             // copy constructor
-        WorldPacket(const WorldPacket &packet)              : ByteBuffer(packet), m_opcode(packet.m_opcode)
+        WorldPacket(const WorldPacket &packet)              : ByteBuffer(packet), m_opcode(packet.m_opcode), m_receivedTime(packet.m_receivedTime)
         {
         }
 
@@ -47,8 +47,13 @@ class WorldPacket : public ByteBuffer
         uint16 GetOpcode() const { return m_opcode; }
         void SetOpcode(uint16 opcode) { m_opcode = opcode; }
 
+        // time in microseconds when packet was queued for processing, 0 if not recorded
+        uint64 GetReceivedTime() const { return m_receivedTime; }
+        void SetReceivedTime(uint64 time) { m_receivedTime = time; }
+
     protected:
         uint16 m_opcode;
+        uint64 m_receivedTime;
 };
 #endif
 